@@ -116,7 +116,7 @@ Rectangle {
                 dot_visible : transferManager.pendingIncomingTransfers.length > 0
                 // iconSource: "/resources/icons/shield-network.svg"
                 Layout.fillWidth: true
-                active: leftPanel.isCurrent(["SessionsOverview" , "OutgoingTransfer", "IncomingTransfer", "SavedTransfer", "TransferTracker", "SimpleTransferApproval"])
+                active: leftPanel.isCurrent(["SessionsOverview" , "ArchivedTransfersPage", "OutgoingTransfer", "IncomingTransfer", "SavedTransfer", "TransferTracker", "SimpleTransferApproval"])
                 onClicked: {
                     walletsButton.collapse()
                     leftPanel.buttonClicked("SessionsOverview")
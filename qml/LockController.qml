@@ -44,6 +44,12 @@ Item {
         }
     }
 
+    // Locked wallets are stored and unloaded; they reopen on first use.
+    onLockedChanged: {
+        if (locked && typeof walletManager !== 'undefined')
+            walletManager.suspendAllWallets()
+    }
+
     Component.onCompleted: {
         if (timeoutMinutes > 0) idleTimer_.start()
     }
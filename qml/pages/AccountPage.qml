@@ -333,6 +333,184 @@ Page {
 
 
 
+            // Password hardening
+            ColumnLayout {
+                id: kdfSection
+                Layout.fillWidth: true
+                Layout.topMargin: 8
+                spacing: 4
+                visible: accountManager.is_authenticated
+
+                property var profile: accountManager.kdfProfile()
+
+                Text { text: "Password Hardening"; font.pixelSize: 14; font.weight: Font.Medium; color: themeManager.textColor }
+                Rectangle { Layout.fillWidth: true; height: 1; color: themeManager.borderColor }
+
+                GridLayout {
+                    Layout.fillWidth: true
+                    Layout.topMargin: 8
+                    columns: 2
+                    columnSpacing: 16
+                    rowSpacing: 8
+
+                    Text { text: "Key derivation:"; color: themeManager.textSecondaryColor; font.pixelSize: 12; Layout.preferredWidth: 120 }
+                    Text {
+                        text: kdfSection.profile.kdf
+                              ? qsTr("%1, %2 passes, %3 MiB").arg(kdfSection.profile.kdf)
+                                    .arg(kdfSection.profile.ops_limit).arg(kdfSection.profile.mem_limit_mib)
+                              : "-"
+                        color: themeManager.textColor
+                        font.pixelSize: 12
+                        Layout.fillWidth: true
+                    }
+
+                    Text { text: "Cipher:"; color: themeManager.textSecondaryColor; font.pixelSize: 12; Layout.preferredWidth: 120 }
+                    Text {
+                        text: kdfSection.profile.cipher || "-"
+                        color: themeManager.textColor
+                        font.pixelSize: 12
+                        Layout.fillWidth: true
+                    }
+                }
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    Layout.topMargin: 8
+                    spacing: 8
+
+                    AppButton {
+                        id: tuneKdfButton
+                        property bool busy: false
+                        text: busy ? qsTr("Calibrating…") : qsTr("Tune Unlock Cost")
+                        variant: "secondary"
+                        enabled: !busy
+                        onClicked: tuneKdfDialog.open()
+                    }
+
+                    Text {
+                        text: qsTr("Re-measures Argon2 on this machine and re-encrypts the account file.")
+                        color: themeManager.textSecondaryColor
+                        font.pixelSize: 11
+                        wrapMode: Text.WordWrap
+                        Layout.fillWidth: true
+                    }
+                }
+
+                Connections {
+                    target: accountManager
+                    function onKdfTuned(success) {
+                        tuneKdfButton.busy = false
+                        kdfSection.profile = accountManager.kdfProfile()
+                        if (success) {
+                            statusAlert.text = qsTr("Unlock cost updated")
+                            statusAlert.variant = "success"
+                            statusAlert.visible = true
+                            statusTimer.restart()
+                        }
+                    }
+                    function onCurrentAccountChanged() { kdfSection.profile = accountManager.kdfProfile() }
+                }
+            }
+
+            // Open accounts
+            ColumnLayout {
+                Layout.fillWidth: true
+                Layout.topMargin: 8
+                spacing: 4
+                visible: accountManager.is_authenticated
+
+                Text { text: "Open accounts"; font.pixelSize: 14; font.weight: Font.Medium; color: themeManager.textColor }
+                Rectangle { Layout.fillWidth: true; height: 1; color: themeManager.borderColor }
+
+                Repeater {
+                    model: accountManager.unlocked_accounts
+
+                    RowLayout {
+                        Layout.fillWidth: true
+                        Layout.topMargin: 4
+                        spacing: 8
+
+                        property bool isCurrent: modelData === accountManager.current_account
+
+                        Text {
+                            text: modelData + (isCurrent ? qsTr("  (current)") : "")
+                            font.pixelSize: 12
+                            font.weight: isCurrent ? Font.Medium : Font.Normal
+                            color: themeManager.textColor
+                            Layout.fillWidth: true
+                        }
+
+                        AppButton {
+                            text: qsTr("Switch")
+                            variant: "secondary"
+                            visible: !isCurrent
+                            onClicked: accountManager.switchAccount(modelData)
+                        }
+
+                        AppButton {
+                            text: qsTr("Close")
+                            variant: "secondary"
+                            visible: !isCurrent
+                            onClicked: accountManager.closeSession(modelData)
+                        }
+                    }
+                }
+
+                RowLayout {
+                    Layout.fillWidth: true
+                    Layout.topMargin: 8
+                    spacing: 8
+
+                    ComboBox {
+                        id: otherAccountCombo
+                        Layout.preferredWidth: 180
+                        implicitHeight: 28
+                        font.pixelSize: 12
+                        textRole: "name"
+                        valueRole: "path"
+                        model: accountManager.getAvailableAccounts().filter(function(a) {
+                            return accountManager.unlocked_accounts.indexOf(a.name) < 0
+                        })
+                    }
+
+                    AppInput {
+                        id: otherAccountPwd
+                        Layout.fillWidth: true
+                        echoMode: TextInput.Password
+                        placeholderText: qsTr("Password")
+                        onAccepted: unlockOtherButton.clicked()
+                    }
+
+                    AppButton {
+                        id: unlockOtherButton
+                        text: qsTr("Unlock")
+                        variant: "secondary"
+                        enabled: otherAccountCombo.currentIndex >= 0 && otherAccountPwd.text.length > 0
+                        onClicked: {
+                            unlockOtherError.visible = false
+                            if (accountManager.addSession(otherAccountCombo.currentValue, otherAccountPwd.text))
+                                otherAccountPwd.text = ""
+                        }
+                    }
+                }
+
+                AppAlert {
+                    id: unlockOtherError
+                    Layout.fillWidth: true
+                    visible: false
+                    variant: "error"
+                    closable: true
+                }
+
+                Connections {
+                    target: accountManager
+                    function onLoginFailed(error) {
+                        unlockOtherError.text = error
+                        unlockOtherError.visible = true
+                    }
+                }
+            }
+
             // Actions
             ColumnLayout {
                 Layout.fillWidth: true
@@ -565,6 +743,58 @@ Page {
         }
     }
 
+    AppFormDialog {
+        id: tuneKdfDialog
+        titleText: qsTr("Tune Unlock Cost")
+        confirmButtonText: qsTr("Calibrate")
+        confirmEnabled: tunePwdField.text.length > 0 && tuneMsField.acceptableInput && tuneMemField.acceptableInput
+
+        content: [
+            Text {
+                text: qsTr("Pick how long unlocking may take and how much memory it may use. Higher is harder to brute-force.")
+                color: themeManager.textColor
+                font.pixelSize: 12
+                Layout.fillWidth: true
+                wrapMode: Text.WordWrap
+            },
+            AppInput {
+                id: tunePwdField
+                Layout.fillWidth: true
+                placeholderText: qsTr("Current password")
+                echoMode: TextInput.Password
+                iconSource: "/resources/icons/lock-password.svg"
+            },
+            AppInput {
+                id: tuneMsField
+                Layout.fillWidth: true
+                placeholderText: qsTr("Unlock time (ms)")
+                text: "1000"
+                validator: IntValidator { bottom: 100; top: 10000 }
+                inputMethodHints: Qt.ImhDigitsOnly
+            },
+            AppInput {
+                id: tuneMemField
+                Layout.fillWidth: true
+                placeholderText: qsTr("Max memory (MiB)")
+                text: "256"
+                validator: IntValidator { bottom: 16; top: 4096 }
+                inputMethodHints: Qt.ImhDigitsOnly
+            }
+        ]
+
+        onAccepted: {
+            if (accountManager.tuneKdf(tunePwdField.text, parseInt(tuneMsField.text), parseInt(tuneMemField.text)))
+                tuneKdfButton.busy = true
+            tunePwdField.text = ""
+        }
+
+        onOpened: {
+            tunePwdField.text = ""
+            errorText = ""
+            tunePwdField.forceActiveFocus()
+        }
+    }
+
     AppAddressBookDialog {
         id: daemonPicker
         titleText: qsTr("Select Daemon")
@@ -0,0 +1,253 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+import MoneroMultisigGui 1.0
+import "components"
+
+Page {
+    id: root
+    title: qsTr("Archived Transfers")
+
+    background: Rectangle {
+        color: themeManager.backgroundColor
+    }
+
+    property int pageSize: 50
+    property int totalCount: 0
+    property var rows: []
+
+    function reload() {
+        totalCount = transferManager.archivedTransferCount()
+        rows = transferManager.archivedTransfersPage(0, Math.max(pageSize, rows.length))
+    }
+
+    function loadMore() {
+        rows = rows.concat(transferManager.archivedTransfersPage(rows.length, pageSize))
+    }
+
+    function formatDate(timestamp) {
+        if (!timestamp) return ""
+        return new Date(timestamp * 1000).toLocaleDateString()
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        anchors.margins: 8
+        spacing: 0
+
+        RowLayout {
+            Layout.fillWidth: true
+            Layout.bottomMargin: 8
+            spacing: 12
+
+            AppBackButton {
+                backText: qsTr("Transfers")
+                onClicked: leftPanel.buttonClicked("SessionsOverview")
+            }
+
+            Text {
+                text: qsTr("Archived Transfers")
+                font.pixelSize: 20
+                font.weight: Font.Bold
+                color: themeManager.textColor
+                Layout.fillWidth: true
+            }
+
+            Text {
+                text: qsTr("(%1 transfers)").arg(totalCount)
+                font.pixelSize: 14
+                color: themeManager.textSecondaryColor
+            }
+        }
+
+        Text {
+            text: qsTr("Settled transfers move here after 30 days. Restore one to keep it in the transfer list.")
+            font.pixelSize: 11
+            color: themeManager.textSecondaryColor
+            wrapMode: Text.WordWrap
+            Layout.fillWidth: true
+            Layout.bottomMargin: 8
+        }
+
+        Rectangle {
+            Layout.fillWidth: true
+            height: 1
+            color: themeManager.borderColor
+            Layout.bottomMargin: 8
+        }
+
+        ScrollView {
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            contentWidth: availableWidth
+            clip: true
+
+            ColumnLayout {
+                width: parent.width
+                spacing: 6
+
+                Repeater {
+                    model: rows
+
+                    delegate: Rectangle {
+                        Layout.fillWidth: true
+                        height: rowColumn.implicitHeight + 20
+                        color: themeManager.backgroundColor
+                        border.color: themeManager.borderColor
+                        border.width: 1
+                        radius: 2
+
+                        ColumnLayout {
+                            id: rowColumn
+                            anchors.left: parent.left
+                            anchors.right: parent.right
+                            anchors.top: parent.top
+                            anchors.margins: 10
+                            spacing: 6
+
+                            RowLayout {
+                                Layout.fillWidth: true
+                                spacing: 8
+
+                                ColumnLayout {
+                                    Layout.fillWidth: true
+                                    spacing: 2
+
+                                    Text {
+                                        text: modelData.wallet_name || modelData.wallet_ref || "Unknown Wallet"
+                                        font.pixelSize: 14
+                                        font.weight: Font.Medium
+                                        color: themeManager.textColor
+                                        Layout.fillWidth: true
+                                        elide: Text.ElideRight
+                                    }
+
+                                    Text {
+                                        text: modelData.ref
+                                        font.pixelSize: 10
+                                        font.family: "Monospace"
+                                        color: themeManager.textSecondaryColor
+                                        Layout.fillWidth: true
+                                        elide: Text.ElideMiddle
+                                    }
+                                }
+
+                                AppCopyButton {
+                                    textToCopy: modelData.ref
+                                    size: 12
+                                }
+                            }
+
+                            RowLayout {
+                                Layout.fillWidth: true
+                                spacing: 12
+
+                                AppStatusIndicator {
+                                    status: (modelData.stage || "").toUpperCase() === "COMPLETE" ? "success" : "error"
+                                    text: modelData.stage || "Unknown"
+                                    dotSize: 5
+                                }
+
+                                Text {
+                                    text: qsTr("Created %1").arg(formatDate(modelData.created_at))
+                                    font.pixelSize: 9
+                                    color: themeManager.textSecondaryColor
+                                    visible: modelData.created_at > 0
+                                }
+
+                                Text {
+                                    text: qsTr("Archived %1").arg(formatDate(modelData.archived_at))
+                                    font.pixelSize: 9
+                                    color: themeManager.textSecondaryColor
+                                    visible: modelData.archived_at > 0
+                                }
+
+                                Text {
+                                    text: (modelData.type || "").toUpperCase()
+                                    font.pixelSize: 8
+                                    color: themeManager.textSecondaryColor
+                                    font.weight: Font.Medium
+                                }
+
+                                Item { Layout.fillWidth: true }
+
+                                AppButton {
+                                    text: qsTr("View Details")
+                                    iconSource: "/resources/icons/eye.svg"
+                                    variant: "secondary"
+                                    implicitHeight: 24
+                                    onClicked: {
+                                        const url = Qt.resolvedUrl("SavedTransfer.qml")
+                                        middlePanel.currentPageUrl = url
+                                        middlePanel.stackView.replace(url, { transferRef: modelData.ref })
+                                    }
+                                }
+
+                                AppButton {
+                                    text: qsTr("Restore")
+                                    iconSource: "/resources/icons/refresh-circle.svg"
+                                    variant: "secondary"
+                                    implicitHeight: 24
+                                    onClicked: {
+                                        if (transferManager.restoreArchivedTransfer(modelData.ref)) {
+                                            statusAlert.variant = "success"
+                                            statusAlert.text = qsTr("Transfer restored to the transfer list")
+                                        } else {
+                                            statusAlert.variant = "error"
+                                            statusAlert.text = qsTr("Could not restore; its wallet is no longer in this account")
+                                        }
+                                        statusAlert.visible = true
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+
+                AppButton {
+                    text: qsTr("Load more")
+                    variant: "secondary"
+                    visible: rows.length < totalCount
+                    Layout.alignment: Qt.AlignHCenter
+                    onClicked: loadMore()
+                }
+
+                ColumnLayout {
+                    Layout.fillWidth: true
+                    Layout.alignment: Qt.AlignCenter
+                    spacing: 12
+                    visible: totalCount === 0
+
+                    AppIcon {
+                        source: "/resources/icons/layers.svg"
+                        width: 32
+                        height: 32
+                        color: themeManager.textSecondaryColor
+                        Layout.alignment: Qt.AlignHCenter
+                    }
+
+                    Text {
+                        text: qsTr("No archived transfers")
+                        font.pixelSize: 14
+                        color: themeManager.textSecondaryColor
+                        Layout.alignment: Qt.AlignHCenter
+                    }
+                }
+            }
+        }
+
+        AppAlert {
+            id: statusAlert
+            Layout.fillWidth: true
+            visible: false
+            closable: true
+        }
+    }
+
+    Connections {
+        target: transferManager
+        function onArchiveChanged() { reload() }
+    }
+
+    Component.onCompleted: reload()
+}
@@ -846,6 +846,7 @@ Page {
         walletMeta = WalletManager.getWalletMeta(walletName) || {}
 
         WalletManager.connectWallet(walletName)
+        WalletManager.warmTransferInputs(walletName)
         walletObj = WalletManager.walletInstance(walletName)
         if (walletObj && walletObj.getBalance) walletObj.getBalance()
         if (walletObj && walletObj.startSync && !walletObj.activeSyncTimer) walletObj.startSync(30)
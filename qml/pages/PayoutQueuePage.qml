@@ -0,0 +1,351 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+import MoneroMultisigGui 1.0
+import "components"
+
+Page {
+    id: root
+    title: qsTr("Payouts")
+
+    property string walletName: ""
+    property var rows: []
+
+    background: Rectangle {
+        color: themeManager.backgroundColor
+    }
+
+    function reload() {
+        rows = transferManager.payoutQueue(walletName).slice().reverse()
+    }
+
+    function atomicToXMR(a) { return (Number(a) / 1e12).toFixed(12) }
+    // Atomic units as a string, so the amount is exact and never read as XMR.
+    function xmrToAtomic(text) {
+        const parts = String(text).trim().split(".")
+        if (parts.length > 2 || !/^[0-9]*$/.test(parts[0]) || !/^[0-9]{0,12}$/.test(parts[1] || ""))
+            return ""
+        const frac = ((parts[1] || "") + "000000000000").slice(0, 12)
+        return ((parts[0] || "") + frac).replace(/^0+/, "")
+    }
+    function fmtDate(ts) { if (!ts) return ""; return new Date(ts * 1000).toLocaleString() }
+
+    function stateStatus(s) {
+        switch (s) {
+            case "sent":         return "success"
+            case "batched":      return "pending"
+            case "needs_review": return "pending"
+            case "failed":       return "error"
+            case "cancelled":    return "offline"
+            default:             return "unknown"
+        }
+    }
+
+    function stateText(s) {
+        switch (s) {
+            case "queued":       return qsTr("Queued")
+            case "batched":      return qsTr("In transfer")
+            case "sent":         return qsTr("Sent")
+            case "needs_review": return qsTr("Needs review")
+            case "failed":       return qsTr("Failed")
+            case "cancelled":    return qsTr("Cancelled")
+            default:             return s
+        }
+    }
+
+    function showStatus(ok, okText, errText) {
+        statusAlert.variant = ok ? "success" : "error"
+        statusAlert.text = ok ? okText : errText
+        statusAlert.visible = true
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        anchors.margins: 8
+        spacing: 0
+
+        RowLayout {
+            Layout.fillWidth: true
+            Layout.bottomMargin: 8
+            spacing: 12
+
+            AppBackButton {
+                backText: qsTr("Wallets")
+                onClicked: leftPanel.buttonClicked("Wallets")
+            }
+
+            Text {
+                text: qsTr("Payouts · %1").arg(walletName)
+                font.pixelSize: 20
+                font.weight: Font.Bold
+                color: themeManager.textColor
+                Layout.fillWidth: true
+                elide: Text.ElideRight
+            }
+
+            AppButton {
+                text: qsTr("Send Now")
+                variant: "primary"
+                enabled: rows.some(function(r) { return r.state === "queued" })
+                onClicked: {
+                    const ref = transferManager.flushPayouts(walletName)
+                    showStatus(ref !== "", qsTr("Batch transfer started"),
+                               qsTr("Could not start a batch transfer"))
+                }
+            }
+        }
+
+        Text {
+            text: qsTr("Queued payouts leave together in one transfer once the batch is full or the oldest has waited long enough. A payout whose transfer may have reached a signer is never queued again on its own; it waits for review.")
+            font.pixelSize: 11
+            color: themeManager.textSecondaryColor
+            wrapMode: Text.WordWrap
+            Layout.fillWidth: true
+            Layout.bottomMargin: 8
+        }
+
+        // Queue a payout
+        ColumnLayout {
+            Layout.fillWidth: true
+            Layout.bottomMargin: 8
+            spacing: 6
+
+            Text {
+                text: qsTr("Queue Payout")
+                font.pixelSize: 14
+                font.weight: Font.Medium
+                color: themeManager.textColor
+            }
+
+            Rectangle {
+                Layout.fillWidth: true
+                height: 1
+                color: themeManager.borderColor
+            }
+
+            RowLayout {
+                Layout.fillWidth: true
+                spacing: 8
+
+                AppInput {
+                    id: addressField
+                    Layout.fillWidth: true
+                    placeholderText: qsTr("XMR address or subaddress")
+                    font.family: "Monospace"
+                    font.pixelSize: 10
+                }
+
+                AppInput {
+                    id: amountField
+                    Layout.preferredWidth: 120
+                    placeholderText: "0.0"
+                }
+
+                AppInput {
+                    id: labelField
+                    Layout.preferredWidth: 160
+                    placeholderText: qsTr("Label (optional)")
+                }
+
+                AppButton {
+                    text: qsTr("Queue")
+                    variant: "secondary"
+                    enabled: addressField.text.trim() !== "" && xmrToAtomic(amountField.text) !== ""
+                    onClicked: {
+                        const id = transferManager.queuePayout(walletName, addressField.text.trim(),
+                                                               xmrToAtomic(amountField.text), labelField.text.trim())
+                        showStatus(id !== "", qsTr("Payout queued"),
+                                   qsTr("Not queued: use a standard address or subaddress on this wallet's network"))
+                        if (id !== "") {
+                            addressField.text = ""
+                            amountField.text = ""
+                            labelField.text = ""
+                        }
+                    }
+                }
+            }
+        }
+
+        Rectangle {
+            Layout.fillWidth: true
+            height: 1
+            color: themeManager.borderColor
+            Layout.bottomMargin: 8
+        }
+
+        ScrollView {
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            contentWidth: availableWidth
+            clip: true
+
+            ColumnLayout {
+                width: parent.width
+                spacing: 6
+
+                Repeater {
+                    model: rows
+
+                    delegate: Rectangle {
+                        Layout.fillWidth: true
+                        height: rowColumn.implicitHeight + 20
+                        color: themeManager.backgroundColor
+                        border.color: themeManager.borderColor
+                        border.width: 1
+                        radius: 2
+
+                        ColumnLayout {
+                            id: rowColumn
+                            anchors.left: parent.left
+                            anchors.right: parent.right
+                            anchors.top: parent.top
+                            anchors.margins: 10
+                            spacing: 6
+
+                            RowLayout {
+                                Layout.fillWidth: true
+                                spacing: 8
+
+                                ColumnLayout {
+                                    Layout.fillWidth: true
+                                    spacing: 2
+
+                                    Text {
+                                        text: qsTr("%1 XMR").arg(atomicToXMR(modelData.amount))
+                                              + (modelData.label ? "  ·  " + modelData.label : "")
+                                        font.pixelSize: 14
+                                        font.weight: Font.Medium
+                                        color: themeManager.textColor
+                                        Layout.fillWidth: true
+                                        elide: Text.ElideRight
+                                    }
+
+                                    Text {
+                                        text: modelData.address
+                                        font.pixelSize: 10
+                                        font.family: "Monospace"
+                                        color: themeManager.textSecondaryColor
+                                        Layout.fillWidth: true
+                                        elide: Text.ElideMiddle
+                                    }
+                                }
+
+                                AppCopyButton {
+                                    textToCopy: modelData.address
+                                    size: 12
+                                }
+                            }
+
+                            RowLayout {
+                                Layout.fillWidth: true
+                                spacing: 12
+
+                                AppStatusIndicator {
+                                    status: stateStatus(modelData.state)
+                                    text: stateText(modelData.state)
+                                    dotSize: 5
+                                }
+
+                                Text {
+                                    text: qsTr("Queued %1").arg(fmtDate(modelData.queued_at))
+                                    font.pixelSize: 9
+                                    color: themeManager.textSecondaryColor
+                                    visible: modelData.queued_at > 0
+                                }
+
+                                Text {
+                                    text: modelData.stage ? qsTr("Transfer: %1").arg(modelData.stage) : ""
+                                    font.pixelSize: 9
+                                    color: themeManager.textSecondaryColor
+                                    visible: text !== ""
+                                }
+
+                                Text {
+                                    text: modelData.last_error ? qsTr("Last: %1").arg(modelData.last_error) : ""
+                                    font.pixelSize: 9
+                                    color: themeManager.textSecondaryColor
+                                    visible: text !== ""
+                                }
+
+                                Item { Layout.fillWidth: true }
+
+                                AppButton {
+                                    text: qsTr("Cancel")
+                                    variant: "secondary"
+                                    implicitHeight: 24
+                                    visible: modelData.state === "queued"
+                                    onClicked: showStatus(transferManager.cancelPayout(walletName, modelData.id),
+                                                          qsTr("Payout cancelled"),
+                                                          qsTr("Could not cancel; it may already be in a transfer"))
+                                }
+
+                                AppButton {
+                                    text: qsTr("Mark Sent")
+                                    variant: "secondary"
+                                    implicitHeight: 24
+                                    visible: modelData.state === "needs_review"
+                                    ToolTip.visible: hovered
+                                    ToolTip.text: qsTr("The transfer reached the chain; close this payout")
+                                    ToolTip.delay: 500
+                                    onClicked: showStatus(transferManager.resolvePayout(walletName, modelData.id, true),
+                                                          qsTr("Payout marked as sent"),
+                                                          qsTr("Could not update the payout"))
+                                }
+
+                                AppButton {
+                                    text: qsTr("Queue Again")
+                                    variant: "secondary"
+                                    implicitHeight: 24
+                                    visible: modelData.state === "needs_review"
+                                    ToolTip.visible: hovered
+                                    ToolTip.text: qsTr("Only if the transfer is known not to have been broadcast")
+                                    ToolTip.delay: 500
+                                    onClicked: showStatus(transferManager.resolvePayout(walletName, modelData.id, false),
+                                                          qsTr("Payout queued again"),
+                                                          qsTr("Could not update the payout"))
+                                }
+                            }
+                        }
+                    }
+                }
+
+                ColumnLayout {
+                    Layout.fillWidth: true
+                    Layout.alignment: Qt.AlignCenter
+                    spacing: 12
+                    visible: rows.length === 0
+
+                    AppIcon {
+                        source: "/resources/icons/layers.svg"
+                        width: 32
+                        height: 32
+                        color: themeManager.textSecondaryColor
+                        Layout.alignment: Qt.AlignHCenter
+                    }
+
+                    Text {
+                        text: qsTr("No payouts")
+                        font.pixelSize: 14
+                        color: themeManager.textSecondaryColor
+                        Layout.alignment: Qt.AlignHCenter
+                    }
+                }
+            }
+        }
+
+        AppAlert {
+            id: statusAlert
+            Layout.fillWidth: true
+            visible: false
+            closable: true
+        }
+    }
+
+    Connections {
+        target: transferManager
+        function onPayoutQueueChanged(name) { if (name === walletName) reload() }
+        function onCurrentSessionChanged() { reload() }
+    }
+
+    Component.onCompleted: reload()
+}
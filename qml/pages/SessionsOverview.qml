@@ -283,6 +283,18 @@ Page {
                 color: themeManager.textSecondaryColor
             }
 
+            AppButton {
+                text: qsTr("Archived")
+                iconSource: "/resources/icons/layers.svg"
+                variant: "secondary"
+                implicitHeight: 28
+                onClicked: {
+                    const url = Qt.resolvedUrl("ArchivedTransfersPage.qml")
+                    middlePanel.currentPageUrl = url
+                    middlePanel.stackView.replace(url)
+                }
+            }
+
             AppButton {
                 text: qsTr("Refresh")
                 iconSource: "/resources/icons/refresh.svg"
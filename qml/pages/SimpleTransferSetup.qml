@@ -575,6 +575,7 @@ Page {
     Component.onCompleted: {
         walletMeta = WalletManager.getWalletMeta(walletName) || {}
         WalletManager.connectWallet(walletName)
+        WalletManager.warmTransferInputs(walletName)
         walletObj = WalletManager.walletInstance(walletName)
         if (walletObj && walletObj.getBalance) walletObj.getBalance()
         if (walletObj && walletObj.startSync && !walletObj.activeSyncTimer) walletObj.startSync(30)
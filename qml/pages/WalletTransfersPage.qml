@@ -10,121 +10,36 @@ Page {
 
     property string walletName: ""
     property var wallet: null
-    property var rawTransfers: []
 
     background: Rectangle {
         color: themeManager.backgroundColor
     }
 
 
-    readonly property int tickSeconds: 10
-    readonly property int autoRefreshSeconds: 30
-
-    property int secondsSinceRefresh: 0
-    property int secondsUntilAutoRefresh: autoRefreshSeconds
-    property double lastRefreshMs: 0
-
-    function fmtAgo(sec) {
-        if (sec <= 0) return qsTr("just now")
-        if (sec < 60) return qsTr("%1s ago").arg(sec)
-        const m = Math.floor(sec / 60)
-        return qsTr("%1m ago").arg(m)
-    }
-
-    function fmtIn(sec) {
-        if (sec <= 0) return qsTr("now")
-        if (sec < 60) return qsTr("in %1s").arg(sec)
-        const m = Math.ceil(sec / 60)
-        return qsTr("in %1m").arg(m)
-    }
-
-    function doRefresh(reason) {
-        if (!wallet) return
-
-
-        if (wallet.busy) return
-
+    function doRefresh() {
+        if (!wallet || wallet.busy) return
+        // New rows arrive through the model once the wallet publishes.
         WalletManager.refreshWallet(walletName)
-
-        wallet.getTransfers()
-
-        secondsUntilAutoRefresh = autoRefreshSeconds
-
-        secondsSinceRefresh = 0
     }
 
     function atomicToXMR(a) { return (Number(a) / 1e12).toFixed(12) }
     function fmtDate(ts) { if (!ts) return ""; return new Date(ts * 1000).toLocaleString() }
 
-    function processTransfers() {
-        if (!rawTransfers) return
-
-        const want = dirFilter.currentText
-        function keep(m) {
-            if (want === "Incoming") return m.direction === "in"
-            if (want === "Outgoing") return m.direction === "out"
-            if (want === "Pending") return m.height === 0 || m.confirmations === 0
-            return true
-        }
-
-        transferModel.clear()
-        for (let i = 0; i < rawTransfers.length; ++i) {
-            const m = rawTransfers[i]
-            if (!keep(m)) continue
-
-            const ts = Number(m.timestamp || 0)
-            const date = ts ? new Date(ts * 1000) : null
-            const section = date ?
-                (date.getFullYear() + "-" +
-                 (date.getMonth() + 1).toString().padStart(2, '0')) :
-                (m.height === 0 ? qsTr("Pending") : qsTr("Unknown date"))
-
-            transferModel.append({
-                txid: m.txid || "",
-                amount: m.amount || 0,
-                blockHeight: m.height || 0,
-                direction: m.direction || "",
-                confirmations: m.confirmations || 0,
-                unlocked: !!m.unlocked,
-                subaddr_major: m.subaddr_major || 0,
-                subaddr_minor: m.subaddr_minor || 0,
-                address: m.address || "",
-                timestamp: ts,
-                section: section
-            })
-        }
-    }
-
     Component.onCompleted: {
         wallet = WalletManager.walletInstance(walletName)
-        if (wallet) {
-            wallet.getTransfers()
-            secondsSinceRefresh = 0
-            secondsUntilAutoRefresh = autoRefreshSeconds
-        }
     }
 
     Connections {
         target: WalletManager
         function onEpochChanged() {
             wallet = WalletManager.walletInstance(walletName)
-            if (root.visible && wallet) wallet.getTransfers()
         }
     }
 
-    Timer {
-        id: tickTimer
-        interval: tickSeconds * 1000
-        repeat: true
-        running: root.visible
-        onTriggered: {
-            secondsSinceRefresh += tickSeconds
-            secondsUntilAutoRefresh = Math.max(0, secondsUntilAutoRefresh - tickSeconds)
-
-            if (secondsUntilAutoRefresh <= 0) {
-                doRefresh("auto")
-            }
-        }
+    TransferHistoryModel {
+        id: transferModel
+        wallet: root.wallet
+        directionFilter: dirFilter.currentText
     }
 
 
@@ -182,9 +97,6 @@ Page {
                     rightPadding: 24
                 }
 
-                onCurrentTextChanged: {
-                    processTransfers()
-                }
             }
 
             Item { Layout.fillWidth: true }
@@ -194,12 +106,10 @@ Page {
                 Layout.bottomMargin: 8
                 spacing: 12
                 Text {
-                    // feedback: refreshed X ago • next refresh in Y
                     visible: wallet !== null
                     text: wallet && wallet.busy
                           ? qsTr("Refreshing…")
-                          : qsTr("Refreshed %1")
-                    .arg(fmtAgo(secondsSinceRefresh))
+                          : qsTr("Block %1").arg(transferModel.chainHeight)
 
                     color: themeManager.textSecondaryColor
                     font.pixelSize: 10
@@ -211,14 +121,11 @@ Page {
                     variant: "secondary"
                     implicitHeight: 28
                     enabled: wallet && !wallet.busy
-                    onClicked: doRefresh("manual")
+                    onClicked: doRefresh()
                 }
             }
         }
 
-        ListModel { id: transferModel }
-
-
         ListView {
             id: list
             Layout.fillWidth: true
@@ -250,7 +157,7 @@ Page {
                 text: qsTr("No transfers found")
                 color: themeManager.textSecondaryColor
                 font.pixelSize: 12
-                visible: list.count === 0 && wallet && !wallet.busy
+                visible: list.count === 0 && wallet && !transferModel.loading
             }
         }
 
@@ -261,11 +168,11 @@ Page {
             Text {
                 id: status
                 text: wallet
-                      ? (wallet.busy
+                      ? (transferModel.loading && transferModel.count === 0
                          ? qsTr("Loading…")
-                         : qsTr("%1 transfers").arg(transferModel.count))
+                         : qsTr("%1 transfers%2").arg(transferModel.count).arg(transferModel.hasMore ? "+" : ""))
                       : qsTr("Wallet not connected")
-                color: wallet && wallet.busy ? themeManager.textSecondaryColor : themeManager.textColor
+                color: transferModel.loading ? themeManager.textSecondaryColor : themeManager.textColor
                 font.pixelSize: 10
             }
 
@@ -283,13 +190,13 @@ Page {
             required property string txid
             required property string direction
             required property var amount
-            required property int confirmations
-            required property int blockHeight
+            required property var confirmations
+            required property var blockHeight
             required property bool unlocked
             required property int subaddr_major
             required property int subaddr_minor
             required property string address
-            required property int timestamp
+            required property var timestamp
             required property string section
 
             width: list.width
@@ -569,15 +476,4 @@ Page {
             open()
         }
     }
-
-    Connections {
-        target: wallet
-        enabled: wallet !== null
-        function onTransfersReady(items) {
-            if (!items) return
-
-            rawTransfers = items
-            processTransfers()
-        }
-    }
 }
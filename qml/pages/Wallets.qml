@@ -70,6 +70,16 @@ Page {
 
                 Item {Layout.fillWidth: true }
 
+                AppButton {
+                    text: qsTr("Connect All")
+                    variant: "secondary"
+                    enabled: WalletManager.walletConnectedCount < walletView.count
+                    onClicked: {
+                        walletView.reportVisible()
+                        WalletManager.connectWallets(walletView.model)
+                    }
+                }
+
                 AppButton {
                     text: qsTr("Stop All Wallets")
                     variant: "warning"
@@ -92,6 +102,19 @@ Page {
                 spacing: 8
                 delegate: WalletDelegate {}
 
+                // Rows on screen open first when several wallets connect at once.
+                function reportVisible() {
+                    var names = []
+                    for (var i = 0; i < count; ++i) {
+                        var item = itemAtIndex(i)
+                        if (item && item.y + item.height > contentY && item.y < contentY + height)
+                            names.push(model[i])
+                    }
+                    WalletManager.setVisibleWallets(names)
+                }
+                onContentYChanged: reportVisible()
+                onCountChanged: reportVisible()
+
 
                 Text {
                     anchors.centerIn: parent
@@ -127,12 +150,34 @@ Page {
 
         readonly property bool isConnected: wallet !== null
         readonly property bool isBusy:     wallet ? wallet.busy : false
+        readonly property bool isSuspended: wallet ? wallet.suspended : false
 
         property var    address_text: walletMeta?  walletMeta.address : "pending"
 
+        property var    readiness: ({})
+
+        function refreshReadiness() {
+            readiness = walletMeta && walletMeta.multisig ? transferManager.multisigReadiness(name) : ({})
+        }
+
         Component.onCompleted: {
             wallet = WalletManager.walletInstance(name)
             walletMeta = WalletManager.getWalletMeta(name)
+            refreshReadiness()
+        }
+
+        Connections {
+            target: transferManager
+            function onMultisigReadinessChanged(walletName) {
+                if (walletName === name) refreshReadiness()
+            }
+        }
+
+        Timer {
+            interval: 30000
+            repeat: true
+            running: isConnected && !!(walletMeta && walletMeta.multisig)
+            onTriggered: refreshReadiness()
         }
 
         Connections {
@@ -185,8 +230,10 @@ Page {
                 Item {Layout.fillWidth: true}
 
                 AppStatusIndicator {
-                    status: isConnected ? "online" : "offline"
-                    text: isConnected ? qsTr("Connected") : qsTr("Disconnected")
+                    status: !isConnected ? "offline" : isSuspended ? "pending" : "online"
+                    text: !isConnected ? qsTr("Disconnected")
+                        : isSuspended  ? qsTr("Suspended")
+                        : qsTr("Connected")
                     dotSize: 6
                     Layout.alignment: Qt.AlignVCenter
                 }
@@ -230,6 +277,16 @@ Page {
                     color: themeManager.textSecondaryColor
                 }
 
+                Text {
+                    readonly property int age: readiness.age_secs !== undefined ? readiness.age_secs : -1
+                    text: readiness.ready
+                          ? qsTr("Ready to spend (%1)").arg(age < 60 ? qsTr("%1 s ago").arg(age) : qsTr("%1 min ago").arg(Math.floor(age / 60)))
+                          : (age >= 0 ? qsTr("Peer infos stale (%1 min old)").arg(Math.floor(age / 60)) : qsTr("Peer infos not collected"))
+                    font.pixelSize: 10
+                    visible : !!(walletMeta && walletMeta.multisig) && wallet
+                    color: readiness.ready ? themeManager.successColor : themeManager.textSecondaryColor
+                }
+
                 Item { Layout.fillWidth: true }
             }
 
@@ -345,6 +402,17 @@ Page {
                         }
                     }
 
+                    AppButton {
+                        text: qsTr("Payouts")
+                        variant: "secondary"
+                        visible: !!(walletMeta && walletMeta.multisig)
+                        onClicked: {
+                            const page = "PayoutQueuePage.qml"
+                            middlePanel.currentPageUrl = page
+                            middlePanel.stackView.replace(page, { walletName: name })
+                        }
+                    }
+
                     AppButton {
                         text: qsTr("Receive")
                         variant: "secondary"
@@ -242,6 +242,7 @@ Rectangle {
                         implicitHeight: 28
                         onClicked: {
                             isCreatingAccount = !isCreatingAccount
+                            if (isCreatingAccount) accountManager.prepareKdf()
                             passwordField.clear()
                             confirmPasswordField.clear()
                             errorAlert.visible = false
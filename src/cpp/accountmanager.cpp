@@ -16,6 +16,8 @@
 #include <QDebug>
 #include <QDirIterator>
 #include <QCoreApplication>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
 #ifdef Q_OS_LINUX
 #include <QtGlobal>
 #endif
@@ -113,6 +115,9 @@ static constexpr const char* kDataRootFolderName = "monero-multisig-gui-data";
 static constexpr const char* kConfigFileName     = "config.txt";
 static constexpr const char* kConfigKeyDataRoot  = "DATA_ROOT=";
 
+static constexpr int     kDefaultUnlockMs   = 1000;
+static constexpr quint64 kDefaultKdfMemCap  = quint64(256) * 1024 * 1024;
+
 AccountManager::AccountManager(QObject *parent) : QObject(parent)
 {
 
@@ -298,6 +303,8 @@ void AccountManager::resetState()
     m_hasLoggedOut        = false;
     m_key.clear();
     m_salt.clear();
+    m_kdf    = CryptoUtils::KdfParams{};
+    m_cipher = CryptoUtils::Cipher::XChaCha20Poly1305;
     m_accountData = QJsonObject();
     m_currentAccount.clear();
     m_currentFilePath.clear();
@@ -328,166 +335,341 @@ bool AccountManager::persistUnlocked()
         return false;
     }
 
-
-    quint16 saltLen = static_cast<quint16>(m_salt.size());
-    QByteArray lenBuf(2, 0);
-    qToBigEndian<quint16>(saltLen, lenBuf.data());
-    out.write(lenBuf);
-    out.write(m_salt);
-
-
-    QByteArray nonce;
-    QByteArray cipher = CryptoUtils::encrypt(QJsonDocument(m_accountData)
-                                                 .toJson(QJsonDocument::Compact),
-                                             m_key, nonce);
+    FileHeader hdr;
+    hdr.cipher = m_cipher;
+    hdr.kdf    = m_kdf;
+    hdr.salt   = m_salt;
+    const QByteArray hdrBytes = encodeHeader(hdr);
+    out.write(hdrBytes);
+
+    QByteArray cipher;
+    try {
+        cipher = CryptoUtils::encrypt(QJsonDocument(m_accountData)
+                                          .toJson(QJsonDocument::Compact),
+                                      m_key, m_cipher, hdrBytes);
+    } catch (const std::exception &e) {
+        qDebug() << "[AccountManager] persist: encrypt failed" << e.what();
+        out.cancelWriting();
+        return false;
+    }
     out.write(cipher);
     const bool ok = out.commit();
 
     return ok;
 }
 
-
-bool AccountManager::login(const QString &filePath, const QString &password)
+static bool readAccountFile(const QString &path, FileHeader &hdr,
+                            QByteArray &hdrBytes, QByteArray &body)
 {
+    QFile in(path);
+    if (!in.open(QIODevice::ReadOnly)) return false;
+    const QByteArray all = in.readAll();
+    in.close();
 
+    qsizetype off = 0;
+    if (!decodeHeader(all, hdr, off)) return false;
 
-    bool ok  = false;
-    QString acct;
-    {
-
-        QMutexLocker locker(&m_mutex);
-        resetState();
+    // legacy files carry no associated data
+    hdrBytes = hdr.version > 0 ? all.left(off) : QByteArray();
+    body     = all.mid(off);
+    return true;
+}
 
-        if (!QFileInfo::exists(filePath)) {
 
-            emit loginFailed(tr("File does not exist: %1").arg(filePath));
-            return false;
-        }
+bool AccountManager::openSession(const QString &filePath, const QString &password,
+                                 Session &out, QString &error) const
+{
+    if (!QFileInfo::exists(filePath)) {
+        error = tr("File does not exist: %1").arg(filePath);
+        return false;
+    }
 
-        auto lockfile = std::make_unique<QLockFile>(filePath + QStringLiteral(".lock"));
-        if (!lockfile->tryLock()) {
+    auto lockfile = std::make_shared<QLockFile>(filePath + QStringLiteral(".lock"));
+    if (!lockfile->tryLock()) {
+        error = tr("Account is already in use");
+        return false;
+    }
 
-            emit loginFailed(tr("Account is already in use"));
-            return false;
-        }
+    if (!QFileInfo(filePath).isReadable()) {
+        error = tr("Cannot open account file");
+        return false;
+    }
 
-        QFile in(filePath);
-        if (!in.open(QIODevice::ReadOnly)) {
+    FileHeader hdr;
+    QByteArray hdrBytes, cipher;
+    if (!readAccountFile(filePath, hdr, hdrBytes, cipher)) {
+        error = tr("Corrupted account file");
+        return false;
+    }
+    if (!cipherAvailable(hdr.cipher)) {
+        error = tr("Account uses %1, which this CPU does not support").arg(cipherName(hdr.cipher));
+        return false;
+    }
 
-            emit loginFailed(tr("Cannot open account file"));
-            return false;
-        }
+    QByteArray key;
+    try {
+        key = CryptoUtils::deriveKey(password, hdr.salt, hdr.kdf);
+    } catch (const std::exception &e) {
+        error = QString::fromLatin1(e.what());
+        return false;
+    }
 
-        // --- read header ---
-        const QByteArray lenBuf = in.read(2);
-        if (lenBuf.size() != 2) {
+    QByteArray plain;
+    if (!CryptoUtils::decrypt(cipher, key, hdr.cipher, hdrBytes, plain)) {
+        error = tr("Invalid password for this account");
+        return false;
+    }
 
-            emit loginFailed(tr("Corrupted account file"));
-            return false;
-        }
-        const quint16 saltLen = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(lenBuf.constData()));
-        m_salt = in.read(saltLen);
-        if (m_salt.size() != saltLen) {
+    const QJsonDocument doc = QJsonDocument::fromJson(plain);
+    if (!doc.isObject()) {
+        error = tr("Account data is not valid JSON");
+        return false;
+    }
 
-            emit loginFailed(tr("Corrupted account file"));
-            return false;
-        }
+    out.data          = doc.object();
+    out.key           = key;
+    out.salt          = hdr.salt;
+    out.kdf           = hdr.kdf;
+    out.cipher        = hdr.cipher;
+    out.filePath      = filePath;
+    out.account       = QFileInfo(filePath).baseName();
+    out.lock          = lockfile;
+    out.legacyHeader  = hdr.version < FileFormatVersion;
+    return true;
+}
 
-        const QByteArray cipher = in.readAll();
-        in.close();
+void AccountManager::installSessionLocked(Session &&s)
+{
+    m_accountData = std::move(s.data);
+    m_key         = s.key;
+    m_salt        = s.salt;
+    m_kdf         = s.kdf;
+    m_cipher      = s.cipher;
+    loadSettingsFromJson(m_accountData);
 
-        try {
-            m_key = CryptoUtils::deriveKey(password, m_salt);
+    m_currentAccountOnion = pickCurrentOnionFrom(m_accountData.value("tor_identities").toArray());
+    m_trustedPeers = sanitizeTrustedPeers(
+        m_accountData.value("trusted_peers").toObject().toVariantMap());
 
-        } catch (const std::exception &e) {
+    m_isAuthenticated   = true;
+    m_hasLoggedOut      = false;
+    m_currentFilePath   = s.filePath;
+    m_currentAccount    = s.account;
+    m_lock              = std::move(s.lock);
+}
 
-            emit loginFailed(QString::fromLatin1(e.what()));
-            return false;
-        }
+// Old unversioned files are rewritten once with a header; the KDF
+// parameters stay the same so the derived key can be reused.
+void AccountManager::migrateLegacyHeaderLocked()
+{
+    m_cipher = preferredCipher();
+    if (!persistUnlocked())
+        qDebug() << "[AccountManager] login: header migration failed, keeping legacy file";
+    else
+        qDebug().noquote() << "[AccountManager] migrated account file to v" << int(FileFormatVersion)
+                           << cipherName(m_cipher);
+}
 
-        QByteArray plain;
-        if (!CryptoUtils::decrypt(cipher, m_key, plain)) {
+AccountManager::Session AccountManager::takeSessionLocked()
+{
+    Session s;
+    s.data     = m_accountData;
+    s.key      = m_key;
+    s.salt     = m_salt;
+    s.kdf      = m_kdf;
+    s.cipher   = m_cipher;
+    s.filePath = m_currentFilePath;
+    s.account  = m_currentAccount;
+    s.lock     = std::move(m_lock);   // keep the account file locked while parked
+    resetState();
+    return s;
+}
 
-            emit loginFailed(tr("Invalid password for this account"));
+bool AccountManager::login(const QString &filePath, const QString &password)
+{
+    QString acct;
+    QStringList closed;
+    {
+        QMutexLocker locker(&m_mutex);
+        resetState();
+        closed = closeParkedLocked();
+
+        Session s;
+        QString error;
+        if (!openSession(filePath, password, s, error)) {
+            locker.unlock();
+            for (const QString &name : std::as_const(closed)) emit sessionClosed(name);
+            emit loginFailed(error);
             return false;
         }
+        const bool legacy = s.legacyHeader;
+        installSessionLocked(std::move(s));
+        acct = m_currentAccount;
+        if (legacy) migrateLegacyHeaderLocked();
+    }
+    for (const QString &name : std::as_const(closed)) emit sessionClosed(name);
+    emit isAuthenticatedChanged();
+    emit currentAccountChanged();
+    emit settingsChanged();
+    emit unlockedAccountsChanged();
+    emit loginSuccess(acct);
 
+    return true;
+}
 
-        const QJsonDocument doc = QJsonDocument::fromJson(plain);
-        if (!doc.isObject()) {
+bool AccountManager::addSession(const QString &filePath, const QString &password)
+{
+    if (!isAuthenticated()) return login(filePath, password);
 
-            emit loginFailed(tr("Account data is not valid JSON"));
-            return false;
+    const QString wanted = QFileInfo(filePath).baseName();
+    if (wanted == currentAccount()) return true;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_parked.contains(wanted)) {
+            locker.unlock();
+            return switchAccount(wanted);
         }
+    }
 
-        m_accountData = doc.object();
-        loadSettingsFromJson(m_accountData);
-
-        const QJsonArray ids = m_accountData.value("tor_identities").toArray();
-        m_currentAccountOnion = pickCurrentOnionFrom(ids);
+    Session s;
+    QString error;
+    if (!openSession(filePath, password, s, error)) {
+        emit loginFailed(error);
+        return false;
+    }
+    return switchToSession(std::move(s));
+}
 
+bool AccountManager::switchAccount(const QString &accountName)
+{
+    if (!isAuthenticated()) return false;
+    if (accountName == currentAccount()) return true;
 
-        m_trustedPeers = sanitizeTrustedPeers(
-            m_accountData.value("trusted_peers").toObject().toVariantMap());
+    Session s;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_parked.find(accountName);
+        if (it == m_parked.end()) return false;
+        s = std::move(it.value());
+        m_parked.erase(it);
+    }
+    return switchToSession(std::move(s));
+}
 
-        m_isAuthenticated   = true;
-        m_hasLoggedOut      = false;
-        m_currentFilePath   = filePath;
-        m_currentAccount    = QFileInfo(filePath).baseName();
-        acct = m_currentAccount;
-        m_lock.swap(lockfile);
-        ok = true;
+bool AccountManager::switchToSession(Session &&s)
+{
+    const QString from = currentAccount();
+    const QString to   = s.account;
 
+    // listeners park their per-account state while the old account is still current
+    emit accountSwitching(from);
+    {
+        QMutexLocker locker(&m_mutex);
+        const bool legacy = s.legacyHeader;
+        Session parked = takeSessionLocked();
+        m_parked.insert(from, std::move(parked));
+        installSessionLocked(std::move(s));
+        if (legacy) migrateLegacyHeaderLocked();
     }
-    if (!ok) return false;
-    emit isAuthenticatedChanged();
+    qDebug().noquote() << "[AccountManager] switched" << from << "->" << to;
+
     emit currentAccountChanged();
     emit settingsChanged();
-    emit loginSuccess(acct);
+    emit torIdentitiesChanged();
+    emit trustedPeersChanged();
+    emit addressBookChanged();
+    emit addressXMRBookChanged();
+    emit addressDaemonBookChanged();
+    emit unlockedAccountsChanged();
+    emit accountSwitched(from, to);
+    return true;
+}
+
+bool AccountManager::closeSession(const QString &accountName)
+{
+    if (!isAuthenticated()) return false;
+
+    if (accountName == currentAccount()) {
+        QString next;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_parked.isEmpty()) next = m_parked.firstKey();
+        }
+        if (next.isEmpty()) { logout(); return true; }
+        if (!switchAccount(next)) return false;
+    }
 
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_parked.find(accountName);
+        if (it == m_parked.end()) return false;
+        if (it->lock) it->lock->unlock();
+        m_parked.erase(it);
+    }
+    emit sessionClosed(accountName);
+    emit unlockedAccountsChanged();
     return true;
 }
 
+QStringList AccountManager::unlockedAccounts() const
+{
+    QMutexLocker locker(&m_mutex);
+    QStringList out = m_parked.keys();
+    if (m_isAuthenticated) out.prepend(m_currentAccount);
+    return out;
+}
+
+QStringList AccountManager::closeParkedLocked()
+{
+    for (auto it = m_parked.begin(); it != m_parked.end(); ++it)
+        if (it->lock) it->lock->unlock();
+    const QStringList closed = m_parked.keys();
+    m_parked.clear();
+    return closed;
+}
+
 void AccountManager::logout()
 {
     bool wasAuth = false;
+    QStringList closed;
     {
         QMutexLocker locker(&m_mutex);
         if (!m_isAuthenticated) return;
         resetState();
+        closed = closeParkedLocked();
         m_hasLoggedOut = true;
         wasAuth = true;
     } // <-- unlock here
 
+    for (const QString &name : std::as_const(closed)) emit sessionClosed(name);
     if (wasAuth) {
         emit isAuthenticatedChanged();
         emit currentAccountChanged();
+        emit unlockedAccountsChanged();
         emit logoutOccurred();
     }
 }
 
-bool AccountManager::passwordIsCorrect(const QString &password) const
+static bool passwordOpens(const QString &path, const QString &password)
 {
-
-    QFile in(m_currentFilePath);
-    if (!in.open(QIODevice::ReadOnly)) return false;
-
-    QByteArray lenBuf = in.read(2);
-    if (lenBuf.size() != 2) return false;
-    quint16 saltLen = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(lenBuf.constData()));
-    QByteArray salt = in.read(saltLen);
-    QByteArray cipher = in.readAll();
-    in.close();
+    FileHeader hdr;
+    QByteArray hdrBytes, cipher;
+    if (!readAccountFile(path, hdr, hdrBytes, cipher)) return false;
 
     QByteArray key;
-    try { key = CryptoUtils::deriveKey(password, salt); }
+    try { key = CryptoUtils::deriveKey(password, hdr.salt, hdr.kdf); }
     catch (...) { return false; }
 
     QByteArray plain;
-    if (!CryptoUtils::decrypt(cipher, key, plain)) return false;
+    if (!CryptoUtils::decrypt(cipher, key, hdr.cipher, hdrBytes, plain)) return false;
     return QJsonDocument::fromJson(plain).isObject();
 }
 
+bool AccountManager::passwordIsCorrect(const QString &password) const
+{
+    return passwordOpens(m_currentFilePath, password);
+}
+
 bool AccountManager::verifyPassword(const QString &password) const
 {
     QMutexLocker locker(&m_mutex);
@@ -509,12 +691,16 @@ bool AccountManager::updatePassword(const QString &oldPassword,
 
     QByteArray newSalt = CryptoUtils::generateSalt();
     QByteArray newKey;
-    try { newKey = CryptoUtils::deriveKey(newPassword, newSalt); }
+    try { newKey = CryptoUtils::deriveKey(newPassword, newSalt, m_kdf); }
     catch (...) { qDebug() << "[AccountManager] updatePassword: deriveKey failed"; return false; }
 
-    m_salt = newSalt;
-    m_key  = newKey;
+    const QByteArray oldSalt = m_salt, oldKey = m_key;
+    const Cipher     oldCipher = m_cipher;
+    m_salt   = newSalt;
+    m_key    = newKey;
+    m_cipher = preferredCipher();
     const bool ok = persistUnlocked();
+    if (!ok) { m_salt = oldSalt; m_key = oldKey; m_cipher = oldCipher; }
 
 
     if (!ok) return false;
@@ -532,6 +718,12 @@ bool AccountManager::createAccount(const QString &accountName,
     bool ok = false;
     QString safe;
 
+    // The calibrated parameters are what a new account must start with; the
+    // pre-calibration defaults are too heavy for small hosts. prepareKdf()
+    // usually finished while the form was filled in.
+    prepareKdf();
+    const KdfParams kdf = m_defaultKdf.result();
+
     {
 
 
@@ -580,8 +772,10 @@ bool AccountManager::createAccount(const QString &accountName,
         };
         m_accountData.swap(data);
 
-        m_salt = CryptoUtils::generateSalt();
-        try { m_key = CryptoUtils::deriveKey(password, m_salt); }
+        m_salt   = CryptoUtils::generateSalt();
+        m_kdf    = kdf;
+        m_cipher = preferredCipher();
+        try { m_key = CryptoUtils::deriveKey(password, m_salt, m_kdf); }
         catch (const std::exception &e) {
 
             emit errorOccurred(e.what());
@@ -619,6 +813,24 @@ QString AccountManager::loadAccountData()
 }
 
 bool AccountManager::saveAccountData(const QString &content)
+{
+    const QJsonDocument doc = QJsonDocument::fromJson(content.toUtf8());
+    if (!doc.isObject()) {
+
+        emit errorOccurred(tr("JSON is not an object"));
+        return false;
+    }
+    return saveAccountObject(doc.object());
+}
+
+QJsonObject AccountManager::accountObject() const
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_isAuthenticated) return {};
+    return m_accountData;
+}
+
+bool AccountManager::saveAccountObject(const QJsonObject &obj)
 {
 
     bool ok = false;
@@ -627,13 +839,10 @@ bool AccountManager::saveAccountData(const QString &content)
         QMutexLocker locker(&m_mutex);
         if (!m_isAuthenticated) return false;
 
-        const QJsonDocument doc = QJsonDocument::fromJson(content.toUtf8());
-        if (!doc.isObject()) {
-
-            emit errorOccurred(tr("JSON is not an object"));
-            return false;
-        }
-        m_accountData = doc.object();
+        QJsonObject incoming = obj;
+        if (!incoming.contains("data_key") && m_accountData.contains("data_key"))
+            incoming.insert("data_key", m_accountData.value("data_key"));
+        m_accountData = incoming;
         ok = persistUnlocked();
         if (!ok) {
 
@@ -646,10 +855,61 @@ bool AccountManager::saveAccountData(const QString &content)
 
     emit torIdentitiesChanged();
     emit currentAccountChanged();
+    emit accountDataChanged();
     return true;
 }
 
 
+QByteArray AccountManager::dataKeyLocked()
+{
+    QByteArray dk = QByteArray::fromBase64(m_accountData.value("data_key").toString().toLatin1());
+    if (dk.size() == KeyBytes) return dk;
+
+    dk = QByteArray(KeyBytes, 0);
+    randombytes_buf(dk.data(), KeyBytes);
+    m_accountData.insert("data_key", QString::fromLatin1(dk.toBase64()));
+    if (!persistUnlocked()) {
+        m_accountData.remove("data_key");
+        return {};
+    }
+    return dk;
+}
+
+QByteArray AccountManager::sealForAccount(const QByteArray &plain, const QByteArray &purpose)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_isAuthenticated) return {};
+
+    const QByteArray dk = dataKeyLocked();
+    if (dk.isEmpty()) return {};
+
+    try {
+        const QByteArray sub = deriveSubkey(dk, purpose);
+        QByteArray out(1, char(static_cast<quint8>(m_cipher)));
+        out += CryptoUtils::encrypt(plain, sub, m_cipher, purpose);
+        return out;
+    } catch (const std::exception &e) {
+        qDebug() << "[AccountManager] sealForAccount:" << e.what();
+        return {};
+    }
+}
+
+bool AccountManager::openForAccount(const QByteArray &sealed, const QByteArray &purpose, QByteArray &plainOut)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_isAuthenticated || sealed.size() < 2) return false;
+
+    const quint8 c = static_cast<quint8>(sealed.at(0));
+    if (c < quint8(Cipher::XSalsa20Poly1305) || c > quint8(Cipher::Aes256Gcm)) return false;
+
+    const QByteArray dk = dataKeyLocked();
+    if (dk.isEmpty()) return false;
+
+    return CryptoUtils::decrypt(sealed.mid(1), deriveSubkey(dk, purpose),
+                                static_cast<Cipher>(c), purpose, plainOut);
+}
+
+
 QVariantList AccountManager::getAvailableAccounts()
 {
     QVariantList out;
@@ -1554,6 +1814,58 @@ bool AccountManager::setDarkModePref(bool dark) {
     return true;
 }
 
+int AccountManager::walletWorkerCount() const {
+    QMutexLocker lk(&m_mutex);
+    return m_accountData.value("settings").toObject()
+        .value("wallet_workers").toInt(0);
+}
+
+bool AccountManager::setWalletWorkerCount(int workers) {
+    workers = qMax(0, workers);
+    {
+        QMutexLocker lk(&m_mutex);
+        if (!m_isAuthenticated) return false;
+
+        QJsonObject settings = m_accountData["settings"].toObject();
+        if (settings.value("wallet_workers").toInt(0) == workers)
+            return true;
+
+        settings["wallet_workers"] = workers;
+        m_accountData["settings"] = settings;
+
+        if (!persistUnlocked()) return false;
+    }
+
+    emit settingsChanged();
+    return true;
+}
+
+int AccountManager::residentWalletLimit() const {
+    QMutexLocker lk(&m_mutex);
+    return m_accountData.value("settings").toObject()
+        .value("resident_wallets").toInt(0);
+}
+
+bool AccountManager::setResidentWalletLimit(int limit) {
+    limit = qMax(0, limit);
+    {
+        QMutexLocker lk(&m_mutex);
+        if (!m_isAuthenticated) return false;
+
+        QJsonObject settings = m_accountData["settings"].toObject();
+        if (settings.value("resident_wallets").toInt(0) == limit)
+            return true;
+
+        settings["resident_wallets"] = limit;
+        m_accountData["settings"] = settings;
+
+        if (!persistUnlocked()) return false;
+    }
+
+    emit settingsChanged();
+    return true;
+}
+
 
 bool AccountManager::importTorIdentity(const QString &label,
                                        const QString &onion,
@@ -1951,3 +2263,99 @@ bool AccountManager::migrateFromLegacyExeDirs()
     }
     return any;
 }
+
+QVariantMap AccountManager::kdfProfile() const
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_isAuthenticated) return {};
+
+    return QVariantMap{
+        { "kdf",            QStringLiteral("argon2id") },
+        { "ops_limit",      static_cast<qulonglong>(m_kdf.opsLimit) },
+        { "mem_limit_mib",  static_cast<qulonglong>(m_kdf.memLimit / (1024 * 1024)) },
+        { "cipher",         cipherName(m_cipher) },
+        { "aes_ni",         cipherAvailable(Cipher::Aes256Gcm) },
+        { "format_version", int(FileFormatVersion) }
+    };
+}
+
+void AccountManager::prepareKdf()
+{
+    if (m_kdfPrepared) return;
+    m_kdfPrepared = true;
+    m_defaultKdf = QtConcurrent::run([]() {
+        return calibrateKdf(kDefaultUnlockMs, kDefaultKdfMemCap);
+    });
+}
+
+// Checking the password, calibrating and deriving the new key all run Argon2
+// several times, so they happen on a worker without m_mutex. The result is
+// installed only if the account still has the key the job started from.
+bool AccountManager::tuneKdf(const QString &password, int targetUnlockMs, int maxMemoryMiB)
+{
+    QString path;
+    QByteArray startSalt;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_isAuthenticated || m_kdfTuning) return false;
+        m_kdfTuning = true;
+        path      = m_currentFilePath;
+        startSalt = m_salt;
+    }
+
+    struct Tuned {
+        QString    error;
+        KdfParams  kdf;
+        QByteArray salt;
+        QByteArray key;
+    };
+
+    const quint64 memCap = quint64(qMax(maxMemoryMiB, 16)) * 1024 * 1024;
+    auto *watcher = new QFutureWatcher<Tuned>(this);
+    connect(watcher, &QFutureWatcher<Tuned>::finished, this, [this, watcher, path, startSalt]() {
+        const Tuned t = watcher->result();
+        watcher->deleteLater();
+
+        bool ok = false;
+        QString error = t.error;
+        {
+            QMutexLocker locker(&m_mutex);
+            m_kdfTuning = false;
+            if (error.isEmpty() && (!m_isAuthenticated || m_currentFilePath != path || m_salt != startSalt))
+                error = tr("Account changed while tuning, nothing was saved");
+
+            if (error.isEmpty()) {
+                const QByteArray oldSalt = m_salt, oldKey = m_key;
+                const KdfParams  oldKdf    = m_kdf;
+                const Cipher     oldCipher = m_cipher;
+                m_salt   = t.salt;
+                m_key    = t.key;
+                m_kdf    = t.kdf;
+                m_cipher = preferredCipher();
+                ok = persistUnlocked();
+                if (!ok) {
+                    m_salt = oldSalt; m_key = oldKey; m_kdf = oldKdf; m_cipher = oldCipher;
+                    error = tr("Failed to write account file");
+                }
+                qDebug().noquote() << "[AccountManager] tuneKdf: ops" << t.kdf.opsLimit
+                                   << "mem" << (t.kdf.memLimit >> 20) << "MiB ->" << (ok ? "saved" : "failed");
+            }
+        }
+        if (!ok) emit errorOccurred(error);
+        emit kdfTuned(ok);
+    });
+
+    watcher->setFuture(QtConcurrent::run([path, password, targetUnlockMs, memCap]() {
+        Tuned t;
+        if (!passwordOpens(path, password)) {
+            t.error = tr("Invalid password for this account");
+            return t;
+        }
+        t.kdf  = calibrateKdf(targetUnlockMs, memCap);
+        t.salt = CryptoUtils::generateSalt();
+        try { t.key = CryptoUtils::deriveKey(password, t.salt, t.kdf); }
+        catch (const std::exception &e) { t.error = QString::fromLatin1(e.what()); }
+        return t;
+    }));
+    return true;
+}
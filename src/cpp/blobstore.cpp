@@ -0,0 +1,321 @@
+#include "win_compat.h"
+#include "blobstore.h"
+#include "accountmanager.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QVariant>
+#include <QCryptographicHash>
+#include <QJsonDocument>
+#include <QDebug>
+
+namespace {
+constexpr int kCacheBytes = 4 * 1024 * 1024;
+
+const QByteArray kIndexPurpose = QByteArrayLiteral("blobstore/index/v1");
+const QByteArray kBlobPurpose  = QByteArrayLiteral("blobstore/blob/v1");
+
+// Peers and older records may use either alphabet, with or without padding.
+QByteArray decodeB64(const QString &b64)
+{
+    const QByteArray in = b64.toLatin1();
+    for (auto alphabet : {QByteArray::Base64UrlEncoding, QByteArray::Base64Encoding}) {
+        for (auto padding : {QByteArray::OmitTrailingEquals, QByteArray::KeepTrailingEquals}) {
+            const auto r = QByteArray::fromBase64Encoding(
+                in, alphabet | padding | QByteArray::AbortOnBase64DecodingErrors);
+            if (r) return r.decoded;
+        }
+    }
+    return {};
+}
+
+bool isHash(const QString &h)
+{
+    if (h.size() != 64) return false;
+    for (QChar c : h)
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) return false;
+    return true;
+}
+}
+
+BlobStore::BlobStore(AccountManager *acct, QObject *parent)
+    : QObject(parent), m_acct(acct)
+{
+    Q_ASSERT(acct);
+    m_cache.setMaxCost(kCacheBytes);
+
+    connect(m_acct, &AccountManager::isAuthenticatedChanged, this, [this](){
+        if (!m_acct->isAuthenticated()) reset();
+    });
+}
+
+BlobStore *BlobStore::of(const QObject *holder)
+{
+    if (!holder) return nullptr;
+    return qobject_cast<BlobStore*>(holder->property("blobStore").value<QObject*>());
+}
+
+QString BlobStore::hashOf(const QByteArray &data)
+{
+    return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex());
+}
+
+QString BlobStore::dir() const
+{
+    const QString base = m_acct->walletAccountDir();
+    return base.isEmpty() ? QString() : QDir(base).filePath("blobs");
+}
+
+QString BlobStore::blobPath(const QString &hash) const
+{
+    return QDir(dir()).filePath(hash.left(2) + QLatin1Char('/') + hash + QStringLiteral(".bin"));
+}
+
+QString BlobStore::indexPath() const
+{
+    return QDir(dir()).filePath("index.bin");
+}
+
+bool BlobStore::ensureLoadedLocked()
+{
+    if (!m_acct->isAuthenticated()) return false;
+
+    const QString acct = m_acct->currentAccount();
+    if (m_loaded && m_loadedFor == acct) return true;
+
+    m_ownerOf.clear();
+    m_previous.clear();
+    m_refs.clear();
+    m_cache.clear();
+
+    if (QFileInfo::exists(indexPath())) {
+        QFile in(indexPath());
+        QByteArray plain;
+        if (!in.open(QIODevice::ReadOnly) ||
+            !m_acct->openForAccount(in.readAll(), kIndexPurpose, plain)) {
+            qWarning() << "[BlobStore] index unreadable, store unavailable";
+            return false;
+        }
+        const QJsonObject idx    = QJsonDocument::fromJson(plain).object();
+        const QJsonObject owners = idx.value("owners").toObject();
+        for (auto it = owners.begin(); it != owners.end(); ++it) {
+            const QString h = it.value().toString();
+            if (!isHash(h)) continue;
+            m_ownerOf.insert(it.key(), h);
+            ++m_refs[h];
+        }
+        // left by a crash before the owner's record was saved; settled on the next login
+        const QJsonObject previous = idx.value("previous").toObject();
+        for (auto it = previous.begin(); it != previous.end(); ++it) {
+            const QString h = it.value().toString();
+            if (!isHash(h) || !m_ownerOf.contains(it.key())) continue;
+            m_previous.insert(it.key(), h);
+            ++m_refs[h];
+        }
+    }
+
+    m_loaded    = true;
+    m_loadedFor = acct;
+    return true;
+}
+
+bool BlobStore::saveIndexLocked()
+{
+    QJsonObject owners, previous;
+    for (auto it = m_ownerOf.cbegin(); it != m_ownerOf.cend(); ++it)
+        owners.insert(it.key(), it.value());
+    for (auto it = m_previous.cbegin(); it != m_previous.cend(); ++it)
+        previous.insert(it.key(), it.value());
+
+    const QJsonObject idx{ {"version", 1}, {"owners", owners}, {"previous", previous} };
+    const QByteArray sealed = m_acct->sealForAccount(
+        QJsonDocument(idx).toJson(QJsonDocument::Compact), kIndexPurpose);
+    if (sealed.isEmpty() || !QDir().mkpath(dir())) return false;
+
+    QSaveFile out(indexPath());
+    if (!out.open(QIODevice::WriteOnly)) return false;
+    out.write(sealed);
+    return out.commit();
+}
+
+void BlobStore::unrefLocked(const QString &hash)
+{
+    auto it = m_refs.find(hash);
+    if (it == m_refs.end()) return;
+    if (--it.value() > 0) return;
+
+    m_refs.erase(it);
+    m_cache.remove(hash);
+    QFile::remove(blobPath(hash));
+}
+
+QString BlobStore::put(const QByteArray &data, const QString &owner)
+{
+    if (data.isEmpty() || owner.isEmpty()) return {};
+
+    QMutexLocker locker(&m_mutex);
+    if (!ensureLoadedLocked()) return {};
+
+    const QString hash = hashOf(data);
+    if (m_ownerOf.value(owner) == hash) return hash;
+
+    if (!m_refs.contains(hash) || !QFileInfo::exists(blobPath(hash))) {
+        const QByteArray sealed = m_acct->sealForAccount(data, kBlobPurpose);
+        if (sealed.isEmpty()) return {};
+
+        const QString path = blobPath(hash);
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QSaveFile out(path);
+        if (!out.open(QIODevice::WriteOnly)) return {};
+        out.write(sealed);
+        if (!out.commit()) return {};
+    }
+
+    // The owner's saved record still names the previous blob until settle().
+    // A blob put since then was never saved anywhere and can go right away.
+    const QString prev = m_ownerOf.value(owner);
+    m_ownerOf.insert(owner, hash);
+    ++m_refs[hash];
+    if (!prev.isEmpty()) {
+        if (m_previous.contains(owner)) unrefLocked(prev);
+        else                            m_previous.insert(owner, prev);
+    }
+    if (m_previous.value(owner) == hash) unrefLocked(m_previous.take(owner));
+
+    if (!saveIndexLocked())
+        qWarning() << "[BlobStore] index write failed";
+
+    m_cache.insert(hash, new QByteArray(data), int(data.size()));
+    return hash;
+}
+
+void BlobStore::settle(const QString &owner, const QString &savedHash)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!ensureLoadedLocked() || !m_previous.contains(owner)) return;
+
+    if (savedHash == m_ownerOf.value(owner)) {
+        unrefLocked(m_previous.take(owner));
+    } else if (savedHash == m_previous.value(owner)) {
+        // the save that would have pointed at the new blob did not happen
+        unrefLocked(m_ownerOf.value(owner));
+        m_ownerOf.insert(owner, m_previous.take(owner));
+    } else {
+        return;
+    }
+    saveIndexLocked();
+}
+
+QByteArray BlobStore::get(const QString &hash)
+{
+    if (!isHash(hash)) return {};
+
+    QMutexLocker locker(&m_mutex);
+    if (!ensureLoadedLocked()) return {};
+    if (const QByteArray *hit = m_cache.object(hash)) return *hit;
+
+    QFile in(blobPath(hash));
+    if (!in.open(QIODevice::ReadOnly)) return {};
+
+    QByteArray plain;
+    if (!m_acct->openForAccount(in.readAll(), kBlobPurpose, plain) || hashOf(plain) != hash) {
+        qWarning() << "[BlobStore] blob" << hash.left(12) << "failed verification";
+        return {};
+    }
+    m_cache.insert(hash, new QByteArray(plain), int(plain.size()));
+    return plain;
+}
+
+bool BlobStore::contains(const QString &hash)
+{
+    QMutexLocker locker(&m_mutex);
+    return ensureLoadedLocked() && m_refs.contains(hash);
+}
+
+void BlobStore::release(const QString &owner)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!ensureLoadedLocked()) return;
+
+    const QString hash = m_ownerOf.take(owner);
+    if (hash.isEmpty()) return;
+    unrefLocked(hash);
+    if (m_previous.contains(owner)) unrefLocked(m_previous.take(owner));
+    saveIndexLocked();
+}
+
+int BlobStore::retainOnly(const QString &prefix, const QSet<QString> &keep)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!ensureLoadedLocked()) return 0;
+
+    QStringList drop;
+    for (auto it = m_ownerOf.cbegin(); it != m_ownerOf.cend(); ++it)
+        if (it.key().startsWith(prefix) && !keep.contains(it.key())) drop << it.key();
+
+    for (const QString &o : std::as_const(drop)) {
+        unrefLocked(m_ownerOf.take(o));
+        if (m_previous.contains(o)) unrefLocked(m_previous.take(o));
+    }
+    if (!drop.isEmpty()) {
+        saveIndexLocked();
+        qDebug().noquote() << "[BlobStore] pruned" << drop.size() << "stale owners under" << prefix;
+    }
+    return drop.size();
+}
+
+int BlobStore::refCount(const QString &hash)
+{
+    QMutexLocker locker(&m_mutex);
+    return ensureLoadedLocked() ? m_refs.value(hash) : 0;
+}
+
+void BlobStore::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_loaded = false;
+    m_loadedFor.clear();
+    m_ownerOf.clear();
+    m_previous.clear();
+    m_refs.clear();
+    m_cache.clear();
+}
+
+QString BlobStore::transferOwner(const QString &transferRef)
+{
+    return QStringLiteral("transfer/") + transferRef;
+}
+
+void BlobStore::setTransferBlob(const QObject *holder, const QString &transferRef,
+                                QJsonObject &entry, const QString &blobB64)
+{
+    if (blobB64.isEmpty()) return;
+
+    BlobStore *bs = of(holder);
+    const QByteArray raw = decodeB64(blobB64);
+    const QString hash = bs && !raw.isEmpty() ? bs->put(raw, transferOwner(transferRef)) : QString();
+    if (hash.isEmpty()) {
+        entry["transfer_blob"] = blobB64;
+        entry.remove("transfer_blob_ref");
+        entry.remove("transfer_blob_raw");
+        return;
+    }
+    entry["transfer_blob_ref"] = hash;
+    entry["transfer_blob_raw"] = true;   // stores before this held the base64 text
+    entry.remove("transfer_blob");
+}
+
+QString BlobStore::transferBlob(const QObject *holder, const QJsonObject &entry)
+{
+    const QString inlined = entry.value("transfer_blob").toString();
+    if (!inlined.isEmpty()) return inlined;
+
+    const QString hash = entry.value("transfer_blob_ref").toString();
+    BlobStore *bs = of(holder);
+    if (hash.isEmpty() || !bs) return {};
+    const QByteArray stored = bs->get(hash);
+    if (stored.isEmpty() || !entry.value("transfer_blob_raw").toBool()) return QString::fromLatin1(stored);
+    return QString::fromLatin1(stored.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+}
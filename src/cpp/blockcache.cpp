@@ -0,0 +1,530 @@
+#include "win_compat.h"
+#include <rpc/core_rpc_server_commands_defs.h>
+#include <storages/portable_storage_template_helper.h>
+#include <cryptonote_basic/cryptonote_format_utils.h>
+#include <string_tools.h>
+#ifdef QT_TRANSLATE_NOOP
+#undef QT_TRANSLATE_NOOP
+#endif
+
+#include "blockcache.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+
+namespace {
+using Cmd     = cryptonote::COMMAND_RPC_GET_BLOCKS_FAST;
+using Req     = Cmd::request;
+using Resp    = Cmd::response;
+using Indices = Cmd::block_output_indices;
+
+constexpr quint64 kChunkBlocks      = 100;
+constexpr quint64 kSafeDepth        = 20;      // never cache what a reorg can still replace
+constexpr size_t  kMaxServeBlocks   = 1000;    // the daemon's own per-call cap
+constexpr size_t  kMinServeBlocks   = 2;       // the split block plus at least one new one
+constexpr qint64  kTemplateMaxAgeMs = 10 * 60 * 1000;
+constexpr int     kHotBytes         = 64 * 1024 * 1024;
+constexpr int     kMaxPartialChunks = 64;
+
+const char      kMagic[4] = {'M', 'M', 'B', 'C'};
+constexpr quint32 kVersion = 2;   // 1 was unsealed and shared by every account
+
+const epee::serialization::portable_storage::limits_t kLimits{
+    65536 * 1024, 65536 * 1024, 65536 * 1024
+};
+
+template<class T>
+bool decode(T &out, const QByteArray &blob)
+{
+    const epee::span<const uint8_t> span(reinterpret_cast<const uint8_t*>(blob.constData()),
+                                         size_t(blob.size()));
+    try { return epee::serialization::load_t_from_binary(out, span, &kLimits); }
+    catch (const std::exception &) { return false; }
+}
+
+template<class T>
+QByteArray encode(T &in)
+{
+    epee::byte_slice out;
+    if (!epee::serialization::store_t_to_binary(in, out)) return {};
+    return QByteArray(reinterpret_cast<const char*>(out.data()), qsizetype(out.size()));
+}
+
+QByteArray hashKey(const crypto::hash &h)
+{
+    return QByteArray(reinterpret_cast<const char*>(h.data), sizeof(h.data));
+}
+
+bool blockHash(const cryptonote::block_complete_entry &e, crypto::hash &out, crypto::hash *prev = nullptr)
+{
+    cryptonote::block b;
+    if (!cryptonote::parse_and_validate_block_from_blob(e.block, b)) return false;
+    out = cryptonote::get_block_hash(b);
+    if (prev) *prev = b.prev_id;
+    return true;
+}
+
+qint64 entryBytes(const cryptonote::block_complete_entry &e, const Indices &idx)
+{
+    qint64 n = qint64(e.block.size()) + 64;
+    for (const auto &tx : e.txs) n += qint64(tx.blob.size()) + 32;
+    for (const auto &t : idx.indices) n += qint64(t.indices.size()) * 8;
+    return n;
+}
+
+QString spaceKey(const QString &upstream, const Req &req)
+{
+    const std::string genesis = epee::string_tools::pod_to_hex(req.block_ids.back());
+    const QByteArray  up = QCryptographicHash::hash(upstream.toUtf8(), QCryptographicHash::Sha256).toHex();
+    return QString::fromLatin1(up.left(16)) + QLatin1Char('-')
+         + QString::fromStdString(genesis.substr(0, 16))
+         + QStringLiteral("-p%1m%2").arg(int(req.prune)).arg(int(req.no_miner_tx));
+}
+
+QString chunkFile(const QString &dir, quint64 index)
+{
+    return QDir(dir).filePath(QStringLiteral("%1.chunk").arg(index, 8, 10, QLatin1Char('0')));
+}
+}
+
+struct BlockCache::Chunk {
+    quint64 index = 0;
+    std::vector<cryptonote::block_complete_entry> blocks;
+    std::vector<Indices>                          indices;
+    std::vector<crypto::hash>                     hashes;
+    std::vector<char>                             present;
+    quint64 count = 0;
+    qint64  bytes = 0;
+
+    explicit Chunk(quint64 i = 0)
+        : index(i), blocks(kChunkBlocks), indices(kChunkBlocks),
+          hashes(kChunkBlocks), present(kChunkBlocks, 0) {}
+};
+
+struct BlockCache::Space {
+    QString dir;
+    bool    scanned = false;
+
+    QHash<QByteArray, quint64> heightOf;   // block hash -> height, disk and partial
+    QHash<quint64, qint64>     onDisk;     // chunk -> file bytes
+    QHash<quint64, qint64>     lastUse;    // chunk -> ms
+    QHash<quint64, QByteArray> hashesOf;   // chunk -> packed hashes of an on-disk chunk
+    QHash<quint64, ChunkPtr>   partial;
+
+    // Header fields of the last daemon answer (no blocks, no pool); cached
+    // answers are built on it so fields this code doesn't know survive.
+    Resp    templ;
+    bool    haveTempl = false;
+    qint64  templMs   = 0;
+    quint64 tip       = 0;
+
+    QString chunkPath(quint64 index) const { return chunkFile(dir, index); }
+};
+
+BlockCache::BlockCache(const QString &dir, qint64 maxDiskBytes, Seal seal, Open open)
+    : m_dir(dir), m_maxDiskBytes(maxDiskBytes), m_seal(std::move(seal)), m_open(std::move(open))
+{
+    m_hot.setMaxCost(kHotBytes);
+}
+
+BlockCache::~BlockCache()
+{
+    m_hot.clear();
+    qDeleteAll(m_spaces);
+}
+
+BlockCache::Space &BlockCache::spaceLocked(const QString &key)
+{
+    Space *&sp = m_spaces[key];
+    if (!sp) {
+        sp = new Space;
+        sp->dir = QDir(m_dir).filePath(key);
+    }
+    if (!sp->scanned) scanLocked(*sp);
+    return *sp;
+}
+
+void BlockCache::scanLocked(Space &sp)
+{
+    sp.scanned = true;
+    const QFileInfoList files = QDir(sp.dir).entryInfoList({QStringLiteral("*.chunk")}, QDir::Files);
+    for (const QFileInfo &fi : files) {
+        QFile in(fi.filePath());
+        quint64 first = 0;
+        QByteArray hashes;
+        if (!in.open(QIODevice::ReadOnly) || !readHeader(in, first, hashes) || first % kChunkBlocks) {
+            in.close();
+            if (!m_retired) QFile::remove(fi.filePath());   // else the key is gone, not the file
+            continue;
+        }
+        const quint64 index = first / kChunkBlocks;
+        for (quint64 i = 0; i < kChunkBlocks; ++i)
+            sp.heightOf.insert(hashes.mid(qsizetype(i) * 32, 32), first + i);
+        sp.onDisk.insert(index, fi.size());
+        sp.lastUse.insert(index, fi.lastModified().toMSecsSinceEpoch());
+        sp.hashesOf.insert(index, hashes);
+        m_diskBytes += fi.size();
+    }
+    if (!files.isEmpty())
+        qDebug().noquote() << "[BlockCache]" << QFileInfo(sp.dir).fileName()
+                           << "has" << sp.onDisk.size() << "chunks on disk";
+    evictLocked();
+}
+
+// A chunk file is magic, version, then the sealed header (first height,
+// count, block hashes) and the sealed blocks, so a scan opens only the header.
+bool BlockCache::readHeader(QIODevice &in, quint64 &first, QByteArray &hashes) const
+{
+    QDataStream ds(&in);
+    char magic[4];
+    quint32 version = 0, sealedLen = 0, count = 0;
+    if (ds.readRawData(magic, 4) != 4 || memcmp(magic, kMagic, 4) != 0) return false;
+    ds >> version >> sealedLen;
+    if (ds.status() != QDataStream::Ok || version != kVersion) return false;
+
+    QByteArray plain;
+    if (!m_open(in.read(sealedLen), plain)) return false;
+    QDataStream hs(plain);
+    hs >> first >> count;
+    if (hs.status() != QDataStream::Ok || count != kChunkBlocks) return false;
+    hashes = plain.mid(12);
+    return hashes.size() == qsizetype(count) * 32;
+}
+
+bool BlockCache::writeChunk(const QString &dir, const Chunk &c, qint64 *bytes) const
+{
+    Resp r;
+    r.start_height   = c.index * kChunkBlocks;
+    r.blocks         = c.blocks;
+    r.output_indices = c.indices;
+    const QByteArray payload = m_seal(encode(r));
+
+    QByteArray header;
+    {
+        QDataStream hs(&header, QIODevice::WriteOnly);
+        hs << quint64(c.index * kChunkBlocks) << quint32(kChunkBlocks);
+        for (const crypto::hash &h : c.hashes) hs.writeRawData(h.data, sizeof(h.data));
+    }
+    header = m_seal(header);
+    if (payload.isEmpty() || header.isEmpty() || !QDir().mkpath(dir)) return false;
+
+    QSaveFile out(chunkFile(dir, c.index));
+    if (!out.open(QIODevice::WriteOnly)) return false;
+    {
+        QDataStream ds(&out);
+        ds.writeRawData(kMagic, 4);
+        ds << kVersion << quint32(header.size());
+        ds.writeRawData(header.constData(), int(header.size()));
+        ds.writeRawData(payload.constData(), int(payload.size()));
+    }
+    *bytes = out.size();
+    return out.commit();
+}
+
+BlockCache::ChunkPtr BlockCache::chunk(const QString &key, quint64 index)
+{
+    const QString hotKey = key + QLatin1Char('/') + QString::number(index);
+    QString    path;
+    QByteArray expect;
+    {
+        QMutexLocker locker(&m_mutex);
+        Space &sp = spaceLocked(key);
+        if (ChunkPtr p = sp.partial.value(index)) return p;
+        if (!sp.onDisk.contains(index)) return {};
+        sp.lastUse[index] = QDateTime::currentMSecsSinceEpoch();
+        if (ChunkPtr *hit = m_hot.object(hotKey)) return *hit;
+        path   = sp.chunkPath(index);
+        expect = sp.hashesOf.value(index);
+    }
+
+    auto c = std::make_shared<Chunk>(index);
+    bool ok = false;
+    QFile in(path);
+    quint64 first = 0;
+    QByteArray hashes;
+    QByteArray plain;
+    if (in.open(QIODevice::ReadOnly) && readHeader(in, first, hashes) && hashes == expect
+        && m_open(in.readAll(), plain)) {
+        Resp r;
+        ok = decode(r, plain)
+          && r.blocks.size() == kChunkBlocks && r.output_indices.size() == kChunkBlocks;
+        for (size_t i = 0; ok && i < kChunkBlocks; ++i) {
+            ok = blockHash(r.blocks[i], c->hashes[i]) && hashKey(c->hashes[i]) == hashes.mid(qsizetype(i) * 32, 32);
+            if (!ok) break;
+            c->bytes += entryBytes(r.blocks[i], r.output_indices[i]);
+            c->blocks[i]  = std::move(r.blocks[i]);
+            c->indices[i] = std::move(r.output_indices[i]);
+            c->present[i] = 1;
+        }
+        c->count = kChunkBlocks;
+    }
+    in.close();
+
+    QMutexLocker locker(&m_mutex);
+    Space &sp = spaceLocked(key);
+    if (!ok) {
+        qWarning().noquote() << "[BlockCache] dropping unreadable chunk" << path;
+        if (sp.onDisk.contains(index)) {
+            for (quint64 i = 0; i < kChunkBlocks; ++i)
+                sp.heightOf.remove(expect.mid(qsizetype(i) * 32, 32));
+            m_diskBytes -= sp.onDisk.take(index);
+            sp.lastUse.remove(index);
+            sp.hashesOf.remove(index);
+            if (!m_retired) QFile::remove(path);
+        }
+        return {};
+    }
+    m_hot.insert(hotKey, new ChunkPtr(c), int(std::min<qint64>(c->bytes, kHotBytes)));
+    return c;
+}
+
+void BlockCache::dropPartialLocked(Space &sp, quint64 index)
+{
+    ChunkPtr c = sp.partial.take(index);
+    if (!c) return;
+    for (quint64 i = 0; i < kChunkBlocks; ++i)
+        if (c->present[i]) sp.heightOf.remove(hashKey(c->hashes[i]));
+}
+
+bool BlockCache::hashAtLocked(const Space &sp, quint64 height, QByteArray &out) const
+{
+    const quint64 index = height / kChunkBlocks;
+    const size_t  off   = size_t(height % kChunkBlocks);
+    if (const ChunkPtr c = sp.partial.value(index)) {
+        if (!c->present[off]) return false;
+        out = hashKey(c->hashes[off]);
+        return true;
+    }
+    auto it = sp.hashesOf.constFind(index);
+    if (it == sp.hashesOf.cend()) return false;
+    out = it->mid(qsizetype(off) * 32, 32);
+    return true;
+}
+
+void BlockCache::evictLocked()
+{
+    while (m_diskBytes > m_maxDiskBytes) {
+        Space  *victim = nullptr;
+        quint64 index  = 0;
+        qint64  oldest = std::numeric_limits<qint64>::max();
+        for (Space *sp : std::as_const(m_spaces)) {
+            for (auto it = sp->onDisk.cbegin(); it != sp->onDisk.cend(); ++it) {
+                const qint64 used = sp->lastUse.value(it.key());
+                if (used < oldest) { oldest = used; victim = sp; index = it.key(); }
+            }
+        }
+        if (!victim) break;
+
+        const QByteArray hashes = victim->hashesOf.take(index);
+        for (quint64 i = 0; i < kChunkBlocks; ++i)
+            victim->heightOf.remove(hashes.mid(qsizetype(i) * 32, 32));
+        m_diskBytes -= victim->onDisk.take(index);
+        victim->lastUse.remove(index);
+        m_hot.remove(QFileInfo(victim->dir).fileName() + QLatin1Char('/') + QString::number(index));
+        QFile::remove(victim->chunkPath(index));
+        ++m_evicted;
+    }
+}
+
+BlockCache::Lookup BlockCache::lookup(const QString &upstream, const QByteArray &request)
+{
+    Lookup out;
+    Req req;
+    if (m_dir.isEmpty() || m_retired) return out;
+    if (!decode(req, request) || req.block_ids.empty()) return out;
+    if (req.requested_info == Cmd::POOL_ONLY) return out;
+    out.cacheable = true;
+
+    const QString key = spaceKey(upstream, req);
+    Resp    resp;
+    quint64 safeEnd = 0;
+    {
+        QMutexLocker locker(&m_mutex);
+        Space &sp = spaceLocked(key);
+        // Same rule as the daemon: an explicit start height wins, otherwise
+        // the answer starts at the wallet's newest block.
+        if (req.start_height > 0) {
+            out.start = qint64(req.start_height);
+        } else {
+            auto it = sp.heightOf.constFind(hashKey(req.block_ids.front()));
+            if (it != sp.heightOf.cend()) out.start = qint64(*it);
+        }
+        const bool fresh = sp.haveTempl
+                        && QDateTime::currentMSecsSinceEpoch() - sp.templMs < kTemplateMaxAgeMs;
+        if (out.start < 0 || !fresh) { ++m_misses; return out; }
+        resp    = sp.templ;
+        safeEnd = sp.tip > kSafeDepth ? sp.tip - kSafeDepth : 0;
+    }
+
+    const quint64 start = quint64(out.start);
+    ChunkPtr c;
+    for (quint64 h = start; h < safeEnd && resp.blocks.size() < kMaxServeBlocks; ++h) {
+        const quint64 index = h / kChunkBlocks;
+        if (!c || c->index != index) c = chunk(key, index);
+        const size_t off = size_t(h % kChunkBlocks);
+        if (!c || !c->present[off]) break;
+        resp.blocks.push_back(c->blocks[off]);
+        resp.output_indices.push_back(c->indices[off]);
+    }
+    c.reset();
+
+    const size_t served = resp.blocks.size();
+    if (served >= kMinServeBlocks) {
+        resp.start_height = start;
+        out.response = encode(resp);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    if (out.response.isEmpty()) { ++m_misses; return out; }
+    ++m_hits;
+    m_servedBlocks += served;
+    return out;
+}
+
+void BlockCache::ingest(const QString &upstream, const QByteArray &request, const QByteArray &response)
+{
+    Req  req;
+    Resp resp;
+    if (m_dir.isEmpty() || m_retired) return;
+    if (!decode(req, request) || req.block_ids.empty() || req.requested_info == Cmd::POOL_ONLY) return;
+    if (!decode(resp, response) || resp.status != CORE_RPC_STATUS_OK) return;
+    if (resp.blocks.size() != resp.output_indices.size()) return;
+
+    std::vector<cryptonote::block_complete_entry> blocks  = std::move(resp.blocks);
+    std::vector<Indices>                          indices = std::move(resp.output_indices);
+    resp.blocks.clear();
+    resp.output_indices.clear();
+    resp.pool_info_extent = Cmd::NONE;
+    resp.added_pool_txs.clear();
+    resp.remaining_added_pool_txids.clear();
+    resp.removed_pool_txids.clear();
+
+    // Each block must name the one before it; the run stops at the first
+    // that does not, and at the first a reorg could still replace.
+    const quint64 safeEnd = resp.current_height > kSafeDepth ? resp.current_height - kSafeDepth : 0;
+    std::vector<crypto::hash> hashes(blocks.size());
+    std::vector<crypto::hash> prevs(blocks.size());
+    std::vector<char>         hashed(blocks.size(), 0);
+    for (size_t i = 0; i < blocks.size() && resp.start_height + i < safeEnd; ++i) {
+        if (!blockHash(blocks[i], hashes[i], &prevs[i])) break;
+        if (i > 0 && prevs[i] != hashes[i - 1]) break;
+        hashed[i] = 1;
+    }
+
+    const QString key = spaceKey(upstream, req);
+    const qint64  now = QDateTime::currentMSecsSinceEpoch();
+    QList<ChunkPtr> complete;
+    QString dir;
+    {
+        QMutexLocker locker(&m_mutex);
+        Space &sp = spaceLocked(key);
+        dir          = sp.dir;
+        sp.templ     = resp;
+        sp.haveTempl = true;
+        sp.templMs   = now;
+        sp.tip       = resp.current_height;
+
+        // The run must also fit what is already cached on either side.
+        QByteArray known;
+        if (!blocks.empty() && hashed[0] && resp.start_height > 0
+            && hashAtLocked(sp, resp.start_height - 1, known) && known != hashKey(prevs[0])) {
+            qWarning().noquote() << "[BlockCache] answer from" << upstream << "does not link at height"
+                                 << resp.start_height << "; not cached";
+            std::fill(hashed.begin(), hashed.end(), 0);
+        }
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            if (!hashed[i]) continue;
+            const quint64 h = resp.start_height + i;
+            if (hashAtLocked(sp, h, known) && known != hashKey(hashes[i])) {
+                std::fill(hashed.begin() + std::ptrdiff_t(i), hashed.end(), 0);
+                break;
+            }
+        }
+
+        for (size_t i = 0; i < blocks.size(); ++i) {
+            if (!hashed[i]) continue;
+            const quint64 h     = resp.start_height + i;
+            const quint64 index = h / kChunkBlocks;
+            const size_t  off   = size_t(h % kChunkBlocks);
+            if (sp.onDisk.contains(index)) continue;
+
+            ChunkPtr &c = sp.partial[index];
+            if (!c) c = std::make_shared<Chunk>(index);
+            if (c->present[off]) continue;
+            if (c.use_count() > 1) c = std::make_shared<Chunk>(*c);   // a reader holds it
+
+            c->bytes        += entryBytes(blocks[i], indices[i]);
+            c->blocks[off]   = std::move(blocks[i]);
+            c->indices[off]  = std::move(indices[i]);
+            c->hashes[off]   = hashes[i];
+            c->present[off]  = 1;
+            ++c->count;
+            sp.heightOf.insert(hashKey(hashes[i]), h);
+            ++m_storedBlocks;
+
+            if (c->count == kChunkBlocks) {
+                complete << c;
+                sp.partial.remove(index);
+            }
+        }
+        while (sp.partial.size() > kMaxPartialChunks)
+            dropPartialLocked(sp, sp.partial.cbegin().key());
+
+        for (const ChunkPtr &c : std::as_const(complete))
+            m_hot.insert(key + QLatin1Char('/') + QString::number(c->index), new ChunkPtr(c),
+                         int(std::min<qint64>(c->bytes, kHotBytes)));
+    }
+
+    for (const ChunkPtr &c : std::as_const(complete)) {
+        qint64 bytes = 0;
+        const bool ok = !m_retired && writeChunk(dir, *c, &bytes);
+
+        QMutexLocker locker(&m_mutex);
+        Space &sp = spaceLocked(key);
+        if (!ok) {
+            for (const crypto::hash &h : c->hashes) sp.heightOf.remove(hashKey(h));
+            m_hot.remove(key + QLatin1Char('/') + QString::number(c->index));
+            qWarning().noquote() << "[BlockCache] could not write chunk" << c->index;
+            continue;
+        }
+        QByteArray packed;
+        packed.reserve(qsizetype(kChunkBlocks) * 32);
+        for (const crypto::hash &h : c->hashes) packed += hashKey(h);
+        sp.onDisk.insert(c->index, bytes);
+        sp.hashesOf.insert(c->index, packed);
+        sp.lastUse.insert(c->index, now);
+        m_diskBytes += bytes;
+    }
+
+    if (!complete.isEmpty()) {
+        QMutexLocker locker(&m_mutex);
+        evictLocked();
+    }
+}
+
+QVariantMap BlockCache::stats() const
+{
+    QMutexLocker locker(&m_mutex);
+    int chunks = 0;
+    for (const Space *sp : m_spaces) chunks += sp->onDisk.size();
+    return {
+        {"hits",           static_cast<qulonglong>(m_hits)},
+        {"misses",         static_cast<qulonglong>(m_misses)},
+        {"served_blocks",  static_cast<qulonglong>(m_servedBlocks)},
+        {"stored_blocks",  static_cast<qulonglong>(m_storedBlocks)},
+        {"evicted_chunks", static_cast<qulonglong>(m_evicted)},
+        {"disk_chunks",    chunks},
+        {"disk_bytes",     m_diskBytes},
+        {"disk_limit",     m_maxDiskBytes},
+        {"memory_bytes",   m_hot.totalCost()},
+    };
+}
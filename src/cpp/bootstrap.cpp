@@ -8,6 +8,13 @@
 #include "multisigmanager.h"
 #include "multisigapirouter.h"
 #include "transfermanager.h"
+#include "transfercatalog.h"
+#include "blobstore.h"
+#include "walletexecutor.h"
+#include "daemonmonitor.h"
+#include "daemonproxy.h"
+#include "walletresidency.h"
+#include "walletlifecycle.h"
 #include <QCoreApplication>
 #include <QVariantMap>
 #include <QDebug>
@@ -36,6 +43,51 @@ QVariantMap Bootstrap::buildCore(QCoreApplication *app)
 
     walletManager->setProperty("accountManager", QVariant::fromValue(static_cast<QObject*>(accountManager)));
 
+    auto *walletExecutor = new WalletExecutor(app);
+    walletManager->setProperty("walletExecutor", QVariant::fromValue(static_cast<QObject*>(walletExecutor)));
+
+    auto *daemonMonitor = new DaemonMonitor(app);
+    walletManager->setProperty("daemonMonitor", QVariant::fromValue(static_cast<QObject*>(daemonMonitor)));
+
+    auto *daemonProxy = new DaemonProxy(app);
+    daemonProxy->setMonitor(daemonMonitor);
+    daemonProxy->setAccountManager(accountManager);
+    walletManager->setProperty("daemonProxy", QVariant::fromValue(static_cast<QObject*>(daemonProxy)));
+
+    auto *walletResidency = new WalletResidency(walletManager, app);
+    walletManager->setProperty("walletResidency", QVariant::fromValue(static_cast<QObject*>(walletResidency)));
+
+    auto *walletLifecycle = new WalletLifecycle(walletManager, app);
+    walletManager->setProperty("walletLifecycle", QVariant::fromValue(static_cast<QObject*>(walletLifecycle)));
+
+    auto *transferCatalog = new TransferCatalog(accountManager, app);
+    accountManager->setProperty("transferCatalog", QVariant::fromValue(static_cast<QObject*>(transferCatalog)));
+
+    auto *blobStore = new BlobStore(accountManager, app);
+    accountManager->setProperty("blobStore", QVariant::fromValue(static_cast<QObject*>(blobStore)));
+
+    QObject::connect(transferCatalog, &TransferCatalog::transferRemoved,
+                     blobStore, [blobStore](const QString &ref) {
+                         blobStore->release(BlobStore::transferOwner(ref));
+                     });
+    // A transfer's blob is replaced only once the account save naming the new one landed.
+    auto settleTransferBlob = [transferCatalog, blobStore](const QString &ref) {
+        blobStore->settle(BlobStore::transferOwner(ref),
+                          transferCatalog->transfer(ref).value("transfer_blob_ref").toString());
+    };
+    QObject::connect(transferCatalog, &TransferCatalog::transferAdded, blobStore, settleTransferBlob);
+    QObject::connect(transferCatalog, &TransferCatalog::transferUpdated, blobStore, settleTransferBlob);
+    QObject::connect(transferCatalog, &TransferCatalog::catalogReset,
+                     blobStore, [accountManager, transferCatalog, blobStore, settleTransferBlob]() {
+                         if (!accountManager->isAuthenticated()) return;
+                         QSet<QString> live;
+                         for (const QString &ref : transferCatalog->allRefs()) {
+                             live.insert(BlobStore::transferOwner(ref));
+                             settleTransferBlob(ref);
+                         }
+                         blobStore->retainOnly(BlobStore::transferOwner({}), live);
+                     });
+
 
     RouterHandler::setWalletManager(walletManager);
 
@@ -64,6 +116,39 @@ QVariantMap Bootstrap::buildCore(QCoreApplication *app)
     QObject::connect(accountManager, &AccountManager::logoutOccurred,
                      transferManager, &TransferManager::reset);
 
+    // Switching between unlocked accounts keeps Tor and open wallets alive.
+    // Listeners run directly so per-account state is parked before the swap.
+    QObject::connect(accountManager, &AccountManager::accountSwitching,
+                     app, [torBackend, walletManager, multisigManager, transferManager](const QString &from) {
+                         transferManager->suspendForAccountSwitch(from);
+                         multisigManager->reset();
+                         torBackend->suspendAccountServices();
+                         walletManager->parkAccount(from);
+                     }, Qt::DirectConnection);
+
+    QObject::connect(accountManager, &AccountManager::accountSwitched,
+                     app, [torBackend, walletManager, transferCatalog, transferManager](const QString &, const QString &to) {
+                         transferCatalog->rebuild();
+                         walletManager->resumeAccount(to);
+                         torBackend->resumeAccountServices();
+                         transferManager->resumeAfterAccountSwitch(to);
+                     }, Qt::DirectConnection);
+
+    QObject::connect(accountManager, &AccountManager::sessionClosed,
+                     walletManager, &MultiWalletController::dropParkedAccount);
+    QObject::connect(accountManager, &AccountManager::sessionClosed,
+                     transferManager, &TransferManager::dropParkedSessions);
+
+
+    QObject::connect(accountManager, &AccountManager::settingsChanged,
+                     walletExecutor, [accountManager, walletExecutor]() {
+                         walletExecutor->setWorkerCount(accountManager->walletWorkerCount());
+                     });
+
+    QObject::connect(accountManager, &AccountManager::settingsChanged,
+                     walletResidency, [accountManager, walletResidency]() {
+                         walletResidency->setLimit(accountManager->residentWalletLimit());
+                     });
 
     QObject::connect(accountManager, &AccountManager::settingsChanged,
                      themeManager, [accountManager, themeManager]() {
@@ -85,6 +170,13 @@ QVariantMap Bootstrap::buildCore(QCoreApplication *app)
     core["wallet_manager"]    = QVariant::fromValue(walletManager);
     core["multisig_manager"]  = QVariant::fromValue(multisigManager);
     core["transfer_manager"]  = QVariant::fromValue(transferManager);
+    core["transfer_catalog"]  = QVariant::fromValue(transferCatalog);
+    core["blob_store"]        = QVariant::fromValue(blobStore);
+    core["wallet_executor"]   = QVariant::fromValue(walletExecutor);
+    core["daemon_monitor"]    = QVariant::fromValue(daemonMonitor);
+    core["daemon_proxy"]      = QVariant::fromValue(daemonProxy);
+    core["wallet_residency"]  = QVariant::fromValue(walletResidency);
+    core["wallet_lifecycle"]  = QVariant::fromValue(walletLifecycle);
     core["theme_manager"] = QVariant::fromValue(themeManager);
     return core;
 }
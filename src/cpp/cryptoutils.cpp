@@ -1,5 +1,7 @@
 #include "cryptoutils.h"
 #include <sodium.h>
+#include <QElapsedTimer>
+#include <QtEndian>
 #include <stdexcept>
 
 using namespace CryptoUtils;
@@ -10,6 +12,28 @@ bool initOnce()
     static bool ok = (sodium_init() >= 0);
     return ok;
 }
+
+constexpr char    kMagic[4]      = { 'M', 'M', 'S', 'A' };
+constexpr quint64 kMaxOpsLimit   = 64;
+constexpr quint64 kMaxMemLimit   = quint64(4) * 1024 * 1024 * 1024;
+constexpr quint64 kMinCalibMem   = quint64(16) * 1024 * 1024;
+constexpr int     kMaxSaltBytes  = 64;
+
+qint64 timeDerivation(quint64 ops, quint64 mem)
+{
+    unsigned char out[KeyBytes];
+    unsigned char salt[crypto_pwhash_SALTBYTES];
+    randombytes_buf(salt, sizeof salt);
+    static const char pw[] = "calibration";
+
+    QElapsedTimer t; t.start();
+    const int rc = crypto_pwhash(out, sizeof out, pw, sizeof pw - 1, salt,
+                                 ops, static_cast<size_t>(mem),
+                                 crypto_pwhash_ALG_ARGON2ID13);
+    const qint64 ms = t.elapsed();
+    sodium_memzero(out, sizeof out);
+    return rc == 0 ? qMax<qint64>(ms, 1) : -1;
+}
 }
 
 bool CryptoUtils::ensureSodium() { return initOnce(); }
@@ -22,18 +46,104 @@ QByteArray CryptoUtils::generateSalt()
     return salt;
 }
 
+KdfParams CryptoUtils::legacyKdf()
+{
+    return { crypto_pwhash_OPSLIMIT_MODERATE, crypto_pwhash_MEMLIMIT_MODERATE };
+}
+
+bool CryptoUtils::cipherAvailable(Cipher c)
+{
+    ensureSodium();
+    switch (c) {
+    case Cipher::XSalsa20Poly1305:
+    case Cipher::XChaCha20Poly1305: return true;
+    case Cipher::Aes256Gcm:         return crypto_aead_aes256gcm_is_available() != 0;
+    }
+    return false;
+}
+
+Cipher CryptoUtils::preferredCipher()
+{
+    return cipherAvailable(Cipher::Aes256Gcm) ? Cipher::Aes256Gcm : Cipher::XChaCha20Poly1305;
+}
+
+QString CryptoUtils::cipherName(Cipher c)
+{
+    switch (c) {
+    case Cipher::XSalsa20Poly1305:  return QStringLiteral("xsalsa20-poly1305");
+    case Cipher::XChaCha20Poly1305: return QStringLiteral("xchacha20-poly1305");
+    case Cipher::Aes256Gcm:         return QStringLiteral("aes-256-gcm");
+    }
+    return {};
+}
+
+int CryptoUtils::nonceBytes(Cipher c)
+{
+    switch (c) {
+    case Cipher::XSalsa20Poly1305:  return crypto_secretbox_NONCEBYTES;
+    case Cipher::XChaCha20Poly1305: return crypto_aead_xchacha20poly1305_ietf_NPUBBYTES;
+    case Cipher::Aes256Gcm:         return crypto_aead_aes256gcm_NPUBBYTES;
+    }
+    return 0;
+}
+
+bool CryptoUtils::kdfParamsSane(const KdfParams &p)
+{
+    return p.opsLimit >= crypto_pwhash_OPSLIMIT_MIN && p.opsLimit <= kMaxOpsLimit
+        && p.memLimit >= crypto_pwhash_MEMLIMIT_MIN && p.memLimit <= kMaxMemLimit
+        && (p.memLimit % 1024) == 0;
+}
+
+KdfParams CryptoUtils::calibrateKdf(int targetMs, quint64 maxMemBytes)
+{
+    ensureSodium();
+    targetMs = qMax(targetMs, 100);
+
+    quint64 mem = qBound<quint64>(kMinCalibMem, maxMemBytes, crypto_pwhash_MEMLIMIT_MODERATE);
+    mem -= mem % 1024;
+    quint64 ops = 2;
+
+    // Memory first: on small hosts a single pass at MODERATE may not even fit.
+    qint64 ms = timeDerivation(ops, mem);
+    while ((ms < 0 || ms > targetMs) && mem / 2 >= kMinCalibMem) {
+        mem /= 2;
+        ms = timeDerivation(ops, mem);
+    }
+    if (ms < 0)
+        return { ops, kMinCalibMem };
+
+    // Argon2 cost is close to linear in passes; spend what is left of the budget there.
+    const double perPass = double(ms) / double(ops);
+    ops = qBound<quint64>(2, quint64(double(targetMs) / perPass), kMaxOpsLimit);
+
+    return { ops, mem };
+}
+
 QByteArray CryptoUtils::deriveKey(const QString &password,
                                   const QByteArray &salt)
+{
+    return deriveKey(password, salt, legacyKdf());
+}
+
+QByteArray CryptoUtils::deriveKey(const QString &password,
+                                  const QByteArray &salt,
+                                  const KdfParams &p)
 {
     ensureSodium();
+    if (!kdfParamsSane(p))
+        throw std::runtime_error("Argon2id parameters out of range");
+    if (salt.size() != crypto_pwhash_SALTBYTES)
+        throw std::runtime_error("Argon2id salt has wrong length");
+
     QByteArray key(KeyBytes, 0);
+    const QByteArray pw = password.toUtf8();
 
     if (crypto_pwhash(reinterpret_cast<unsigned char *>(key.data()), key.size(),
-                      password.toUtf8().constData(), password.toUtf8().size(),
+                      pw.constData(), pw.size(),
                       reinterpret_cast<const unsigned char *>(salt.constData()),
-                      crypto_pwhash_OPSLIMIT_MODERATE,
-                      crypto_pwhash_MEMLIMIT_MODERATE,
-                      crypto_pwhash_ALG_DEFAULT) != 0)
+                      p.opsLimit,
+                      static_cast<size_t>(p.memLimit),
+                      crypto_pwhash_ALG_ARGON2ID13) != 0)
         throw std::runtime_error("Argon2id key derivation failed");
 
     return key;
@@ -81,3 +191,147 @@ bool CryptoUtils::decrypt(const QByteArray &cipherWithNonce,
     plainOut.swap(plain);
     return true;
 }
+
+QByteArray CryptoUtils::encrypt(const QByteArray &plain,
+                                const QByteArray &key,
+                                Cipher cipher,
+                                const QByteArray &ad)
+{
+    ensureSodium();
+    if (!cipherAvailable(cipher))
+        throw std::runtime_error("Cipher not available on this CPU");
+
+    if (cipher == Cipher::XSalsa20Poly1305) {
+        QByteArray nonce;
+        return encrypt(plain, key, nonce);
+    }
+
+    const int nlen = nonceBytes(cipher);
+    const int abytes = (cipher == Cipher::Aes256Gcm) ? crypto_aead_aes256gcm_ABYTES
+                                                     : crypto_aead_xchacha20poly1305_ietf_ABYTES;
+    QByteArray out(nlen + plain.size() + abytes, 0);
+    auto *nonce = reinterpret_cast<unsigned char *>(out.data());
+    randombytes_buf(nonce, nlen);
+
+    unsigned long long clen = 0;
+    const auto *m  = reinterpret_cast<const unsigned char *>(plain.constData());
+    const auto *a  = reinterpret_cast<const unsigned char *>(ad.constData());
+    const auto *k  = reinterpret_cast<const unsigned char *>(key.constData());
+
+    if (cipher == Cipher::Aes256Gcm)
+        crypto_aead_aes256gcm_encrypt(nonce + nlen, &clen, m, plain.size(), a, ad.size(), nullptr, nonce, k);
+    else
+        crypto_aead_xchacha20poly1305_ietf_encrypt(nonce + nlen, &clen, m, plain.size(), a, ad.size(), nullptr, nonce, k);
+
+    out.resize(nlen + static_cast<qsizetype>(clen));
+    return out;
+}
+
+bool CryptoUtils::decrypt(const QByteArray &cipherWithNonce,
+                          const QByteArray &key,
+                          Cipher cipher,
+                          const QByteArray &ad,
+                          QByteArray &plainOut)
+{
+    ensureSodium();
+    if (cipher == Cipher::XSalsa20Poly1305)
+        return decrypt(cipherWithNonce, key, plainOut);
+    if (!cipherAvailable(cipher))
+        return false;
+
+    const int nlen = nonceBytes(cipher);
+    const int abytes = (cipher == Cipher::Aes256Gcm) ? crypto_aead_aes256gcm_ABYTES
+                                                     : crypto_aead_xchacha20poly1305_ietf_ABYTES;
+    if (cipherWithNonce.size() < nlen + abytes)
+        return false;
+
+    const auto *nonce = reinterpret_cast<const unsigned char *>(cipherWithNonce.constData());
+    const auto *c     = nonce + nlen;
+    const qsizetype clen = cipherWithNonce.size() - nlen;
+    const auto *a  = reinterpret_cast<const unsigned char *>(ad.constData());
+    const auto *k  = reinterpret_cast<const unsigned char *>(key.constData());
+
+    QByteArray plain(clen - abytes, 0);
+    unsigned long long mlen = 0;
+    int rc;
+    if (cipher == Cipher::Aes256Gcm)
+        rc = crypto_aead_aes256gcm_decrypt(reinterpret_cast<unsigned char *>(plain.data()), &mlen,
+                                           nullptr, c, clen, a, ad.size(), nonce, k);
+    else
+        rc = crypto_aead_xchacha20poly1305_ietf_decrypt(reinterpret_cast<unsigned char *>(plain.data()), &mlen,
+                                                        nullptr, c, clen, a, ad.size(), nonce, k);
+    if (rc != 0)
+        return false;
+
+    plain.resize(static_cast<qsizetype>(mlen));
+    plainOut.swap(plain);
+    return true;
+}
+
+QByteArray CryptoUtils::deriveSubkey(const QByteArray &key, const QByteArray &context)
+{
+    ensureSodium();
+    QByteArray out(KeyBytes, 0);
+    crypto_generichash(reinterpret_cast<unsigned char *>(out.data()), out.size(),
+                       reinterpret_cast<const unsigned char *>(context.constData()), context.size(),
+                       reinterpret_cast<const unsigned char *>(key.constData()), key.size());
+    return out;
+}
+
+QByteArray CryptoUtils::encodeHeader(const FileHeader &h)
+{
+    QByteArray out(kMagic, sizeof kMagic);
+    out.append(char(FileFormatVersion));
+    out.append(char(static_cast<quint8>(h.cipher)));
+
+    QByteArray num(4, 0);
+    qToBigEndian<quint32>(static_cast<quint32>(h.kdf.opsLimit), num.data());
+    out.append(num);
+    qToBigEndian<quint32>(static_cast<quint32>(h.kdf.memLimit / 1024), num.data());
+    out.append(num);
+
+    out.append(char(static_cast<quint8>(h.salt.size())));
+    out.append(h.salt);
+    return out;
+}
+
+bool CryptoUtils::decodeHeader(const QByteArray &file, FileHeader &out, qsizetype &bodyOffset)
+{
+    if (file.startsWith(QByteArray(kMagic, sizeof kMagic))) {
+        constexpr qsizetype fixed = sizeof kMagic + 1 + 1 + 4 + 4 + 1;
+        if (file.size() < fixed) return false;
+
+        const auto *p = reinterpret_cast<const uchar *>(file.constData()) + sizeof kMagic;
+        const quint8 ver = p[0];
+        if (ver != FileFormatVersion) return false;
+
+        const quint8 c = p[1];
+        if (c < quint8(Cipher::XSalsa20Poly1305) || c > quint8(Cipher::Aes256Gcm)) return false;
+
+        KdfParams kdf;
+        kdf.opsLimit = qFromBigEndian<quint32>(p + 2);
+        kdf.memLimit = quint64(qFromBigEndian<quint32>(p + 6)) * 1024;
+        if (!kdfParamsSane(kdf)) return false;
+
+        const int saltLen = p[10];
+        if (saltLen > kMaxSaltBytes || file.size() < fixed + saltLen) return false;
+
+        out.version = ver;
+        out.cipher  = static_cast<Cipher>(c);
+        out.kdf     = kdf;
+        out.salt    = file.mid(fixed, saltLen);
+        bodyOffset  = fixed + saltLen;
+        return true;
+    }
+
+    if (file.size() < 2) return false;
+    const quint16 saltLen = qFromBigEndian<quint16>(reinterpret_cast<const uchar *>(file.constData()));
+    if (saltLen > kMaxSaltBytes || file.size() < 2 + saltLen) return false;
+
+    out.version = 0;
+    out.cipher  = Cipher::XSalsa20Poly1305;
+    out.kdf     = legacyKdf();
+    out.salt    = file.mid(2, saltLen);
+    bodyOffset  = 2 + saltLen;
+    return true;
+}
@@ -0,0 +1,196 @@
+#include "win_compat.h"
+#include "daemonmonitor.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QNetworkProxy>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QDateTime>
+#include <QTimer>
+#include <QVariant>
+#include <QUrl>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+constexpr int    kPollDirectMs  = 10'000;
+constexpr int    kPollProxyMs   = 20'000;    // every poll over Tor costs a circuit round trip
+constexpr int    kMaxBackoffMs  = 5 * 60'000;
+constexpr int    kTimeoutMs     = 15'000;
+constexpr qint64 kMaxReplyBytes = 64 * 1024;
+}
+
+DaemonMonitor::DaemonMonitor(QObject *parent) : QObject(parent) {}
+
+DaemonMonitor::~DaemonMonitor()
+{
+    const QStringList keys = m_endpoints.keys();
+    for (const QString &k : keys) drop(k);
+}
+
+DaemonMonitor *DaemonMonitor::of(const QObject *holder)
+{
+    if (!holder) return nullptr;
+    return qobject_cast<DaemonMonitor*>(holder->property("daemonMonitor").value<QObject*>());
+}
+
+QString DaemonMonitor::endpointKey(const QString &daemonAddr, const QString &proxyHost, quint16 proxyPort)
+{
+    const QString addr = daemonAddr.trimmed().toLower();
+    return proxyPort ? addr + QStringLiteral("|socks:") + proxyHost + QLatin1Char(':') + QString::number(proxyPort)
+                     : addr;
+}
+
+QString DaemonMonitor::watch(const QString &daemonAddr, const QString &proxyHost, quint16 proxyPort,
+                             QObject *subscriber)
+{
+    const QString key = endpointKey(daemonAddr, proxyHost, proxyPort);
+    if (daemonAddr.trimmed().isEmpty() || !subscriber) return key;
+
+    auto it = m_endpoints.find(key);
+    if (it == m_endpoints.end()) {
+        Endpoint ep;
+        ep.addr      = daemonAddr.trimmed();
+        ep.proxyHost = proxyHost;
+        ep.proxyPort = proxyPort;
+        ep.nam       = new QNetworkAccessManager(this);
+        if (proxyPort)
+            ep.nam->setProxy(QNetworkProxy(QNetworkProxy::Socks5Proxy, proxyHost, proxyPort));
+        ep.timer     = new QTimer(this);
+        ep.timer->setSingleShot(true);
+        connect(ep.timer, &QTimer::timeout, this, [this, key]() { poll(key); });
+
+        it = m_endpoints.insert(key, ep);
+        qDebug().noquote() << "[DaemonMonitor] watching" << key;
+        QTimer::singleShot(0, this, [this, key]() { poll(key); });
+    }
+
+    if (!it->subscribers.contains(subscriber)) {
+        it->subscribers.insert(subscriber);
+        connect(subscriber, &QObject::destroyed, this, [this](QObject *o) { unwatch(o); });
+    }
+    emit statsChanged();
+    return key;
+}
+
+void DaemonMonitor::unwatch(QObject *subscriber)
+{
+    QStringList idle;
+    for (auto it = m_endpoints.begin(); it != m_endpoints.end(); ++it) {
+        if (it->subscribers.remove(subscriber) && it->subscribers.isEmpty())
+            idle << it.key();
+    }
+    for (const QString &k : std::as_const(idle)) drop(k);
+    if (!idle.isEmpty()) emit statsChanged();
+}
+
+void DaemonMonitor::drop(const QString &key)
+{
+    auto it = m_endpoints.find(key);
+    if (it == m_endpoints.end()) return;
+    it->timer->stop();
+    it->timer->deleteLater();
+    it->nam->deleteLater();   // aborts an in-flight poll with it
+    m_endpoints.erase(it);
+    qDebug().noquote() << "[DaemonMonitor] stopped" << key;
+}
+
+void DaemonMonitor::schedule(Endpoint &ep)
+{
+    int ms = ep.proxyPort ? kPollProxyMs : kPollDirectMs;
+    if (ep.failures > 0) ms = std::min(kMaxBackoffMs, ms << std::min(ep.failures, 5));
+    ep.timer->start(ms);
+}
+
+void DaemonMonitor::poll(const QString &key)
+{
+    auto it = m_endpoints.find(key);
+    if (it == m_endpoints.end() || it->inFlight) return;
+
+    QUrl url(it->addr.contains(QStringLiteral("://")) ? it->addr : QStringLiteral("http://") + it->addr);
+    url.setPath(QStringLiteral("/get_info"));
+
+    QNetworkRequest req(url);
+    req.setRawHeader("Accept", "application/json");
+    req.setTransferTimeout(kTimeoutMs);
+    req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::ManualRedirectPolicy);
+
+    it->inFlight = true;
+    ++it->polls;
+    QNetworkReply *reply = it->nam->get(req);
+
+    connect(reply, &QNetworkReply::downloadProgress, reply, [reply](qint64 got, qint64) {
+        if (got > kMaxReplyBytes) reply->abort();
+    });
+    connect(reply, &QNetworkReply::finished, this, [this, key, reply]() {
+        reply->deleteLater();
+        auto it = m_endpoints.find(key);
+        if (it == m_endpoints.end()) return;
+        Endpoint &ep = *it;
+        ep.inFlight = false;
+
+        const QJsonObject info = reply->error() == QNetworkReply::NoError
+                                     ? QJsonDocument::fromJson(reply->readAll()).object()
+                                     : QJsonObject{};
+        const quint64 height = info.value("height").toVariant().toULongLong();
+        if (height == 0) {
+            if (++ep.failures == 1)
+                qDebug().noquote() << "[DaemonMonitor]" << key << "poll failed:" << reply->errorString();
+            schedule(ep);
+            emit statsChanged();
+            return;
+        }
+
+        const QString top  = info.value("top_block_hash").toString();
+        const quint64 pool = info.value("tx_pool_size").toVariant().toULongLong();
+        const bool first   = ep.lastOkMs == 0;
+        const bool tip     = !first && (height != ep.height || top != ep.topHash);
+        const bool mempool = !first && !tip && pool != ep.poolSize;
+
+        ep.height   = height;
+        ep.topHash  = top;
+        ep.poolSize = pool;
+        ep.lastOkMs = QDateTime::currentMSecsSinceEpoch();
+        ep.failures = 0;
+        if (tip || mempool) ++ep.changes;
+        schedule(ep);
+
+        // Subscribers refresh once on start anyway; only changes are news.
+        if (tip)     emit tipChanged(key, height, top);
+        if (mempool) emit mempoolChanged(key, pool);
+        emit statsChanged();
+    });
+}
+
+quint64 DaemonMonitor::cachedHeight(const QString &daemonAddr, qint64 maxAgeMs) const
+{
+    const QString addr = daemonAddr.trimmed().toLower();
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    quint64 best = 0;
+    for (auto it = m_endpoints.cbegin(); it != m_endpoints.cend(); ++it) {
+        if (it->addr.toLower() != addr || it->lastOkMs == 0) continue;
+        if (now - it->lastOkMs > maxAgeMs) continue;
+        best = std::max(best, it->height);
+    }
+    return best;
+}
+
+QVariantList DaemonMonitor::endpoints() const
+{
+    QVariantList out;
+    for (auto it = m_endpoints.cbegin(); it != m_endpoints.cend(); ++it) {
+        out.append(QVariantMap{
+            {"endpoint",    it.key()},
+            {"height",      static_cast<qulonglong>(it->height)},
+            {"pool_size",   static_cast<qulonglong>(it->poolSize)},
+            {"last_ok_ms",  it->lastOkMs},
+            {"failures",    it->failures},
+            {"polls",       static_cast<qulonglong>(it->polls)},
+            {"changes",     static_cast<qulonglong>(it->changes)},
+            {"subscribers", it->subscribers.size()},
+        });
+    }
+    return out;
+}
@@ -0,0 +1,565 @@
+#include "win_compat.h"
+#include "daemonproxy.h"
+#include "blockcache.h"
+#include "distributioncache.h"
+#include "rpccache.h"
+#include "daemonmonitor.h"
+#include "accountmanager.h"
+
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+#include <QNetworkProxy>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSet>
+#include <QUrl>
+#include <QVariant>
+#include <QDebug>
+
+namespace {
+constexpr int    kMaxHeaderBytes   = 16 * 1024;
+constexpr qint64 kMaxBodyBytes     = 16 * 1024 * 1024;
+constexpr int    kUpstreamTimeout  = 180'000;    // wallet2's own timeout for large calls
+constexpr qint64 kJoinWindow       = 200;        // blocks; a fetch starting this close is worth waiting for
+constexpr qint64 kMaxDiskBytes     = 1024LL * 1024 * 1024;
+const QByteArray kBlockCachePurpose = QByteArrayLiteral("daemon_proxy/block_cache/v1");
+constexpr qint64 kDistWarmMs       = 30 * 60'000;  // keep refetching this long after the last use
+
+const QByteArray kBlocksPath = QByteArrayLiteral("/getblocks.bin");
+const QByteArray kHashesPath = QByteArrayLiteral("/gethashes.bin");
+const QByteArray kDistPath   = QByteArrayLiteral("/get_output_distribution.bin");
+
+// What wallet2 calls on a daemon; the listener is unauthenticated, so
+// anything else is refused rather than relayed over the user's route.
+const QSet<QByteArray> kAllowedPaths = {
+    "/getblocks.bin", "/get_blocks.bin", "/getblocks_by_height.bin", "/get_blocks_by_height.bin",
+    "/gethashes.bin", "/get_hashes.bin", "/get_o_indexes.bin", "/get_outs.bin",
+    "/get_output_distribution.bin", "/get_transaction_pool_hashes.bin",
+    "/get_info", "/getinfo", "/getheight", "/get_height",
+    "/gettransactions", "/get_transactions", "/is_key_image_spent",
+    "/sendrawtransaction", "/send_raw_transaction",
+};
+const QSet<QString> kAllowedRpc = {
+    "get_version", "get_info", "getinfo", "hard_fork_info", "get_fee_estimate",
+    "get_block_count", "getblockcount", "get_last_block_header", "getlastblockheader",
+    "get_block_header_by_height", "getblockheaderbyheight", "get_block_header_by_hash",
+    "get_block_headers_range", "getblockheadersrange", "get_block", "getblock",
+    "get_output_histogram", "get_output_distribution", "get_txpool_backlog",
+    "rpc_access_info",
+};
+
+bool allowed(const QByteArray &method, const QByteArray &path, const QByteArray &body)
+{
+    if (method != "POST" && method != "GET") return false;
+    if (kAllowedPaths.contains(path)) return true;
+    if (path != "/json_rpc") return false;
+    const QJsonObject obj = QJsonDocument::fromJson(body).object();
+    return kAllowedRpc.contains(obj.value("method").toString());
+}
+
+QByteArray reasonFor(int status)
+{
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 403: return "Forbidden";
+    case 404: return "Not Found";
+    case 502: return "Bad Gateway";
+    default:  return "Status";
+    }
+}
+}
+
+struct DaemonProxy::Upstream {
+    QString                key;
+    QString                base;    // scheme://host:port of the daemon
+    QString                local;
+    QTcpServer            *server = nullptr;
+    QNetworkAccessManager *nam    = nullptr;
+};
+
+struct DaemonProxy::Request {
+    QByteArray method;
+    QByteArray path;
+    QByteArray type;
+    QByteArray body;
+    bool       keepAlive = true;
+    bool       browser   = false;   // sent an Origin header; wallet2 never does
+};
+
+struct DaemonProxy::Conn {
+    Upstream            *up = nullptr;
+    QPointer<QTcpSocket> sock;
+    QByteArray           buf;
+    bool                 busy      = false;
+    bool                 keepAlive = true;
+};
+
+struct DaemonProxy::Inflight {
+    QString    upKey;
+    qint64     start     = -1;
+    bool       cacheable = false;
+    QByteArray reqBody;
+    QByteArray distKey;    // set for distribution fetches
+    quint64    tip       = 0;
+    QList<ConnPtr>                   waiters;
+    QList<QPair<ConnPtr, Request>>   retries;   // wait for the fetch, then look up again
+};
+
+DaemonProxy::DaemonProxy(QObject *parent)
+    : QObject(parent)
+{
+    // Off until an account is unlocked; see setAccountManager().
+    m_cache = std::make_shared<BlockCache>(QString(), kMaxDiskBytes, nullptr, nullptr);
+    m_dist  = std::make_unique<DistributionCache>();
+
+    // Older versions kept one unsealed cache for every account here.
+    const QString legacy = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (!legacy.isEmpty() && QDir(legacy).exists(QStringLiteral("blockcache")))
+        (void)QtConcurrent::run([dir = QDir(legacy).filePath(QStringLiteral("blockcache"))]() {
+            QDir(dir).removeRecursively();
+        });
+    m_rpc   = std::make_unique<RpcCache>();
+}
+
+DaemonProxy::~DaemonProxy()
+{
+    m_closing = true;
+    m_cache->retire();
+    for (Upstream *up : std::as_const(m_upstreams)) {
+        delete up->server;
+        delete up->nam;
+        delete up;
+    }
+    qDeleteAll(m_inflight);
+}
+
+DaemonProxy *DaemonProxy::of(const QObject *holder)
+{
+    if (!holder) return nullptr;
+    return qobject_cast<DaemonProxy*>(holder->property("daemonProxy").value<QObject*>());
+}
+
+QString DaemonProxy::localAddress(const QString &daemonAddr, const QString &proxyHost, quint16 proxyPort)
+{
+    QString addr = daemonAddr.trimmed();
+    while (addr.endsWith(QLatin1Char('/'))) addr.chop(1);
+    if (addr.isEmpty()) return {};
+
+    // Same key as the monitor's, so its tips map onto our upstreams.
+    const QString key = DaemonMonitor::endpointKey(addr, proxyHost, proxyPort);
+    if (Upstream *up = m_upstreams.value(key)) return up->local;
+
+    auto *up   = new Upstream;
+    up->key    = key;
+    up->base   = addr.contains(QStringLiteral("://")) ? addr : QStringLiteral("http://") + addr;
+    up->server = new QTcpServer(this);
+    if (!up->server->listen(QHostAddress::LocalHost, 0)) {
+        qWarning().noquote() << "[DaemonProxy] could not listen:" << up->server->errorString();
+        delete up->server;
+        delete up;
+        return {};
+    }
+    up->nam = new QNetworkAccessManager(this);
+    if (proxyPort)
+        up->nam->setProxy(QNetworkProxy(QNetworkProxy::Socks5Proxy, proxyHost, proxyPort));
+    up->local = QStringLiteral("http://127.0.0.1:%1").arg(up->server->serverPort());
+
+    connect(up->server, &QTcpServer::newConnection, this, [this, up]() { accept(up); });
+    m_upstreams.insert(key, up);
+    qDebug().noquote() << "[DaemonProxy]" << up->local << "->" << key;
+    emit statsChanged();
+    return up->local;
+}
+
+void DaemonProxy::setAccountManager(AccountManager *am)
+{
+    m_acct = am;
+    if (!am) return;
+    connect(am, &AccountManager::isAuthenticatedChanged, this, &DaemonProxy::bindCache);
+    connect(am, &AccountManager::currentAccountChanged,  this, &DaemonProxy::bindCache);
+    bindCache();
+}
+
+// Blocks stay with the account that fetched them, sealed like its other
+// stores; fetches still running for the previous account write nothing.
+void DaemonProxy::bindCache()
+{
+    const QString base = m_acct && m_acct->isAuthenticated() ? m_acct->walletAccountDir() : QString();
+    const QString dir  = base.isEmpty() ? QString() : QDir(base).filePath(QStringLiteral("blockcache"));
+    if (dir == m_cacheDir) return;
+    m_cacheDir = dir;
+
+    m_cache->retire();
+    AccountManager *am = m_acct;
+    m_cache = std::make_shared<BlockCache>(dir, kMaxDiskBytes,
+        [am](const QByteArray &plain) { return am->sealForAccount(plain, kBlockCachePurpose); },
+        [am](const QByteArray &sealed, QByteArray &plain) {
+            return am->openForAccount(sealed, kBlockCachePurpose, plain);
+        });
+    emit statsChanged();
+}
+
+void DaemonProxy::setMonitor(DaemonMonitor *monitor)
+{
+    if (!monitor) return;
+    connect(monitor, &DaemonMonitor::tipChanged, this,
+            [this](const QString &endpoint, quint64 height) { onTip(endpoint, height); });
+}
+
+void DaemonProxy::warm(const QString &daemonAddr, const QString &proxyHost, quint16 proxyPort)
+{
+    if (localAddress(daemonAddr, proxyHost, proxyPort).isEmpty()) return;
+    QString addr = daemonAddr.trimmed();
+    while (addr.endsWith(QLatin1Char('/'))) addr.chop(1);
+    Upstream *up = m_upstreams.value(DaemonMonitor::endpointKey(addr, proxyHost, proxyPort));
+    if (!up) return;
+
+    const QByteArray body = DistributionCache::rctRequest();
+    const QByteArray key  = DistributionCache::keyFor(body);
+    if (key.isEmpty()) return;
+    m_dist->want(up->key, key, body);
+
+    const quint64 tip = m_tips.value(up->key);
+    if (tip && m_dist->lookup(up->key, key, tip).isEmpty()) prefetch(up, body);
+}
+
+void DaemonProxy::onTip(const QString &endpoint, quint64 height)
+{
+    Upstream *up = m_upstreams.value(endpoint);
+    if (!up || m_closing) return;
+    m_tips.insert(endpoint, height);
+    for (const QByteArray &body : m_dist->due(endpoint, height, kDistWarmMs))
+        prefetch(up, body);
+}
+
+void DaemonProxy::prefetch(Upstream *up, const QByteArray &body)
+{
+    Request req;
+    req.method = "POST";
+    req.path   = kDistPath;
+    req.type   = "application/octet-stream";
+    req.body   = body;
+
+    const QByteArray key = up->key.toUtf8() + ' ' + kDistPath + ' '
+                         + QCryptographicHash::hash(body, QCryptographicHash::Sha256).toHex();
+    if (m_inflight.contains(key)) return;
+    Inflight *f = startFetch(up, req, key);
+    f->distKey  = DistributionCache::keyFor(body);
+    f->tip      = m_tips.value(up->key);
+}
+
+void DaemonProxy::accept(Upstream *up)
+{
+    while (QTcpSocket *s = up->server->nextPendingConnection()) {
+        auto conn  = std::make_shared<Conn>();
+        conn->up   = up;
+        conn->sock = s;
+        connect(s, &QTcpSocket::readyRead, this, [this, conn]() {
+            if (!conn->sock) return;
+            conn->buf += conn->sock->readAll();
+            pump(conn);
+        });
+        connect(s, &QTcpSocket::disconnected, s, &QObject::deleteLater);
+    }
+}
+
+int DaemonProxy::takeRequest(QByteArray &buf, Request &out)
+{
+    // wallet2 probes for TLS first; anything that isn't an HTTP request line
+    // gets the connection dropped so it falls back to plain HTTP.
+    if (!buf.isEmpty() && !(buf.at(0) >= 'A' && buf.at(0) <= 'Z')) return -1;
+
+    const qsizetype end = buf.indexOf("\r\n\r\n");
+    if (end < 0) return buf.size() > kMaxHeaderBytes ? -1 : 0;
+
+    const QList<QByteArray> lines = buf.left(end).split('\n');
+    const QList<QByteArray> first = lines.value(0).trimmed().split(' ');
+    if (first.size() < 3) return -1;
+
+    out = Request{};
+    out.method    = first.at(0);
+    out.path      = first.at(1);
+    out.keepAlive = first.at(2) != "HTTP/1.0";
+
+    qint64 length = 0;
+    for (int i = 1; i < lines.size(); ++i) {
+        const QByteArray line  = lines.at(i).trimmed();
+        const qsizetype  colon = line.indexOf(':');
+        if (colon <= 0) continue;
+        const QByteArray name  = line.left(colon).trimmed().toLower();
+        const QByteArray value = line.mid(colon + 1).trimmed();
+        if      (name == "content-length")    length = value.toLongLong();
+        else if (name == "content-type")      out.type = value;
+        else if (name == "connection")        out.keepAlive = value.toLower() != "close";
+        else if (name == "transfer-encoding") return -1;   // wallet2 never sends chunked bodies
+        else if (name == "origin")            out.browser = true;
+    }
+    if (length < 0 || length > kMaxBodyBytes) return -1;
+
+    const qsizetype total = end + 4 + length;
+    if (buf.size() < total) return 0;
+    out.body = buf.mid(end + 4, length);
+    buf.remove(0, total);
+    return 1;
+}
+
+void DaemonProxy::pump(const ConnPtr &conn)
+{
+    if (conn->busy || !conn->sock) return;
+
+    Request req;
+    const int got = takeRequest(conn->buf, req);
+    if (got < 0) { conn->sock->abort(); return; }
+    if (got == 0) return;
+
+    conn->busy      = true;
+    conn->keepAlive = req.keepAlive;
+    handle(conn, req);
+}
+
+void DaemonProxy::handle(const ConnPtr &conn, const Request &req)
+{
+    const QByteArray path = req.path.split('?').first();
+    if (req.browser || !allowed(req.method, path, req.body)) {
+        qWarning().noquote() << "[DaemonProxy] refused" << req.method << path;
+        reply(conn, 403, "text/plain", "Forbidden");
+        return;
+    }
+    if (req.method == "POST" && path == kBlocksPath) {
+        lookupBlocks(conn, req, true);
+        return;
+    }
+    if (req.method == "POST" && path == kDistPath) {
+        lookupDistribution(conn, req);
+        return;
+    }
+    qint64 ttl = 0;
+    const QByteArray rpcKey = RpcCache::keyFor(path, req.body, &ttl);
+    if (!rpcKey.isEmpty()) {
+        const QByteArray hit = m_rpc->lookup(conn->up->key, rpcKey, m_tips.value(conn->up->key), req.body);
+        if (!hit.isEmpty()) {
+            m_cacheBytes += quint64(hit.size());
+            reply(conn, 200, "application/json", hit);
+            emit statsChanged();
+            return;
+        }
+        forwardRpc(conn, req, rpcKey, ttl);
+        return;
+    }
+    forward(conn, req, -1, false, false);
+}
+
+void DaemonProxy::forwardRpc(const ConnPtr &conn, const Request &req, const QByteArray &key, qint64 ttlMs)
+{
+    Upstream *up = conn->up;
+    const QString upKey = up->key;
+    const quint64 tip   = m_tips.value(upKey);
+    QNetworkReply *r = send(up, req);
+    connect(r, &QNetworkReply::finished, this, [this, r, conn, upKey, key, tip, ttlMs]() {
+        r->deleteLater();
+        if (m_closing) return;
+        int status = r->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        const QByteArray body = status ? r->readAll() : QByteArray();
+        if (!status) status = 502;
+        m_upstreamBytes += quint64(body.size());
+        if (status == 200) m_rpc->store(upKey, key, tip, ttlMs, body);
+        reply(conn, status, r->header(QNetworkRequest::ContentTypeHeader).toByteArray(), body);
+    });
+}
+
+void DaemonProxy::lookupDistribution(const ConnPtr &conn, const Request &req)
+{
+    Upstream *up = conn->up;
+    const QByteArray dkey = DistributionCache::keyFor(req.body);
+    const quint64    tip  = m_tips.value(up->key);
+    if (!dkey.isEmpty()) {
+        const QByteArray hit = m_dist->lookup(up->key, dkey, tip);
+        if (!hit.isEmpty()) {
+            m_cacheBytes += quint64(hit.size());
+            reply(conn, 200, "application/octet-stream", hit);
+            emit statsChanged();
+            return;
+        }
+        // Remember it so the next blocks refetch it in the background.
+        m_dist->want(up->key, dkey, req.body);
+    }
+    forward(conn, req, -1, false, false);
+}
+
+void DaemonProxy::lookupBlocks(const ConnPtr &conn, const Request &req, bool mayWait)
+{
+    auto *watcher = new QFutureWatcher<BlockCache::Lookup>(this);
+    connect(watcher, &QFutureWatcher<BlockCache::Lookup>::finished, this,
+            [this, watcher, conn, req, mayWait]() {
+        const BlockCache::Lookup hit = watcher->result();
+        watcher->deleteLater();
+        if (m_closing) return;
+        if (!hit.response.isEmpty()) {
+            m_cacheBytes += quint64(hit.response.size());
+            reply(conn, 200, "application/octet-stream", hit.response);
+            emit statsChanged();
+            return;
+        }
+        forward(conn, req, hit.start, hit.cacheable, mayWait);
+    });
+
+    const std::shared_ptr<BlockCache> cache = m_cache;
+    const QByteArray body     = req.body;
+    const QString    upstream = conn->up->key;
+    watcher->setFuture(QtConcurrent::run([cache, upstream, body]() { return cache->lookup(upstream, body); }));
+}
+
+QNetworkReply *DaemonProxy::send(Upstream *up, const Request &req)
+{
+    QNetworkRequest nr(QUrl(up->base + QString::fromLatin1(req.path)));
+    if (!req.type.isEmpty()) nr.setHeader(QNetworkRequest::ContentTypeHeader, req.type);
+    nr.setTransferTimeout(kUpstreamTimeout);
+    nr.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::ManualRedirectPolicy);
+    ++m_forwarded;
+    return up->nam->sendCustomRequest(nr, req.method, req.body);
+}
+
+void DaemonProxy::forward(const ConnPtr &conn, const Request &req, qint64 start, bool cacheable, bool mayWait)
+{
+    Upstream *up = conn->up;
+    const QByteArray path = req.path.split('?').first();
+
+    // Only read-only block and distribution calls are merged; everything
+    // else goes out as sent.
+    const bool mergeable = req.method == "POST"
+                        && (path == kBlocksPath || path == kHashesPath || path == kDistPath);
+    if (!mergeable) {
+        QNetworkReply *r = send(up, req);
+        connect(r, &QNetworkReply::finished, this, [this, r, conn]() {
+            r->deleteLater();
+            if (m_closing) return;
+            int status = r->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+            const QByteArray body = status ? r->readAll() : QByteArray();
+            if (!status) status = 502;
+            m_upstreamBytes += quint64(body.size());
+            reply(conn, status, r->header(QNetworkRequest::ContentTypeHeader).toByteArray(), body);
+        });
+        return;
+    }
+
+    const QByteArray key = up->key.toUtf8() + ' ' + path + ' '
+                         + QCryptographicHash::hash(req.body, QCryptographicHash::Sha256).toHex();
+    if (Inflight *f = m_inflight.value(key)) {
+        f->waiters << conn;
+        ++m_merged;
+        emit statsChanged();
+        return;
+    }
+    if (cacheable && mayWait && start >= 0) {
+        for (Inflight *f : std::as_const(m_inflight)) {
+            if (f->upKey != up->key || !f->cacheable || f->start < 0) continue;
+            if (start < f->start || start >= f->start + kJoinWindow) continue;
+            f->retries << qMakePair(conn, req);
+            ++m_waited;
+            emit statsChanged();
+            return;
+        }
+    }
+
+    Inflight *f  = startFetch(up, req, key);
+    f->start     = start;
+    f->cacheable = cacheable;
+    f->waiters << conn;
+    if (path == kDistPath) {
+        f->distKey = DistributionCache::keyFor(req.body);
+        f->tip     = m_tips.value(up->key);
+    }
+}
+
+DaemonProxy::Inflight *DaemonProxy::startFetch(Upstream *up, const Request &req, const QByteArray &key)
+{
+    auto *f    = new Inflight;
+    f->upKey   = up->key;
+    f->reqBody = req.body;
+    m_inflight.insert(key, f);
+
+    QNetworkReply *r = send(up, req);
+    connect(r, &QNetworkReply::finished, this, [this, r, key]() {
+        r->deleteLater();
+        if (m_closing) return;
+        int status = r->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        const QByteArray body = status ? r->readAll() : QByteArray();
+        if (!status) status = 502;
+        m_upstreamBytes += quint64(body.size());
+        finish(key, status, r->header(QNetworkRequest::ContentTypeHeader).toByteArray(), body);
+    });
+    return f;
+}
+
+void DaemonProxy::finish(const QByteArray &key, int status, const QByteArray &type, const QByteArray &body)
+{
+    Inflight *f = m_inflight.take(key);
+    if (!f) return;
+
+    for (const ConnPtr &c : std::as_const(f->waiters)) reply(c, status, type, body);
+
+    if (!f->distKey.isEmpty() && status == 200 && DistributionCache::looksOk(body))
+        m_dist->store(f->upKey, f->distKey, f->reqBody, f->tip, body);
+
+    const QList<QPair<ConnPtr, Request>> retries = f->retries;
+    const bool       ingest  = f->cacheable && status == 200 && !body.isEmpty();
+    const QByteArray reqBody = f->reqBody;
+    const QString    upKey   = f->upKey;
+    delete f;
+
+    auto resume = [this, retries]() {
+        for (const auto &p : retries) lookupBlocks(p.first, p.second, false);
+    };
+    emit statsChanged();
+    if (!ingest) { resume(); return; }
+
+    auto *watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher, resume]() {
+        watcher->deleteLater();
+        if (!m_closing) resume();
+    });
+    const std::shared_ptr<BlockCache> cache = m_cache;
+    watcher->setFuture(QtConcurrent::run([cache, upKey, reqBody, body]() { cache->ingest(upKey, reqBody, body); }));
+}
+
+void DaemonProxy::reply(const ConnPtr &conn, int status, const QByteArray &type, const QByteArray &body)
+{
+    conn->busy = false;
+    QTcpSocket *s = conn->sock;
+    if (!s) return;
+
+    QByteArray head = "HTTP/1.1 " + QByteArray::number(status) + ' ' + reasonFor(status) + "\r\n";
+    if (!type.isEmpty()) head += "Content-Type: " + type + "\r\n";
+    head += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    head += conn->keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+    s->write(head);
+    s->write(body);
+
+    if (!conn->keepAlive) { s->disconnectFromHost(); return; }
+    if (!conn->buf.isEmpty()) pump(conn);
+}
+
+QVariantMap DaemonProxy::stats() const
+{
+    QVariantMap s = m_cache->stats();
+    s.insert(m_dist->stats());
+    s.insert(m_rpc->stats());
+    s.insert("listeners",      m_upstreams.size());
+    s.insert("inflight",       m_inflight.size());
+    s.insert("forwarded",      static_cast<qulonglong>(m_forwarded));
+    s.insert("merged",         static_cast<qulonglong>(m_merged));
+    s.insert("waited",         static_cast<qulonglong>(m_waited));
+    s.insert("upstream_bytes", static_cast<qulonglong>(m_upstreamBytes));
+    s.insert("cache_bytes",    static_cast<qulonglong>(m_cacheBytes));
+    return s;
+}
@@ -0,0 +1,141 @@
+#include "win_compat.h"
+#include <rpc/core_rpc_server_commands_defs.h>
+#include <storages/portable_storage_template_helper.h>
+#ifdef QT_TRANSLATE_NOOP
+#undef QT_TRANSLATE_NOOP
+#endif
+
+#include "distributioncache.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+using Cmd = cryptonote::COMMAND_RPC_GET_OUTPUT_DISTRIBUTION;
+
+constexpr int    kMaxEntries = 8;
+constexpr qint64 kMaxBytes   = 64 * 1024 * 1024;
+
+const epee::serialization::portable_storage::limits_t kLimits{ 4096, 4096, 4096 };
+
+QString slot(const QString &upstream, const QByteArray &key)
+{
+    return upstream + QLatin1Char(' ') + QString::fromLatin1(key);
+}
+}
+
+QByteArray DistributionCache::keyFor(const QByteArray &request)
+{
+    Cmd::request req;
+    try {
+        const epee::span<const uint8_t> span(reinterpret_cast<const uint8_t*>(request.constData()),
+                                             size_t(request.size()));
+        if (!epee::serialization::load_t_from_binary(req, span, &kLimits)) return {};
+    } catch (...) {
+        return {};
+    }
+
+    QByteArray key;
+    for (uint64_t a : req.amounts) key += QByteArray::number(qulonglong(a)) + ',';
+    key += QStringLiteral("|%1-%2|%3%4%5")
+               .arg(req.from_height).arg(req.to_height)
+               .arg(int(req.cumulative)).arg(int(req.binary)).arg(int(req.compress)).toLatin1();
+    return key;
+}
+
+QByteArray DistributionCache::rctRequest()
+{
+    // Same parameters as wallet2::get_rct_distribution().
+    Cmd::request req{};
+    req.amounts.push_back(0);
+    req.from_height = 0;
+    req.to_height   = 0;
+    req.cumulative  = false;
+    req.binary      = true;
+    req.compress    = true;
+
+    std::string out;
+    if (!epee::serialization::store_t_to_binary(req, out)) return {};
+    return QByteArray::fromStdString(out);
+}
+
+bool DistributionCache::looksOk(const QByteArray &response)
+{
+    // epee binary: name "status", string type, length 2, "OK".
+    static const QByteArray kStatusOk("\x06status\x0a\x08OK");
+    return response.contains(kStatusOk);
+}
+
+QByteArray DistributionCache::lookup(const QString &upstream, const QByteArray &key, quint64 tip)
+{
+    auto it = m_entries.find(slot(upstream, key));
+    if (it == m_entries.end()) { ++m_misses; return {}; }
+
+    it->lastUsedMs = QDateTime::currentMSecsSinceEpoch();
+    if (tip == 0 || it->tip != tip || it->response.isEmpty()) { ++m_misses; return {}; }
+    ++m_hits;
+    return it->response;
+}
+
+void DistributionCache::store(const QString &upstream, const QByteArray &key, const QByteArray &request,
+                              quint64 tip, const QByteArray &response)
+{
+    Entry &e = m_entries[slot(upstream, key)];
+    m_bytes     += response.size() - e.response.size();
+    e.request    = request;
+    e.response   = response;
+    e.tip        = tip;
+    if (e.lastUsedMs == 0) e.lastUsedMs = QDateTime::currentMSecsSinceEpoch();
+    ++m_stores;
+    evict();
+}
+
+void DistributionCache::want(const QString &upstream, const QByteArray &key, const QByteArray &request)
+{
+    Entry &e = m_entries[slot(upstream, key)];
+    if (e.request.isEmpty()) e.request = request;
+    e.lastUsedMs = QDateTime::currentMSecsSinceEpoch();
+    evict();
+}
+
+QList<QByteArray> DistributionCache::due(const QString &upstream, quint64 tip, qint64 warmMs)
+{
+    const QString prefix = upstream + QLatin1Char(' ');
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+    QList<QByteArray> out;
+    for (auto it = m_entries.begin(); it != m_entries.end();) {
+        if (!it.key().startsWith(prefix)) { ++it; continue; }
+        if (now - it->lastUsedMs > warmMs) {
+            m_bytes -= it->response.size();
+            it = m_entries.erase(it);
+            continue;
+        }
+        if (it->tip != tip) out << it->request;
+        ++it;
+    }
+    return out;
+}
+
+void DistributionCache::evict()
+{
+    while (m_entries.size() > kMaxEntries || m_bytes > kMaxBytes) {
+        auto oldest = std::min_element(m_entries.begin(), m_entries.end(),
+                                       [](const Entry &a, const Entry &b) { return a.lastUsedMs < b.lastUsedMs; });
+        if (oldest == m_entries.end()) break;
+        m_bytes -= oldest->response.size();
+        m_entries.erase(oldest);
+    }
+}
+
+QVariantMap DistributionCache::stats() const
+{
+    return {
+        { "dist_entries", int(m_entries.size()) },
+        { "dist_bytes",   m_bytes },
+        { "dist_hits",    static_cast<qulonglong>(m_hits) },
+        { "dist_misses",  static_cast<qulonglong>(m_misses) },
+        { "dist_stores",  static_cast<qulonglong>(m_stores) },
+    };
+}
@@ -7,12 +7,16 @@
 #include "multiwalletcontroller.h"
 #include "torbackend.h"
 #include "accountmanager.h"
+#include "transfercatalog.h"
+#include "blobstore.h"
 #include "wallet.h"
+#include "peerlatency.h"
 #include "cryptoutils_extras.h"
 
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
@@ -27,6 +31,7 @@ using namespace CryptoUtils;
 
 namespace {
 constexpr int RETRY_MS = 5'000;
+constexpr int kFanOutWidth = 3;   // candidates probed at once
 
 static constexpr qint64 kMaxHttpBytes   = 256 * 1024;
 static constexpr int    kMaxBlobBytes   = 256 * 1024;
@@ -94,18 +99,13 @@ IncomingTransfer::IncomingTransfer(MultiWalletController *wm,
     m_walletName = walletNameForRef(m_walletRef);
 
 
-    QJsonDocument doc = QJsonDocument::fromJson(acct->loadAccountData().toUtf8());
-    const QJsonArray wallets = doc.object()
-                                   .value("monero").toObject()
-                                   .value("wallets").toArray();
-    for (const auto &wv : wallets) {
-        const QJsonObject w = wv.toObject();
-        const QJsonObject transfers = w.value("transfers").toObject();
-        if (!transfers.contains(m_transferRef)) continue;
-        const QJsonObject tr = transfers.value(m_transferRef).toObject();
+    TransferCatalog *catalog = TransferCatalog::of(acct);
+    if (catalog && catalog->contains(m_transferRef)) {
+        const QJsonObject tr = catalog->transfer(m_transferRef);
 
-        m_transferBlobB64 = tr.value("transfer_blob").toString();
+        m_transferBlobB64 = BlobStore::transferBlob(acct, tr);
         m_description     = tr.value("transfer_description").toObject();
+        m_describeRecord  = tr.value("describe_cache").toObject();
         m_signatures      = tr.value("signatures").toVariant().toStringList();
         m_signingOrder    = tr.value("signing_order").toVariant().toStringList();
         m_txId            = tr.value("tx_id").toString();
@@ -120,7 +120,6 @@ IncomingTransfer::IncomingTransfer(MultiWalletController *wm,
         else if (st == "CHECKING_STATUS") m_stage = Stage::CHECKING_STATUS;
         else if (st == "COMPLETE")        m_stage = Stage::COMPLETE;
         else                              m_stage = Stage::ERROR;
-        break;
     }
 
 
@@ -208,6 +207,9 @@ void IncomingTransfer::validate()
 
     saveToAccount();
 
+    if (!m_describeRecord.isEmpty())
+        w->adoptDescribeRecord(m_transferBlobB64, m_describeRecord);
+
     connect(w, &Wallet::describeTransferResult,
             this, &IncomingTransfer::onDescribeTransfer,
             Qt::QueuedConnection);
@@ -235,6 +237,8 @@ void IncomingTransfer::onDescribeTransfer(QString /*walletName*/, QVariant v, QS
         saveToAccount();
         return;
     }
+    if (Wallet *w = walletByRef(m_walletRef))
+        m_describeRecord = w->describeRecord(m_transferBlobB64);
     const QJsonObject first = descArr.first().toObject();
     if (first != m_description) {
         setStage(Stage::ERROR, "Mismatch between transfer data sent & local transfer description verification");
@@ -350,6 +354,18 @@ void IncomingTransfer::onErrorOccurred(QString error, QString operation_caller)
 
 void IncomingTransfer::maybeSubmit()
 {
+    if (fanOut()) {
+        if (unsignedPeers().isEmpty()) {
+            setStage(Stage::BROADCASTING, QStringLiteral("Broadcasting to network…"));
+            broadcastSelf();
+            return;
+        }
+        setStage(Stage::SUBMITTING, QStringLiteral("Looking for the next signer…"));
+        m_retry.start();
+        submitToNextPeer();
+        return;
+    }
+
     const QString me = myOnionFQDN();
     const int myIdx = m_signingOrder.indexOf(me, Qt::CaseInsensitive);
 
@@ -377,6 +393,27 @@ void IncomingTransfer::maybeSubmit()
 
 void IncomingTransfer::submitToNextPeer()
 {
+    if (fanOut()) {
+        if (!m_offeredTo.isEmpty()) {         // one signer holds the txset at a time
+            if (m_offerUnconfirmed) confirmOffer();
+            return;
+        }
+
+        QStringList candidates = unsignedPeers();
+        if (candidates.isEmpty()) {
+            setStage(Stage::BROADCASTING, QStringLiteral("Broadcasting to network…"));
+            broadcastSelf();
+            return;
+        }
+        if (auto *latency = PeerLatency::of(m_wm)) candidates = latency->rank(candidates);
+
+        // The first ready answer gets the txset, see onHttpResult.
+        const QString path = QStringLiteral("/api/multisig/transfer/ping?ref=%1").arg(m_walletRef);
+        for (int i = 0; i < candidates.size() && i < kFanOutWidth; ++i)
+            httpGetAsync(candidates[i], path, true);
+        emit statusChanged(QStringLiteral("Looking for an available signer (%1 candidates)").arg(candidates.size()));
+        return;
+    }
 
     const QString me = myOnionFQDN();
     const int myIdx = m_signingOrder.indexOf(me, Qt::CaseInsensitive);
@@ -398,10 +435,23 @@ void IncomingTransfer::submitToNextPeer()
         return;
     }
 
+    submitTo(nextPeer, m_signingOrder);
+}
+
+void IncomingTransfer::confirmOffer()
+{
+    if (m_stopFlag || m_offeredTo.isEmpty()) return;
+    const QString path = QStringLiteral("/api/multisig/transfer/status?ref=%1&transfer_ref=%2")
+                             .arg(m_walletRef, m_transferRef);
+    httpGetAsync(m_offeredTo, path, true);
+}
+
+void IncomingTransfer::submitTo(const QString &nextPeer, const QStringList &order)
+{
     const QJsonObject body{
         {"transfer_ref", m_transferRef},
         {"transfer_blob", m_transferBlobB64},
-        {"signing_order", QJsonArray::fromStringList(m_signingOrder)},
+        {"signing_order", QJsonArray::fromStringList(order)},
         {"who_has_signed",QJsonArray::fromStringList(m_signatures)},
         {"transfer_description", m_description}
     };
@@ -423,6 +473,30 @@ void IncomingTransfer::submitToNextPeer()
     httpPostAsync(nextPeer, path, body, true);
 }
 
+bool IncomingTransfer::fanOut() const
+{
+    const QVariantMap meta = m_wm->getWalletMeta(m_walletName);
+    const int threshold = meta.value("threshold").toInt();
+    return threshold > 0 && meta.value("total").toInt() > threshold;
+}
+
+QStringList IncomingTransfer::unsignedPeers() const
+{
+    QStringList configured = walletPeersByRef(m_walletRef);
+    if (configured.isEmpty())
+        configured = m_wm->peersForWallet(m_walletName);
+
+    const QString me = myOnionFQDN();
+    QStringList out;
+    for (const QString &p : std::as_const(configured)) {
+        const QString low = p.trimmed().toLower();
+        if (low.isEmpty() || low.compare(me, Qt::CaseInsensitive) == 0) continue;
+        if (m_signatures.contains(low, Qt::CaseInsensitive) || out.contains(low)) continue;
+        out << low;
+    }
+    return out;
+}
+
 void IncomingTransfer::broadcastSelf()
 {
     Wallet *w = walletByRef(m_walletRef);
@@ -460,16 +534,48 @@ void IncomingTransfer::onSubmitResult(bool ok, QString result, QString operation
 void IncomingTransfer::onHttpResult(QString onion, QString path,
                                     QJsonObject res, QString err)
 {
-    Q_UNUSED(onion)
-
+    if (m_stopFlag) return;
     if (!err.isEmpty() || res.contains("error")) {
+        // The txset may have landed before the error; the peer stays the
+        // holder until it says otherwise, see confirmOffer().
+        if (onion == m_offeredTo && path.startsWith("/api/multisig/transfer/submit"))
+            m_offerUnconfirmed = true;
+        return;
+    }
+
+    if (path.startsWith("/api/multisig/transfer/status")) {
+        if (m_stage != Stage::SUBMITTING || !m_offerUnconfirmed || onion != m_offeredTo) return;
+        m_offerUnconfirmed = false;
+        if (res.value("received_transfer").toBool(false)) {
+            submitTo(onion, m_offeredOrder);   // keyed by transfer_ref, a resend is safe
+        } else {
+            m_offeredTo.clear();
+            submitToNextPeer();
+        }
+        return;
+    }
 
+    if (path.startsWith("/api/multisig/transfer/ping")) {
+        if (m_stage != Stage::SUBMITTING || !m_offeredTo.isEmpty()) return;
+        if (!res.value("online").toBool(false) || !res.value("ready").toBool(false)) return;
+
+        QStringList candidates = unsignedPeers();
+        if (!candidates.contains(onion, Qt::CaseInsensitive)) return;
+        if (auto *latency = PeerLatency::of(m_wm)) candidates = latency->rank(candidates);
+
+        m_offeredTo    = onion;
+        m_offeredOrder = PeerLatency::chainVia(m_signatures, onion, candidates);
+        submitTo(onion, m_offeredOrder);
         return;
     }
 
     if (path.startsWith("/api/multisig/transfer/submit")) {
         const bool ok = res.value("success").toBool(false);
-        if (!ok) return;
+        if (!ok) {
+            if (onion == m_offeredTo) { m_offeredTo.clear(); m_offerUnconfirmed = false; }
+            return;
+        }
+        if (onion == m_offeredTo) m_signingOrder = m_offeredOrder;
 
 
         setStage(Stage::CHECKING_STATUS,"Submitted – waiting for status");
@@ -502,58 +608,43 @@ void IncomingTransfer::retryRound()
 void IncomingTransfer::saveToAccount()
 {
     if (!m_acct) return;
+    TransferCatalog *catalog = TransferCatalog::of(m_acct);
+    if (!catalog) return;
 
-    QJsonDocument doc = QJsonDocument::fromJson(m_acct->loadAccountData().toUtf8());
-    QJsonObject root  = doc.object();
-
-    QJsonObject mon   = root.value("monero").toObject();
-    QJsonArray wallets= mon.value("wallets").toArray();
-
-    for (int i=0;i<wallets.size();++i) {
-        QJsonObject w = wallets[i].toObject();
-        if (w.value("reference").toString()!=m_walletRef &&
-            w.value("name").toString()!=m_walletName) { wallets[i]=w; continue; }
-
-        QJsonObject transfers = w.value("transfers").toObject();
-        QJsonObject e = transfers.value(m_transferRef).toObject();
-
-        e["transfer_blob"]  = m_transferBlobB64;
-        e["signatures"]     = QJsonArray::fromStringList(m_signatures);
-        e["stage"]          = stageName(m_stage);
-        e["status"]         = m_status;
-        if (!m_myOnion.isEmpty()) e["my_onion"] = m_myOnion;
-        if (!m_txId.isEmpty()) e["tx_id"] = m_txId;
+    QJsonObject e = catalog->transfer(m_transferRef);
 
-        const qint64 now = QDateTime::currentSecsSinceEpoch();
-        if (!e.contains("received_at")) e["received_at"]=now;
-        if ((m_stage==Stage::SUBMITTING || m_stage==Stage::BROADCASTING) && !e.contains("submitted_at"))
-            e["submitted_at"]=now;
+    BlobStore::setTransferBlob(m_acct, m_transferRef, e, m_transferBlobB64);
+    e["signatures"]     = QJsonArray::fromStringList(m_signatures);
+    e["signing_order"]  = QJsonArray::fromStringList(m_signingOrder);
+    e["stage"]          = stageName(m_stage);
+    e["status"]         = m_status;
+    if (!m_myOnion.isEmpty()) e["my_onion"] = m_myOnion;
+    if (!m_txId.isEmpty()) e["tx_id"] = m_txId;
+    if (!m_describeRecord.isEmpty()) e["describe_cache"] = m_describeRecord;
 
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    if (!e.contains("received_at")) e["received_at"]=now;
+    if ((m_stage==Stage::SUBMITTING || m_stage==Stage::BROADCASTING) && !e.contains("submitted_at"))
+        e["submitted_at"]=now;
 
-        QJsonObject peersObj = e.value("peers").toObject();
 
-        const QString me = myOnionFQDN();
-        const bool iSigned = m_signatures.contains(me, Qt::CaseInsensitive);
+    QJsonObject peersObj = e.value("peers").toObject();
 
+    const QString me = myOnionFQDN();
+    const bool iSigned = m_signatures.contains(me, Qt::CaseInsensitive);
 
-        peersObj.insert(me, QJsonArray{
-                                stageName(m_stage),
-                                true,
-                                iSigned,
-                                m_status
-                            });
 
+    peersObj.insert(me, QJsonArray{
+                            stageName(m_stage),
+                            true,
+                            iSigned,
+                            m_status
+                        });
 
-        e["peers"] = peersObj;
 
-        transfers.insert(m_transferRef, e);
-        w["transfers"]=transfers; wallets[i]=w;
-        break;
-    }
+    e["peers"] = peersObj;
 
-    mon["wallets"] = wallets;
-    root["monero"] = mon;
-    (void)m_acct->saveAccountData(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    (void)catalog->upsert(m_walletRef, m_walletName, m_myOnion, m_transferRef, e);
 }
 
 void IncomingTransfer::setStage(Stage s,const QString &msg)
@@ -585,10 +676,20 @@ void IncomingTransfer::stop(const QString &reason)
     if (m_stopFlag) return;
     m_stopFlag=true;
     m_retry.stop();
-    m_httpPool.waitForDone(5'000);
+    m_httpPool.clear();   // requests in flight are ignored once stopped
+    // A queued describe or sign would still run and use the nonces.
+    if (reason != QLatin1String("success"))
+        if (Wallet *w = walletByRef(m_walletRef)) w->cancelOperations(m_transferRef);
     emit finished(m_transferRef, reason);
 }
 
+void IncomingTransfer::deleteWhenIdle()
+{
+    m_httpPool.clear();
+    if (m_httpPool.activeThreadCount() == 0) { deleteLater(); return; }
+    QTimer::singleShot(250, this, &IncomingTransfer::deleteWhenIdle);
+}
+
 QString IncomingTransfer::getTransferDetailsJson() const
 {
     QJsonObject o{
@@ -608,9 +709,16 @@ QString IncomingTransfer::getTransferDetailsJson() const
 void IncomingTransfer::httpGetAsync(const QString &onion,const QString &path,bool signedFlag)
 {
     QRunnable *task = QRunnable::create([=](){
+        QElapsedTimer rtt; rtt.start();
         const QJsonObject res = httpRequestBlocking(onion,path,"GET",signedFlag);
         const QString err = res.value("error").toString();
-        emit onHttpResult(onion,path,res,err);
+        const qint64 rttMs = rtt.elapsed();
+        // Results are handled on the session's thread, like TransferInitiator's.
+        QMetaObject::invokeMethod(this, [this, onion, path, res, err, rttMs](){
+            if (auto *latency = PeerLatency::of(m_wm))
+                latency->record(onion, err.isEmpty() && !res.contains("error"), rttMs);
+            onHttpResult(onion,path,res,err);
+        }, Qt::QueuedConnection);
     });
     task->setAutoDelete(true);
     m_httpPool.start(task);
@@ -620,9 +728,16 @@ void IncomingTransfer::httpPostAsync(const QString &onion,const QString &path,
                                      const QJsonObject &json,bool signedFlag)
 {
     QRunnable *task = QRunnable::create([=](){
+        QElapsedTimer rtt; rtt.start();
         const QJsonObject res = httpRequestBlocking(onion,path,"POST",signedFlag,json);
         const QString err = res.value("error").toString();
-        emit onHttpResult(onion,path,res,err);
+        const qint64 rttMs = rtt.elapsed();
+        // Results are handled on the session's thread, like TransferInitiator's.
+        QMetaObject::invokeMethod(this, [this, onion, path, res, err, rttMs](){
+            if (auto *latency = PeerLatency::of(m_wm))
+                latency->record(onion, err.isEmpty() && !res.contains("error"), rttMs);
+            onHttpResult(onion,path,res,err);
+        }, Qt::QueuedConnection);
     });
     task->setAutoDelete(true);
     m_httpPool.start(task);
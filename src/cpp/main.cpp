@@ -8,12 +8,14 @@
 #include "accountmanager.h"
 #include "bootstrap.h"
 #include "wallet.h"
+#include "transferhistorymodel.h"
 #include "multiwalletcontroller.h"
 #include "torbackend.h"
 #include "multisigmanager.h"
 #include "transfermanager.h"
 #include "transfertracker.h"
 #include "thememanager.h"
+#include "walletlifecycle.h"
 #include <QCoreApplication>
 
 
@@ -29,6 +31,7 @@ int main(int argc, char *argv[])
     #endif
 
     qmlRegisterType<Wallet>("MoneroMultisigGui", 1, 0, "Wallet");
+    qmlRegisterType<TransferHistoryModel>("MoneroMultisigGui", 1, 0, "TransferHistoryModel");
     qmlRegisterType<MultiWalletController>("MoneroMultisigGui", 1, 0, "WalletManager");
     qmlRegisterType<TransferTracker>("MoneroMultisigGui", 1, 0, "TransferTracker");
 
@@ -65,5 +68,10 @@ int main(int argc, char *argv[])
     if (engine.rootObjects().isEmpty())
         return -1;
 
-    return app.exec();
+    const int rc = app.exec();
+
+    // Let open wallets store before the process goes away.
+    if (auto *lifecycle = core["wallet_lifecycle"].value<WalletLifecycle*>())
+        lifecycle->shutdown();
+    return rc;
 }
@@ -3,6 +3,8 @@
 #include "multisigsession.h"
 #include "accountmanager.h"
 #include "multiwalletcontroller.h"
+#include "transfercatalog.h"
+#include "blobstore.h"
 #include <cryptoutils_extras.h>
 
 #include <QUrl>
@@ -762,7 +764,14 @@ bool MultisigApiRouter::handleTransferRequestInfo(const QByteArray &method,
         info = pair.first; ts = pair.second;
 
         const qint64 now = QDateTime::currentSecsSinceEpoch();
-        const bool stale = (ts == 0) || (now - ts > kMsigInfoMaxAgeSec);
+        bool stale = (ts == 0) || (now - ts > kMsigInfoMaxAgeSec);
+
+        // Old but unchanged info is still valid; only real wallet changes
+        // cost another export_multisig().
+        if (stale && ts != 0 && m->renewMultisigInfo(walletName)) {
+            ts    = m->giveMultisigInfo(walletName).second;
+            stale = false;
+        }
 
 
         if (stale) {
@@ -928,7 +937,17 @@ bool MultisigApiRouter::handleTransferStatus(const QByteArray &method,
 
     QJsonObject saved;
     if (!readSavedTransfer(ref, transferRef, &saved)) {
-        sendPlain(sock, 404, "Not found"); return true;
+        // A signer whose submit got lost in transit asks this before offering
+        // the txset to someone else, so "never got it" needs a real answer.
+        sendJson(sock, 200, QJsonObject{
+            { "ref", ref },
+            { "transferRef", transferRef },
+            { "online", true },
+            { "time", qint64(QDateTime::currentSecsSinceEpoch()) },
+            { "received_transfer", false },
+            { "has_signed", false }
+        });
+        return true;
     }
 
     const QString stage = saved.value("stage").toString();
@@ -1063,42 +1082,20 @@ bool MultisigApiRouter::saveIncomingTransfer(const QString &walletRef,
                                              const QStringList &whoHasSigned)
 {
     if (!m_acct) return false;
+    TransferCatalog *catalog = TransferCatalog::of(m_acct);
+    if (!catalog) return false;
 
-
-    QJsonDocument doc = QJsonDocument::fromJson(m_acct->loadAccountData().toUtf8());
-    QJsonObject root  = doc.object();
-    QJsonObject monero= root.value("monero").toObject();
-    QJsonArray wallets= monero.value("wallets").toArray();
-
-    int idx=-1; QJsonObject wobj;
-    for (int i=0;i<wallets.size();++i){
-        QJsonObject o = wallets.at(i).toObject();
-
-        const QString wantOnion = normOnion(m_boundOnion);
-
-        for (int i=0;i<wallets.size();++i){
-            QJsonObject o = wallets.at(i).toObject();
-            const QString oName  = o.value("name").toString();
-            const QString oRef   = o.value("reference").toString();
-            const QString oOnion = normOnion(o.value("my_onion").toString());
-
-            bool match = false;
-
-            if (!walletRef.isEmpty() && oRef == walletRef && oOnion == wantOnion) {
-                match = true;
-            }
-
-            if (match) { idx=i; wobj=o; break; }
-        }
-    }
-    if (idx<0) return false;
+    const QString wantOnion = normOnion(m_boundOnion);
+    if (walletRef.isEmpty()) return false;
+    const QString ownerName = catalog->walletNameForRefOnion(walletRef, wantOnion);
+    if (ownerName.isEmpty()) return false;
 
 
     QJsonObject transfer;
     transfer["type"]        = QStringLiteral("MULTISIG");
-    transfer["wallet_name"] = wobj.value("name").toString();
+    transfer["wallet_name"] = ownerName;
     transfer["wallet_ref"]  = walletRef;
-    transfer["transfer_blob"] = jsonBody.value("transfer_blob").toString();
+    BlobStore::setTransferBlob(m_acct, transferRef, transfer, jsonBody.value("transfer_blob").toString());
     transfer["transfer_description"] = jsonBody.value("transfer_description").toObject();
     transfer["signing_order"] = QJsonArray::fromStringList(signingOrder);
     transfer["signatures"]    = QJsonArray::fromStringList(whoHasSigned);
@@ -1159,15 +1156,7 @@ bool MultisigApiRouter::saveIncomingTransfer(const QString &walletRef,
     transfer["peers"] = peersMap;
 
 
-    QJsonObject transfers = wobj.value("transfers").toObject();
-    transfers.insert(transferRef, transfer);
-    wobj["transfers"] = transfers;
-    wallets[idx] = wobj;
-    monero["wallets"] = wallets;
-    root["monero"] = monero;
-
-    const bool ok = m_acct->saveAccountData(QJsonDocument(root).toJson(QJsonDocument::Compact));
-    return ok;
+    return catalog->upsert(walletRef, ownerName, wantOnion, transferRef, transfer);
 }
 
 bool MultisigApiRouter::readSavedTransfer(const QString &walletRef,
@@ -1175,35 +1164,20 @@ bool MultisigApiRouter::readSavedTransfer(const QString &walletRef,
                                           QJsonObject *out) const
 {
     if (!m_acct || !out) return false;
+    TransferCatalog *catalog = TransferCatalog::of(m_acct);
+    if (!catalog || !catalog->contains(transferRef)) return false;
 
-    QJsonDocument doc = QJsonDocument::fromJson(m_acct->loadAccountData().toUtf8());
-    const QJsonObject root  = doc.object();
-    const QJsonArray  wallets= root.value("monero").toObject().value("wallets").toArray();
-
-    for (const QJsonValue &v : wallets) {
-        const QJsonObject w = v.toObject();
-        const QString wantName  = walletNameForRefOnion(walletRef, m_boundOnion);
-        const QString wantOnion = normOnion(m_boundOnion);
-
-        for (const QJsonValue &v : wallets) {
-            const QJsonObject w = v.toObject();
-            const QString wName  = w.value("name").toString();
-            const QString wRef   = w.value("reference").toString();
-            const QString wOnion = normOnion(w.value("my_onion").toString());
+    const QString wantName  = walletNameForRefOnion(walletRef, m_boundOnion);
+    const QString wantOnion = normOnion(m_boundOnion);
 
-            const bool matchByName = (!wantName.isEmpty() && wName == wantName);
-            const bool matchByRef  = (!walletRef.isEmpty() && wRef == walletRef && wOnion == wantOnion);
+    const bool matchByName = (!wantName.isEmpty() && catalog->walletNameOf(transferRef) == wantName);
+    const bool matchByRef  = (!walletRef.isEmpty() &&
+                              catalog->walletRefOf(transferRef) == walletRef &&
+                              catalog->walletOnionOf(transferRef) == wantOnion);
+    if (!matchByName && !matchByRef) return false;
 
-            if (!matchByName && !matchByRef) continue;
-
-            const QJsonObject transfers = w.value("transfers").toObject();
-            if (transfers.contains(transferRef)) {
-                *out = transfers.value(transferRef).toObject();
-                return true;
-            }
-        }
-    }
-    return false;
+    *out = catalog->transfer(transferRef);
+    return true;
 }
 
 
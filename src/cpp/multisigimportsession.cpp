@@ -3,6 +3,7 @@
 #include "multiwalletcontroller.h"
 #include "torbackend.h"
 #include "accountmanager.h"
+#include "blobstore.h"
 #include "wallet.h"
 #include "cryptoutils_extras.h"
 
@@ -10,6 +11,8 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
 #include <QDir>
 #include <QVariantMap>
 #include <QNetworkAccessManager>
@@ -24,11 +27,18 @@
 #include <QRunnable>
 #include <QPointer>
 #include <QDebug>
+#include <algorithm>
+#include <limits>
 
 
 using namespace CryptoUtils;
 
 static constexpr int HTTP_TIMEOUT_MS = 10'000;
+static constexpr int kCoalesceMs     = 2'000;    // import triggers for one wallet merge within this
+static constexpr int kRetryMs        = 60'000;   // recheck of a wallet still waiting for peers
+static constexpr int kPeerInfoFlushMs = 5'000;   // peer info changes are written in batches
+static constexpr int kRewarmMs       = 240'000;  // refetch for funded wallets, before readiness expires
+static constexpr qint64 kReadyMaxAgeSecs = 300;  // same window TransferInitiator accepts peer infos in
 static constexpr Qt::ConnectionType kQueuedUnique =
     static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::UniqueConnection);
 
@@ -37,6 +47,7 @@ inline QByteArray b64urlNoPad(const QByteArray &raw) {
     return raw.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
 }
 inline qint64 nowSecs() { return QDateTime::currentSecsSinceEpoch(); }
+const QByteArray kPeerInfoPurpose = QByteArrayLiteral("multisig_import/peer_infos/v1");
 
 static QByteArray b64urlDecodeNoPad(QByteArray s)
 {
@@ -161,9 +172,14 @@ MultisigImportSession::MultisigImportSession(QObject *parent)
             this, &MultisigImportSession::onHttp,
             Qt::QueuedConnection);
 
-    m_checkTimer.setInterval(60'000);
-    connect(&m_checkTimer, &QTimer::timeout,
-            this, &MultisigImportSession::_checkAllWallets);
+    m_kickTimer.setSingleShot(true);
+    connect(&m_kickTimer, &QTimer::timeout,
+            this, &MultisigImportSession::_runDue);
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(kPeerInfoFlushMs);
+    connect(&m_flushTimer, &QTimer::timeout,
+            this, &MultisigImportSession::_flushPeerInfos);
 
     m_httpPool.setMaxThreadCount(20);
 
@@ -179,7 +195,14 @@ MultisigImportSession::~MultisigImportSession()
     m_importConnections.clear();
     stop();
     m_httpPool.waitForDone(HTTP_TIMEOUT_MS + 1000);
+    _flushPeerInfos();
+
+}
 
+MultisigImportSession *MultisigImportSession::of(const QObject *holder)
+{
+    if (!holder) return nullptr;
+    return qobject_cast<MultisigImportSession*>(holder->property("multisigImportSession").value<QObject*>());
 }
 
 void MultisigImportSession::initialize(MultiWalletController *wm, TorBackend *tor)
@@ -187,6 +210,25 @@ void MultisigImportSession::initialize(MultiWalletController *wm, TorBackend *to
 
     m_wm  = wm;
     m_tor = tor;
+
+    disconnect(m_importNeededConn);
+    disconnect(m_stateChangedConn);
+    disconnect(m_walletsChangedConn);
+    if (m_wm) {
+        m_importNeededConn = connect(m_wm, &MultiWalletController::multisigImportNeeded,
+                this, [this](const QString &walletName) { _wantImport(walletName, kCoalesceMs); },
+                Qt::QueuedConnection);
+        // New outputs or spends make the imported infos stale; fetch again.
+        m_stateChangedConn = connect(m_wm, &MultiWalletController::multisigStateChanged,
+                this, [this](const QString &walletName) {
+                    emit readinessChanged(walletName);
+                    if (_walletWantsRefresh(walletName)) _wantImport(walletName, kCoalesceMs);
+                },
+                Qt::QueuedConnection);
+        // Wallets opened after start() are seeded like the ones before it.
+        m_walletsChangedConn = connect(m_wm, &MultiWalletController::walletsChanged,
+                this, &MultisigImportSession::_checkAllWallets, Qt::QueuedConnection);
+    }
 }
 
 QString MultisigImportSession::_accountCacheDir() const
@@ -227,7 +269,6 @@ void MultisigImportSession::start()
     m_running = true;
     emit runningChanged();
 
-    m_checkTimer.start();
     emit sessionStarted();
     emit statusChanged(QStringLiteral("Multisig import session started"));
 
@@ -242,7 +283,13 @@ void MultisigImportSession::stop()
 
     emit runningChanged();
 
-    m_checkTimer.stop();
+    m_kickTimer.stop();
+    m_dueAt.clear();
+    m_afterImport.clear();
+    _flushPeerInfos();
+    const QStringList warm = m_warm.keys();
+    m_warm.clear();
+    for (const QString &walletName : warm) emit readinessChanged(walletName);
     if (m_inFlight == 0 && !m_stoppedSignaled) {
         m_stoppedSignaled = true;
         emit sessionStopped();
@@ -293,58 +340,148 @@ void MultisigImportSession::_loadSigningKeys()
 }
 
 
+// Seeds the queue when the session starts; after that wallets come in through
+// multisigImportNeeded, multisigStateChanged and the retries below.
 void MultisigImportSession::_checkAllWallets()
 {
+    if (!m_running || m_stopRequested || !_isReady() || !m_wm) return;
 
-    if (!m_running || m_stopRequested || !_isReady() || !m_wm) {
-
-        return;
-    }
+    for (const QString &walletName : m_wm->connectedWalletNames())
+        if (_walletWantsRefresh(walletName))
+            _wantImport(walletName, 0);
+}
 
-    const QStringList names = m_wm->connectedWalletNames();
+bool MultisigImportSession::_walletNeedsImport(const QString &walletName) const
+{
+    if (!m_wm->getWalletMeta(walletName).value("multisig", true).toBool())
+        return false;
 
+    // Read from the published snapshot. Before the first one the flag is
+    // unknown; publishing it raises multisigImportNeeded if it is set.
+    Wallet *w = qobject_cast<Wallet*>(m_wm->walletInstance(walletName));
+    return w && w->hasMultisigPartialKeyImages();
+}
 
-    for (const QString &walletName : names) {
-        const QVariantMap meta = m_wm->getWalletMeta(walletName);
-        bool isMultisig = meta.value("multisig", true).toBool();
+// A wallet with spendable funds is kept ready to spend: its peers' infos are
+// fetched and imported ahead of any transfer, and again before they age out.
+bool MultisigImportSession::_walletWantsRefresh(const QString &walletName) const
+{
+    if (_walletNeedsImport(walletName)) return true;
+    if (!m_wm->getWalletMeta(walletName).value("multisig", true).toBool()) return false;
 
+    // Keeping warm is not worth reopening a suspended wallet for.
+    Wallet *w = qobject_cast<Wallet*>(m_wm->walletInstance(walletName));
+    if (!w || w->suspended() || !w->snapshotReady() || w->unlockedBalance() == 0) return false;
 
-        if (!isMultisig) {
+    const QVariantMap r = readiness(walletName);
+    return !r.value("ready").toBool()
+           || r.value("age_secs").toLongLong() * 1000 >= kRewarmMs;
+}
 
-            continue;
-        }
+// Several triggers for one wallet within the delay collapse into one pass.
+void MultisigImportSession::_wantImport(const QString &walletName, int delayMs)
+{
+    if (!m_running || m_stopRequested) return;
 
-        QObject *w = m_wm->walletInstance(walletName);
+    if (m_pendingImports.contains(walletName)) {
+        m_afterImport.insert(walletName);
+        return;
+    }
 
-        const bool needsImport = w->property("has_multisig_partial_key_images").toBool();
+    const qint64 due = QDateTime::currentMSecsSinceEpoch() + delayMs;
+    const auto it = m_dueAt.constFind(walletName);
+    if (it != m_dueAt.cend() && it.value() <= due) return;
+    m_dueAt.insert(walletName, due);
+    _armKick();
+}
 
+void MultisigImportSession::_armKick()
+{
+    if (m_dueAt.isEmpty()) { m_kickTimer.stop(); return; }
 
+    qint64 next = std::numeric_limits<qint64>::max();
+    for (auto it = m_dueAt.cbegin(); it != m_dueAt.cend(); ++it)
+        next = std::min(next, it.value());
+    const qint64 wait = next - QDateTime::currentMSecsSinceEpoch();
+    m_kickTimer.start(int(std::clamp<qint64>(wait, 0, kRetryMs)));
+}
 
-        if (needsImport) {
+void MultisigImportSession::_runDue()
+{
+    if (!m_running || m_stopRequested || !_isReady() || !m_wm) return;
 
-            _processWalletImport(walletName);
-        } else {
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QStringList due;
+    for (auto it = m_dueAt.begin(); it != m_dueAt.end(); ) {
+        if (it.value() <= now) { due << it.key(); it = m_dueAt.erase(it); }
+        else ++it;
+    }
 
+    const QStringList connected = m_wm->connectedWalletNames();
+    for (const QString &walletName : std::as_const(due)) {
+        if (!connected.contains(walletName) || !_walletWantsRefresh(walletName))
+            continue;
+        if (m_pendingImports.contains(walletName)) {
+            m_afterImport.insert(walletName);
+            continue;
         }
+        _processWalletImport(walletName);
+        // Peers may not have answered yet; look again while the flag stays
+        // set, and before a funded wallet's readiness runs out.
+        _wantImport(walletName, _walletNeedsImport(walletName) ? kRetryMs : kRewarmMs);
     }
-
+    _armKick();
 }
 
-bool MultisigImportSession::_walletNeedsImport(const QString &walletName) const
+// Ready once every cosigner's current info is imported. The data is as old
+// as the oldest of those infos, and only holds while the wallet's multisig
+// state is still the one that import produced.
+void MultisigImportSession::_updateReadiness(const QString &walletName)
 {
+    Wallet *w = qobject_cast<Wallet*>(m_wm ? m_wm->walletInstance(walletName) : nullptr);
+    if (!w || !w->lastImportFingerprint()) return;
 
-    QObject *w = m_wm->walletInstance(walletName);
-    if (!w) {
-
-        return true;
+    const QString me = _resolveOwnOnionForWallet(walletName);
+    const QJsonObject &all = _peerInfos(walletName);
+    const qint64 t = nowSecs();
+    qint64 oldest = t;
+    int cosigners = 0;
+    for (const QString &p : m_wm->peersForWallet(walletName)) {
+        const QString q = fqdn(p);
+        if (!me.isEmpty() && QString::compare(q, me, Qt::CaseInsensitive) == 0) continue;
+        const QJsonObject e = all.value(q).toObject();
+        const qint64 ts = static_cast<qint64>(e.value("timestamp").toDouble(0));
+        if (!_cachedInfoImported(e) || t - ts > kReadyMaxAgeSecs) return;
+        oldest = std::min(oldest, ts);
+        ++cosigners;
     }
+    if (cosigners == 0) return;
 
+    m_warm.insert(walletName, Warm{ oldest, w->lastImportFingerprint() });
+    emit readinessChanged(walletName);
+}
 
-    QMetaObject::invokeMethod(w, "refreshHasMultisigPartialKeyImages", Qt::QueuedConnection);
-
-    const bool need = w->property("has_multisig_partial_key_images").toBool();
+QVariantMap MultisigImportSession::readiness(const QString &walletName) const
+{
+    const auto it = m_warm.constFind(walletName);
+    if (it == m_warm.cend())
+        return { { "ready", false }, { "age_secs", -1 }, { "current", false } };
+
+    Wallet *w = qobject_cast<Wallet*>(m_wm ? m_wm->walletInstance(walletName) : nullptr);
+    const qint64 age = nowSecs() - it->atSecs;
+    const bool current = w && !w->hasMultisigPartialKeyImages()
+                         && w->lastImportFingerprint() == it->fingerprint
+                         && w->multisigFingerprint() == it->fingerprint;
+    return {
+        { "ready",    current && age <= kReadyMaxAgeSecs },
+        { "age_secs", age },
+        { "current",  current }
+    };
+}
 
-    return need;
+bool MultisigImportSession::readyToSpend(const QString &walletName) const
+{
+    return readiness(walletName).value("ready").toBool();
 }
 
 void MultisigImportSession::_processWalletImport(const QString &walletName)
@@ -380,7 +517,7 @@ void MultisigImportSession::_processWalletImport(const QString &walletName)
         return;
     }
 
-    const QJsonObject cached = _loadCachedInfos(walletName);
+    const QJsonObject cached = _peerInfos(walletName);
 
     const QStringList toQuery = _filterStalePeers(peersToCheck, cached);
 
@@ -396,54 +533,163 @@ void MultisigImportSession::_processWalletImport(const QString &walletName)
     _attemptImport(walletName, cached);
 }
 
-QJsonObject MultisigImportSession::_loadCachedInfos(const QString &walletName) const
+// Peer infos live in memory per wallet. They are read from disk once per
+// account and written back sealed, in batches, only when something changed.
+QString MultisigImportSession::_peerInfoFile(const QString &walletName) const
 {
-    const QString file = QDir(_accountCacheDir()).filePath(QStringLiteral("%1/peer_infos.json").arg(walletName));
-
-
-    QFile f(file);
-    if (!f.exists()) {
+    return QDir(_accountCacheDir()).filePath(walletName + QStringLiteral("/peer_infos.bin"));
+}
 
-        return {};
+QJsonObject &MultisigImportSession::_peerInfos(const QString &walletName)
+{
+    const QString dir = _accountCacheDir();
+    if (dir != m_peerInfosDir) {
+        m_peerInfos.clear();
+        m_peerInfosDirty.clear();
+        m_peerInfosDir = dir;
     }
-    if (!f.open(QIODevice::ReadOnly)) {
 
-        return {};
+    auto it = m_peerInfos.find(walletName);
+    if (it != m_peerInfos.end()) return it.value();
+
+    AccountManager *am = m_wm ? m_wm->accountManager() : nullptr;
+    QJsonObject all;
+    QByteArray plain;
+    QFile sealed(_peerInfoFile(walletName));
+    if (am && sealed.open(QIODevice::ReadOnly)
+        && am->openForAccount(sealed.readAll(), kPeerInfoPurpose, plain)) {
+        all = QJsonDocument::fromJson(plain).object();
+        _settlePeerBlobs(walletName, all);
+    } else {
+        // Plaintext cache from older versions; rewritten sealed on the next flush.
+        QFile legacy(QDir(dir).filePath(walletName + QStringLiteral("/peer_infos.json")));
+        if (legacy.open(QIODevice::ReadOnly)) {
+            all = QJsonDocument::fromJson(legacy.readAll()).object();
+            for (auto e = all.begin(); e != all.end(); ++e) {
+                QJsonObject o = e.value().toObject();
+                const QByteArray raw = _cachedInfoRaw(o);
+                if (!raw.isEmpty()) o["info_hash"] = BlobStore::hashOf(raw);
+                if (o.take("imported").toBool(false))
+                    o["imported_hash"] = o.value("info_hash");
+                e.value() = o;
+            }
+            _markPeerInfosDirty(walletName);
+        }
     }
-    const QJsonDocument doc = QJsonDocument::fromJson(f.readAll());
 
-    return doc.object();
+    return m_peerInfos.insert(walletName, all).value();
 }
 
-void MultisigImportSession::_saveCachedInfo(const QString &walletName,
-                                            const QString &peerOnion,
-                                            const QByteArray &infoRaw)
+void MultisigImportSession::_markPeerInfosDirty(const QString &walletName)
 {
+    m_peerInfosDirty.insert(walletName);
+    if (!m_flushTimer.isActive()) m_flushTimer.start();
+}
 
-    const QString dir = QDir(_accountCacheDir()).filePath(walletName);
-    QDir().mkpath(dir);
-    const QString file = QDir(dir).filePath("peer_infos.json");
+void MultisigImportSession::_flushPeerInfos()
+{
+    m_flushTimer.stop();
+    if (m_peerInfosDirty.isEmpty()) return;
 
+    // Sealed with the current account's key, so never write another account's cache.
+    if (_accountCacheDir() != m_peerInfosDir) {
+        m_peerInfosDirty.clear();
+        return;
+    }
+    AccountManager *am = m_wm ? m_wm->accountManager() : nullptr;
+    if (!am) return;
+
+    for (auto it = m_peerInfosDirty.begin(); it != m_peerInfosDirty.end(); ) {
+        const QString walletName = *it;
+        const QByteArray sealed = am->sealForAccount(
+            QJsonDocument(m_peerInfos.value(walletName)).toJson(QJsonDocument::Compact), kPeerInfoPurpose);
+        const QString file = _peerInfoFile(walletName);
+
+        QSaveFile out(file);
+        const bool ok = !sealed.isEmpty()
+                        && QDir().mkpath(QFileInfo(file).absolutePath())
+                        && out.open(QIODevice::WriteOnly)
+                        && out.write(sealed) == sealed.size()
+                        && out.commit();
+        if (!ok) {
+            qDebug() << "[_flushPeerInfos] write failed for" << walletName;
+            ++it;
+            continue;
+        }
+        QFile::remove(QDir(m_peerInfosDir).filePath(walletName + QStringLiteral("/peer_infos.json")));
+        _settlePeerBlobs(walletName, m_peerInfos.value(walletName));
+        it = m_peerInfosDirty.erase(it);
+    }
+}
 
-    QJsonObject all = _loadCachedInfos(walletName);
+// Infos replaced since the last write keep their old blob until the cache
+// naming the new one is on disk.
+void MultisigImportSession::_settlePeerBlobs(const QString &walletName, const QJsonObject &saved)
+{
+    BlobStore *bs = m_wm ? BlobStore::of(m_wm->accountManager()) : nullptr;
+    if (!bs) return;
+    for (auto e = saved.begin(); e != saved.end(); ++e)
+        bs->settle(QStringLiteral("peerinfo/%1/%2").arg(walletName, e.key()),
+                   e.value().toObject().value("info_hash").toString());
+}
 
-    const QString b64 = QString::fromLatin1(
-        infoRaw.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
+void MultisigImportSession::_saveCachedInfo(const QString &walletName,
+                                            const QString &peerOnion,
+                                            const QByteArray &infoRaw)
+{
+    QJsonObject &all = _peerInfos(walletName);
+    QJsonObject entry = all.value(peerOnion).toObject();
+    const QString hash = BlobStore::hashOf(infoRaw);
+
+    // the info itself goes to the sealed blob store; the cache keeps its hash
+    BlobStore *bs = m_wm ? BlobStore::of(m_wm->accountManager()) : nullptr;
+    const bool same = entry.value("info_hash").toString() == hash
+                      && (entry.contains("info_b64") || (bs && bs->contains(hash)));
+
+    entry.insert("timestamp", qint64(nowSecs()));
+    if (same) {
+        // Same info again: only its freshness changes, which is not worth a write.
+        all.insert(peerOnion, entry);
+        return;
+    }
 
-    QJsonObject entry{
-        { "info_b64",      b64 },
+    entry = QJsonObject{
         { "timestamp", qint64(nowSecs()) },
-        { "imported",  false }
+        { "info_hash", hash }
     };
+    const QString stored = bs ? bs->put(infoRaw, QStringLiteral("peerinfo/%1/%2").arg(walletName, peerOnion))
+                              : QString();
+    if (stored.isEmpty())
+        entry.insert("info_b64", QString::fromLatin1(b64urlNoPad(infoRaw)));
     all.insert(peerOnion, entry);
+    _markPeerInfosDirty(walletName);
+}
 
-    QFile f(file);
-    if (f.open(QIODevice::WriteOnly)) {
-        f.write(QJsonDocument(all).toJson(QJsonDocument::Indented));
-        qDebug() << "[_saveCachedInfo] Successfully saved cache with" << all.size() << "total entries";
-    } else {
-        qDebug() << "[_saveCachedInfo] Failed to open cache file for writing:" << file;
+QByteArray MultisigImportSession::_cachedInfoRaw(const QJsonObject &entry) const
+{
+    const QByteArray b64 = entry.value("info_b64").toString().toLatin1();
+    if (!b64.isEmpty()) {
+        if (!isBase64UrlString(b64)) return {};
+        return QByteArray::fromBase64(b64, QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
     }
+
+    const QString hash = entry.value("info_hash").toString();
+    if (hash.isEmpty()) return {};
+    BlobStore *bs = m_wm ? BlobStore::of(m_wm->accountManager()) : nullptr;
+    return bs ? bs->get(hash) : QByteArray();
+}
+
+// Imported state is kept per info hash: a newer info from the same peer is
+// pending again until it has been imported itself.
+bool MultisigImportSession::_cachedInfoImported(const QJsonObject &entry)
+{
+    const QString hash = entry.value("info_hash").toString();
+    return !hash.isEmpty() && entry.value("imported_hash").toString() == hash;
+}
+
+bool MultisigImportSession::_cachedInfoMatches(const QJsonObject &entry, const QByteArray &infoRaw)
+{
+    return entry.value("info_hash").toString() == BlobStore::hashOf(infoRaw);
 }
 
 QStringList MultisigImportSession::_filterStalePeers(const QStringList &peers,
@@ -455,7 +701,7 @@ QStringList MultisigImportSession::_filterStalePeers(const QStringList &peers,
     for (const QString &p : peers) {
         const QJsonObject e = cached.value(p).toObject();
         const qint64 ts     = static_cast<qint64>(e.value("timestamp").toDouble(0));
-        const bool imported = e.value("imported").toBool(false);
+        const bool imported = _cachedInfoImported(e);
         const bool fresh    = (ts > 0) && ((t - ts) <= m_cacheExpirySecs);
 
         if (!(fresh && imported)) {
@@ -483,27 +729,15 @@ void MultisigImportSession::_attemptImport(const QString &walletName, const QJso
         const QString peer = it.key();
         const QJsonObject e = it.value().toObject();
         const qint64 ts = static_cast<qint64>(e.value("timestamp").toDouble(0));
-        const bool imported = e.value("imported").toBool(false);
+        const bool imported = _cachedInfoImported(e);
         const bool withinExpiry = (t - ts) <= m_cacheExpirySecs;
 
 
         if (withinExpiry && !imported) {
 
-            const QString b64 = e.value("info_b64").toString();
-            if (b64.isEmpty()) continue;
-
-            const QByteArray b64ba = b64.toLatin1();
-            if (!isBase64UrlString(b64ba)) {
-                qDebug() << "[_attemptImport] invalid base64url alphabet for peer" << peer;
-                continue;
-            }
-
-            const QByteArray raw = QByteArray::fromBase64(
-                b64.toLatin1(),
-                QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
-
+            const QByteArray raw = _cachedInfoRaw(e);
             if (raw.isEmpty()) {
-                qDebug() << "[_attemptImport] bad base64 for peer" << peer;
+                qDebug() << "[_attemptImport] cached info unavailable for peer" << peer;
                 continue;
             }
 
@@ -521,7 +755,9 @@ void MultisigImportSession::_attemptImport(const QString &walletName, const QJso
 
 
     if (payloads.isEmpty()) {
-
+        // Everything cached is already imported; the infos may just have been
+        // confirmed by the peers again.
+        _updateReadiness(walletName);
         return;
     }
 
@@ -557,6 +793,10 @@ void MultisigImportSession::_attemptImport(const QString &walletName, const QJso
                     disconnect(connIt.value());
                     m_importConnections.erase(connIt);
                 }
+
+                _updateReadiness(walletName);
+                if (m_afterImport.remove(walletName))
+                    _wantImport(walletName, kCoalesceMs);
             }
         },
         Qt::QueuedConnection);
@@ -583,6 +823,10 @@ void MultisigImportSession::_onImportMultisigResult(const QString &walletName, i
 
     _recordImportCompleted(walletName, entries, actualImported);
     emit walletImportCompleted(walletName);
+    _updateReadiness(walletName);
+
+    if (m_afterImport.remove(walletName))
+        _wantImport(walletName, kCoalesceMs);
 
 }
 
@@ -809,7 +1053,7 @@ void MultisigImportSession::onHttp(QString onion, QString path, QJsonObject res,
         _recordPeerInfoReceived(walletName, onion);
         emit peerInfoReceived(walletName, onion);
 
-        _attemptImport(walletName, _loadCachedInfos(walletName));
+        _attemptImport(walletName, _peerInfos(walletName));
     }
 }
 
@@ -873,40 +1117,19 @@ void MultisigImportSession::_recordImportCompleted(const QString &walletName,
     m_importActivity.insert(walletName, st);
 
     if (actualImported > 0) {
-        QJsonObject all = _loadCachedInfos(walletName);
+        QJsonObject &all = _peerInfos(walletName);
         bool changed = false;
 
         for (const auto &en : entries) {
             QJsonObject e = all.value(en.peer).toObject();
-            if (e.isEmpty()) continue;
-
-            const QString cachedB64 = e.value("info_b64").toString();
-            const QString justB64 = QString::fromLatin1(
-                en.infoRaw.toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals));
-
-            const bool match = (cachedB64 == justB64);
-            const bool already = e.value("imported").toBool(false);
-
-            if (match && !already) {
-                e["imported"] = true;
-                all.insert(en.peer, e);
-                changed = true;
-            } else if (!match && already) {
-
-                e["imported"] = false;
-                all.insert(en.peer, e);
-                changed = true;
-            }
+            if (e.isEmpty() || !_cachedInfoMatches(e, en.infoRaw) || _cachedInfoImported(e))
+                continue;
+            e["imported_hash"] = e.value("info_hash");
+            all.insert(en.peer, e);
+            changed = true;
         }
 
-        if (changed) {
-            const QString dir  = QDir(_accountCacheDir()).filePath(walletName);
-            QDir().mkpath(dir);
-            const QString file = QDir(dir).filePath("peer_infos.json");
-            QFile f(file);
-            if (f.open(QIODevice::WriteOnly))
-                f.write(QJsonDocument(all).toJson(QJsonDocument::Indented));
-        }
+        if (changed) _markPeerInfosDirty(walletName);
     }
 }
 
@@ -981,6 +981,16 @@ void MultisigSession::endOp(const char *op, int round) {
 
 quint64 MultisigSession::get_chain_height_robust()
 {
+    // The shared daemon monitor usually has a fresh height; only fall back
+    // to a blocking /get_height when it has none yet.
+    if (m_wm) {
+        const quint64 cached = m_wm->cachedChainHeight();
+        if (cached > 0) {
+            qDebug() << "[MultisigSession] Using cached chain height:" << cached;
+            return cached;
+        }
+    }
+
     // Get AccountManager to access daemon settings
     AccountManager *acct = nullptr;
     if (auto obj = m_wm->property("accountManager").value<QObject*>())
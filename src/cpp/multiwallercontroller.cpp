@@ -2,10 +2,16 @@
 #include "multiwalletcontroller.h"
 #include "torbackend.h"
 #include "wallet.h"
+#include "walletexecutor.h"
+#include "daemonmonitor.h"
+#include "daemonproxy.h"
+#include "walletresidency.h"
+#include "walletlifecycle.h"
 #include "accountmanager.h"
 #include "restore_height.h"
 
 #include <QDateTime>
+#include <utility>
 #include <QRandomGenerator>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -36,12 +42,20 @@ static inline QDir msigDir(const AccountManager *am) {
     return QDir(am ? am->multisigInfoDir() : QString());
 }
 
+namespace {
+constexpr int kHeightWatchLingerMs = 5 * 60'000;   // cachedChainHeight() keeps polling this long
+}
+
 MultiWalletController::MultiWalletController(AccountManager *am, TorBackend *tor, QObject *parent) :
     QObject(parent),
     m_am(am),
     m_tor(tor)
 {
     Q_ASSERT(am);
+    m_heightWatch.setSingleShot(true);
+    m_heightWatch.setInterval(kHeightWatchLingerMs);
+    connect(&m_heightWatch, &QTimer::timeout, this, &MultiWalletController::releaseHeightWatch);
+
     connect(m_am, &AccountManager::isAuthenticatedChanged,
             this, &MultiWalletController::onAccountStatusChanged,
             Qt::QueuedConnection);
@@ -105,6 +119,24 @@ NetworkPlan plan_for(AccountManager *am, TorBackend *tor) {
     return p;
 }
 
+// Wallets sync through the shared local proxy (one block fetch for all of
+// them); it does the SOCKS hop itself. Without it they dial the daemon.
+static void route_wallet(const QObject *holder, Wallet *w, const NetworkPlan &net) {
+    if (DaemonProxy *proxy = DaemonProxy::of(holder)) {
+        const QString local = proxy->localAddress(net.daemonAddr,
+                                                  net.useProxy ? net.proxyHost : QString(),
+                                                  net.useProxy ? net.proxyPort : 0);
+        if (!local.isEmpty()) {
+            w->setDaemonAddress(local);
+            w->clearProxy();
+            return;
+        }
+    }
+    w->setDaemonAddress(net.daemonAddr);
+    if (net.useProxy)  w->setSocksProxy(net.proxyHost, net.proxyPort);
+    else               w->clearProxy();
+}
+
 void MultiWalletController::loadWalletsFromAccount()
 {
     m_walletNames.clear();
@@ -256,6 +288,18 @@ QPair<QByteArray, qint64> MultiWalletController::giveMultisigInfo(const QString
     return { it->info, it->ts };
 }
 
+bool MultiWalletController::renewMultisigInfo(const QString &walletName)
+{
+    auto it = m_msigCache.find(walletName);
+    if (it == m_msigCache.end() || it->info.isEmpty()) return false;
+
+    const Wallet *w = walletPtr(walletName);
+    if (!w || !w->multisigInfoCurrent()) return false;
+
+    it->ts = QDateTime::currentSecsSinceEpoch();
+    return true;
+}
+
 void MultiWalletController::requestGenMultisig(const QString &walletName)
 {
     if (Wallet *w = walletPtr(walletName)) {
@@ -474,21 +518,23 @@ bool MultiWalletController::updateWalletPassword(const QString &walletName, cons
     const QString old = m_meta.value(walletName).password;
 
     connect(w, &Wallet::passwordChanged, this,
-            [this, walletName, newPassword](bool ok) {
-                if (ok && m_am && m_am->isAuthenticated()) {
-                    QJsonDocument doc = QJsonDocument::fromJson(m_am->loadAccountData().toUtf8());
-                    QJsonObject root  = doc.object();
-                    QJsonArray  arr   = root.value("monero").toObject().value("wallets").toArray();
-                    for (int i = 0; i < arr.size(); ++i) {
-                        QJsonObject o = arr.at(i).toObject();
-                        if (o.value("name").toString() == walletName) { o["password"] = newPassword; arr[i] = o; break; }
+            [this, walletName, newPassword, w](bool ok) {
+                whenCurrent(walletName, w, [=]() {
+                    if (ok && m_am && m_am->isAuthenticated()) {
+                        QJsonDocument doc = QJsonDocument::fromJson(m_am->loadAccountData().toUtf8());
+                        QJsonObject root  = doc.object();
+                        QJsonArray  arr   = root.value("monero").toObject().value("wallets").toArray();
+                        for (int i = 0; i < arr.size(); ++i) {
+                            QJsonObject o = arr.at(i).toObject();
+                            if (o.value("name").toString() == walletName) { o["password"] = newPassword; arr[i] = o; break; }
+                        }
+                        QJsonObject monero = root.value("monero").toObject();
+                        monero["wallets"] = arr; root["monero"] = monero;
+                        (void) m_am->saveAccountData(QJsonDocument(root).toJson(QJsonDocument::Compact));
+                        auto it = m_meta.find(walletName); if (it != m_meta.end()) it->password = newPassword;
                     }
-                    QJsonObject monero = root.value("monero").toObject();
-                    monero["wallets"] = arr; root["monero"] = monero;
-                    (void) m_am->saveAccountData(QJsonDocument(root).toJson(QJsonDocument::Compact));
-                    auto it = m_meta.find(walletName); if (it != m_meta.end()) it->password = newPassword;
-                }
-                emit passwordReady(ok, walletName, ok ? newPassword : QString());
+                    emit passwordReady(ok, walletName, ok ? newPassword : QString());
+                });
             },
             Qt::QueuedConnection);
 
@@ -655,100 +701,149 @@ void MultiWalletController::addWalletToAccount(const QString &walletName,
 }
 
 
-void MultiWalletController::connectWallet(const QString &walletName)
+// Forwards a wallet's signals under its name. Parked wallets are unwired so
+// they cannot speak for a same-named wallet of the current account.
+void MultiWalletController::wireWallet(const QString &walletName, Wallet *w)
 {
-    if (m_wallets.contains(walletName)) {
-        qDebug().noquote() << "m_wallets.contains(walletName)";
-        return;
-    }
+    unwireWallet(w);
+    auto *ctx = new QObject(this);
+    m_wiring.insert(w, ctx);
 
-    const auto meta = m_meta.value(walletName);
-    qDebug().noquote() << meta.wallet_name;
+    connect(w, &Wallet::busyChanged, ctx, [this, walletName]() {
+        emit busyChanged(walletName, walletBusy(walletName));
+    }, Qt::QueuedConnection);
 
-    if (!meta.wallet_name.isNull()) {
-        auto *w = new Wallet;
-        QString accountName = m_am->currentAccount();
-        QDir().mkpath(m_am->walletAccountDir());
-        const QString walletPath = m_am->walletPath(walletName);
+    connect(w, &Wallet::errorOccurred, ctx, [this, walletName](const QString &msg) {
+        emit rpcError(walletName, msg);
+    }, Qt::QueuedConnection);
 
-        const auto net = plan_for(m_am, m_tor);
-        qDebug() << "Setting daemon address to:" << net.daemonAddr
-                 << "via_tor=" << net.useProxy
-                 << (net.useProxy ? QString("socks %1:%2").arg(net.proxyHost).arg(net.proxyPort) : QString());
-        w->setDaemonAddress(net.daemonAddr);
-        if (net.useProxy)  w->setSocksProxy(net.proxyHost, net.proxyPort);
-        else               w->clearProxy();
+    connect(w, &Wallet::queueChanged, ctx, [this, walletName] {
+        emit pendingOpsChanged(walletName);
+    }, Qt::QueuedConnection);
 
-        connect(w, &Wallet::busyChanged, this, [this, walletName]() {
-            emit busyChanged(walletName, walletBusy(walletName));
-        }, Qt::QueuedConnection);
+    connect(w, &Wallet::syncProgress, ctx, [this, walletName](quint64 /*current*/, quint64 /*target*/) {
+        m_lastRefreshTs[walletName] = QDateTime::currentSecsSinceEpoch();
+    }, Qt::QueuedConnection);
 
-        connect(w, &Wallet::errorOccurred, this, [this, walletName](const QString &msg) {
-            emit rpcError(walletName, msg);
-        }, Qt::QueuedConnection);
+    connect(w, &Wallet::multisigInfoPrepared, ctx, [this, walletName](const QByteArray &info) {
+        m_msigCache[walletName] = MultisigInfoCache{ info, QDateTime::currentSecsSinceEpoch() };
+        emit multisigInfoUpdated(walletName);
+    }, Qt::QueuedConnection);
 
-        connect(w, &Wallet::queueChanged, this, [this, walletName] {
-            emit pendingOpsChanged(walletName);
-        }, Qt::QueuedConnection);
+    connect(w, &Wallet::multisigImportNeeded, ctx, [this, walletName]() {
+        emit multisigImportNeeded(walletName);
+    }, Qt::QueuedConnection);
 
-        connect(w, &Wallet::syncProgress, this, [this, walletName](quint64 /*current*/, quint64 /*target*/) {
-            m_lastRefreshTs[walletName] = QDateTime::currentSecsSinceEpoch();
-        }, Qt::QueuedConnection);
+    connect(w, &Wallet::multisigStateChanged, ctx, [this, walletName]() {
+        emit multisigStateChanged(walletName);
+    }, Qt::QueuedConnection);
 
-        connect(w, &Wallet::multisigInfoPrepared, this, [this, walletName](const QByteArray &info) {
-            m_msigCache[walletName] = MultisigInfoCache{ info, QDateTime::currentSecsSinceEpoch() };
-            emit multisigInfoUpdated(walletName);
-        }, Qt::QueuedConnection);
+    connect(w, &Wallet::balanceReady, ctx, [this, walletName](quint64 bal, quint64 unlk, bool){
+        emit walletBalanceChanged(walletName, bal, unlk);
+    }, Qt::QueuedConnection);
 
-        connect(w, &Wallet::balanceReady, this, [this, walletName](quint64 bal, quint64 unlk, bool){
-            emit walletBalanceChanged(walletName, bal, unlk);
-        }, Qt::QueuedConnection);
 
-        connect(w, &Wallet::walletOpened, this, [this, walletName, w]() {
 
+    connect(w, &Wallet::accountsReady, ctx,
+            [this, walletName](const QVariantList &a){ emit accountsReady(walletName, a); },
+            Qt::QueuedConnection);
+
+
+    connect(w, &Wallet::subaddressesReady, ctx,
+            [this, walletName](int acc, const QVariantList &items){ emit subaddressesReady(walletName, acc, items); },
+            Qt::QueuedConnection);
+    connect(w, &Wallet::subaddressCreated, ctx,
+            [this, walletName](int acc, int idx, const QString &addr){ emit subaddressCreated(walletName, acc, idx, addr); },
+            Qt::QueuedConnection);
+    connect(w, &Wallet::subaddressLabeled, ctx,
+            [this, walletName](int acc, int idx, const QString &label){ emit subaddressLabeled(walletName, acc, idx, label); },
+            Qt::QueuedConnection);
+
+
+    connect(w, &Wallet::subaddressLookaheadSet, ctx,
+            [this, walletName](int maj, int min){ emit subaddressLookaheadSet(walletName, maj, min); },
+            Qt::QueuedConnection);
+}
+
+void MultiWalletController::unwireWallet(Wallet *w)
+{
+    delete m_wiring.take(w);
+}
+
+void MultiWalletController::whenCurrent(const QString &walletName, Wallet *w, std::function<void()> fn)
+{
+    for (const ParkedAccount &p : std::as_const(m_parked)) {
+        if (p.wallets.value(walletName) == w) {
+            m_deferred[w].append(std::move(fn));
+            return;
+        }
+    }
+    fn();
+}
+
+// Sync starts once the wallet file is open; a wallet still opening when its
+// account is parked gets this run by resumeAccount().
+void MultiWalletController::hookOpen(const QString &walletName, Wallet *w)
+{
+    connect(w, &Wallet::walletOpened, this, [this, walletName, w]() {
+        whenCurrent(walletName, w, [this, walletName, w]() {
             const auto meta = m_meta.value(walletName);
             const uint64_t h = meta.restore_height > 10 ? meta.restore_height - 10 : 0;
             w->setRefreshHeight(h);
             emit walletsChanged();
-            w->startSync(120);
+            startWalletSync(w);
             w->getBalance();
-        }, Qt::QueuedConnection);
+        });
+    }, Qt::QueuedConnection);
+}
 
+// Every wallet enters m_wallets through here, so each one forwards the same
+// signals whichever path opened, created or restored it.
+void MultiWalletController::adoptWallet(const QString &walletName, Wallet *w)
+{
+    wireWallet(walletName, w);
+    m_wallets.insert(walletName, w);
+    emit walletsChanged();
+    bumpEpoch();
+}
 
+// False when no open was started: unknown wallet, or one from another
+// network. An already connected wallet counts as started.
+bool MultiWalletController::connectWallet(const QString &walletName)
+{
+    if (m_wallets.contains(walletName)) {
+        qDebug().noquote() << "m_wallets.contains(walletName)";
+        return true;
+    }
 
-        connect(w, &Wallet::accountsReady, this,
-                [this, walletName](const QVariantList &a){ emit accountsReady(walletName, a); },
-                Qt::QueuedConnection);
+    const auto meta = m_meta.value(walletName);
+    qDebug().noquote() << meta.wallet_name;
 
+    if (meta.wallet_name.isNull()) return false;
 
-        connect(w, &Wallet::subaddressesReady, this,
-                [this, walletName](int acc, const QVariantList &items){ emit subaddressesReady(walletName, acc, items); },
-                Qt::QueuedConnection);
-        connect(w, &Wallet::subaddressCreated, this,
-                [this, walletName](int acc, int idx, const QString &addr){ emit subaddressCreated(walletName, acc, idx, addr); },
-                Qt::QueuedConnection);
-        connect(w, &Wallet::subaddressLabeled, this,
-                [this, walletName](int acc, int idx, const QString &label){ emit subaddressLabeled(walletName, acc, idx, label); },
-                Qt::QueuedConnection);
-
+    const QString nettype = m_am->networkType();
+    if (meta.net_type != nettype) {
+        emit rpcError(walletName , QStringLiteral("Network mismatch: current account network is '%1'.").arg(nettype));
+        return false;
+    }
 
-        connect(w, &Wallet::subaddressLookaheadSet, this,
-                [this, walletName](int maj, int min){ emit subaddressLookaheadSet(walletName, maj, min); },
-                Qt::QueuedConnection);
+    auto *w = new Wallet;
+    w->setExecutor(WalletExecutor::of(this));
+    QDir().mkpath(m_am->walletAccountDir());
+    const QString walletPath = m_am->walletPath(walletName);
 
-        m_wallets.insert(walletName, w);
-        emit walletsChanged();
-        bumpEpoch();
+    const auto net = plan_for(m_am, m_tor);
+    qDebug() << "Setting daemon address to:" << net.daemonAddr
+             << "via_tor=" << net.useProxy
+             << (net.useProxy ? QString("socks %1:%2").arg(net.proxyHost).arg(net.proxyPort) : QString());
+    route_wallet(this, w, net);
 
-        const QString nettype = m_am->networkType();
+    hookOpen(walletName, w);
 
-        if (meta.net_type != nettype ) {
-            emit rpcError(walletName , QStringLiteral("Network mismatch: current account network is '%1'.").arg(nettype));
-            return;
-        }
+    adoptWallet(walletName, w);
 
-        w->open(walletPath, meta.password, nettype);
-    }
+    w->open(walletPath, meta.password, nettype);
+    return true;
 }
 
 QStringList MultiWalletController::connectedWalletNames() const
@@ -810,6 +905,7 @@ void MultiWalletController::createWallet(const QString &walletName,const QString
 
     if (meta.wallet_name.isNull()){
         auto *w = new Wallet;
+        w->setExecutor(WalletExecutor::of(this));
         QString accountName = m_am->currentAccount();
         const QString walletPath = m_am->walletPath(walletName);
 
@@ -817,25 +913,9 @@ void MultiWalletController::createWallet(const QString &walletName,const QString
         qDebug() << "Setting daemon address to:" << net.daemonAddr
                  << "via_tor=" << net.useProxy
                  << (net.useProxy ? QString("socks %1:%2").arg(net.proxyHost).arg(net.proxyPort) : QString());
-        w->setDaemonAddress(net.daemonAddr);
-        if (net.useProxy)  w->setSocksProxy(net.proxyHost, net.proxyPort);
-        else               w->clearProxy();
+        route_wallet(this, w, net);
 
-        connect(w, &Wallet::busyChanged, this, [this, walletName]() {
-            emit busyChanged(walletName, walletBusy(walletName));
-        }, Qt::QueuedConnection);
-
-        connect(w, &Wallet::errorOccurred, this, [this, walletName](const QString &msg) {
-            emit rpcError(walletName, msg);
-        }, Qt::QueuedConnection);
-
-        connect(w, &Wallet::queueChanged, this, [this, walletName] {
-            emit pendingOpsChanged(walletName);
-        }, Qt::QueuedConnection);
-
-        m_wallets.insert(walletName, w);
-        emit walletsChanged();
-        bumpEpoch();
+        adoptWallet(walletName, w);
 
         qDebug() << "creating new wallet";
 
@@ -850,6 +930,9 @@ void MultiWalletController::disconnectWallet(const QString &walletName)
         return;
 
     Wallet *w = it.value();
+    unwireWallet(w);
+    m_deferred.remove(w);
+    if (auto *lc = WalletLifecycle::of(this)) lc->trackClose(walletName, w);
     w->stopSync();
     w->close();
     connect(w, &Wallet::walletFullyClosed, this, [this, w]() {
@@ -858,6 +941,7 @@ void MultiWalletController::disconnectWallet(const QString &walletName)
     m_wallets.erase(it);
     m_msigCache.remove(walletName);
     m_lastRefreshTs.remove(walletName);
+    releaseHeightWatch();
 
     emit walletsChanged();
     bumpEpoch();
@@ -876,6 +960,35 @@ void MultiWalletController::stopAllWallets()
         disconnectWallet(name);
 }
 
+void MultiWalletController::connectWallets(const QStringList &walletNames)
+{
+    if (auto *lc = WalletLifecycle::of(this)) {
+        lc->open(walletNames);
+        return;
+    }
+    for (const QString &name : walletNames)
+        connectWallet(name);
+}
+
+void MultiWalletController::setVisibleWallets(const QStringList &walletNames)
+{
+    if (auto *lc = WalletLifecycle::of(this)) lc->setVisible(walletNames);
+}
+
+void MultiWalletController::suspendAllWallets()
+{
+    for (Wallet *w : liveWallets())
+        w->suspend();
+}
+
+void MultiWalletController::closeAllWallets()
+{
+    stopAllWallets();
+    const QStringList parked = m_parked.keys();
+    for (const QString &acct : parked)
+        dropParkedAccount(acct);
+}
+
 
 void MultiWalletController::onAccountStatusChanged()
 {
@@ -884,6 +997,9 @@ void MultiWalletController::onAccountStatusChanged()
 
         loadWalletsFromAccount();
     } else {
+        const QStringList parked = m_parked.keys();
+        for (const QString &acct : parked)
+            dropParkedAccount(acct);
 
         m_walletNames.clear();
         m_walletRefs.clear();
@@ -896,6 +1012,84 @@ void MultiWalletController::onAccountStatusChanged()
     }
 }
 
+void MultiWalletController::parkAccount(const QString &account)
+{
+    if (account.isEmpty()) return;
+
+    ParkedAccount p;
+    p.walletNames   = std::exchange(m_walletNames, {});
+    p.walletRefs    = std::exchange(m_walletRefs, {});
+    p.meta          = std::exchange(m_meta, {});
+    p.metaRef       = std::exchange(m_meta_ref, {});
+    p.wallets       = std::exchange(m_wallets, {});
+    p.msigCache     = std::exchange(m_msigCache, {});
+    p.lastRefreshTs = std::exchange(m_lastRefreshTs, {});
+
+    for (Wallet *w : std::as_const(p.wallets))
+        unwireWallet(w);
+
+    qDebug().noquote() << "[MultiWalletController] parked" << p.wallets.size()
+                       << "open wallets of" << account;
+    m_parked.insert(account, std::move(p));
+    releaseHeightWatch();
+
+    emit walletsChanged();
+    bumpEpoch();
+}
+
+void MultiWalletController::resumeAccount(const QString &account)
+{
+    auto it = m_parked.find(account);
+    if (it == m_parked.end()) {
+        loadWalletsFromAccount();
+        bumpEpoch();
+        return;
+    }
+
+    ParkedAccount p = std::move(it.value());
+    m_parked.erase(it);
+
+    stopAllWallets();
+    m_walletNames   = p.walletNames;
+    m_walletRefs    = p.walletRefs;
+    m_meta          = p.meta;
+    m_meta_ref      = p.metaRef;
+    m_wallets       = p.wallets;
+    m_msigCache     = p.msigCache;
+    m_lastRefreshTs = p.lastRefreshTs;
+
+    for (auto wit = m_wallets.cbegin(); wit != m_wallets.cend(); ++wit) {
+        wireWallet(wit.key(), wit.value());
+        for (const auto &fn : m_deferred.take(wit.value())) fn();
+        wit.value()->getBalance();
+    }
+
+    emit walletsChanged();
+    bumpEpoch();
+}
+
+void MultiWalletController::dropParkedAccount(const QString &account)
+{
+    auto it = m_parked.find(account);
+    if (it == m_parked.end()) return;
+
+    const QHash<QString, Wallet*> wallets = it->wallets;
+    m_parked.erase(it);
+
+    auto *lc = WalletLifecycle::of(this);
+    for (auto wit = wallets.cbegin(); wit != wallets.cend(); ++wit) {
+        Wallet *w = wit.value();
+        unwireWallet(w);
+        m_deferred.remove(w);
+        if (lc) lc->trackClose(wit.key(), w);
+        w->stopSync();
+        w->close();
+        connect(w, &Wallet::walletFullyClosed, this, [w]() {
+            w->deleteLater();
+        }, Qt::QueuedConnection);
+    }
+}
+
 bool MultiWalletController::importWallet(bool          fromFile,
                                          const QString &walletName,
                                          const QString &source,
@@ -1003,18 +1197,17 @@ bool MultiWalletController::importWallet(bool          fromFile,
 
 
     auto *w = new Wallet;
+    w->setExecutor(WalletExecutor::of(this));
 
     const auto net = plan_for(m_am, m_tor);
     qDebug() << "Setting daemon address to:" << net.daemonAddr
              << "via_tor=" << net.useProxy
              << (net.useProxy ? QString("socks %1:%2").arg(net.proxyHost).arg(net.proxyPort) : QString());
-    w->setDaemonAddress(net.daemonAddr);
-    if (net.useProxy)  w->setSocksProxy(net.proxyHost, net.proxyPort);
-    else               w->clearProxy();
+    route_wallet(this, w, net);
 
+    // rpcError is forwarded by adoptWallet().
     connect(w, &Wallet::errorOccurred, this,
-            [this, walletName](const QString &msg){
-                emit rpcError(walletName, msg);
+            [this, walletName](const QString &){
                 if (m_restoreInPlaceJobs.contains(walletName)) {
                     // rollbackRestoreInPlace(walletName, msg);
                 }
@@ -1062,8 +1255,150 @@ bool MultiWalletController::importWallet(bool          fromFile,
 
 
         connect(w, &Wallet::walletOpened, this,
-                [=] {
+                [=]() {
+                    whenCurrent(walletName, w, [=]() {
+                        Meta m;
+                        m.password   = password;
+                        m.reference  = reference;
+                        m.wallet_name= walletName;
+                        m.multisig   = multisig;
+                        m.threshold  = 0;
+                        m.total      = 0;
+                        m.peers      = peersOut;
+                        m.online     = true;
+                        m.address    = "pending";
+                        m.seed       = seedWords;
+                        m.restore_height = restoreHeight;
+                        m.my_onion   = chosenMyOnion;
+                        m.creator    = "user";
+                        m.net_type =  nettype;
+
+                        m_meta.insert(walletName, m);
+                        if (!reference.isEmpty() && !chosenMyOnion.isEmpty())
+                            m_meta_ref.insert(refKey(reference, chosenMyOnion), m);
+
+
+
+                        addWalletToAccount(walletName,
+                                           password,
+                                           /*seed*/ QString(),
+                                           w->address(),
+                                           restoreHeight,
+                                           chosenMyOnion,
+                                           reference,
+                                           multisig,
+                                           /*threshold*/ 0,
+                                           /*total*/ 0,
+                                           peersOut,
+                                           /*online*/ true,
+                                           "user",
+                                           nettype);
+
+
+
+
+                        w->getPrimarySeed();
+                        w->isMultisig();
+                        startWalletSync(w);
+                        w->getBalance();
+                        maybeFinalizeRestoreInPlace(walletName);
+                    });
+                },
+                Qt::QueuedConnection);
 
+
+        connect(w, &Wallet::primarySeedReady, this,
+                [this, walletName, w](const QString &seed) {
+                    whenCurrent(walletName, w, [=]() {
+                        if (seed.isEmpty()) return;
+                        const Meta m = m_meta.value(walletName);
+                        addWalletToAccount(walletName,
+                                           m.password,
+                                           seed,
+                                           m.address,
+                                           m.restore_height,
+                                           m.my_onion,
+                                           m.reference,
+                                           m.multisig,
+                                           m.threshold,
+                                           m.total,
+                                           m.peers,
+                                           m.online,
+                                           m.creator,
+                                           m.net_type);
+                        maybeFinalizeRestoreInPlace(walletName);
+                    });
+                }, Qt::QueuedConnection);
+
+
+        connect(w, &Wallet::isMultisigReady, this,
+                [this, w, walletName](bool isMulti) {
+                    whenCurrent(walletName, w, [=]() {
+                        auto m = m_meta.value(walletName);
+                        if (m.multisig != isMulti) {
+                            m.multisig = isMulti;
+                            addWalletToAccount(walletName,
+                                               m.password,
+                                               m.seed,
+                                               m.address,
+                                               m.restore_height,
+                                               m.my_onion,
+                                               m.reference,
+                                               isMulti,
+                                               m.threshold,
+                                               m.total,
+                                               m.peers,
+                                               m.online,
+                                               m.creator,
+                                               m.net_type);
+                        }
+                        if (isMulti)
+                            w->getMultisigParams();
+                        maybeFinalizeRestoreInPlace(walletName);
+                    });
+                }, Qt::QueuedConnection);
+
+
+        connect(w, &Wallet::multisigParamsReady, this,
+                [this, walletName, w](quint32 th, quint32 tot) {
+                    whenCurrent(walletName, w, [=]() {
+                        auto m = m_meta.value(walletName);
+
+
+                        m.threshold = int(th);
+                        m.total     = int(tot);
+
+                        addWalletToAccount(walletName,
+                                           m.password,
+                                           m.seed,
+                                           m.address,
+                                           m.restore_height,
+                                           m.my_onion,
+                                           m.reference,
+                                           m.multisig,
+                                           th,
+                                           tot,
+                                           m.peers,
+                                           m.online,
+                                           m.creator,
+                                           m.net_type);
+                        maybeFinalizeRestoreInPlace(walletName);
+                    });
+                }, Qt::QueuedConnection);
+
+
+        adoptWallet(walletName, w);
+        qDebug().noquote() << "Trying to open";
+
+        w->open(walletPath, password, nettype);
+        return true;
+    }
+
+
+
+    connect(w, &Wallet::walletRestored, this,
+            [=]() {
+                whenCurrent(walletName, w, [=]() {
                     Meta m;
                     m.password   = password;
                     m.reference  = reference;
@@ -1084,11 +1419,9 @@ bool MultiWalletController::importWallet(bool          fromFile,
                     if (!reference.isEmpty() && !chosenMyOnion.isEmpty())
                         m_meta_ref.insert(refKey(reference, chosenMyOnion), m);
 
-
-
                     addWalletToAccount(walletName,
                                        password,
-                                       /*seed*/ QString(),
+                                       seedWords,
                                        w->address(),
                                        restoreHeight,
                                        chosenMyOnion,
@@ -1101,44 +1434,18 @@ bool MultiWalletController::importWallet(bool          fromFile,
                                        "user",
                                        nettype);
 
-
-
-
-                    w->getPrimarySeed();
                     w->isMultisig();
-                    w->startSync(120);
+                    startWalletSync(w);
                     w->getBalance();
                     maybeFinalizeRestoreInPlace(walletName);
-                },
-                Qt::QueuedConnection);
-
-
-        connect(w, &Wallet::primarySeedReady, this,
-                [this, walletName](const QString &seed)
-                {
-                    if (seed.isEmpty()) return;
-                    const Meta m = m_meta.value(walletName);
-                    addWalletToAccount(walletName,
-                                       m.password,
-                                       seed,
-                                       m.address,
-                                       m.restore_height,
-                                       m.my_onion,
-                                       m.reference,
-                                       m.multisig,
-                                       m.threshold,
-                                       m.total,
-                                       m.peers,
-                                       m.online,
-                                       m.creator,
-                                       m.net_type);
-                    maybeFinalizeRestoreInPlace(walletName);
-                }, Qt::QueuedConnection);
+                });
+            },
+            Qt::QueuedConnection);
 
 
-        connect(w, &Wallet::isMultisigReady, this,
-                [this, w, walletName](bool isMulti)
-                {
+    connect(w, &Wallet::isMultisigReady, this,
+            [this, w, walletName](bool isMulti) {
+                whenCurrent(walletName, w, [=]() {
                     auto m = m_meta.value(walletName);
                     if (m.multisig != isMulti) {
                         m.multisig = isMulti;
@@ -1160,15 +1467,14 @@ bool MultiWalletController::importWallet(bool          fromFile,
                     if (isMulti)
                         w->getMultisigParams();
                     maybeFinalizeRestoreInPlace(walletName);
-                }, Qt::QueuedConnection);
+                });
+            }, Qt::QueuedConnection);
 
 
-        connect(w, &Wallet::multisigParamsReady, this,
-                [this, walletName](quint32 th, quint32 tot)
-                {
+    connect(w, &Wallet::multisigParamsReady, this,
+            [this, walletName, w](quint32 th, quint32 tot) {
+                whenCurrent(walletName, w, [=]() {
                     auto m = m_meta.value(walletName);
-
-
                     m.threshold = int(th);
                     m.total     = int(tot);
 
@@ -1186,123 +1492,13 @@ bool MultiWalletController::importWallet(bool          fromFile,
                                        m.online,
                                        m.creator,
                                        m.net_type);
-                    maybeFinalizeRestoreInPlace(walletName);
-                }, Qt::QueuedConnection);
-
-
-        m_wallets.insert(walletName, w);
-        bumpEpoch();
-        emit walletsChanged();
-        qDebug().noquote() << "Trying to open";
-
-        w->open(walletPath, password, nettype);
-        return true;
-    }
-
-
-
-    connect(w, &Wallet::walletRestored, this,
-            [=] {
-
-                Meta m;
-                m.password   = password;
-                m.reference  = reference;
-                m.wallet_name= walletName;
-                m.multisig   = multisig;
-                m.threshold  = 0;
-                m.total      = 0;
-                m.peers      = peersOut;
-                m.online     = true;
-                m.address    = "pending";
-                m.seed       = seedWords;
-                m.restore_height = restoreHeight;
-                m.my_onion   = chosenMyOnion;
-                m.creator    = "user";
-                m.net_type =  nettype;
-
-                m_meta.insert(walletName, m);
-                if (!reference.isEmpty() && !chosenMyOnion.isEmpty())
-                    m_meta_ref.insert(refKey(reference, chosenMyOnion), m);
-
-                addWalletToAccount(walletName,
-                                   password,
-                                   seedWords,
-                                   w->address(),
-                                   restoreHeight,
-                                   chosenMyOnion,
-                                   reference,
-                                   multisig,
-                                   /*threshold*/ 0,
-                                   /*total*/ 0,
-                                   peersOut,
-                                   /*online*/ true,
-                                   "user",
-                                   nettype);
-
-                w->isMultisig();
-                w->startSync(120);
-                w->getBalance();
-                maybeFinalizeRestoreInPlace(walletName);
-            },
-            Qt::QueuedConnection);
-
-
-    connect(w, &Wallet::isMultisigReady, this,
-            [this, w, walletName](bool isMulti)
-            {
-                auto m = m_meta.value(walletName);
-                if (m.multisig != isMulti) {
-                    m.multisig = isMulti;
-                    addWalletToAccount(walletName,
-                                       m.password,
-                                       m.seed,
-                                       m.address,
-                                       m.restore_height,
-                                       m.my_onion,
-                                       m.reference,
-                                       isMulti,
-                                       m.threshold,
-                                       m.total,
-                                       m.peers,
-                                       m.online,
-                                       m.creator,
-                                       m.net_type);
-                }
-                if (isMulti)
-                    w->getMultisigParams();
-                maybeFinalizeRestoreInPlace(walletName);
-            }, Qt::QueuedConnection);
 
+                    maybeFinalizeRestoreInPlace(walletName);
 
-    connect(w, &Wallet::multisigParamsReady, this,
-            [this, walletName](quint32 th, quint32 tot)
-            {
-                auto m = m_meta.value(walletName);
-                m.threshold = int(th);
-                m.total     = int(tot);
-
-                addWalletToAccount(walletName,
-                                   m.password,
-                                   m.seed,
-                                   m.address,
-                                   m.restore_height,
-                                   m.my_onion,
-                                   m.reference,
-                                   m.multisig,
-                                   th,
-                                   tot,
-                                   m.peers,
-                                   m.online,
-                                   m.creator,
-                                   m.net_type);
-
-                maybeFinalizeRestoreInPlace(walletName);
-
+                });
             }, Qt::QueuedConnection);
 
-    m_wallets.insert(walletName, w);
-    bumpEpoch();
-    emit walletsChanged();
+    adoptWallet(walletName, w);
     qDebug().noquote() << "Trying to restore";
     w->restoreFromSeed(walletPath,
                        password,
@@ -1343,10 +1539,102 @@ bool MultiWalletController::setSubaddressLookahead(const QString &walletName, qu
 }
 
 
+namespace {
+// Safety net only; new blocks and mempool changes trigger refreshes.
+constexpr int    kFallbackSyncSec      = 600;
+constexpr qint64 kActiveWalletMs       = 5 * 60'000;    // used this recently: every mempool change counts
+constexpr qint64 kIdleMempoolRefreshMs = 3 * 60'000;    // otherwise at most this often
+}
+
+void MultiWalletController::startWalletSync(Wallet *w)
+{
+    DaemonMonitor *mon = DaemonMonitor::of(this);
+    if (!mon) { w->startSync(120); return; }
+
+    const auto net = plan_for(m_am, m_tor);
+    const QString key = mon->watch(net.daemonAddr,
+                                   net.useProxy ? net.proxyHost : QString(),
+                                   net.useProxy ? net.proxyPort : 0, w);
+
+    // Lambdas cannot be unique connections; a restarted sync replaces the old pair.
+    disconnect(mon, nullptr, w, nullptr);
+    connect(mon, &DaemonMonitor::tipChanged, w, [w, key](const QString &ep, quint64, const QString &) {
+        if (ep == key) w->refreshAsync();
+    });
+    connect(mon, &DaemonMonitor::mempoolChanged, w,
+            [w, key, lastMs = qint64(0)](const QString &ep, quint64) mutable {
+        if (ep != key) return;
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        if (now - w->lastUsedMs() > kActiveWalletMs && now - lastMs < kIdleMempoolRefreshMs) return;
+        lastMs = now;
+        w->refreshAsync();
+    });
+    w->startSync(kFallbackSyncSec);
+}
+
+void MultiWalletController::releaseHeightWatch()
+{
+    if (!m_wallets.isEmpty() || m_heightWatch.isActive()) return;
+    if (auto *mon = DaemonMonitor::of(this)) mon->unwatch(this);
+}
+
+quint64 MultiWalletController::cachedChainHeight()
+{
+    DaemonMonitor *mon = DaemonMonitor::of(this);
+    if (!mon) return 0;
+
+    const auto net = plan_for(m_am, m_tor);
+    const quint64 h = mon->cachedHeight(net.daemonAddr);
+    // Keep the endpoint warm for the next caller even with no wallet open,
+    // until the last wallet is gone and nobody asked for a while.
+    mon->watch(net.daemonAddr, net.useProxy ? net.proxyHost : QString(),
+               net.useProxy ? net.proxyPort : 0, this);
+    m_heightWatch.start();
+    return h;
+}
+
+QList<Wallet*> MultiWalletController::liveWallets() const
+{
+    QList<Wallet*> out = m_wallets.values();
+    for (const ParkedAccount &p : m_parked)
+        out += p.wallets.values();
+    return out;
+}
+
+QVariantMap MultiWalletController::residencyStats() const
+{
+    const WalletResidency *res = WalletResidency::of(this);
+    return res ? res->stats() : QVariantMap{};
+}
+
+void MultiWalletController::warmTransferInputs(const QString &walletName)
+{
+    if (!m_meta.contains(walletName)) return;
+    DaemonProxy *proxy = DaemonProxy::of(this);
+    if (!proxy) return;
+
+    const auto net = plan_for(m_am, m_tor);
+    const QString host = net.useProxy ? net.proxyHost : QString();
+    const quint16 port = net.useProxy ? net.proxyPort : 0;
+    // The proxy refreshes on the monitor's tips; make sure someone polls.
+    if (auto *mon = DaemonMonitor::of(this)) {
+        mon->watch(net.daemonAddr, host, port, this);
+        m_heightWatch.start();
+    }
+    proxy->warm(net.daemonAddr, host, port);
+}
+
+QVariantList MultiWalletController::lifecycleTrace() const
+{
+    const WalletLifecycle *lc = WalletLifecycle::of(this);
+    return lc ? lc->trace() : QVariantList{};
+}
+
 void MultiWalletController::reset()
 {
 
     stopAllWallets();
+    if (auto *mon = DaemonMonitor::of(this)) mon->unwatch(this);
     m_walletNames.clear();
     m_walletRefs.clear();
     m_meta.clear();
@@ -1714,7 +2002,8 @@ bool MultiWalletController::createStandardWallet(const QString &walletName,
     }
 
     const std::time_t now = QDateTime::currentSecsSinceEpoch();
-    job.restoreHeight = restore_height::estimate_from_timestamp(now, nettype_to_int(nettype));
+    const quint64 tip = cachedChainHeight();
+    job.restoreHeight = tip > 0 ? tip : restore_height::estimate_from_timestamp(now, nettype_to_int(nettype));
     m_stdCreateJobs.insert(name, job);
 
     // Wallet path
@@ -1722,74 +2011,66 @@ bool MultiWalletController::createStandardWallet(const QString &walletName,
 
     // Create wallet instance
     auto *w = new Wallet;
+    w->setExecutor(WalletExecutor::of(this));
 
     const auto net = plan_for(m_am, m_tor);
-    w->setDaemonAddress(net.daemonAddr);
-    if (net.useProxy)  w->setSocksProxy(net.proxyHost, net.proxyPort);
-    else               w->clearProxy();
+    route_wallet(this, w, net);
 
+    // rpcError is forwarded by adoptWallet().
     connect(w, &Wallet::errorOccurred, this,
-            [this, name, w](const QString &msg) {
-                emit rpcError(name, msg);
-                m_stdCreateJobs.remove(name);
-
-                // cleanup instance if we inserted it
-                if (m_wallets.value(name) == w) {
-                    disconnectWallet(name);
-                } else {
-                    w->deleteLater();
-                }
+            [this, name, w](const QString &) {
+                whenCurrent(name, w, [=]() {
+                    m_stdCreateJobs.remove(name);
+
+                    // cleanup instance if we inserted it
+                    if (m_wallets.value(name) == w) {
+                        disconnectWallet(name);
+                    } else {
+                        w->deleteLater();
+                    }
+                });
             },
             Qt::QueuedConnection);
 
     connect(w, &Wallet::walletCreated, this,
             [this, name, w]() {
-                // Request both; we finalize when both arrive
-                w->getPrimarySeed();
-                w->getAddress();
+                whenCurrent(name, w, [=]() {
+                    // Request both; we finalize when both arrive
+                    w->getPrimarySeed();
+                    w->getAddress();
 
-                // Optional: start sync immediately
-                w->startSync(120);
+                    // Optional: start sync immediately
+                    startWalletSync(w);
+                });
             },
             Qt::QueuedConnection);
 
     connect(w, &Wallet::primarySeedReady, this,
-            [this, name](const QString &seed) {
-                if (!m_stdCreateJobs.contains(name) || seed.isEmpty()) return;
-                auto &job = m_stdCreateJobs[name];
-                job.seed = seed;
-                job.gotSeed = true;
-                maybeFinalizeStandardCreate(name);
+            [this, name, w](const QString &seed) {
+                whenCurrent(name, w, [=]() {
+                    if (!m_stdCreateJobs.contains(name) || seed.isEmpty()) return;
+                    auto &job = m_stdCreateJobs[name];
+                    job.seed = seed;
+                    job.gotSeed = true;
+                    maybeFinalizeStandardCreate(name);
+                });
             },
             Qt::QueuedConnection);
 
     connect(w, &Wallet::addressReady, this,
-            [this, name](const QString &addr) {
-                if (!m_stdCreateJobs.contains(name) || addr.isEmpty()) return;
-                auto &job = m_stdCreateJobs[name];
-                job.address = addr;
-                job.gotAddr = true;
-                maybeFinalizeStandardCreate(name);
+            [this, name, w](const QString &addr) {
+                whenCurrent(name, w, [=]() {
+                    if (!m_stdCreateJobs.contains(name) || addr.isEmpty()) return;
+                    auto &job = m_stdCreateJobs[name];
+                    job.address = addr;
+                    job.gotAddr = true;
+                    maybeFinalizeStandardCreate(name);
+                });
             },
             Qt::QueuedConnection);
 
-    // Hook typical signals like you do in connectWallet/createWallet (busy/rpc/etc)
-    connect(w, &Wallet::busyChanged, this, [this, name]() {
-        emit busyChanged(name, walletBusy(name));
-    }, Qt::QueuedConnection);
-
-    connect(w, &Wallet::queueChanged, this, [this, name] {
-        emit pendingOpsChanged(name);
-    }, Qt::QueuedConnection);
-
-    connect(w, &Wallet::balanceReady, this, [this, name](quint64 bal, quint64 unlk, bool){
-        emit walletBalanceChanged(name, bal, unlk);
-    }, Qt::QueuedConnection);
-
     // Insert into map so UI can see it immediately
-    m_wallets.insert(name, w);
-    emit walletsChanged();
-    bumpEpoch();
+    adoptWallet(name, w);
 
     // Create new standard wallet
     w->createNew(walletPath, password, "English", nettype, 1);
@@ -0,0 +1,416 @@
+#include "win_compat.h"
+#include "payoutqueue.h"
+#include "accountmanager.h"
+
+#include <cryptonote_basic/cryptonote_basic_impl.h>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+constexpr int    kMaxOutputs      = 15;        // 16 outputs per tx, one is change
+constexpr int    kDefaultWaitMins = 60;
+constexpr int    kMaxAttempts     = 3;
+constexpr int    kSweepMs         = 30'000;
+constexpr qint64 kDoneKeepSecs    = 30 * 24 * 3600;
+
+const QByteArray kQueuePurpose = QByteArrayLiteral("payout_queue/v1");
+
+cryptonote::network_type toNetType(const QString &n)
+{
+    const QString low = n.trimmed().toLower();
+    if (low == QLatin1String("testnet"))  return cryptonote::TESTNET;
+    if (low == QLatin1String("stagenet")) return cryptonote::STAGENET;
+    return cryptonote::MAINNET;
+}
+
+// Standard and subaddresses of the wallet's network only: a transaction
+// carries at most one payment id, so integrated addresses cannot share a batch.
+bool isBatchableAddress(const QString &a, cryptonote::network_type net)
+{
+    cryptonote::address_parse_info info;
+    return cryptonote::get_account_address_from_str(info, net, a.toStdString())
+           && !info.has_payment_id;
+}
+
+QJsonArray defaultOrder(const QVariantMap &meta)
+{
+    const QString me  = meta.value("my_onion").toString().trimmed().toLower();
+    const int     thr = meta.value("threshold").toInt();
+
+    QJsonArray out{ me };
+    for (const QString &p : meta.value("peers").toStringList()) {
+        if (out.size() >= thr) break;
+        const QString low = p.trimmed().toLower();
+        if (low.isEmpty() || low == me) continue;
+        out.append(low);
+    }
+    return out;
+}
+}
+
+PayoutQueue::PayoutQueue(AccountManager *acct, QObject *parent)
+    : QObject(parent), m_acct(acct)
+{
+    m_timer.setInterval(kSweepMs);
+    connect(&m_timer, &QTimer::timeout, this, &PayoutQueue::sweep);
+    m_timer.start();
+}
+
+QString PayoutQueue::path() const
+{
+    return QDir(m_acct->walletAccountDir()).filePath("payout_queues.bin");
+}
+
+bool PayoutQueue::ensureLoaded()
+{
+    if (!m_acct || !m_acct->isAuthenticated()) return false;
+    const QString owner = m_acct->walletAccountDir();
+    if (m_loaded && owner == m_loadedFor) return true;
+
+    m_queues = {};
+    QFile in(path());
+    if (in.exists()) {
+        QByteArray plain;
+        if (!in.open(QIODevice::ReadOnly) || !m_acct->openForAccount(in.readAll(), kQueuePurpose, plain)) {
+            qWarning() << "[PayoutQueue] queue file unreadable, payouts unavailable";
+            return false;
+        }
+        m_queues = QJsonDocument::fromJson(plain).object();
+    }
+    m_loaded    = true;
+    m_loadedFor = owner;
+
+    // Queues used to live in the account document; move them out once.
+    if (!in.exists()) {
+        QJsonObject root = QJsonDocument::fromJson(m_acct->loadAccountData().toUtf8()).object();
+        if (root.contains("payout_queues")) {
+            m_queues = root.take("payout_queues").toObject();
+            if (save())
+                m_acct->saveAccountData(QString::fromUtf8(QJsonDocument(root).toJson(QJsonDocument::Compact)));
+        }
+    }
+    return true;
+}
+
+// Only this file is rewritten; the account document is not touched per change.
+bool PayoutQueue::save()
+{
+    const QByteArray sealed = m_acct->sealForAccount(
+        QJsonDocument(m_queues).toJson(QJsonDocument::Compact), kQueuePurpose);
+    bool ok = !sealed.isEmpty() && QDir().mkpath(m_acct->walletAccountDir());
+    if (ok) {
+        QSaveFile out(path());
+        ok = out.open(QIODevice::WriteOnly) && out.write(sealed) == sealed.size() && out.commit();
+    }
+    if (!ok) qWarning() << "[PayoutQueue] saving payout queues failed";
+    return ok;
+}
+
+void PayoutQueue::reset()
+{
+    m_loaded = false;
+    m_loadedFor.clear();
+    m_queues = {};
+}
+
+QJsonObject PayoutQueue::queueFor(const QString &walletName, const QVariantMap &meta)
+{
+    QJsonObject q = m_queues.value(walletName).toObject();
+    if (q.isEmpty()) {
+        q["max_batch"]     = kMaxOutputs;
+        q["max_wait_secs"] = kDefaultWaitMins * 60;
+        q["fee_priority"]  = 0;
+        q["inspect"]       = true;
+        q["items"]         = QJsonArray{};
+    }
+    q["wallet_ref"] = meta.value("reference").toString();
+    q["my_onion"]   = meta.value("my_onion").toString();
+    q["threshold"]  = meta.value("threshold").toInt();
+    if (q.value("signing_order").toArray().isEmpty())
+        q["signing_order"] = defaultOrder(meta);
+    return q;
+}
+
+bool PayoutQueue::configure(const QString &walletName, const QVariantMap &meta,
+                            const QStringList &signingOrder, int feePriority, bool inspect,
+                            int maxBatch, int maxWaitMinutes)
+{
+    if (!ensureLoaded() || meta.isEmpty()) return false;
+
+    QJsonObject q = queueFor(walletName, meta);
+    QJsonArray order;
+    for (const QString &o : signingOrder) order.append(o.trimmed().toLower());
+    q["signing_order"] = order.isEmpty() ? defaultOrder(meta) : order;
+    q["fee_priority"]  = feePriority;
+    q["inspect"]       = inspect;
+    q["max_batch"]     = std::clamp(maxBatch, 1, kMaxOutputs);
+    q["max_wait_secs"] = qMax(1, maxWaitMinutes) * 60;
+    m_queues[walletName] = q;
+    save();
+    emit changed(walletName);
+    checkDue(walletName);
+    return true;
+}
+
+QString PayoutQueue::enqueue(const QString &walletName, const QVariantMap &meta,
+                             const QString &address, quint64 amount, const QString &label)
+{
+    if (!ensureLoaded() || meta.isEmpty() || amount == 0) return {};
+    const QString addr = address.trimmed();
+    const QString net  = meta.value("net_type", m_acct->networkType()).toString();
+    if (!isBatchableAddress(addr, toNetType(net))) {
+        qWarning() << "[PayoutQueue] not a" << net << "standard address or subaddress, not queued";
+        return {};
+    }
+
+    QJsonObject q = queueFor(walletName, meta);
+    QJsonArray items = q.value("items").toArray();
+    const QString id = QString::number(QRandomGenerator::system()->generate64(), 16).rightJustified(16, QChar('0'));
+    items.append(QJsonObject{
+        {"id",        id},
+        {"address",   addr},
+        {"amount",    QString::number(amount)},
+        {"label",     label},
+        {"state",     "queued"},
+        {"queued_at", QDateTime::currentSecsSinceEpoch()},
+        {"attempts",  0},
+    });
+    q["items"] = items;
+    m_queues[walletName] = q;
+    save();
+    emit changed(walletName);
+    checkDue(walletName);
+    return id;
+}
+
+bool PayoutQueue::cancel(const QString &walletName, const QString &id)
+{
+    if (!ensureLoaded()) return false;
+    QJsonObject q = m_queues.value(walletName).toObject();
+    QJsonArray items = q.value("items").toArray();
+    for (int i = 0; i < items.size(); ++i) {
+        QJsonObject it = items[i].toObject();
+        if (it.value("id").toString() != id) continue;
+        if (it.value("state").toString() != QLatin1String("queued")) return false;
+        it["state"]   = "cancelled";
+        it["done_at"] = QDateTime::currentSecsSinceEpoch();
+        items[i] = it;
+        q["items"] = items;
+        m_queues[walletName] = q;
+        save();
+        emit changed(walletName);
+        return true;
+    }
+    return false;
+}
+
+QVariantList PayoutQueue::items(const QString &walletName)
+{
+    if (!ensureLoaded()) return {};
+    return m_queues.value(walletName).toObject().value("items").toArray().toVariantList();
+}
+
+PayoutQueue::Batch PayoutQueue::take(const QString &walletName)
+{
+    Batch b;
+    if (!ensureLoaded()) return b;
+    const QJsonObject q = m_queues.value(walletName).toObject();
+    const int maxBatch = q.value("max_batch").toInt(kMaxOutputs);
+
+    for (const QJsonValue &v : q.value("items").toArray()) {
+        const QJsonObject it = v.toObject();
+        if (it.value("state").toString() != QLatin1String("queued")) continue;
+        b.destinations.append(QVariantMap{
+            {"address", it.value("address").toString()},
+            {"amount",  it.value("amount").toString().toLongLong()},
+        });
+        b.ids << it.value("id").toString();
+        if (b.ids.size() >= maxBatch) break;
+    }
+    if (b.ids.isEmpty()) return b;
+
+    b.walletRef   = q.value("wallet_ref").toString();
+    b.myOnion     = q.value("my_onion").toString();
+    b.threshold   = q.value("threshold").toInt();
+    b.feePriority = q.value("fee_priority").toInt();
+    b.inspect     = q.value("inspect").toBool(true);
+    for (const QJsonValue &v : q.value("signing_order").toArray()) b.signingOrder << v.toString();
+    return b;
+}
+
+void PayoutQueue::markBatched(const QString &walletName, const QStringList &ids, const QString &transferRef)
+{
+    QJsonObject q = m_queues.value(walletName).toObject();
+    QJsonArray items = q.value("items").toArray();
+    for (int i = 0; i < items.size(); ++i) {
+        QJsonObject it = items[i].toObject();
+        if (!ids.contains(it.value("id").toString())) continue;
+        it["state"]        = "batched";
+        it["transfer_ref"] = transferRef;
+        it["attempts"]     = it.value("attempts").toInt() + 1;
+        items[i] = it;
+    }
+    q["items"] = items;
+    m_queues[walletName] = q;
+    save();
+    qDebug().noquote() << "[PayoutQueue]" << walletName << ":" << ids.size() << "payout(s) in" << transferRef;
+    emit changed(walletName);
+}
+
+bool PayoutQueue::settle(const QString &transferRef, const QString &result, bool neverSubmitted,
+                         const QString &txId)
+{
+    if (transferRef.isEmpty() || !ensureLoaded()) return false;
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    const bool sent = result == QLatin1String("success");
+
+    for (auto qit = m_queues.begin(); qit != m_queues.end(); ++qit) {
+        QJsonObject q = qit.value().toObject();
+        QJsonArray items = q.value("items").toArray();
+        bool touched = false, mine = false;
+        for (int i = 0; i < items.size(); ++i) {
+            QJsonObject it = items[i].toObject();
+            if (it.value("transfer_ref").toString() != transferRef) continue;
+            mine = true;
+            if (it.value("state").toString() != QLatin1String("batched")) continue;
+
+            if (sent) {
+                it["state"]   = "sent";
+                it["tx_id"]   = txId;
+                it["done_at"] = now;
+            } else if (!neverSubmitted) {
+                // A signer may have broadcast it; only a person can tell.
+                it["state"]      = "needs_review";
+                it["last_error"] = result;
+            } else if (it.value("attempts").toInt() >= kMaxAttempts) {
+                it["state"]      = "failed";
+                it["last_error"] = result;
+                it["done_at"]    = now;
+            } else {
+                // Back in line for the next window, not straight into another round.
+                it["state"]      = "queued";
+                it["last_error"] = result;
+                it["queued_at"]  = now;
+                it.remove("transfer_ref");
+            }
+            items[i] = it;
+            touched = true;
+        }
+        if (!mine) continue;
+        if (touched) {
+            q["items"] = items;
+            qit.value() = q;
+            save();
+            emit changed(qit.key());
+        }
+        return holds(transferRef);
+    }
+    return false;
+}
+
+bool PayoutQueue::holds(const QString &transferRef)
+{
+    if (transferRef.isEmpty() || !ensureLoaded()) return false;
+    for (auto qit = m_queues.cbegin(); qit != m_queues.cend(); ++qit)
+        for (const QJsonValue &v : qit.value().toObject().value("items").toArray()) {
+            const QJsonObject it = v.toObject();
+            if (it.value("transfer_ref").toString() == transferRef &&
+                it.value("state").toString() == QLatin1String("needs_review"))
+                return true;
+        }
+    return false;
+}
+
+bool PayoutQueue::resolve(const QString &walletName, const QString &id, bool sent, QString *transferRef)
+{
+    if (!ensureLoaded()) return false;
+    QJsonObject q = m_queues.value(walletName).toObject();
+    QJsonArray items = q.value("items").toArray();
+    for (int i = 0; i < items.size(); ++i) {
+        QJsonObject it = items[i].toObject();
+        if (it.value("id").toString() != id) continue;
+        if (it.value("state").toString() != QLatin1String("needs_review")) return false;
+        if (transferRef) *transferRef = it.value("transfer_ref").toString();
+
+        const qint64 now = QDateTime::currentSecsSinceEpoch();
+        if (sent) {
+            it["state"]   = "sent";
+            it["done_at"] = now;
+        } else {
+            it["state"]     = "queued";
+            it["queued_at"] = now;
+            it.remove("transfer_ref");
+        }
+        items[i] = it;
+        q["items"] = items;
+        m_queues[walletName] = q;
+        save();
+        emit changed(walletName);
+        if (!sent) checkDue(walletName);
+        return true;
+    }
+    return false;
+}
+
+QStringList PayoutQueue::batchedRefs()
+{
+    QStringList out;
+    if (!ensureLoaded()) return out;
+    for (auto qit = m_queues.cbegin(); qit != m_queues.cend(); ++qit)
+        for (const QJsonValue &v : qit.value().toObject().value("items").toArray()) {
+            const QJsonObject it = v.toObject();
+            const QString ref = it.value("transfer_ref").toString();
+            if (it.value("state").toString() == QLatin1String("batched") && !out.contains(ref))
+                out << ref;
+        }
+    return out;
+}
+
+void PayoutQueue::checkDue(const QString &walletName)
+{
+    const QJsonObject q = m_queues.value(walletName).toObject();
+    const int    maxBatch = q.value("max_batch").toInt(kMaxOutputs);
+    const qint64 maxWait  = q.value("max_wait_secs").toInteger(kDefaultWaitMins * 60);
+    const qint64 now      = QDateTime::currentSecsSinceEpoch();
+
+    int    queued = 0;
+    qint64 oldest = now;
+    for (const QJsonValue &v : q.value("items").toArray()) {
+        const QJsonObject it = v.toObject();
+        if (it.value("state").toString() != QLatin1String("queued")) continue;
+        ++queued;
+        oldest = qMin(oldest, it.value("queued_at").toInteger(now));
+    }
+    if (queued > 0 && (queued >= maxBatch || now - oldest >= maxWait))
+        emit flushDue(walletName);
+}
+
+void PayoutQueue::sweep()
+{
+    if (!ensureLoaded()) return;
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+    bool pruned = false;
+    for (auto qit = m_queues.begin(); qit != m_queues.end(); ++qit) {
+        QJsonObject q = qit.value().toObject();
+        QJsonArray items = q.value("items").toArray();
+        for (int i = items.size() - 1; i >= 0; --i) {
+            const qint64 doneAt = items[i].toObject().value("done_at").toInteger();
+            if (doneAt > 0 && now - doneAt > kDoneKeepSecs) { items.removeAt(i); pruned = true; }
+        }
+        q["items"] = items;
+        qit.value() = q;
+    }
+    if (pruned) save();
+
+    for (const QString &walletName : m_queues.keys())
+        checkDue(walletName);
+}
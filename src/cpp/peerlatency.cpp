@@ -0,0 +1,86 @@
+#include "win_compat.h"
+#include "peerlatency.h"
+
+#include <QDateTime>
+#include <QVariant>
+#include <algorithm>
+
+namespace {
+constexpr double kRttWeight  = 0.3;   // weight of a new sample
+constexpr qint64 kFreshSecs  = 120;
+constexpr int    kMaxEntries = 512;
+
+QString key(const QString &onion)
+{
+    return onion.trimmed().toLower();
+}
+}
+
+PeerLatency::PeerLatency(QObject *parent)
+    : QObject(parent)
+{
+}
+
+PeerLatency *PeerLatency::of(const QObject *holder)
+{
+    if (!holder) return nullptr;
+    return qobject_cast<PeerLatency*>(holder->property("peerLatency").value<QObject*>());
+}
+
+void PeerLatency::record(const QString &onion, bool ok, qint64 rttMs)
+{
+    const QString k = key(onion);
+    if (k.isEmpty()) return;
+
+    if (!m_entries.contains(k) && m_entries.size() >= kMaxEntries) {
+        auto oldest = std::min_element(m_entries.begin(), m_entries.end(),
+                                       [](const Entry &a, const Entry &b){ return a.lastOkAt < b.lastOkAt; });
+        m_entries.erase(oldest);
+    }
+
+    Entry &e = m_entries[k];
+    if (!ok) { ++e.failures; return; }
+
+    e.rttMs    = (e.lastOkAt == 0) ? double(rttMs) : e.rttMs + kRttWeight * (double(rttMs) - e.rttMs);
+    e.failures = 0;
+    e.lastOkAt = QDateTime::currentSecsSinceEpoch();
+}
+
+QStringList PeerLatency::rank(const QStringList &onions) const
+{
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+    struct Ranked { QString onion; int tier; double score; };
+    QList<Ranked> ranked;
+    ranked.reserve(onions.size());
+    for (const QString &o : onions) {
+        const auto it = m_entries.constFind(key(o));
+        if (it == m_entries.constEnd())
+            ranked.push_back({o, 1, 0});
+        else if (it->failures > 0)
+            ranked.push_back({o, 2, double(it->failures)});
+        else if (now - it->lastOkAt <= kFreshSecs)
+            ranked.push_back({o, 0, it->rttMs});
+        else
+            ranked.push_back({o, 1, 0});
+    }
+
+    std::stable_sort(ranked.begin(), ranked.end(), [](const Ranked &a, const Ranked &b){
+        return a.tier != b.tier ? a.tier < b.tier : a.score < b.score;
+    });
+
+    QStringList out;
+    out.reserve(ranked.size());
+    for (const Ranked &r : ranked) out << r.onion;
+    return out;
+}
+
+QStringList PeerLatency::chainVia(const QStringList &signedBy, const QString &next,
+                                  const QStringList &rest)
+{
+    QStringList out = signedBy;
+    if (!out.contains(next, Qt::CaseInsensitive)) out << next;
+    for (const QString &o : rest)
+        if (!out.contains(o, Qt::CaseInsensitive)) out << o;
+    return out;
+}
@@ -0,0 +1,129 @@
+#include "win_compat.h"
+#include "rpccache.h"
+
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QSet>
+#include <iterator>
+
+namespace {
+constexpr int kMaxEntries = 256;
+
+struct Policy { const char *method; qint64 ttlMs; };
+
+// JSON-RPC methods wallet2 calls around transaction construction. All of
+// them also expire on a new block.
+const Policy kJsonRpc[] = {
+    { "get_fee_estimate", 60'000 },
+    { "hard_fork_info",   10 * 60'000 },
+    { "get_version",      10 * 60'000 },
+};
+
+// Plain JSON endpoints.
+const Policy kPaths[] = {
+    { "/get_info", 10'000 },
+};
+
+QByteArray methodOf(const QByteArray &key)
+{
+    return key.left(key.indexOf(' '));
+}
+
+QString slot(const QString &upstream, const QByteArray &key)
+{
+    return upstream + QLatin1Char(' ') + QString::fromUtf8(key);
+}
+}
+
+QByteArray RpcCache::keyFor(const QByteArray &path, const QByteArray &body, qint64 *ttlMs)
+{
+    for (const Policy &p : kPaths) {
+        if (path != p.method) continue;
+        // get_info takes no parameters worth keying on.
+        if (ttlMs) *ttlMs = p.ttlMs;
+        return path + ' ';
+    }
+    if (path != "/json_rpc") return {};
+
+    QJsonParseError err{};
+    const QJsonObject obj = QJsonDocument::fromJson(body, &err).object();
+    if (err.error != QJsonParseError::NoError) return {};
+
+    const QByteArray method = obj.value("method").toString().toUtf8();
+    for (const Policy &p : kJsonRpc) {
+        if (method != p.method) continue;
+        if (ttlMs) *ttlMs = p.ttlMs;
+        // QJsonObject keeps keys sorted, so equal params serialise equally.
+        const QJsonValue params = obj.value("params");
+        const QByteArray canon  = params.isObject()
+                                ? QJsonDocument(params.toObject()).toJson(QJsonDocument::Compact)
+                                : QByteArray();
+        return method + ' ' + canon;
+    }
+    return {};
+}
+
+QByteArray RpcCache::lookup(const QString &upstream, const QByteArray &key, quint64 tip,
+                            const QByteArray &requestBody)
+{
+    const QString method = QString::fromUtf8(methodOf(key));
+    const qint64  now    = QDateTime::currentMSecsSinceEpoch();
+
+    const auto it = m_entries.constFind(slot(upstream, key));
+    if (it == m_entries.constEnd() || it->expiresMs <= now || (tip && it->tip && it->tip != tip)) {
+        ++m_missesBy[method];
+        return {};
+    }
+    ++m_hitsBy[method];
+
+    if (!key.startsWith("/")) {
+        // Answer with the caller's id, as the daemon would.
+        QJsonObject resp = QJsonDocument::fromJson(it->response).object();
+        resp.insert("id", QJsonDocument::fromJson(requestBody).object().value("id"));
+        return QJsonDocument(resp).toJson(QJsonDocument::Compact);
+    }
+    return it->response;
+}
+
+void RpcCache::store(const QString &upstream, const QByteArray &key, quint64 tip, qint64 ttlMs,
+                     const QByteArray &response)
+{
+    const QJsonObject obj = QJsonDocument::fromJson(response).object();
+    const QJsonObject result = key.startsWith("/") ? obj : obj.value("result").toObject();
+    if (obj.contains("error") || result.isEmpty()) return;
+    if (result.contains("status") && result.value("status").toString() != QLatin1String("OK")) return;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    m_entries.insert(slot(upstream, key), Entry{ response, tip, now + ttlMs });
+    if (m_entries.size() > kMaxEntries) prune(now);
+}
+
+void RpcCache::prune(qint64 now)
+{
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+        it = it->expiresMs <= now ? m_entries.erase(it) : std::next(it);
+    while (m_entries.size() > kMaxEntries) m_entries.erase(m_entries.begin());
+}
+
+QVariantMap RpcCache::stats() const
+{
+    quint64 hits = 0, misses = 0;
+    QVariantMap byMethod;
+    QSet<QString> methods;
+    for (auto it = m_hitsBy.cbegin(); it != m_hitsBy.cend(); ++it)   methods.insert(it.key());
+    for (auto it = m_missesBy.cbegin(); it != m_missesBy.cend(); ++it) methods.insert(it.key());
+    for (const QString &m : std::as_const(methods)) {
+        const quint64 h = m_hitsBy.value(m), x = m_missesBy.value(m);
+        hits += h; misses += x;
+        byMethod.insert(m, QVariantMap{ { "hits", static_cast<qulonglong>(h) },
+                                        { "misses", static_cast<qulonglong>(x) } });
+    }
+    return {
+        { "rpc_entries",   int(m_entries.size()) },
+        { "rpc_hits",      static_cast<qulonglong>(hits) },
+        { "rpc_misses",    static_cast<qulonglong>(misses) },
+        { "rpc_by_method", byMethod },
+    };
+}
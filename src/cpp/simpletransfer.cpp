@@ -11,6 +11,7 @@
 #include "multiwalletcontroller.h"
 #include "wallet.h"
 #include "accountmanager.h"
+#include "transfercatalog.h"
 
 
 namespace {
@@ -100,13 +101,27 @@ void SimpleTransfer::start()
 
 void SimpleTransfer::cancel()
 {
-    Wallet *w = walletByRef(m_walletRef);
-    if (w) w->discardPreparedSimpleTransfer(m_transferRef);
     setStage(Stage::ERROR, "aborted");
 
     stop("abort");
 }
 
+void SimpleTransfer::park()
+{
+    if (m_stop) return;
+    m_stop = true;
+    if (m_stage < Stage::SUBMITTING)
+        if (Wallet *w = walletByRef(m_walletRef)) w->discardPreparedSimpleTransfer(m_transferRef);
+}
+
+SimpleTransfer *SimpleTransfer::restarted(QObject *parent) const
+{
+    if (m_stage >= Stage::SUBMITTING) return nullptr;
+    return new SimpleTransfer(m_wm, m_acct, m_transferRef, m_walletRef,
+                              m_destinationsInit, m_feePriority, m_feeSplit,
+                              m_inspect, parent);
+}
+
 void SimpleTransfer::proceedAfterApproval()
 {
     if (m_stage != Stage::APPROVING) return;
@@ -218,55 +233,42 @@ void SimpleTransfer::stop(const QString &reason)
 {
     if (m_stop) return;
     m_stop = true;
+    if (reason != QLatin1String("success")) {
+        if (Wallet *w = walletByRef(m_walletRef)) {
+            // Queued steps go first; the discard is queued under the same ref.
+            w->cancelOperations(m_transferRef);
+            w->discardPreparedSimpleTransfer(m_transferRef);
+        }
+    }
     emit finished(m_transferRef, reason);
 }
 
 void SimpleTransfer::saveToAccount()
 {
     if (!m_acct) return;
-
-    QJsonDocument doc = QJsonDocument::fromJson(m_acct->loadAccountData().toUtf8());
-    QJsonObject root  = doc.object();
-
-    QJsonObject mon   = root.value("monero").toObject();
-    QJsonArray wallets= mon.value("wallets").toArray();
-
-    for (int i=0;i<wallets.size();++i) {
-        QJsonObject w = wallets[i].toObject();
-        const bool match =
-            (w.value("reference").toString()==m_walletRef) ||
-            (w.value("name").toString()==m_walletName);
-        if (!match) continue;
-
-        QJsonObject transfers = w.value("transfers").toObject();
-        QJsonObject entry     = transfers.value(m_transferRef).toObject();
-
-        const qint64 now = QDateTime::currentSecsSinceEpoch();
-        if (!entry.contains("created_at")) entry["created_at"] = now;
-
-        entry["type"]        = QStringLiteral("SIMPLE");
-        entry["wallet_name"] = m_walletName;
-        entry["wallet_ref"]  = m_walletRef;
-        entry["destinations"]= toJsonRecipients(m_destinations);
-        entry["peers"]       = QJsonObject{};
-        entry["stage"]       = stageName(m_stage);
-        entry["status"]      = QStringLiteral("updated");
-        entry["tx_id"]       = m_txId.isEmpty() ? QString("pending") : m_txId;
-        entry["transfer_description"] = m_transferDescription;
-
-        if (m_stage == Stage::SUBMITTING || m_stage == Stage::CHECKING_STATUS) {
-            if (!entry.contains("submitted_at")) entry["submitted_at"] = now;
-        }
-
-        transfers.insert(m_transferRef, entry);
-        w["transfers"] = transfers;
-        wallets[i] = w;
-        break;
+    TransferCatalog *catalog = TransferCatalog::of(m_acct);
+    if (!catalog) return;
+
+    QJsonObject entry = catalog->transfer(m_transferRef);
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    if (!entry.contains("created_at")) entry["created_at"] = now;
+
+    entry["type"]        = QStringLiteral("SIMPLE");
+    entry["wallet_name"] = m_walletName;
+    entry["wallet_ref"]  = m_walletRef;
+    entry["destinations"]= toJsonRecipients(m_destinations);
+    entry["peers"]       = QJsonObject{};
+    entry["stage"]       = stageName(m_stage);
+    entry["status"]      = QStringLiteral("updated");
+    entry["tx_id"]       = m_txId.isEmpty() ? QString("pending") : m_txId;
+    entry["transfer_description"] = m_transferDescription;
+
+    if (m_stage == Stage::SUBMITTING || m_stage == Stage::CHECKING_STATUS) {
+        if (!entry.contains("submitted_at")) entry["submitted_at"] = now;
     }
 
-    mon["wallets"] = wallets;
-    root["monero"] = mon;
-    (void)m_acct->saveAccountData(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    (void)catalog->upsert(m_walletRef, m_walletName, QString(), m_transferRef, entry);
 }
 
 QString SimpleTransfer::getTransferDetailsJson() const
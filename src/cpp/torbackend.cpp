@@ -949,6 +949,49 @@ void TorBackend::startIfAutoconnect()
     }
 }
 
+void TorBackend::suspendAccountServices()
+{
+    const bool live = m_running && (m_ctl.state() == QAbstractSocket::ConnectedState);
+
+    QByteArray batch;
+    const QStringList onions = m_services.keys();
+    for (const QString &onion : onions) {
+        if (live) {
+            QString sid = onion;
+            if (sid.endsWith(".onion", Qt::CaseInsensitive)) sid.chop(6);
+            batch += "DEL_ONION " + sid.toLatin1() + "\r\n";
+        }
+        stopAndDeleteService(onion);
+    }
+    if (!batch.isEmpty()) m_ctl.write(batch);
+
+    for (auto &svc : m_pendingNew) {
+        if (svc.router) { svc.router->close(); svc.router->deleteLater(); }
+    }
+    m_pendingNew.clear();
+    m_pendingNewLabels.clear();
+    m_requestCounts.clear();
+    m_onionAddress.clear();
+
+    qDebug() << "[TorBackend] suspended" << onions.size() << "services for account switch";
+    emit onionAddressesChanged();
+    emit requestCountsChanged();
+}
+
+void TorBackend::resumeAccountServices()
+{
+    if (!m_acct || !m_acct->isAuthenticated()) return;
+
+    const bool live = m_running && (m_ctl.state() == QAbstractSocket::ConnectedState);
+    if (m_acct->getTorIdentities().isEmpty())
+        ensureDefaultService();
+    else if (live)
+        sendAddOnionCmd();
+
+    if (!live) startIfAutoconnect();
+    emit onionAddressesChanged();
+}
+
 void TorBackend::reset()
 {
 
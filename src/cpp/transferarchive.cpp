@@ -0,0 +1,236 @@
+#include "win_compat.h"
+#include "transferarchive.h"
+#include "accountmanager.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+constexpr int kSegmentMaxEntries = 256;
+constexpr int kMaxPageSize       = 500;
+
+const QByteArray kIndexPurpose   = QByteArrayLiteral("transfer_archive/index/v1");
+const QByteArray kSegmentPurpose = QByteArrayLiteral("transfer_archive/segment/v1");
+
+QJsonObject summaryRow(const QString &ref, const QJsonObject &tr, int seg, qint64 now)
+{
+    return QJsonObject{
+        {"ref",          ref},
+        {"wallet_ref",   tr.value("wallet_ref").toString()},
+        {"wallet_name",  tr.value("wallet_name").toString()},
+        {"type",         tr.value("type").toString()},
+        {"stage",        tr.value("stage").toString()},
+        {"tx_id",        tr.value("tx_id").toString()},
+        {"created_at",   tr.value("created_at").toInteger()},
+        {"archived_at",  now},
+        {"recipient_count", tr.value("transfer_description").toObject()
+                                .value("recipients").toArray().size()},
+        {"seg",          seg}
+    };
+}
+}
+
+TransferArchive::TransferArchive(AccountManager *acct, QObject *parent)
+    : QObject(parent), m_acct(acct)
+{
+}
+
+QString TransferArchive::dir() const
+{
+    if (!m_acct) return {};
+    const QString base = m_acct->walletAccountDir();
+    return base.isEmpty() ? QString() : QDir(base).filePath("transfer_archive");
+}
+
+QString TransferArchive::segmentPath(int seg) const
+{
+    return QDir(dir()).filePath(QStringLiteral("seg_%1.bin").arg(seg, 6, 10, QChar('0')));
+}
+
+QString TransferArchive::indexPath() const
+{
+    return QDir(dir()).filePath("index.bin");
+}
+
+bool TransferArchive::writeSealed(const QString &path, const QByteArray &plain, const QByteArray &purpose)
+{
+    const QByteArray sealed = m_acct->sealForAccount(qCompress(plain, 9), purpose);
+    if (sealed.isEmpty()) return false;
+
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly)) return false;
+    out.write(sealed);
+    return out.commit();
+}
+
+bool TransferArchive::readSealed(const QString &path, const QByteArray &purpose, QByteArray &plainOut)
+{
+    QFile in(path);
+    if (!in.open(QIODevice::ReadOnly)) return false;
+    const QByteArray sealed = in.readAll();
+    in.close();
+
+    QByteArray packed;
+    if (!m_acct->openForAccount(sealed, purpose, packed)) return false;
+    plainOut = qUncompress(packed);
+    return !plainOut.isEmpty();
+}
+
+bool TransferArchive::ensureIndexLoaded()
+{
+    if (!m_acct || !m_acct->isAuthenticated()) return false;
+
+    const QString acct = m_acct->currentAccount();
+    if (m_loaded && m_loadedFor == acct) return true;
+
+    reset();
+
+    if (QFileInfo::exists(indexPath())) {
+        QByteArray plain;
+        if (!readSealed(indexPath(), kIndexPurpose, plain)) {
+            qWarning() << "[TransferArchive] index unreadable, archive unavailable";
+            return false;
+        }
+        const QJsonObject idx = QJsonDocument::fromJson(plain).object();
+        m_index   = idx.value("rows").toArray();
+        m_nextSeg = idx.value("next_seg").toInt(0);
+        for (const auto &v : std::as_const(m_index)) {
+            const QJsonObject r = v.toObject();
+            m_segOf.insert(r.value("ref").toString(), r.value("seg").toInt());
+        }
+    }
+
+    m_loaded    = true;
+    m_loadedFor = acct;
+    return true;
+}
+
+bool TransferArchive::append(const QList<QPair<QString, QJsonObject>> &entries)
+{
+    if (entries.isEmpty()) return true;
+    if (!ensureIndexLoaded()) return false;
+    if (!QDir().mkpath(dir())) return false;
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    QJsonArray rows  = m_index;
+    QHash<QString, int> segOf = m_segOf;
+    int nextSeg = m_nextSeg;
+
+    // Segments are written first; the index rewrite is the commit point, so a
+    // crash in between leaves only unreferenced segment files behind.
+    for (int i = 0; i < entries.size(); i += kSegmentMaxEntries) {
+        const int seg = nextSeg++;
+        QJsonObject body;
+        for (int j = i; j < qMin(i + kSegmentMaxEntries, int(entries.size())); ++j) {
+            const auto &e = entries.at(j);
+            if (segOf.contains(e.first)) continue;
+            body.insert(e.first, e.second);
+            rows.push_back(summaryRow(e.first, e.second, seg, now));
+            segOf.insert(e.first, seg);
+        }
+        if (body.isEmpty()) continue;
+        if (!writeSealed(segmentPath(seg), QJsonDocument(body).toJson(QJsonDocument::Compact), kSegmentPurpose))
+            return false;
+    }
+
+    QList<QJsonObject> sorted;
+    sorted.reserve(rows.size());
+    for (const auto &v : std::as_const(rows)) sorted.push_back(v.toObject());
+    std::sort(sorted.begin(), sorted.end(), [](const QJsonObject &a, const QJsonObject &b){
+        return a.value("created_at").toInteger() > b.value("created_at").toInteger();
+    });
+    QJsonArray sortedRows;
+    for (const auto &o : std::as_const(sorted)) sortedRows.push_back(o);
+
+    const QJsonObject idx{ {"version", 1}, {"next_seg", nextSeg}, {"rows", sortedRows} };
+    if (!writeSealed(indexPath(), QJsonDocument(idx).toJson(QJsonDocument::Compact), kIndexPurpose))
+        return false;
+
+    m_index   = sortedRows;
+    m_segOf   = segOf;
+    m_nextSeg = nextSeg;
+    emit archiveChanged();
+    return true;
+}
+
+int TransferArchive::count(const QString &walletRef)
+{
+    if (!ensureIndexLoaded()) return 0;
+    if (walletRef.isEmpty()) return m_index.size();
+
+    int n = 0;
+    for (const auto &v : std::as_const(m_index))
+        if (v.toObject().value("wallet_ref").toString() == walletRef) ++n;
+    return n;
+}
+
+QVariantList TransferArchive::page(int offset, int limit, const QString &walletRef)
+{
+    QVariantList out;
+    if (!ensureIndexLoaded()) return out;
+
+    offset = qMax(0, offset);
+    limit  = qBound(1, limit, kMaxPageSize);
+
+    int skipped = 0;
+    for (const auto &v : std::as_const(m_index)) {
+        const QJsonObject r = v.toObject();
+        if (!walletRef.isEmpty() && r.value("wallet_ref").toString() != walletRef) continue;
+        if (skipped++ < offset) continue;
+        out.push_back(r.toVariantMap());
+        if (out.size() >= limit) break;
+    }
+    return out;
+}
+
+bool TransferArchive::contains(const QString &ref)
+{
+    return ensureIndexLoaded() && m_segOf.contains(ref);
+}
+
+bool TransferArchive::remove(const QString &ref)
+{
+    if (!ensureIndexLoaded() || !m_segOf.contains(ref)) return false;
+
+    QJsonArray rows;
+    for (const auto &v : std::as_const(m_index))
+        if (v.toObject().value("ref").toString() != ref) rows.push_back(v);
+
+    const QJsonObject idx{ {"version", 1}, {"next_seg", m_nextSeg}, {"rows", rows} };
+    if (!writeSealed(indexPath(), QJsonDocument(idx).toJson(QJsonDocument::Compact), kIndexPurpose))
+        return false;
+
+    m_index = rows;
+    m_segOf.remove(ref);
+    emit archiveChanged();
+    return true;
+}
+
+QJsonObject TransferArchive::entry(const QString &ref)
+{
+    if (!ensureIndexLoaded()) return {};
+    auto it = m_segOf.constFind(ref);
+    if (it == m_segOf.cend()) return {};
+
+    QByteArray plain;
+    if (!readSealed(segmentPath(it.value()), kSegmentPurpose, plain)) {
+        qWarning() << "[TransferArchive] segment" << it.value() << "unreadable";
+        return {};
+    }
+    return QJsonDocument::fromJson(plain).object().value(ref).toObject();
+}
+
+void TransferArchive::reset()
+{
+    m_loaded = false;
+    m_loadedFor.clear();
+    m_index = QJsonArray();
+    m_segOf.clear();
+    m_nextSeg = 0;
+}
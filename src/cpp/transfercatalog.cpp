@@ -0,0 +1,414 @@
+#include "win_compat.h"
+#include "transfercatalog.h"
+#include "accountmanager.h"
+
+#include <QJsonArray>
+#include <QVariant>
+#include <QDebug>
+
+TransferCatalog::TransferCatalog(AccountManager *acct, QObject *parent)
+    : QObject(parent), m_acct(acct)
+{
+    Q_ASSERT(acct);
+
+    connect(m_acct, &AccountManager::isAuthenticatedChanged, this, [this](){
+        if (m_acct->isAuthenticated()) rebuild();
+        else                           clear();
+    });
+    connect(m_acct, &AccountManager::accountDataChanged, this, &TransferCatalog::sync);
+}
+
+TransferCatalog *TransferCatalog::of(const QObject *holder)
+{
+    if (!holder) return nullptr;
+    return qobject_cast<TransferCatalog*>(holder->property("transferCatalog").value<QObject*>());
+}
+
+QString TransferCatalog::normOnion(QString s)
+{
+    s = s.trimmed().toLower();
+    if (!s.isEmpty() && !s.endsWith(".onion")) s.append(".onion");
+    return s;
+}
+
+QString TransferCatalog::walletKey(const QString &ref, const QString &onion)
+{
+    return ref.trimmed().toLower() + QLatin1Char('|') + normOnion(onion);
+}
+
+void TransferCatalog::scanWallet(const QJsonObject &w, QHash<QString, Entry> &out)
+{
+    const QString wref   = w.value("reference").toString();
+    const QString wname  = w.value("name").toString();
+    const QString wonion = normOnion(w.value("my_onion").toString());
+
+    const QJsonObject transfers = w.value("transfers").toObject();
+    for (auto it = transfers.begin(); it != transfers.end(); ++it) {
+        Entry e;
+        e.data        = it.value().toObject();
+        e.walletRef   = wref;
+        e.walletName  = wname;
+        e.walletOnion = wonion.isEmpty() ? normOnion(e.data.value("my_onion").toString()) : wonion;
+        e.stage       = e.data.value("stage").toString();
+        e.createdAt   = e.data.value("created_at").toVariant().toLongLong();
+        out.insert(it.key(), e);
+    }
+}
+
+void TransferCatalog::indexLocked(const QString &ref, const Entry &e)
+{
+    m_byRef.insert(ref, e);
+    m_byWallet[walletKey(e.walletRef, e.walletOnion)].insert(ref);
+    m_byStage[e.stage].insert(ref);
+    m_byCreated.insert(e.createdAt, ref);
+}
+
+void TransferCatalog::unindexLocked(const QString &ref, const Entry &e)
+{
+    m_byRef.remove(ref);
+
+    const QString wk = walletKey(e.walletRef, e.walletOnion);
+    auto wit = m_byWallet.find(wk);
+    if (wit != m_byWallet.end()) { wit->remove(ref); if (wit->isEmpty()) m_byWallet.erase(wit); }
+
+    auto sit = m_byStage.find(e.stage);
+    if (sit != m_byStage.end()) { sit->remove(ref); if (sit->isEmpty()) m_byStage.erase(sit); }
+
+    m_byCreated.remove(e.createdAt, ref);
+}
+
+void TransferCatalog::rebuild()
+{
+    const QJsonArray wallets = m_acct->accountObject().value("monero").toObject().value("wallets").toArray();
+    int n = 0;
+    {
+        QWriteLocker locker(&m_lock);
+        m_byRef.clear(); m_byWallet.clear(); m_byStage.clear(); m_byCreated.clear();
+        m_walletNames.clear(); m_wallets.clear();
+        for (const auto &wv : wallets) {
+            const QJsonObject w = wv.toObject();
+            const QString key = walletKey(w.value("reference").toString(), w.value("my_onion").toString());
+            m_walletNames.insert(key, w.value("name").toString());
+            m_wallets.insert(key, {w.value("name").toString(), w.value("transfers").toObject()});
+
+            QHash<QString, Entry> fresh;
+            scanWallet(w, fresh);
+            for (auto it = fresh.cbegin(); it != fresh.cend(); ++it)
+                indexLocked(it.key(), it.value());
+        }
+        n = m_byRef.size();
+    }
+    qDebug().noquote() << "[TransferCatalog] built with" << n << "transfers";
+    emit catalogReset();
+}
+
+// fresh: every transfer now held by the wallets being diffed.
+// candidates: refs those wallets held before.
+void TransferCatalog::applyLocked(const QHash<QString, Entry> &fresh, const QSet<QString> &candidates,
+                                  QList<Change> &changes)
+{
+    for (const QString &ref : candidates) {
+        if (fresh.contains(ref)) continue;
+        auto old = m_byRef.constFind(ref);
+        if (old == m_byRef.cend()) continue;
+        changes.push_back({Change::Removed, ref, old->stage, {}});
+        unindexLocked(ref, *old);
+    }
+
+    for (auto it = fresh.cbegin(); it != fresh.cend(); ++it) {
+        auto old = m_byRef.constFind(it.key());
+        if (old == m_byRef.cend()) {
+            indexLocked(it.key(), it.value());
+            changes.push_back({Change::Added, it.key(), {}, it.value().stage});
+            continue;
+        }
+        if (old->data == it.value().data && old->walletRef == it.value().walletRef &&
+            old->walletName == it.value().walletName) continue;
+
+        const QString oldStage = old->stage;
+        unindexLocked(it.key(), *old);
+        indexLocked(it.key(), it.value());
+        changes.push_back({Change::Updated, it.key(), oldStage, it.value().stage});
+    }
+}
+
+void TransferCatalog::emitChanges(const QList<Change> &changes)
+{
+    for (const auto &c : changes) {
+        switch (c.kind) {
+        case Change::Added:   emit transferAdded(c.ref); break;
+        case Change::Removed: emit transferRemoved(c.ref); break;
+        case Change::Updated:
+            emit transferUpdated(c.ref);
+            if (c.oldStage != c.newStage) emit stageChanged(c.ref, c.oldStage, c.newStage);
+            break;
+        }
+    }
+}
+
+// Saves not made by the catalog. Untouched wallets still share their
+// transfers object with the last snapshot, so comparing them is a pointer
+// check; only wallets that differ are rescanned.
+void TransferCatalog::sync()
+{
+    if (m_saving || !m_acct->isAuthenticated()) return;
+
+    const QJsonArray wallets = m_acct->accountObject().value("monero").toObject().value("wallets").toArray();
+    QList<Change> changes;
+    {
+        QWriteLocker locker(&m_lock);
+        QHash<QString, WalletSnap> seen;
+        QHash<QString, Entry> fresh;
+        QSet<QString> candidates;
+
+        for (const auto &wv : wallets) {
+            const QJsonObject w = wv.toObject();
+            const QString key = walletKey(w.value("reference").toString(), w.value("my_onion").toString());
+            const WalletSnap now{ w.value("name").toString(), w.value("transfers").toObject() };
+
+            auto old = m_wallets.constFind(key);
+            if (old != m_wallets.cend() && !seen.contains(key) &&
+                old->name == now.name && old->transfers == now.transfers) {
+                seen.insert(key, now);   // share the new document's data from here on
+                continue;
+            }
+            if (old != m_wallets.cend())
+                for (auto it = old->transfers.begin(); it != old->transfers.end(); ++it)
+                    candidates.insert(it.key());
+            scanWallet(w, fresh);
+            seen.insert(key, now);
+        }
+
+        for (auto it = m_wallets.cbegin(); it != m_wallets.cend(); ++it) {
+            if (seen.contains(it.key())) continue;
+            for (auto t = it->transfers.begin(); t != it->transfers.end(); ++t)
+                candidates.insert(t.key());
+        }
+
+        m_walletNames.clear();
+        for (auto it = seen.cbegin(); it != seen.cend(); ++it)
+            m_walletNames.insert(it.key(), it->name);
+        m_wallets = seen;
+
+        applyLocked(fresh, candidates, changes);
+    }
+    emitChanges(changes);
+}
+
+bool TransferCatalog::saveOwn(const QJsonObject &root)
+{
+    m_saving = true;
+    const bool ok = m_acct->saveAccountObject(root);
+    m_saving = false;
+    return ok;
+}
+
+void TransferCatalog::clear()
+{
+    {
+        QWriteLocker locker(&m_lock);
+        m_byRef.clear(); m_byWallet.clear(); m_byStage.clear(); m_byCreated.clear();
+        m_walletNames.clear(); m_wallets.clear();
+    }
+    emit catalogReset();
+}
+
+bool TransferCatalog::contains(const QString &ref) const
+{
+    QReadLocker locker(&m_lock);
+    return m_byRef.contains(ref);
+}
+
+QJsonObject TransferCatalog::transfer(const QString &ref) const
+{
+    QReadLocker locker(&m_lock);
+    auto it = m_byRef.constFind(ref);
+    return it == m_byRef.cend() ? QJsonObject{} : it->data;
+}
+
+QString TransferCatalog::walletRefOf(const QString &ref) const
+{
+    QReadLocker locker(&m_lock);
+    return m_byRef.value(ref).walletRef;
+}
+
+QString TransferCatalog::walletNameOf(const QString &ref) const
+{
+    QReadLocker locker(&m_lock);
+    return m_byRef.value(ref).walletName;
+}
+
+QString TransferCatalog::walletOnionOf(const QString &ref) const
+{
+    QReadLocker locker(&m_lock);
+    return m_byRef.value(ref).walletOnion;
+}
+
+QStringList TransferCatalog::refsForWallet(const QString &walletRef, const QString &onion) const
+{
+    QReadLocker locker(&m_lock);
+    if (!onion.isEmpty()) {
+        const QSet<QString> s = m_byWallet.value(walletKey(walletRef, onion));
+        return QStringList(s.cbegin(), s.cend());
+    }
+    QStringList out;
+    const QString prefix = walletRef.trimmed().toLower() + QLatin1Char('|');
+    for (auto it = m_byWallet.cbegin(); it != m_byWallet.cend(); ++it)
+        if (it.key().startsWith(prefix))
+            for (const QString &r : it.value()) out << r;
+    return out;
+}
+
+QStringList TransferCatalog::refsInStage(const QString &stage) const
+{
+    QReadLocker locker(&m_lock);
+    const QSet<QString> s = m_byStage.value(stage);
+    return QStringList(s.cbegin(), s.cend());
+}
+
+QStringList TransferCatalog::refsNewestFirst() const
+{
+    QReadLocker locker(&m_lock);
+    QStringList out;
+    out.reserve(m_byCreated.size());
+    for (auto it = m_byCreated.cend(); it != m_byCreated.cbegin(); ) {
+        --it;
+        out << it.value();
+    }
+    return out;
+}
+
+QStringList TransferCatalog::allRefs() const
+{
+    QReadLocker locker(&m_lock);
+    return m_byRef.keys();
+}
+
+int TransferCatalog::size() const
+{
+    QReadLocker locker(&m_lock);
+    return m_byRef.size();
+}
+
+QString TransferCatalog::walletNameForRefOnion(const QString &walletRef, const QString &onion) const
+{
+    QReadLocker locker(&m_lock);
+    if (!onion.isEmpty()) return m_walletNames.value(walletKey(walletRef, onion));
+
+    const QString prefix = walletRef.trimmed().toLower() + QLatin1Char('|');
+    for (auto it = m_walletNames.cbegin(); it != m_walletNames.cend(); ++it)
+        if (it.key().startsWith(prefix)) return it.value();
+    return {};
+}
+
+bool TransferCatalog::upsert(const QString &walletRef, const QString &walletName, const QString &onion,
+                             const QString &ref, const QJsonObject &entry)
+{
+    QJsonObject root    = m_acct->accountObject();
+    QJsonObject monero  = root.value("monero").toObject();
+    QJsonArray  wallets = monero.value("wallets").toArray();
+
+    const QString wantOnion = normOnion(onion);
+    int idx = -1;
+    if (!walletRef.isEmpty() && !wantOnion.isEmpty()) {
+        for (int i = 0; i < wallets.size() && idx < 0; ++i) {
+            const QJsonObject w = wallets.at(i).toObject();
+            if (w.value("reference").toString() == walletRef &&
+                normOnion(w.value("my_onion").toString()) == wantOnion) idx = i;
+        }
+    }
+    for (int i = 0; i < wallets.size() && idx < 0; ++i) {
+        const QJsonObject w = wallets.at(i).toObject();
+        if ((!walletRef.isEmpty()  && w.value("reference").toString() == walletRef) ||
+            (!walletName.isEmpty() && w.value("name").toString()      == walletName)) idx = i;
+    }
+    if (idx < 0) return false;
+
+    QJsonObject w = wallets.at(idx).toObject();
+    QJsonObject transfers = w.value("transfers").toObject();
+    transfers.insert(ref, entry);
+    w.insert("transfers", transfers);
+    wallets[idx] = w;
+    monero.insert("wallets", wallets);
+    root.insert("monero", monero);
+
+    if (!saveOwn(root)) return false;
+
+    QHash<QString, Entry> fresh;
+    scanWallet(QJsonObject{ {"reference", w.value("reference")}, {"name", w.value("name")},
+                            {"my_onion", w.value("my_onion")}, {"transfers", QJsonObject{{ref, entry}}} },
+               fresh);
+    QList<Change> changes;
+    {
+        QWriteLocker locker(&m_lock);
+        const QString key = walletKey(w.value("reference").toString(), w.value("my_onion").toString());
+        m_wallets[key] = { w.value("name").toString(), transfers };
+        m_walletNames.insert(key, w.value("name").toString());
+        applyLocked(fresh, {}, changes);
+    }
+    emitChanges(changes);
+    return true;
+}
+
+bool TransferCatalog::remove(const QString &ref)
+{
+    return apply({}, QStringList{ ref });
+}
+
+bool TransferCatalog::apply(const QHash<QString, QJsonObject> &updates, const QStringList &removals)
+{
+    QJsonObject root    = m_acct->accountObject();
+    QJsonObject monero  = root.value("monero").toObject();
+    QJsonArray  wallets = monero.value("wallets").toArray();
+
+    QHash<QString, Entry> fresh;
+    QSet<QString> candidates;
+    QHash<QString, WalletSnap> snaps;
+    bool touched = false;
+
+    for (int i = 0; i < wallets.size(); ++i) {
+        QJsonObject w = wallets.at(i).toObject();
+        QJsonObject transfers = w.value("transfers").toObject();
+        bool changed = false;
+
+        for (const QString &ref : removals) {
+            if (!transfers.contains(ref)) continue;
+            transfers.remove(ref);
+            candidates.insert(ref);
+            changed = true;
+        }
+        QJsonObject upd;
+        for (auto it = updates.cbegin(); it != updates.cend(); ++it) {
+            if (!transfers.contains(it.key())) continue;
+            transfers.insert(it.key(), it.value());
+            upd.insert(it.key(), it.value());
+            changed = true;
+        }
+        if (!changed) continue;
+
+        w.insert("transfers", transfers);
+        wallets[i] = w;
+        touched = true;
+
+        QJsonObject partial = w;
+        partial.insert("transfers", upd);
+        scanWallet(partial, fresh);
+        snaps.insert(walletKey(w.value("reference").toString(), w.value("my_onion").toString()),
+                     { w.value("name").toString(), transfers });
+    }
+    if (!touched) return false;
+
+    monero.insert("wallets", wallets);
+    root.insert("monero", monero);
+    if (!saveOwn(root)) return false;
+
+    QList<Change> changes;
+    {
+        QWriteLocker locker(&m_lock);
+        for (auto it = snaps.cbegin(); it != snaps.cend(); ++it)
+            m_wallets.insert(it.key(), it.value());
+        applyLocked(fresh, candidates, changes);
+    }
+    emitChanges(changes);
+    return true;
+}
@@ -0,0 +1,279 @@
+#include "win_compat.h"
+#include "transferhistorymodel.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+constexpr int     kPageSize   = 200;
+constexpr quint64 kHeadWindow = 20;   // covers the 10-block lock and shallow reorgs
+
+bool sameRow(const TransferRow &a, const TransferRow &b)
+{
+    return a.txid == b.txid && a.direction == b.direction && a.amount == b.amount &&
+           a.fee == b.fee && a.height == b.height && a.timestamp == b.timestamp &&
+           a.unlocked == b.unlocked && a.address == b.address &&
+           a.subaddrMajor == b.subaddrMajor && a.subaddrMinor == b.subaddrMinor;
+}
+}
+
+TransferHistoryModel::TransferHistoryModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void TransferHistoryModel::setWallet(QObject *w)
+{
+    Wallet *next = qobject_cast<Wallet*>(w);
+    if (next == m_wallet) return;
+
+    if (m_wallet) disconnect(m_wallet, nullptr, this, nullptr);
+    m_wallet = next;
+    if (m_wallet) {
+        connect(m_wallet, &Wallet::transferPageReady, this, &TransferHistoryModel::onPage);
+        connect(m_wallet, &Wallet::snapshotChanged,   this, &TransferHistoryModel::onSnapshot);
+    }
+    emit walletChanged();
+    reload();
+}
+
+void TransferHistoryModel::setDirectionFilter(const QString &f)
+{
+    const QString next = f.isEmpty() ? QStringLiteral("All") : f;
+    if (next == m_filter) return;
+    m_filter = next;
+    emit directionFilterChanged();
+    syncView(true);
+}
+
+void TransferHistoryModel::reload()
+{
+    m_caller = QStringLiteral("history/%1/%2")
+                   .arg(quintptr(this), 0, 16).arg(++m_generation);
+    m_all.clear();
+    m_cursor      = kNoCursor;
+    m_headHeight  = 0;
+    m_hasMore     = false;
+    m_loaded      = false;
+    m_headPending = false;
+    m_pagePending = false;
+    syncView(true);
+
+    // Until the wallet is open the first page waits for its first snapshot.
+    if (m_wallet && m_wallet->snapshotReady()) {
+        m_pagePending = true;
+        m_wallet->getTransferPage(0, kNoCursor, kPageSize, m_caller + QStringLiteral("/page"));
+    }
+    emit loadingChanged();
+}
+
+void TransferHistoryModel::requestHead()
+{
+    if (!m_wallet || !m_wallet->snapshotReady() || !m_loaded || m_headPending) return;
+
+    const quint64 since = m_headHeight > kHeadWindow ? m_headHeight - kHeadWindow : 0;
+    m_headPending = true;
+    m_wallet->getTransferPage(since, kNoCursor, 0, m_caller + QStringLiteral("/head"));
+    emit loadingChanged();
+}
+
+void TransferHistoryModel::onSnapshot()
+{
+    if (!m_wallet || !m_wallet->snapshotReady()) return;
+    if (!m_loaded) {
+        if (!m_pagePending) reload();
+        return;
+    }
+    // Refresh, imports and commits all republish; any of them can add rows
+    // near the tip or in the pool.
+    requestHead();
+}
+
+bool TransferHistoryModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_wallet && m_loaded && m_hasMore && !m_pagePending;
+}
+
+void TransferHistoryModel::fetchMore(const QModelIndex &parent)
+{
+    if (!canFetchMore(parent)) return;
+    m_pagePending = true;
+    m_wallet->getTransferPage(0, m_cursor, kPageSize, m_caller + QStringLiteral("/page"));
+    emit loadingChanged();
+}
+
+void TransferHistoryModel::onPage(const QString &caller, quint64 sinceHeight, quint64 belowHeight,
+                                  quint64 chainHeight, const QVector<TransferRow> &rows, bool more)
+{
+    if (!caller.startsWith(m_caller + QLatin1Char('/'))) return;
+    const bool head = caller.endsWith(QStringLiteral("/head"));
+
+    if (head) {
+        m_headPending = false;
+        // The head fetch is authoritative for the pool and everything above sinceHeight.
+        m_all.erase(std::remove_if(m_all.begin(), m_all.end(), [sinceHeight](const TransferRow &r) {
+                        return r.height == 0 || r.height > sinceHeight;
+                    }), m_all.end());
+        m_all += rows;
+        m_cursor = std::min(m_cursor, sinceHeight + 1);
+    } else {
+        m_pagePending = false;
+        if (belowHeight == kNoCursor)
+            m_all.erase(std::remove_if(m_all.begin(), m_all.end(),
+                                       [](const TransferRow &r) { return r.height == 0; }), m_all.end());
+        m_all += rows;
+
+        quint64 lowest = kNoCursor;
+        for (const auto &r : rows)
+            if (r.height > 0) lowest = std::min(lowest, r.height);
+        m_hasMore = more;
+        m_cursor  = more ? std::min(m_cursor, lowest) : 0;
+        m_loaded  = true;
+    }
+    if (head || belowHeight == kNoCursor) m_headHeight = chainHeight;
+
+    std::sort(m_all.begin(), m_all.end(), &TransferHistoryModel::before);
+    // A head and a page fetch in flight together can both carry the same rows.
+    m_all.erase(std::unique(m_all.begin(), m_all.end(), [](const TransferRow &a, const TransferRow &b) {
+                    return a.txid == b.txid && a.direction == b.direction;
+                }), m_all.end());
+    setChainHeight(chainHeight);
+    syncView();
+    emit loadingChanged();
+}
+
+bool TransferHistoryModel::before(const TransferRow &a, const TransferRow &b)
+{
+    const bool pa = a.height == 0, pb = b.height == 0;
+    if (pa != pb) return pa;
+    if (a.height != b.height) return a.height > b.height;
+    if (a.timestamp != b.timestamp) return a.timestamp > b.timestamp;
+    if (a.txid != b.txid) return a.txid < b.txid;
+    return a.direction < b.direction;
+}
+
+bool TransferHistoryModel::accepts(const TransferRow &r) const
+{
+    if (m_filter == QLatin1String("Incoming")) return r.direction == QLatin1String("in");
+    if (m_filter == QLatin1String("Outgoing")) return r.direction == QLatin1String("out");
+    if (m_filter == QLatin1String("Pending"))  return r.height == 0;
+    return true;
+}
+
+void TransferHistoryModel::setChainHeight(quint64 h)
+{
+    if (h == m_chainHeight) return;
+    m_chainHeight = h;
+    emit chainHeightChanged();
+    if (!m_view.isEmpty())
+        emit dataChanged(index(0), index(m_view.size() - 1), {ConfirmationsRole});
+}
+
+// Walks the current view and the freshly filtered rows in sort order and
+// turns the difference into runs of removes, inserts and changed rows.
+void TransferHistoryModel::syncView(bool reset)
+{
+    QVector<TransferRow> next;
+    next.reserve(m_all.size());
+    for (const auto &r : std::as_const(m_all))
+        if (accepts(r)) next.append(r);
+
+    const int oldCount = m_view.size();
+    if (reset || m_view.isEmpty() || next.isEmpty()) {
+        beginResetModel();
+        m_view = std::move(next);
+        endResetModel();
+        if (m_view.size() != oldCount) emit countChanged();
+        return;
+    }
+
+    int i = 0, j = 0;
+    while (i < m_view.size() || j < next.size()) {
+        if (j >= next.size() || (i < m_view.size() && before(m_view[i], next[j]))) {
+            int end = i;
+            while (end < m_view.size() && (j >= next.size() || before(m_view[end], next[j]))) ++end;
+            beginRemoveRows({}, i, end - 1);
+            m_view.remove(i, end - i);
+            endRemoveRows();
+            continue;
+        }
+        if (i >= m_view.size() || before(next[j], m_view[i])) {
+            int end = j;
+            while (end < next.size() && (i >= m_view.size() || before(next[end], m_view[i]))) ++end;
+            beginInsertRows({}, i, i + (end - j) - 1);
+            for (int k = j; k < end; ++k) m_view.insert(i + (k - j), next[k]);
+            endInsertRows();
+            i += end - j;
+            j  = end;
+            continue;
+        }
+        if (!sameRow(m_view[i], next[j])) {
+            m_view[i] = next[j];
+            emit dataChanged(index(i), index(i));
+        }
+        ++i; ++j;
+    }
+    if (m_view.size() != oldCount) emit countChanged();
+}
+
+int TransferHistoryModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_view.size();
+}
+
+QVariant TransferHistoryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_view.size()) return {};
+    const TransferRow &r = m_view.at(index.row());
+
+    switch (role) {
+    case TxidRole:          return r.txid;
+    case PaymentIdRole:     return r.paymentId;
+    case DirectionRole:     return r.direction;
+    case AmountRole:        return static_cast<qulonglong>(r.amount);
+    case FeeRole:           return static_cast<qulonglong>(r.fee);
+    case BlockHeightRole:   return static_cast<qulonglong>(r.height);
+    case ConfirmationsRole:
+        return static_cast<qulonglong>(r.height == 0 || r.height >= m_chainHeight ? 0 : m_chainHeight - r.height);
+    case UnlockedRole:      return r.unlocked;
+    case TimestampRole:     return static_cast<qulonglong>(r.timestamp);
+    case SubaddrMajorRole:  return static_cast<int>(r.subaddrMajor);
+    case SubaddrMinorRole:  return static_cast<int>(r.subaddrMinor);
+    case AddressRole:       return r.address;
+    case SectionRole:
+        if (r.timestamp)
+            return QDateTime::fromSecsSinceEpoch(qint64(r.timestamp)).toString(QStringLiteral("yyyy-MM"));
+        return r.height == 0 ? tr("Pending") : tr("Unknown date");
+    }
+    return {};
+}
+
+QHash<int, QByteArray> TransferHistoryModel::roleNames() const
+{
+    return {
+        { TxidRole,          "txid" },
+        { PaymentIdRole,     "payment_id" },
+        { DirectionRole,     "direction" },
+        { AmountRole,        "amount" },
+        { FeeRole,           "fee" },
+        { BlockHeightRole,   "blockHeight" },
+        { ConfirmationsRole, "confirmations" },
+        { UnlockedRole,      "unlocked" },
+        { TimestampRole,     "timestamp" },
+        { SubaddrMajorRole,  "subaddr_major" },
+        { SubaddrMinorRole,  "subaddr_minor" },
+        { AddressRole,       "address" },
+        { SectionRole,       "section" },
+    };
+}
+
+QVariantMap TransferHistoryModel::get(int row) const
+{
+    QVariantMap out;
+    if (row < 0 || row >= m_view.size()) return out;
+    const QHash<int, QByteArray> names = roleNames();
+    for (auto it = names.cbegin(); it != names.cend(); ++it)
+        out.insert(QString::fromLatin1(it.value()), data(index(row), it.key()));
+    return out;
+}
@@ -4,6 +4,10 @@
 #include "torbackend.h"
 #include "wallet.h"
 #include "accountmanager.h"
+#include "transfercatalog.h"
+#include "blobstore.h"
+#include "multisigimportsession.h"
+#include "peerlatency.h"
 #include "cryptoutils_extras.h"
 
 #include <QNetworkAccessManager>
@@ -17,6 +21,7 @@
 #include <QJsonDocument>
 #include <QJsonArray>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QCryptographicHash>
 #include <QMetaObject>
 #include <QtGlobal>
@@ -31,6 +36,12 @@ using namespace CryptoUtils;
 namespace {
 static constexpr int PING_MS  = 5'000;
 static constexpr int RETRY_MS = 5'000;
+static constexpr int FANOUT_WIDTH      = 3;    // candidates probed at once
+static constexpr int FANOUT_FRESH_SECS = 10;   // a ready answer this recent counts
+// Wallet results are routed by operation_caller; each step may run more
+// than once per transfer (warm start fallback, retries) but connects once.
+static constexpr Qt::ConnectionType kQueuedUnique =
+    static_cast<Qt::ConnectionType>(Qt::QueuedConnection | Qt::UniqueConnection);
 
 static QString stageName(TransferInitiator::Stage s)
 {
@@ -255,12 +266,19 @@ TransferInitiator::TransferInitiator(MultiWalletController *wm,
     }
 
 
-    connect(this, &TransferInitiator::_httpResult, this, [this](QString onion, QString path, QJsonObject res, QString err){
-        if (!m_peers.contains(onion)) return;
+    connect(this, &TransferInitiator::_httpResult, this, [this](QString onion, QString path, QJsonObject res, QString err, qint64 rttMs){
+        if (m_stopFlag || !m_peers.contains(onion)) return;
         auto &peer = m_peers[onion];
 
-        if (!err.isEmpty() || res.contains("error")) {
+        const bool failed = !err.isEmpty() || res.contains("error");
+        if (auto *latency = PeerLatency::of(m_wm)) latency->record(onion, !failed, rttMs);
+
+        if (failed) {
             peer.online = false;
+            // The txset may have landed before the error; the peer stays the
+            // holder until it says otherwise, see confirmOffer().
+            if (onion == m_offeredTo && path.startsWith("/api/multisig/transfer/submit"))
+                m_offerUnconfirmed = true;
             emit peerStatusChanged();
             return;
         }
@@ -271,6 +289,7 @@ TransferInitiator::TransferInitiator(MultiWalletController *wm,
             if (peer.online) peer.lastSeen = QDateTime::currentSecsSinceEpoch();
             emit peerStatusChanged();
             if (m_stage == Stage::CHECKING_PEERS) checkPeersOnline();
+            if (m_stage == Stage::SUBMITTING && fanOut() && peer.online && peer.ready) offerToFastest();
             return;
         }
 
@@ -292,14 +311,17 @@ TransferInitiator::TransferInitiator(MultiWalletController *wm,
         }
 
         if (path.startsWith("/api/multisig/transfer/submit")) {
-            if (res.value("success").toBool(false)) {
-                setStage(Stage::CHECKING_STATUS, QString("Created transfer and submitted to peer"));
-                const qint64 submittedTs = QDateTime::currentSecsSinceEpoch();
-                m_submittedAt = submittedTs;
-                saveToAccount();
-                emit submittedSuccessfully(m_transferRef);
-                stop(QStringLiteral("success"));
+            if (!res.value("success").toBool(false)) {
+                if (onion == m_offeredTo) { m_offeredTo.clear(); m_offerUnconfirmed = false; }
+                return;
             }
+            if (onion == m_offeredTo) m_signingOrder = m_offeredOrder;
+            setStage(Stage::CHECKING_STATUS, QString("Created transfer and submitted to peer"));
+            const qint64 submittedTs = QDateTime::currentSecsSinceEpoch();
+            m_submittedAt = submittedTs;
+            saveToAccount();
+            emit submittedSuccessfully(m_transferRef);
+            stop(QStringLiteral("success"));
             return;
         }
 
@@ -310,6 +332,15 @@ TransferInitiator::TransferInitiator(MultiWalletController *wm,
             const QString tx = res.value("tx_id").toString();
             if (!tx.isEmpty() && tx != "pending") m_txId = tx;
             emit peerStatusChanged();
+            if (m_stage == Stage::SUBMITTING && m_offerUnconfirmed && onion == m_offeredTo) {
+                m_offerUnconfirmed = false;
+                if (peer.receivedTransfer) {
+                    submitTo(onion, m_offeredOrder);   // keyed by transfer_ref, a resend is safe
+                } else {
+                    m_offeredTo.clear();
+                    offerToFastest();
+                }
+            }
             return;
         }
     }, Qt::QueuedConnection);
@@ -343,6 +374,34 @@ void TransferInitiator::cancel()
     stop(QStringLiteral("abort"));
 }
 
+void TransferInitiator::park()
+{
+    if (m_stopFlag) return;
+    m_stopFlag = true;
+    m_ping.stop();
+    m_retry.stop();
+    m_httpPool.clear();
+}
+
+TransferInitiator *TransferInitiator::restarted(QObject *parent) const
+{
+    if (m_stage >= Stage::SUBMITTING) return nullptr;
+
+    QStringList peers = m_peers.keys();
+    peers << m_myOnionSelected;
+    return new TransferInitiator(m_wm, m_tor, m_transferRef, m_walletRef,
+                                 m_destinationsInit, peers, m_signingOrder,
+                                 m_threshold, m_feePriority, m_feeSplit,
+                                 m_inspectBeforeSend, m_myOnionSelected, parent);
+}
+
+void TransferInitiator::deleteWhenIdle()
+{
+    m_httpPool.clear();
+    if (m_httpPool.activeThreadCount() == 0) { deleteLater(); return; }
+    QTimer::singleShot(250, this, &TransferInitiator::deleteWhenIdle);
+}
+
 void TransferInitiator::pingRound()
 {
     if (m_stopFlag) return;
@@ -370,6 +429,16 @@ void TransferInitiator::checkPeersOnline()
                            std::all_of(m_peers.cbegin(), m_peers.cend(),
                                        [](const PeerState &p){ return p.online && p.ready; }));
     if (!allReady) return;
+
+    // The import session already holds every cosigner's current info.
+    const MultisigImportSession *warm = MultisigImportSession::of(m_wm);
+    if (!m_warmTried && warm && warm->readyToSpend(m_walletName)) {
+        m_warmTried = m_warmStart = true;
+        setStage(Stage::CREATING_TRANSFER, QStringLiteral("Creating multisig transfer..."));
+        createMultisigTransfer();
+        return;
+    }
+
     setStage(Stage::COLLECTING_INFO, QStringLiteral("Collecting multisig info from peers..."));
     pollMultisigInfo();
 }
@@ -404,7 +473,7 @@ void TransferInitiator::createOwnMultisigInfo()
 
     connect(w, &Wallet::multisigInfoPrepared,
             this, &TransferInitiator::onMultisigInfoPrepared,
-            Qt::QueuedConnection);
+            kQueuedUnique);
 
 
     w->prepareMultisigInfo(m_transferRef);
@@ -429,7 +498,7 @@ void TransferInitiator::importAllMultisigInfos()
 
     connect(w, &Wallet::multisigInfosImported,
             this, &TransferInitiator::onMultisigInfosImported,
-            Qt::QueuedConnection);
+            kQueuedUnique);
 
     w->importMultisigInfosBulk(infos,m_transferRef);
 }
@@ -450,11 +519,11 @@ void TransferInitiator::createMultisigTransfer()
 
     connect(w, &Wallet::unsignedMultisigReady,
             this, &TransferInitiator::onUnsignedMultisigReady,
-            Qt::QueuedConnection);
+            kQueuedUnique);
 
     connect(w, &Wallet::errorOccurred,
             this, &TransferInitiator::onErrorOccurred,
-            Qt::QueuedConnection);
+            kQueuedUnique);
 
     QVariantList dest = destinationsToVariantList(m_destinations);
 
@@ -469,6 +538,15 @@ void TransferInitiator::onErrorOccurred(QString error , QString operation_caller
 {
     if (operation_caller!= m_transferRef ) return;
 
+    if (m_warmStart && m_stage == Stage::CREATING_TRANSFER) {
+        // Readiness was stale after all; take the full path once.
+        qDebug().noquote() << "[TransferInitiator] warm start failed:" << error;
+        m_warmStart = false;
+        setStage(Stage::COLLECTING_INFO, QStringLiteral("Collecting multisig info from peers..."));
+        pollMultisigInfo();
+        return;
+    }
+
     setStage(Stage::ERROR, error);
     saveToAccount();
     stop("error");
@@ -482,6 +560,7 @@ void TransferInitiator::onUnsignedMultisigReady(QByteArray txset,
 {
 
     if (operation_caller != m_transferRef ) return;
+    m_warmStart = false;
     if (txset.isEmpty()) {
         setStage(Stage::ERROR, "Empty txset");
         stop(QStringLiteral("Error on onUnsignedMultisigReady"));
@@ -525,7 +604,7 @@ void TransferInitiator::describeTransfer()
 
     connect(w, &Wallet::describeTransferResult,
             this, &TransferInitiator::onDescribeTransferResultVariant,
-            Qt::QueuedConnection);
+            kQueuedUnique);
 
     w->describeTransfer(m_transferBlob,m_transferRef);
 }
@@ -605,6 +684,12 @@ void TransferInitiator::proceedAfterApproval()
 
 void TransferInitiator::submitToNextPeer()
 {
+    if (fanOut()) {
+        if (m_offerUnconfirmed) confirmOffer();
+        else                    offerToFastest();
+        return;
+    }
+
     QString nextPeer;
     for (const auto &o : m_signingOrder) {
         if (!m_signatures.contains(o)) { nextPeer = o; break; }
@@ -614,10 +699,62 @@ void TransferInitiator::submitToNextPeer()
         return;
     }
 
+    submitTo(nextPeer, m_signingOrder);
+}
+
+bool TransferInitiator::fanOut() const
+{
+    return m_threshold > 0 && m_peers.size() + 1 > m_threshold;
+}
+
+void TransferInitiator::offerToFastest()
+{
+    if (m_stopFlag || m_stage != Stage::SUBMITTING) return;
+    if (!m_offeredTo.isEmpty()) return;   // one signer holds the txset at a time
+
+    QStringList candidates;
+    for (auto it = m_peers.cbegin(); it != m_peers.cend(); ++it)
+        if (!m_signatures.contains(it.key())) candidates << it.key();
+    if (candidates.isEmpty()) {
+        setStage(Stage::CHECKING_STATUS, QStringLiteral("All signers accounted for; awaiting broadcast"));
+        return;
+    }
+    if (auto *latency = PeerLatency::of(m_wm)) candidates = latency->rank(candidates);
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    for (const QString &c : std::as_const(candidates)) {
+        const PeerState &p = m_peers[c];
+        if (p.online && p.ready && now - p.lastSeen <= FANOUT_FRESH_SECS) {
+            m_offeredTo    = c;
+            m_offeredOrder = PeerLatency::chainVia(m_signatures, c, candidates);
+            submitTo(c, m_offeredOrder);
+            return;
+        }
+    }
+
+    // Nobody known ready: ask the fastest few at once, the first ready answer
+    // gets the txset and later answers find m_offeredTo taken.
+    const QString path = QStringLiteral("/api/multisig/transfer/ping?ref=%1").arg(m_walletRef);
+    for (int i = 0; i < candidates.size() && i < FANOUT_WIDTH; ++i)
+        httpGetAsync(candidates[i], path, true);
+    emit statusChanged(QStringLiteral("Looking for an available signer (%1 candidates)").arg(candidates.size()));
+}
+
+void TransferInitiator::confirmOffer()
+{
+    if (m_stopFlag || m_offeredTo.isEmpty()) return;
+    const QString path = QStringLiteral("/api/multisig/transfer/status?ref=%1&transfer_ref=%2")
+                             .arg(m_walletRef, m_transferRef);
+    httpGetAsync(m_offeredTo, path, true);
+    emit statusChanged(QStringLiteral("Checking whether %1 got the transfer").arg(m_offeredTo.left(10)));
+}
+
+void TransferInitiator::submitTo(const QString &nextPeer, const QStringList &order)
+{
     const QJsonObject body{
                            {"transfer_ref", m_transferRef},
                            {"transfer_blob", m_transferBlob},
-                           {"signing_order", QJsonArray::fromStringList(m_signingOrder)},
+                           {"signing_order", QJsonArray::fromStringList(order)},
                            {"who_has_signed", QJsonArray::fromStringList(m_signatures)},
                            {"transfer_description", m_transferDescription},
                            {"created_at",  static_cast<qint64>(m_created_at)},
@@ -643,82 +780,56 @@ void TransferInitiator::checkPeerStatus()
 void TransferInitiator::saveToAccount()
 {
     if (!m_acct) return;
+    TransferCatalog *catalog = TransferCatalog::of(m_acct);
+    if (!catalog) return;
 
-    QJsonDocument doc = QJsonDocument::fromJson(m_acct->loadAccountData().toUtf8());
-    QJsonObject root  = doc.object();
-    QJsonObject monero= root.value("monero").toObject();
-    QJsonArray  wallets = monero.value("wallets").toArray();
-
-    bool updated = false;
-
-    for (int i = 0; i < wallets.size(); ++i) {
-        QJsonObject w = wallets.at(i).toObject();
-
-        const bool match =
-            (w.value("reference").toString() == m_walletRef) ||
-            (w.value("name").toString()      == m_walletName);
-
-        if (!match) continue;
-
-        QJsonObject transfers = w.value("transfers").toObject();
-
-        QJsonObject peersObj;
-        for (auto it = m_peers.cbegin(); it != m_peers.cend(); ++it) {
-            const auto &p = it.value();
-            peersObj.insert(it.key(),
-                            QJsonArray{ p.stageName, p.receivedTransfer, p.hasSigned , p.status });
-        }
-
-        QJsonArray dest = destinationsToJson(m_destinations);
-
-        QJsonObject entry = transfers.value(m_transferRef).toObject();
+    QJsonObject peersObj;
+    for (auto it = m_peers.cbegin(); it != m_peers.cend(); ++it) {
+        const auto &p = it.value();
+        peersObj.insert(it.key(),
+                        QJsonArray{ p.stageName, p.receivedTransfer, p.hasSigned , p.status });
+    }
 
+    QJsonArray dest = destinationsToJson(m_destinations);
 
-        entry["type"]                  = QStringLiteral("MULTISIG");
-        entry["wallet_name"]           = m_walletName;
-        entry["wallet_ref"]            = m_walletRef;
-        entry["destinations"]          = dest;
-        entry["peers"]                 = peersObj;
-        entry["signing_order"]         = QJsonArray::fromStringList(m_signingOrder);
-        entry["stage"]                 = stageName(m_stage);
-        entry["signatures"]            = QJsonArray::fromStringList(m_signatures);
-        entry["status"]                = m_status;
-        entry["transfer_blob"]         = m_transferBlob;
-        entry["transfer_description"]  = m_transferDescription;
+    QJsonObject entry = catalog->transfer(m_transferRef);
 
 
-        if (!m_txId.isEmpty())
-            entry["tx_id"] = m_txId;
-        else if (!entry.contains("tx_id"))
-            entry["tx_id"] = QString();
+    entry["type"]                  = QStringLiteral("MULTISIG");
+    entry["wallet_name"]           = m_walletName;
+    entry["wallet_ref"]            = m_walletRef;
+    entry["destinations"]          = dest;
+    entry["peers"]                 = peersObj;
+    entry["signing_order"]         = QJsonArray::fromStringList(m_signingOrder);
+    entry["stage"]                 = stageName(m_stage);
+    entry["signatures"]            = QJsonArray::fromStringList(m_signatures);
+    entry["status"]                = m_status;
+    BlobStore::setTransferBlob(m_acct, m_transferRef, entry, m_transferBlob);
+    entry["transfer_description"]  = m_transferDescription;
 
 
-        entry["created_at"] = m_created_at;
+    if (!m_txId.isEmpty())
+        entry["tx_id"] = m_txId;
+    else if (!entry.contains("tx_id"))
+        entry["tx_id"] = QString();
 
-        if (m_submittedAt > 0)
-            entry["submitted_at"] = m_submittedAt;
 
-        entry["my_onion"] = m_myOnionSelected;
+    entry["created_at"] = m_created_at;
 
-        transfers.insert(m_transferRef, entry);
-        w.insert("transfers", transfers);
-        wallets[i] = w;
+    if (m_submittedAt > 0)
+        entry["submitted_at"] = m_submittedAt;
+    entry["submit_started"] = m_submitStarted;
 
-        updated = true;
-        break;
-    }
+    entry["my_onion"] = m_myOnionSelected;
 
-    if (updated) {
-        monero.insert("wallets", wallets);
-        root.insert("monero", monero);
-        (void)m_acct->saveAccountData(QJsonDocument(root).toJson(QJsonDocument::Compact));
-    }
+    (void)catalog->upsert(m_walletRef, m_walletName, m_myOnionSelected, m_transferRef, entry);
 }
 
 void TransferInitiator::setStage(Stage s, const QString &statusMsg)
 {
     m_stage = s;
     m_status = statusMsg;
+    if (s == Stage::SUBMITTING) m_submitStarted = true;
     emit stageChanged(stageName(m_stage));
     if (!statusMsg.isEmpty()) emit statusChanged(statusMsg);
 }
@@ -729,16 +840,24 @@ void TransferInitiator::stop(const QString &reason)
     m_stopFlag = true;
     m_ping.stop();
     m_retry.stop();
-    m_httpPool.waitForDone(10'000);
+    m_httpPool.clear();   // requests in flight are ignored once stopped
+    Wallet *w = reason != QLatin1String("success") ? walletByRef(m_walletRef) : nullptr;
+    // Queued steps (txset build, describe) would still run and use the nonces;
+    // dropped before the release below, which is queued under the same ref.
+    if (w) w->cancelOperations(m_transferRef);
+    // A txset that may have reached a signer keeps its outputs; they free up
+    // once seen spent or the reservation ages out.
+    if (w && !m_submitStarted) w->releaseOutputs(m_transferRef);
     emit finished(m_transferRef, reason);
 }
 
 void TransferInitiator::httpGetAsync(const QString &onion, const QString &path, bool signedFlag)
 {
     QRunnable *task = QRunnable::create([=](){
+        QElapsedTimer rtt; rtt.start();
         const QJsonObject res = httpRequestBlocking(onion, path, "GET", signedFlag);
         const QString err = res.value("error").toString();
-        emit _httpResult(onion, path, res, err);
+        emit _httpResult(onion, path, res, err, rtt.elapsed());
     });
     task->setAutoDelete(true);
     m_httpPool.start(task);
@@ -747,9 +866,10 @@ void TransferInitiator::httpGetAsync(const QString &onion, const QString &path,
 void TransferInitiator::httpPostAsync(const QString &onion, const QString &path, const QJsonObject &json, bool signedFlag)
 {
     QRunnable *task = QRunnable::create([=](){
+        QElapsedTimer rtt; rtt.start();
         const QJsonObject res = httpRequestBlocking(onion, path, "POST", signedFlag, json);
         const QString err = res.value("error").toString();
-        emit _httpResult(onion, path, res, err);
+        emit _httpResult(onion, path, res, err, rtt.elapsed());
     });
     task->setAutoDelete(true);
     m_httpPool.start(task);
@@ -5,6 +5,11 @@
 #include "incomingtransfer.h"
 #include "transfertracker.h"
 #include "multisigimportsession.h"
+#include "peerlatency.h"
+#include "transferarchive.h"
+#include "payoutqueue.h"
+#include "transfercatalog.h"
+#include "blobstore.h"
 #include "multiwalletcontroller.h"
 #include "torbackend.h"
 #include "accountmanager.h"
@@ -22,6 +27,32 @@
 #include <QVector>
 #include <QPair>
 
+namespace {
+constexpr int kArchiveRetentionDays = 30;
+constexpr int kArchiveSweepMs       = 60 * 60 * 1000;
+
+const char *const kTerminalStages[] = {
+    "COMPLETE", "ABORTED", "DECLINED", "BROADCAST_SUCCESS", "ERROR", "FAILED"
+};
+
+// True only when the saved transfer provably never left this wallet: no
+// signer was handed the txset, or the signers declined it and no tx id was
+// ever seen. Records from before "submit_started" go by their stage.
+bool neverSubmitted(const QJsonObject &entry, const QString &result)
+{
+    static const QSet<QString> kPreSubmit{
+        "INIT", "MULTISIG_IMPORT_CHECK", "CHECKING_PEERS", "COLLECTING_INFO",
+        "CREATING_TRANSFER", "VALIDATING", "APPROVING"
+    };
+    if (entry.isEmpty()) return false;
+    const QString tx = entry.value("tx_id").toString();
+    if (!tx.isEmpty() && tx != QLatin1String("pending")) return false;
+    if (result == QLatin1String("declined")) return true;
+    if (entry.value("submitted_at").toInteger() > 0) return false;
+    return entry.contains("submit_started") ? !entry.value("submit_started").toBool()
+                                            : kPreSubmit.contains(entry.value("stage").toString());
+}
+}
 
 TransferManager::TransferManager(MultiWalletController *wm,
                                  TorBackend            *tor,
@@ -34,21 +65,51 @@ TransferManager::TransferManager(MultiWalletController *wm,
     {
         m_acct = qobject_cast<AccountManager*>(obj);
 
+        m_catalog = TransferCatalog::of(m_acct);
+        if (m_catalog) {
+            m_notify.setSingleShot(true);
+            m_notify.setInterval(0);
+            connect(&m_notify, &QTimer::timeout, this, &TransferManager::currentSessionChanged);
+            auto bump = [this](){ m_notify.start(); };
+            connect(m_catalog, &TransferCatalog::transferAdded,   this, bump);
+            connect(m_catalog, &TransferCatalog::transferUpdated, this, bump);
+            connect(m_catalog, &TransferCatalog::transferRemoved, this, bump);
+            connect(m_catalog, &TransferCatalog::catalogReset,    this, bump);
+        }
+
+        m_archive = new TransferArchive(m_acct, this);
+        connect(m_archive, &TransferArchive::archiveChanged,
+                this, &TransferManager::archiveChanged);
+
+        m_payouts = new PayoutQueue(m_acct, this);
+        connect(m_payouts, &PayoutQueue::flushDue,
+                this, [this](const QString &walletName){ flushPayouts(walletName); },
+                Qt::QueuedConnection);
+        connect(m_payouts, &PayoutQueue::changed,
+                this, &TransferManager::payoutQueueChanged);
+
         connect(m_acct, &AccountManager::isAuthenticatedChanged,
                 this, [this](){
                     if (!m_acct->isAuthenticated()) return;
-                    restoreAllSaved();
+                    reconcilePayouts();
+                    archiveTerminalTransfers();
+                    m_archiveTimer.start();
                     emit currentSessionChanged();
                 }, Qt::QueuedConnection);
     }
 
-    restoreAllSaved();
+    m_archiveTimer.setInterval(kArchiveSweepMs);
+    connect(&m_archiveTimer, &QTimer::timeout,
+            this, [this](){ archiveTerminalTransfers(); });
 
 
     m_msigImport = new MultisigImportSession(this);
     m_msigImport->initialize(m_wm, m_tor);
+    m_wm->setProperty("multisigImportSession", QVariant::fromValue(static_cast<QObject*>(m_msigImport)));
     setupMultisigImportWiring();
 
+    m_wm->setProperty("peerLatency", QVariant::fromValue(static_cast<QObject*>(new PeerLatency(this))));
+
     if (m_acct) {
         connect(m_acct, &AccountManager::isAuthenticatedChanged,
                 this, [this](){
@@ -68,6 +129,7 @@ TransferManager::~TransferManager()
     for (auto *p : std::as_const(m_outgoing))  p->deleteLater();
     for (auto *p : std::as_const(m_incoming))  p->deleteLater();
     for (auto *p : std::as_const(m_trackers))  p->deleteLater();
+    for (const QString &acct : m_parked.keys()) dropParkedSessions(acct);
 }
 
 
@@ -144,10 +206,17 @@ QString TransferManager::startOutgoingTransfer(const QString &walletRef,
     m_outgoing.insert(ref, init);
     emit currentSessionChanged();
 
+    wireOutgoing(init);
+    init->start();
+    emit sessionStarted(ref);
+    return ref;
+}
+
+void TransferManager::wireOutgoing(TransferInitiator *init)
+{
     connect(init, &TransferInitiator::submittedSuccessfully,
             this, [this](const QString &tref){
                 resumeTracker(tref);
-                restoreAllSaved();
                 emit currentSessionChanged();
             }, Qt::QueuedConnection);
 
@@ -155,21 +224,19 @@ QString TransferManager::startOutgoingTransfer(const QString &walletRef,
             this,
             [this](const QString &tref, const QString &result){
 
-                if (result == "abort") deleteSavedTransfer(tref);
                 auto it = m_outgoing.find(tref);
+                const bool submitted = it == m_outgoing.end() || it.value()->submitStarted();
+                if (result != "success" && m_payouts) m_payouts->settle(tref, result, !submitted);
+                if (result == "abort") deleteSavedTransfer(tref);
+                it = m_outgoing.find(tref);
                 if (it != m_outgoing.end()) {
-                    it.value()->deleteLater();
+                    it.value()->deleteWhenIdle();
                     m_outgoing.erase(it);
-                    restoreAllSaved();
                     emit currentSessionChanged();
 
                 }
             },
             Qt::QueuedConnection);
-
-    init->start();
-    emit sessionStarted(ref);
-    return ref;
 }
 
 /* ────────────────────────────────────────────────────────────────────────────
@@ -211,78 +278,58 @@ QString TransferManager::saveIncomingTransfer(const QString &walletRef,
                                               const QStringList &signedBy,
                                               const QVariantMap &jsonBody)
 {
-    if (!m_acct) return {};
-
-    QJsonDocument doc = QJsonDocument::fromJson(m_acct->loadAccountData().toUtf8());
-    QJsonObject root  = doc.object();
-    QJsonObject monero= root.value("monero").toObject();
-    QJsonArray  wallets= monero.value("wallets").toArray();
-
-    bool updated=false;
-    for (int i=0;i<wallets.size();++i) {
-        QJsonObject w = wallets[i].toObject();
-        if (w.value("reference").toString()!=walletRef) { wallets[i]=w; continue; }
-
-        QJsonObject transfers = w.value("transfers").toObject();
-
-        // peers map
-        QJsonObject peersObj;
-        for (const QString &o : order) {
-            const bool present = signedBy.contains(o,Qt::CaseInsensitive);
-            peersObj.insert(o, QJsonArray{
-                                          present ? "CHECKING_STATUS" : "UNKNOWN",
-                                          present, present, ""});
-        }
+    if (!m_acct || !m_catalog) return {};
+
+    // peers map
+    QJsonObject peersObj;
+    for (const QString &o : order) {
+        const bool present = signedBy.contains(o,Qt::CaseInsensitive);
+        peersObj.insert(o, QJsonArray{
+                                      present ? "CHECKING_STATUS" : "UNKNOWN",
+                                      present, present, ""});
+    }
 
-        QString my_onion;
-        {
-            QStringList ours = m_acct ? m_acct->torOnions() : QStringList{};
-            for (QString &o : ours) o = normOnion(o);
-            for (auto it = peersObj.begin(); it != peersObj.end(); ++it) {
-                const QString peerKey = normOnion(it.key());
-                if (ours.contains(peerKey, Qt::CaseInsensitive)) {
-                    my_onion = peerKey;
-                    break;
-                }
+    QString my_onion;
+    {
+        QStringList ours = m_acct ? m_acct->torOnions() : QStringList{};
+        for (QString &o : ours) o = normOnion(o);
+        for (auto it = peersObj.begin(); it != peersObj.end(); ++it) {
+            const QString peerKey = normOnion(it.key());
+            if (ours.contains(peerKey, Qt::CaseInsensitive)) {
+                my_onion = peerKey;
+                break;
             }
         }
-
-
-        QJsonObject entry{
-            {"wallet_name", w.value("name").toString()},
-            {"wallet_ref",  walletRef},
-            {"destinations",
-             QJsonArray::fromVariantList(
-                 jsonBody.value("transfer_description").toMap()
-                     .value("recipients").toList())},
-            {"peers",       peersObj},
-            {"signing_order", QJsonArray::fromStringList(order)},
-            {"stage", "RECEIVED"},
-            {"signatures",  QJsonArray::fromStringList(signedBy)},
-            {"status","NEW"},
-            {"transfer_blob", blobB64},
-            {"transfer_description",
-             QJsonObject::fromVariantMap(
-                 jsonBody.value("transfer_description").toMap())},
-            {"tx_id","pending"},
-            {"created_at", static_cast<qint64>(QDateTime::currentSecsSinceEpoch())}
-        };
-
-        if (!my_onion.isEmpty())
-            entry.insert("my_onion", my_onion);
-
-        transfers.insert(transferRef, entry);
-
-
-        w["transfers"]=transfers; wallets[i]=w; updated=true;
     }
-    if (!updated) return {};
 
-    monero["wallets"]=wallets; root["monero"]=monero;
-    (void)m_acct->saveAccountData(
-        QJsonDocument(root).toJson(QJsonDocument::Compact));
+    QString walletName = m_catalog->walletNameForRefOnion(walletRef, my_onion);
+    if (walletName.isEmpty()) walletName = m_catalog->walletNameForRefOnion(walletRef, {});
+    if (walletName.isEmpty()) return {};
+
+    QJsonObject entry{
+        {"wallet_name", walletName},
+        {"wallet_ref",  walletRef},
+        {"destinations",
+         QJsonArray::fromVariantList(
+             jsonBody.value("transfer_description").toMap()
+                 .value("recipients").toList())},
+        {"peers",       peersObj},
+        {"signing_order", QJsonArray::fromStringList(order)},
+        {"stage", "RECEIVED"},
+        {"signatures",  QJsonArray::fromStringList(signedBy)},
+        {"status","NEW"},
+        {"transfer_description",
+         QJsonObject::fromVariantMap(
+             jsonBody.value("transfer_description").toMap())},
+        {"tx_id","pending"},
+        {"created_at", static_cast<qint64>(QDateTime::currentSecsSinceEpoch())}
+    };
+
+    if (!my_onion.isEmpty())
+        entry.insert("my_onion", my_onion);
+    BlobStore::setTransferBlob(m_acct, transferRef, entry, blobB64);
 
-    restoreAllSaved();
+    if (!m_catalog->upsert(walletRef, walletName, my_onion, transferRef, entry)) return {};
 
     emit currentSessionChanged();
     return transferRef;
@@ -293,7 +340,7 @@ QString TransferManager::startIncomingTransfer(const QString &transferRef)
 {
     if (m_incoming.contains(transferRef)) return transferRef;
 
-    const QVariantMap saved = m_allSavedMap.value(transferRef);
+    const QJsonObject saved = m_catalog ? m_catalog->transfer(transferRef) : QJsonObject{};
     if (saved.isEmpty()) return {};
 
     const QString wref = saved.value("wallet_ref").toString();
@@ -304,7 +351,6 @@ QString TransferManager::startIncomingTransfer(const QString &transferRef)
     connect(sess, &IncomingTransfer::finished,
             this, [this](const QString &ref, const QString &res){
                 m_incoming.remove(ref);
-                restoreAllSaved();
                 emit sessionFinished(ref, res);
                 emit currentSessionChanged();
             }, Qt::QueuedConnection);
@@ -346,51 +392,26 @@ QString TransferManager::normOnion(QString s)
     return s;
 }
 
-static inline QVariantMap _getSaved(const QHash<QString, QVariantMap> &all,
-                                    const QString &ref)
-{
-    auto it = all.find(ref);
-    return (it == all.end()) ? QVariantMap{} : it.value();
-}
-
-
 bool TransferManager::isTerminalStage(const QString &stage)
 {
-    static const QSet<QString> kTerm{
-        "COMPLETE","ABORTED","DECLINED","BROADCAST_SUCCESS","ERROR","FAILED"
-    };
-    return kTerm.contains(stage);
+    for (const char *t : kTerminalStages)
+        if (stage == QLatin1String(t)) return true;
+    return false;
 }
 
 
 QVariantList TransferManager::openTransfersModel() const
 {
-    QSet<QString> seen;
-    QVector<QPair<QString,QVariantMap>> list;
-    list.reserve(m_allSavedMap.size());
-
-    auto feed=[&](const QString &ref){
-        if (seen.contains(ref)) return;
-        const QVariantMap saved=_getSaved(m_allSavedMap,ref);
-        if (saved.isEmpty()) return;
-        if (isTerminalStage(saved.value("stage").toString())) return;
-        seen.insert(ref); list.push_back({ref,saved});
-    };
-
-    for (const auto &r : m_outgoing.keys())  feed(r);
-    for (const auto &r : m_trackers.keys())  feed(r);
-    for (auto it=m_allSavedMap.begin(); it!=m_allSavedMap.end(); ++it) feed(it.key());
+    QVariantList out;
+    if (!m_catalog) return out;
 
-    std::sort(list.begin(), list.end(), [](const auto&a,const auto&b){
-        return a.second.value("created_at").toLongLong() >
-               b.second.value("created_at").toLongLong();
-    });
+    for (const QString &ref : m_catalog->refsNewestFirst()) {
+        const QJsonObject saved = m_catalog->transfer(ref);
+        if (saved.isEmpty()) continue;
+        if (isTerminalStage(saved.value("stage").toString())) continue;
 
-    QVariantList out;
-    out.reserve(list.size());
-    for (const auto &p : list) {
-        QVariantMap row=p.second;
-        row["ref"]=p.first;
+        QVariantMap row=saved.toVariantMap();
+        row["ref"]=ref;
         const QVariantList rec=row.value("transfer_description").toMap()
                                      .value("recipients").toList();
         row["recipient_count"]=rec.size();
@@ -410,8 +431,8 @@ QString TransferManager::getOutgoingDetails(const QString &ref) const
 
 QVariantMap TransferManager::getTransferSummary(const QString &ref) const
 {
-    const QVariantMap saved=_getSaved(m_allSavedMap,ref);
-    if (!saved.isEmpty()) return saved;
+    if (m_catalog && m_catalog->contains(ref))
+        return m_catalog->transfer(ref).toVariantMap();
 
     const QString json=getOutgoingDetails(ref);
     if (!json.isEmpty()) {
@@ -433,80 +454,37 @@ QVariantMap TransferManager::getTransferSummary(const QString &ref) const
 QStringList TransferManager::outgoingSessions()          const { return m_outgoing.keys();  }
 QStringList TransferManager::incomingSessions()          const { return m_incoming.keys();  }
 QStringList TransferManager::activeTrackers()            const { return m_trackers.keys();  }
-QStringList TransferManager::pendingIncomingTransfers()  const { return m_pendingIncomingMap.keys(); }
-QStringList TransferManager::allSavedTransfers()         const { return m_allSavedMap.keys(); }
-
-
-void TransferManager::restoreAllSaved()
+QStringList TransferManager::pendingIncomingTransfers()  const
 {
-    m_allSavedMap.clear();
-    m_pendingIncomingMap.clear();
-
-    const QJsonObject root = loadAccountRoot();
-    const QJsonArray wallets = root.value("monero").toObject()
-                                   .value("wallets").toArray();
-
-    for (const auto &wv : wallets) {
-        const QJsonObject w = wv.toObject();
-        const QJsonObject transfers = w.value("transfers").toObject();
-
-        for (auto it = transfers.begin(); it != transfers.end(); ++it) {
-            const QString ref = it.key();
-            const QJsonObject tr = it.value().toObject();
-
-            m_allSavedMap.insert(ref, tr.toVariantMap());
-
-
-            const QString stage  = tr.value("stage").toString();
-            const QString status = tr.value("status").toString();
-            if (stage.compare("RECEIVED", Qt::CaseInsensitive) == 0 &&
-                status == "NEW") {
-                m_pendingIncomingMap.insert(ref, tr.toVariantMap());
-            }
-        }
-    }
-
-    emit currentSessionChanged();
+    QStringList out;
+    if (!m_catalog) return out;
+    for (const QString &ref : m_catalog->refsInStage(QStringLiteral("RECEIVED")))
+        if (m_catalog->transfer(ref).value("status").toString() == "NEW")
+            out << ref;
+    return out;
 }
 
+QStringList TransferManager::allSavedTransfers() const
+{ return m_catalog ? m_catalog->allRefs() : QStringList{}; }
 
-QJsonObject TransferManager::loadAccountRoot() const
-{
-    return m_acct
-               ? QJsonDocument::fromJson(m_acct->loadAccountData().toUtf8()).object()
-               : QJsonObject{};
-}
 
-void TransferManager::saveAccountRoot(const QJsonObject &root) const
+void TransferManager::restoreAllSaved()
 {
-    if (m_acct)
-        (void)m_acct->saveAccountData(
-            QJsonDocument(root).toJson(QJsonDocument::Compact));
+    // The catalog follows every account save; this only nudges bound views.
+    emit currentSessionChanged();
 }
 
 
 bool TransferManager::deleteSavedTransfer(const QString &ref)
 {
-    if (!m_acct) return false;
-
-    QJsonObject root = loadAccountRoot();
-    QJsonObject mon  = root.value("monero").toObject();
-    QJsonArray wallets = mon.value("wallets").toArray();
-    bool removed=false;
-
-    for (int i=0;i<wallets.size();++i){
-        QJsonObject w=wallets[i].toObject();
-        QJsonObject transfers=w.value("transfers").toObject();
-        if (transfers.contains(ref)) {
-            transfers.remove(ref); w["transfers"]=transfers;
-            wallets[i]=w; removed=true; break;
-        }
-    }
-    if (!removed) return false;
-
-    mon["wallets"]=wallets; root["monero"]=mon;
-    saveAccountRoot(root);
-    restoreAllSaved();
+    if (!m_acct || !m_catalog) return false;
+    const QString walletName = m_catalog->walletNameOf(ref);
+    const QJsonObject entry  = m_catalog->transfer(ref);
+    if (!m_catalog->remove(ref)) return false;
+    // Payouts left for review keep the transfer's outputs reserved.
+    const bool held = m_payouts &&
+        m_payouts->settle(ref, QStringLiteral("deleted"), neverSubmitted(entry, QStringLiteral("deleted")));
+    if (!held) releaseOutputs(walletName, ref);
     emit currentSessionChanged();
     return true;
 }
@@ -516,17 +494,29 @@ void TransferManager::wireTracker(TransferTracker *t)
 {
     connect(t,&TransferTracker::progress,
             this,[this](const QString&,const QVariantMap&){
-                restoreAllSaved(); emit currentSessionChanged(); },
+                emit currentSessionChanged(); },
             Qt::QueuedConnection);
 
     connect(t,&TransferTracker::finished,
             this,[this,t](const QString &ref,const QString &res){
+                const QJsonObject entry = m_catalog ? m_catalog->transfer(ref) : QJsonObject{};
+                const bool held = m_payouts && (res == "success" || res == "declined" || res == "error") &&
+                    m_payouts->settle(ref, res, neverSubmitted(entry, res), entry.value("tx_id").toString());
+                if ((res == "declined" || res == "error") && !held)
+                    releaseOutputs(m_catalog ? m_catalog->walletNameOf(ref) : QString(), ref);
                 m_trackers.remove(ref); t->deleteLater();
-                restoreAllSaved(); emit currentSessionChanged();
+                emit currentSessionChanged();
                 emit sessionFinished(ref,res);
             }, Qt::QueuedConnection);
 }
 
+void TransferManager::releaseOutputs(const QString &walletName, const QString &ref)
+{
+    if (walletName.isEmpty()) return;
+    if (auto *w = qobject_cast<Wallet*>(m_wm->walletInstance(walletName)))
+        w->releaseOutputs(ref);
+}
+
 bool TransferManager::resumeTracker(const QString &ref)
 {
     if (m_trackers.contains(ref)) return true;
@@ -547,21 +537,14 @@ bool TransferManager::resumeTrackerInternal(const QString &ref,
                                             QString *outWname,
                                             QString *outMyOnion)
 {
-    const QJsonObject root=loadAccountRoot();
-    const QJsonArray wallets=root.value("monero").toObject()
-                                   .value("wallets").toArray();
-    for (const auto &wv:wallets){
-        const QJsonObject w=wv.toObject();
-        const QJsonObject transfers=w.value("transfers").toObject();
-        if (!transfers.contains(ref)) continue;
-        const QString stage=transfers.value(ref).toObject().value("stage").toString();
-        if (isTerminalStage(stage)) return false;
-        if (outWref)  *outWref = w.value("reference").toString();
-        if (outWname) *outWname= w.value("name").toString();
-        if (outMyOnion) *outMyOnion = transfers.value(ref).toObject().value("my_onion").toString();
-        return true;
-    }
-    return false;
+    if (!m_catalog || !m_catalog->contains(ref)) return false;
+
+    const QJsonObject tr = m_catalog->transfer(ref);
+    if (isTerminalStage(tr.value("stage").toString())) return false;
+    if (outWref)    *outWref    = m_catalog->walletRefOf(ref);
+    if (outWname)   *outWname   = m_catalog->walletNameOf(ref);
+    if (outMyOnion) *outMyOnion = tr.value("my_onion").toString();
+    return true;
 }
 
 
@@ -596,21 +579,107 @@ QString TransferManager::getSavedTransferDetails(const QString &transferRef) con
     if (auto *s = m_outgoing.value(transferRef, nullptr))
         return s->getTransferDetailsJson();
 
-    const QJsonObject root = loadAccountRoot();
-    const QJsonArray  wallets = root.value("monero").toObject()
-                                   .value("wallets").toArray();
-
-    for (const auto &wv : wallets) {
-        const QJsonObject w = wv.toObject();
-        const QJsonObject transfers = w.value("transfers").toObject();
-        if (transfers.contains(transferRef)) {
-            return QJsonDocument(transfers.value(transferRef).toObject())
+    if (m_catalog && m_catalog->contains(transferRef))
+        return QJsonDocument(m_catalog->transfer(transferRef))
             .toJson(QJsonDocument::Compact);
+
+    return getArchivedTransferDetails(transferRef);
+}
+
+
+int TransferManager::archiveTerminalTransfers()
+{
+    if (!m_acct || !m_acct->isAuthenticated() || !m_archive || !m_catalog) return 0;
+
+    const int days = m_acct->accountObject().value("settings").toObject()
+                         .value("archive_retention_days").toInt(kArchiveRetentionDays);
+    if (days < 0) return 0;
+
+    const qint64 now    = QDateTime::currentSecsSinceEpoch();
+    const qint64 cutoff = now - qint64(days) * 86400;
+
+    QHash<QString, QJsonObject>        stamps;
+    QList<QPair<QString, QJsonObject>> moving;
+    QStringList                        movingRefs;
+
+    for (const char *stage : kTerminalStages) {
+        for (const QString &ref : m_catalog->refsInStage(QLatin1String(stage))) {
+            if (hasLiveSession(ref)) continue;
+            QJsonObject tr = m_catalog->transfer(ref);
+
+            // retention counts from when we first saw the transfer settled
+            const qint64 at = tr.value("terminal_at").toInteger();
+            if (at <= 0) {
+                tr["terminal_at"] = now;
+                stamps.insert(ref, tr);
+                continue;
+            }
+            if (at > cutoff) continue;
+
+            if (!tr.contains("wallet_ref"))  tr["wallet_ref"]  = m_catalog->walletRefOf(ref);
+            if (!tr.contains("wallet_name")) tr["wallet_name"] = m_catalog->walletNameOf(ref);
+            // the blob is released with the account entry; settled transfers never re-sign
+            tr.remove("transfer_blob_ref");
+            tr.remove("transfer_blob_raw");
+            moving.push_back({ref, tr});
+            movingRefs << ref;
         }
     }
-    return {};
+
+    if (!moving.isEmpty() && !m_archive->append(moving)) {
+        qWarning() << "[TransferManager] archive append failed; transfers stay in account";
+        movingRefs.clear();
+    }
+    if (stamps.isEmpty() && movingRefs.isEmpty()) return 0;
+
+    if (!m_catalog->apply(stamps, movingRefs)) return 0;
+
+    if (!movingRefs.isEmpty()) {
+        qDebug().noquote() << "[TransferManager] archived" << movingRefs.size() << "terminal transfers";
+        emit currentSessionChanged();
+    }
+    return int(movingRefs.size());
+}
+
+int TransferManager::archivedTransferCount(const QString &walletRef) const
+{
+    return m_archive ? m_archive->count(walletRef) : 0;
+}
+
+QVariantList TransferManager::archivedTransfersPage(int offset, int limit,
+                                                    const QString &walletRef) const
+{
+    return m_archive ? m_archive->page(offset, limit, walletRef) : QVariantList{};
+}
+
+QString TransferManager::getArchivedTransferDetails(const QString &transferRef) const
+{
+    if (!m_archive) return {};
+    const QJsonObject tr = m_archive->entry(transferRef);
+    if (tr.isEmpty()) return {};
+    return QString::fromUtf8(QJsonDocument(tr).toJson(QJsonDocument::Compact));
 }
 
+bool TransferManager::restoreArchivedTransfer(const QString &transferRef)
+{
+    if (!m_archive || !m_catalog || m_catalog->contains(transferRef)) return false;
+    QJsonObject tr = m_archive->entry(transferRef);
+    if (tr.isEmpty()) return false;
+
+    tr["terminal_at"] = QDateTime::currentSecsSinceEpoch();
+    if (!m_catalog->upsert(tr.value("wallet_ref").toString(), tr.value("wallet_name").toString(),
+                           tr.value("my_onion").toString(), transferRef, tr)) {
+        qWarning() << "[TransferManager] restore: wallet of" << transferRef << "is not in this account";
+        return false;
+    }
+    // Still in the account if this fails; the next sweep finds it archived
+    // already and only drops the account copy again.
+    if (!m_archive->remove(transferRef))
+        qWarning() << "[TransferManager] restore: archive index not updated for" << transferRef;
+
+    emit currentSessionChanged();
+    return true;
+}
 
 void TransferManager::setupMultisigImportWiring()
 {
@@ -623,6 +692,8 @@ void TransferManager::setupMultisigImportWiring()
             this, &TransferManager::multisigImportWalletCompleted, Qt::QueuedConnection);
     connect(m_msigImport, &MultisigImportSession::peerInfoReceived,
             this, &TransferManager::multisigImportPeerInfoReceived, Qt::QueuedConnection);
+    connect(m_msigImport, &MultisigImportSession::readinessChanged,
+            this, &TransferManager::multisigReadinessChanged, Qt::QueuedConnection);
 }
 
 void TransferManager::maybeStartMultisigImport()
@@ -636,6 +707,9 @@ void TransferManager::maybeStartMultisigImport()
 bool TransferManager::isMultisigImportSessionRunning() const
 { return m_msigImport ? m_msigImport->running() : false; }
 
+QVariantMap TransferManager::multisigReadiness(const QString &walletName) const
+{ return m_msigImport ? m_msigImport->readiness(walletName) : QVariantMap{}; }
+
 void TransferManager::startMultisigImportSession()
 { if (m_msigImport) m_msigImport->start(); }
 
@@ -658,6 +732,99 @@ void TransferManager::clearMultisigImportActivity()
 { if (m_msigImport) m_msigImport->clearActivity(); }
 
 
+bool TransferManager::configurePayoutQueue(const QString &walletName,
+                                           const QStringList &signingOrder,
+                                           int  feePriority,
+                                           bool inspectBeforeSending,
+                                           int  maxBatch,
+                                           int  maxWaitMinutes)
+{
+    if (!m_payouts) return false;
+    return m_payouts->configure(walletName, m_wm->getWalletMeta(walletName), signingOrder,
+                                feePriority, inspectBeforeSending, maxBatch, maxWaitMinutes);
+}
+
+QString TransferManager::queuePayout(const QString &walletName, const QString &address,
+                                     const QVariant &amount, const QString &label)
+{
+    if (!m_payouts) return {};
+    const auto dests = toAtomicDests({ QVariantMap{ {"address", address}, {"amount", amount} } });
+    if (dests.isEmpty()) return {};
+    return m_payouts->enqueue(walletName, m_wm->getWalletMeta(walletName),
+                              dests.first().address, dests.first().amount, label);
+}
+
+bool TransferManager::cancelPayout(const QString &walletName, const QString &id)
+{
+    return m_payouts && m_payouts->cancel(walletName, id);
+}
+
+bool TransferManager::resolvePayout(const QString &walletName, const QString &id, bool sent)
+{
+    QString ref;
+    if (!m_payouts || !m_payouts->resolve(walletName, id, sent, &ref)) return false;
+    if (!m_payouts->holds(ref)) releaseOutputs(walletName, ref);
+    return true;
+}
+
+// Settles payouts whose transfer ended while nobody was listening: it
+// finished or was removed before a restart, or its session was dropped with
+// an account. A transfer still running, or tracked after submit, settles
+// itself.
+void TransferManager::reconcilePayouts()
+{
+    if (!m_payouts || !m_catalog) return;
+    for (const QString &ref : m_payouts->batchedRefs()) {
+        if (m_outgoing.contains(ref) || m_trackers.contains(ref)) continue;
+
+        QJsonObject entry = m_catalog->transfer(ref);
+        if (entry.isEmpty() && m_archive) entry = m_archive->entry(ref);
+        if (entry.isEmpty()) {
+            m_payouts->settle(ref, QStringLiteral("missing"), false);
+            continue;
+        }
+
+        const QString stage  = entry.value("stage").toString();
+        const QString result = stage.toLower();
+        if (stage == QLatin1String("COMPLETE") || stage == QLatin1String("BROADCAST_SUCCESS"))
+            m_payouts->settle(ref, QStringLiteral("success"), true, entry.value("tx_id").toString());
+        else if (isTerminalStage(stage))
+            m_payouts->settle(ref, result, neverSubmitted(entry, result));
+        else if (neverSubmitted(entry, QStringLiteral("interrupted")))
+            m_payouts->settle(ref, QStringLiteral("interrupted"), true);
+    }
+}
+
+QVariantList TransferManager::payoutQueue(const QString &walletName) const
+{
+    if (!m_payouts) return {};
+    QVariantList out = m_payouts->items(walletName);
+    for (QVariant &v : out) {
+        QVariantMap m = v.toMap();
+        const QString ref = m.value("transfer_ref").toString();
+        if (ref.isEmpty() || !m_catalog || !m_catalog->contains(ref)) continue;
+        m["stage"] = m_catalog->transfer(ref).value("stage").toString();
+        v = m;
+    }
+    return out;
+}
+
+// Starts one outgoing transfer for the next batch; the queue's signers and
+// fee settings stand in for the transfer setup page.
+QString TransferManager::flushPayouts(const QString &walletName)
+{
+    if (!m_payouts || !m_acct || !m_acct->isAuthenticated()) return {};
+    const PayoutQueue::Batch b = m_payouts->take(walletName);
+    if (b.ids.isEmpty() || b.walletRef.isEmpty() || b.signingOrder.isEmpty()) return {};
+
+    const QString ref = startOutgoingTransfer(b.walletRef, b.destinations,
+                                              b.signingOrder, b.signingOrder,
+                                              b.threshold, b.feePriority, {},
+                                              b.inspect, b.myOnion);
+    if (!ref.isEmpty()) m_payouts->markBatched(walletName, b.ids, ref);
+    return ref;
+}
+
 QString TransferManager::startSimpleTransfer(const QString &walletRef,
                                              const QVariantList &destinations,
                                              int feePriority,
@@ -682,10 +849,17 @@ QString TransferManager::startSimpleTransfer(const QString &walletRef,
     m_simple.insert(ref, sess);
     emit currentSessionChanged();
 
+    wireSimple(sess);
+    sess->start();
+    emit sessionStarted(ref);
+    return ref;
+}
+
+void TransferManager::wireSimple(SimpleTransfer *sess)
+{
     connect(sess, &SimpleTransfer::submittedSuccessfully,
             this, [this](const QString &tref){
-
-                restoreAllSaved();
+                Q_UNUSED(tref)
                 emit currentSessionChanged();
             }, Qt::QueuedConnection);
 
@@ -697,13 +871,8 @@ QString TransferManager::startSimpleTransfer(const QString &walletRef,
                     it.value()->deleteLater();
                     m_simple.erase(it);
                 }
-                restoreAllSaved();
                 emit currentSessionChanged();
             }, Qt::QueuedConnection);
-
-    sess->start();
-    emit sessionStarted(ref);
-    return ref;
 }
 
 bool TransferManager::abortSimpleTransfer(const QString &ref)
@@ -758,78 +927,123 @@ bool TransferManager::declineIncomingTransfer(const QString &transferRef)
         }
     }
 
-    QJsonDocument doc = QJsonDocument::fromJson(m_acct->loadAccountData().toUtf8());
-    QJsonObject root  = doc.object();
-    QJsonObject monero= root.value("monero").toObject();
-    QJsonArray  wallets= monero.value("wallets").toArray();
-
-    bool updated = false;
-    for (int i = 0; i < wallets.size(); ++i) {
-        QJsonObject w = wallets[i].toObject();
-        QJsonObject transfers = w.value("transfers").toObject();
-
-        if (!transfers.contains(transferRef)) {
-            wallets[i] = w;
-            continue;
+    if (!m_catalog || !m_catalog->contains(transferRef)) return false;
+    QJsonObject transfer = m_catalog->transfer(transferRef);
+    if (isTerminalStage(transfer.value("stage").toString())) return false;
+
+    transfer["stage"] = "DECLINED";
+    transfer["status"] = "Transfer declined by user";
+    transfer["declined_at"] = QDateTime::currentSecsSinceEpoch();
+
+    QJsonObject peersObj = transfer.value("peers").toObject();
+    QString targetOnion = normOnion(transfer.value("my_onion").toString());
+    if (targetOnion.isEmpty()) {
+        QStringList ours = m_acct ? m_acct->torOnions() : QStringList{};
+        for (QString &o : ours) o = normOnion(o);
+        for (auto it = peersObj.begin(); it != peersObj.end() && targetOnion.isEmpty(); ++it) {
+            const QString peerKey = normOnion(it.key());
+            if (ours.contains(peerKey, Qt::CaseInsensitive))
+                targetOnion = peerKey;
         }
+    }
 
-        QJsonObject transfer = transfers.value(transferRef).toObject();
-
-        const QString currentStage = transfer.value("stage").toString();
-        if (isTerminalStage(currentStage)) {
-            wallets[i] = w;
-            continue;
+    if (!targetOnion.isEmpty() && peersObj.contains(targetOnion)) {
+        QJsonArray peerArray = peersObj.value(targetOnion).toArray();
+        if (peerArray.size() >= 4) {
+            peerArray[0] = "DECLINED";
+            peerArray[1] = true;
+            peerArray[2] = false;
+            peerArray[3] = "Declined";
+            peersObj[targetOnion] = peerArray;
         }
+    }
+    transfer["peers"] = peersObj;
 
-        transfer["stage"] = "DECLINED";
-        transfer["status"] = "Transfer declined by user";
-
-        const qint64 now = QDateTime::currentSecsSinceEpoch();
-        transfer["declined_at"] = now;
-
-        QJsonObject peersObj = transfer.value("peers").toObject();
-        QString targetOnion = normOnion(transfer.value("my_onion").toString());
-        if (targetOnion.isEmpty()) {
-            QStringList ours = m_acct ? m_acct->torOnions() : QStringList{};
-            for (QString &o : ours) o = normOnion(o);
-            for (auto it = peersObj.begin(); it != peersObj.end() && targetOnion.isEmpty(); ++it) {
-                const QString peerKey = normOnion(it.key());
-                if (ours.contains(peerKey, Qt::CaseInsensitive))
-                    targetOnion = peerKey;
-            }
-        }
+    if (!m_catalog->apply({{transferRef, transfer}})) return false;
 
-        if (!targetOnion.isEmpty() && peersObj.contains(targetOnion)) {
-            QJsonArray peerArray = peersObj.value(targetOnion).toArray();
-            if (peerArray.size() >= 4) {
-                peerArray[0] = "DECLINED";
-                peerArray[1] = true;
-                peerArray[2] = false;
-                peerArray[3] = "Declined";
-                peersObj[targetOnion] = peerArray;
-            }
-        }
-        transfer["peers"] = peersObj;
+    emit currentSessionChanged();
+
+    return true;
+}
 
-        transfers[transferRef] = transfer;
-        w["transfers"] = transfers;
-        wallets[i] = w;
-        updated = true;
-        break;
+void TransferManager::suspendForAccountSwitch(const QString &account)
+{
+    // Park sessions while the outgoing account is still current. A switch is
+    // not an abort: nothing finishes, reserved outputs stay reserved, and the
+    // sessions are taken up again when the account is switched back to.
+    ParkedSessions &parked = m_parked[account];
+    for (auto it = m_outgoing.cbegin(); it != m_outgoing.cend(); ++it) {
+        if (!it.value()) continue;
+        disconnect(it.value(), nullptr, this, nullptr);
+        it.value()->park();
+        if (TransferInitiator *again = it.value()->restarted(this)) parked.outgoing.insert(it.key(), again);
+        it.value()->deleteWhenIdle();
+    }
+    for (auto it = m_incoming.cbegin(); it != m_incoming.cend(); ++it) {
+        if (!it.value()) continue;
+        disconnect(it.value(), nullptr, this, nullptr);
+        it.value()->cancel();
+        it.value()->deleteWhenIdle();
+        parked.incoming << it.key();
+    }
+    for (auto it = m_trackers.cbegin(); it != m_trackers.cend(); ++it) {
+        if (!it.value()) continue;
+        disconnect(it.value(), nullptr, this, nullptr);
+        it.value()->stop();
+        it.value()->deleteLater();
+        parked.trackers << it.key();
+    }
+    for (auto it = m_simple.cbegin(); it != m_simple.cend(); ++it) {
+        if (!it.value()) continue;
+        disconnect(it.value(), nullptr, this, nullptr);
+        it.value()->park();
+        if (SimpleTransfer *again = it.value()->restarted(this)) parked.simple.insert(it.key(), again);
+        it.value()->deleteLater();
     }
 
-    if (!updated) return false;
+    m_outgoing.clear();
+    m_incoming.clear();
+    m_trackers.clear();
+    m_simple.clear();
+    reset();
+}
 
-    monero["wallets"] = wallets;
-    root["monero"] = monero;
+void TransferManager::resumeAfterAccountSwitch(const QString &account)
+{
+    if (!m_acct || !m_acct->isAuthenticated()) return;
 
-    (void)m_acct->saveAccountData(
-        QJsonDocument(root).toJson(QJsonDocument::Compact));
+    archiveTerminalTransfers();
+    m_archiveTimer.start();
+    if (m_msigImport) {
+        m_msigImport->initialize(m_wm, m_tor);
+        maybeStartMultisigImport();
+    }
+
+    const ParkedSessions parked = m_parked.take(account);
+    for (auto it = parked.outgoing.cbegin(); it != parked.outgoing.cend(); ++it) {
+        m_outgoing.insert(it.key(), it.value());
+        wireOutgoing(it.value());
+        it.value()->start();
+    }
+    for (auto it = parked.simple.cbegin(); it != parked.simple.cend(); ++it) {
+        m_simple.insert(it.key(), it.value());
+        wireSimple(it.value());
+        it.value()->start();
+    }
+    for (const QString &ref : parked.trackers)
+        resumeTracker(ref);
+    for (const QString &ref : parked.incoming)
+        if (!m_trackers.contains(ref)) startIncomingTransfer(ref);
+    reconcilePayouts();
 
-    restoreAllSaved();
     emit currentSessionChanged();
+}
 
-    return true;
+void TransferManager::dropParkedSessions(const QString &account)
+{
+    const ParkedSessions parked = m_parked.take(account);
+    for (TransferInitiator *init : parked.outgoing) { init->park(); init->deleteLater(); }
+    for (SimpleTransfer *sess : parked.simple)      { sess->park(); sess->deleteLater(); }
 }
 
 void TransferManager::reset()
@@ -856,8 +1070,10 @@ void TransferManager::reset()
     m_incoming.clear();
     m_trackers.clear();
     m_simple.clear();
-    m_pendingIncomingMap.clear();
-    m_allSavedMap.clear();
+
+    m_archiveTimer.stop();
+    if (m_archive) m_archive->reset();
+    if (m_payouts) m_payouts->reset();
 
     if (m_msigImport) {
         m_msigImport->stop();
@@ -2,6 +2,7 @@
 #include "transfertracker.h"
 #include "torbackend.h"
 #include "accountmanager.h"
+#include "transfercatalog.h"
 #include "cryptoutils_extras.h"
 
 #include <QNetworkAccessManager>
@@ -19,13 +20,6 @@
 
 using namespace CryptoUtils;
 
-static inline QJsonObject loadRoot(AccountManager *acct) {
-    return QJsonDocument::fromJson(acct->loadAccountData().toUtf8()).object();
-}
-static inline void saveRoot(AccountManager *acct, const QJsonObject &root) {
-    (void)acct->saveAccountData(QJsonDocument(root).toJson(QJsonDocument::Compact));
-}
-
 static inline QString _normOnion(QString s) {
     s = s.trimmed().toLower();
     if (!s.isEmpty() && !s.endsWith(".onion")) s.append(".onion");
@@ -212,22 +206,11 @@ bool TransferTracker::loadOnceFromAccount()
 {
     if (!m_acct) return false;
 
-    m_root = loadRoot(m_acct);
-    const QJsonObject monero  = m_root.value("monero").toObject();
-    const QJsonArray  wallets = monero.value("wallets").toArray();
+    TransferCatalog *catalog = TransferCatalog::of(m_acct);
+    if (!catalog || !catalog->contains(m_transferRef)) return false;
 
-    m_walletIdx = -1;
-    for (int i = 0; i < wallets.size(); ++i) {
-        const QJsonObject w = wallets.at(i).toObject();
-        const bool match = (w.value("reference").toString() == m_walletRef) ||
-                           (w.value("name").toString()      == m_walletName);
-        if (match) { m_walletIdx = i; break; }
-    }
-    if (m_walletIdx < 0) return false;
-
-    const QJsonObject w   = wallets.at(m_walletIdx).toObject();
-    const QJsonObject trs = w.value("transfers").toObject();
-    const QJsonObject e   = trs.value(m_transferRef).toObject();
+    m_entry = catalog->transfer(m_transferRef);
+    const QJsonObject e = m_entry;
 
 
     QStringList sessionParticipants;
@@ -291,11 +274,19 @@ bool TransferTracker::loadOnceFromAccount()
     return true;
 }
 
+// Empty once the transfer is deleted or archived, so nothing writes it back.
+QJsonObject TransferTracker::currentEntry() const
+{
+    TransferCatalog *catalog = TransferCatalog::of(m_acct);
+    return catalog ? catalog->transfer(m_transferRef) : QJsonObject{};
+}
+
 bool TransferTracker::writeBack()
 {
     if (!m_acct) return false;
-    saveRoot(m_acct, m_root);
-    return true;
+    TransferCatalog *catalog = TransferCatalog::of(m_acct);
+    if (!catalog || !catalog->contains(m_transferRef)) return false;
+    return catalog->upsert(m_walletRef, m_walletName, m_myOnion, m_transferRef, m_entry);
 }
 
 bool TransferTracker::persistPeerStageIfChanged(const QString &onion,
@@ -316,23 +307,14 @@ bool TransferTracker::persistPeerStageIfChanged(const QString &onion,
 
     m_peerStageCache.insert(key, incoming);
 
-    QJsonObject monero  = m_root.value("monero").toObject();
-    QJsonArray  wallets = monero.value("wallets").toArray();
-    if (m_walletIdx < 0 || m_walletIdx >= wallets.size()) return false;
-
-    QJsonObject w   = wallets.at(m_walletIdx).toObject();
-    QJsonObject trs = w.value("transfers").toObject();
-    QJsonObject e   = trs.value(m_transferRef).toObject();
+    QJsonObject e = currentEntry();
+    if (e.isEmpty()) return false;
 
     QJsonObject peerStages = e.value("peer_stages").toObject();
     peerStages.insert(key, QJsonObject::fromVariantMap(incoming));
     e.insert("peer_stages", peerStages);
 
-    trs.insert(m_transferRef, e);
-    w.insert("transfers", trs);
-    wallets[m_walletIdx] = w;
-    monero.insert("wallets", wallets);
-    m_root.insert("monero", monero);
+    m_entry = e;
 
     writeBack();
     return true;
@@ -360,13 +342,8 @@ bool TransferTracker::persistAggregateIfChanged(const QString &stageCandidate,
     m_lastTime           = timeOut;
 
 
-    QJsonObject monero  = m_root.value("monero").toObject();
-    QJsonArray  wallets = monero.value("wallets").toArray();
-    if (m_walletIdx < 0 || m_walletIdx >= wallets.size()) return false;
-
-    QJsonObject w   = wallets.at(m_walletIdx).toObject();
-    QJsonObject trs = w.value("transfers").toObject();
-    QJsonObject e   = trs.value(m_transferRef).toObject();
+    QJsonObject e = currentEntry();
+    if (e.isEmpty()) return false;
 
     e.insert("stage",  stageOut);
     e.insert("tx_id",  txidOut.isEmpty() ? QStringLiteral("pending") : txidOut);
@@ -376,11 +353,7 @@ bool TransferTracker::persistAggregateIfChanged(const QString &stageCandidate,
                                                      : stageOut));
     e.insert("time",   timeOut);
 
-    trs.insert(m_transferRef, e);
-    w.insert("transfers", trs);
-    wallets[m_walletIdx] = w;
-    monero.insert("wallets", wallets);
-    m_root.insert("monero", monero);
+    m_entry = e;
 
     writeBack();
     return true;
@@ -451,6 +424,7 @@ void TransferTracker::tick()
 
         if (ref != m_walletRef || transferRef != m_transferRef ) {
             continue; }
+        if (!res.value("received_transfer").toBool(true)) continue;   // peer has no copy yet
 
         const QString stage = res.value("stage_name").toString();
         const QString status = res.value("status").toString();
@@ -561,23 +535,14 @@ bool TransferTracker::persistPeerInfoIfChanged(const QString &onion,
 
     m_peerInfoCache.insert(key, incoming);
 
-    QJsonObject monero  = m_root.value("monero").toObject();
-    QJsonArray  wallets = monero.value("wallets").toArray();
-    if (m_walletIdx < 0 || m_walletIdx >= wallets.size()) return false;
-
-    QJsonObject w   = wallets.at(m_walletIdx).toObject();
-    QJsonObject trs = w.value("transfers").toObject();
-    QJsonObject e   = trs.value(m_transferRef).toObject();
+    QJsonObject e = currentEntry();
+    if (e.isEmpty()) return false;
 
     QJsonObject peers = e.value("peers").toObject();
     peers.insert(key, QJsonArray{ stage, receivedTransfer, hasSigned , status });
     e.insert("peers", peers);
 
-    trs.insert(m_transferRef, e);
-    w.insert("transfers", trs);
-    wallets[m_walletIdx] = w;
-    monero.insert("wallets", wallets);
-    m_root.insert("monero", monero);
+    m_entry = e;
 
     writeBack();
     return true;
@@ -586,13 +551,8 @@ bool TransferTracker::persistPeerInfoIfChanged(const QString &onion,
 bool TransferTracker::ensureSignatureListed(const QString &onion)
 {
     const QString key = onion.trimmed().toLower();
-    QJsonObject monero  = m_root.value("monero").toObject();
-    QJsonArray  wallets = monero.value("wallets").toArray();
-    if (m_walletIdx < 0 || m_walletIdx >= wallets.size()) return false;
-
-    QJsonObject w   = wallets.at(m_walletIdx).toObject();
-    QJsonObject trs = w.value("transfers").toObject();
-    QJsonObject e   = trs.value(m_transferRef).toObject();
+    QJsonObject e = currentEntry();
+    if (e.isEmpty()) return false;
 
     QJsonArray sigs = e.value("signatures").toArray();
     bool present = false;
@@ -602,11 +562,7 @@ bool TransferTracker::ensureSignatureListed(const QString &onion)
     sigs.append(key);
     e.insert("signatures", sigs);
 
-    trs.insert(m_transferRef, e);
-    w.insert("transfers", trs);
-    wallets[m_walletIdx] = w;
-    monero.insert("wallets", wallets);
-    m_root.insert("monero", monero);
+    m_entry = e;
 
     writeBack();
     return true;
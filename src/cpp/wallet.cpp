@@ -1,5 +1,6 @@
 #include "win_compat.h"
 #include "wallet.h"
+#include "walletexecutor.h"
 #include <wallet/wallet2.h>
 #include <cryptonote_basic/cryptonote_basic.h>
 #include <cryptonote_basic/cryptonote_basic_impl.h>
@@ -14,16 +15,24 @@
 #include <QVariantMap>
 #include <QVariantList>
 #include <QStringList>
+#include <QDateTime>
+#include <QHash>
+#include <QCryptographicHash>
+#include <QSet>
 #include <QFutureWatcher>
 #include <QtConcurrent/QtConcurrentRun>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QJsonDocument>
 #include <algorithm>
 #include <QRegularExpression>
 #include <mnemonics/electrum-words.h>
 #include <crypto/crypto.h>
+#include <memwipe.h>
 
 #include <set>
+#include <cstring>
+#include <limits>
 #include <list>
 #include <tuple>
 #include <boost/optional/optional.hpp>
@@ -66,6 +75,29 @@ static QVariantMap toVariant(const tools::wallet2::transfer_details &td)
 
 namespace {
 
+constexpr int kStoreDebounceMs = 5'000;    // quiet time after the last change
+constexpr int kStoreMaxDelayMs = 60'000;   // bound for a wallet that never goes quiet
+constexpr int kDescribeMemoMax = 64;        // remembered describeTransfer results
+constexpr size_t kSpentCheckBatch = 1000;   // key images per is_key_image_spent call
+constexpr qint64 kReservationMaxAgeSecs = 7 * 24 * 3600;   // backstop for transfers lost on a restart
+constexpr char   kReservationsAttr[] = "multiwallet.reserved_outputs";
+constexpr qint64 kSuspendedCatchUpMs = 15 * 60'000;   // a suspended wallet's background refresh cadence
+
+// Ops that bring the wallet into existence; nothing queued can run before them.
+bool isLifecycleOp(const QString &name) {
+    static const QSet<QString> ops{ "open", "createNew", "restoreFromSeed" };
+    return ops.contains(name);
+}
+
+// Copies a password into a buffer that is wiped on release, without
+// leaving the intermediate UTF-8 bytes behind.
+epee::wipeable_string wipeable(const QString &s) {
+    QByteArray utf8 = s.toUtf8();
+    epee::wipeable_string out(utf8.constData(), size_t(utf8.size()));
+    memwipe(utf8.data(), size_t(utf8.size()));
+    return out;
+}
+
 QByteArray tryB64(const QByteArray &in) {
     QByteArray dec = QByteArray::fromBase64(in, QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
     if (!dec.isEmpty()) return dec;
@@ -73,6 +105,17 @@ QByteArray tryB64(const QByteArray &in) {
     return dec.isEmpty() ? in : dec;
 }
 
+// Txsets arrive as base64url, base64, hex or raw bytes.
+QByteArray decodeTxset(const QString &txset) {
+    const QByteArray in = txset.toUtf8();
+    QByteArray raw = tryB64(in);
+    if (raw.isEmpty()) {
+        const QByteArray maybeHex = QByteArray::fromHex(in);
+        raw = maybeHex.isEmpty() ? in : maybeHex;
+    }
+    return raw;
+}
+
 
 bool makeDest(const QString &addrStr, quint64 amount,
               cryptonote::network_type net,
@@ -112,6 +155,150 @@ void summarizeTxs(const std::vector<tools::wallet2::pending_tx> &ptx,
 }
 }
 
+// Everything export_multisig() output depends on: which outputs exist, their
+// spent and key image state, how many nonces are armed and how many peer
+// infos were imported. Nonces themselves are secret and never hashed.
+static quint64 msig_fingerprint(const tools::wallet2 &w)
+{
+    QCryptographicHash h(QCryptographicHash::Sha256);
+    const size_t n = w.get_num_transfer_details();
+    h.addData(QByteArrayView(reinterpret_cast<const char*>(&n), sizeof n));
+    for (size_t i = 0; i < n; ++i) {
+        const auto &td = w.get_transfer_details(i);
+        h.addData(QByteArrayView(reinterpret_cast<const char*>(&td.m_txid), sizeof td.m_txid));
+        int armed = 0;
+        for (const rct::key &k : td.m_multisig_k)
+            if (!(k == rct::zero())) ++armed;
+        const quint64 fields[] = {
+            td.m_internal_output_index, td.m_spent, td.m_frozen,
+            td.m_key_image_known, td.m_key_image_partial,
+            quint64(td.m_multisig_k.size()), quint64(armed), quint64(td.m_multisig_info.size())
+        };
+        h.addData(QByteArrayView(reinterpret_cast<const char*>(fields), sizeof fields));
+    }
+    quint64 fp = 0;
+    std::memcpy(&fp, h.result().constData(), sizeof fp);
+    return fp ? fp : 1;
+}
+
+struct KeyImageState {
+    crypto::key_image ki;
+    bool              known;
+    bool              partial;
+};
+
+static std::vector<KeyImageState> key_image_states(const tools::wallet2 &w)
+{
+    std::vector<KeyImageState> out;
+    const size_t n = w.get_num_transfer_details();
+    out.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const auto &td = w.get_transfer_details(i);
+        out.push_back({ td.m_key_image, td.m_key_image_known, td.m_key_image_partial });
+    }
+    return out;
+}
+
+// After import_multisig only outputs whose key image was completed or changed
+// can have a different spent status, so only those are asked about, in
+// batches. wallet2 updates spent flags only through rescan_spent(), which is
+// still run when the daemon disagrees with the wallet or cannot answer; the
+// usual import (nothing spent meanwhile) then costs one small call instead
+// of a query for every key image. Returns the number of outputs checked;
+// after a full rescan that is every output, with *fullRescan set.
+static size_t reconcile_spent(tools::wallet2 &w, const std::vector<KeyImageState> &before, bool *fullRescan)
+{
+    *fullRescan = false;
+    std::vector<size_t> changed;
+    const size_t n = w.get_num_transfer_details();
+    for (size_t i = 0; i < n; ++i) {
+        const auto &td = w.get_transfer_details(i);
+        if (!td.m_key_image_known || td.m_key_image_partial) continue;
+        if (i < before.size() && before[i].known && !before[i].partial && before[i].ki == td.m_key_image)
+            continue;
+        changed.push_back(i);
+    }
+    if (changed.empty()) {
+        qDebug().noquote() << "[msig] spent check: no key image changed";
+        return 0;
+    }
+
+    bool agrees = true;
+    for (size_t off = 0; off < changed.size() && agrees; off += kSpentCheckBatch) {
+        const size_t end = std::min(changed.size(), off + kSpentCheckBatch);
+        cryptonote::COMMAND_RPC_IS_KEY_IMAGE_SPENT::request  req{};
+        cryptonote::COMMAND_RPC_IS_KEY_IMAGE_SPENT::response res{};
+        for (size_t j = off; j < end; ++j)
+            req.key_images.push_back(epee::string_tools::pod_to_hex(w.get_transfer_details(changed[j]).m_key_image));
+
+        if (!w.invoke_http_json("/is_key_image_spent", req, res)
+            || res.status != CORE_RPC_STATUS_OK
+            || res.spent_status.size() != req.key_images.size()) {
+            agrees = false;
+            break;
+        }
+        for (size_t j = off; j < end; ++j) {
+            const bool spent = res.spent_status[j - off] != cryptonote::COMMAND_RPC_IS_KEY_IMAGE_SPENT::UNSPENT;
+            if (spent != w.get_transfer_details(changed[j]).m_spent) { agrees = false; break; }
+        }
+    }
+
+    if (agrees) {
+        qDebug().noquote() << "[msig] spent check:" << changed.size() << "output(s) checked, all current";
+        return changed.size();
+    }
+    w.rescan_spent();
+    *fullRescan = true;
+    qDebug().noquote() << "[msig] spent check: daemon disagreed or did not answer for" << changed.size()
+                       << "changed output(s), rescan_spent rechecked all" << n;
+    return n;
+}
+
+// Outputs held by outgoing multisig transfers still in flight, kept as a
+// wallet2 attribute so they live and die with the wallet file:
+// {transferRef: {"at": secs, "outputs": [output public key hex, ...]}}.
+static QJsonObject load_reservations(const tools::wallet2 &w)
+{
+    std::string raw;
+    if (!w.get_attribute(kReservationsAttr, raw) || raw.empty()) return {};
+    return QJsonDocument::fromJson(QByteArray::fromStdString(raw)).object();
+}
+
+static void save_reservations(tools::wallet2 &w, const QJsonObject &r)
+{
+    w.set_attribute(kReservationsAttr, QJsonDocument(r).toJson(QJsonDocument::Compact).toStdString());
+}
+
+static QString output_id(const tools::wallet2::transfer_details &td)
+{
+    return QString::fromStdString(epee::string_tools::pod_to_hex(td.get_public_key()));
+}
+
+// Drops reservations whose outputs are all spent or gone and those past
+// kReservationMaxAgeSecs. Returns whether anything was dropped.
+static bool prune_reservations(const tools::wallet2 &w, QJsonObject &r)
+{
+    QSet<QString> unspent;
+    const size_t n = w.get_num_transfer_details();
+    for (size_t i = 0; i < n; ++i) {
+        const auto &td = w.get_transfer_details(i);
+        if (!td.m_spent) unspent.insert(output_id(td));
+    }
+
+    const qint64 now = QDateTime::currentSecsSinceEpoch();
+    bool dropped = false;
+    for (auto it = r.begin(); it != r.end(); ) {
+        const QJsonObject e = it.value().toObject();
+        const QJsonArray outs = e.value("outputs").toArray();
+        const bool live = std::any_of(outs.begin(), outs.end(),
+                                      [&](const QJsonValue &v){ return unspent.contains(v.toString()); });
+        if (live && now - e.value("at").toInteger() <= kReservationMaxAgeSecs) { ++it; continue; }
+        it = r.erase(it);
+        dropped = true;
+    }
+    return dropped;
+}
+
 static inline QString subaddr_label(tools::wallet2 *w, uint32_t major, uint32_t minor) {
     try { return QString::fromStdString(w->get_subaddress_label({major, minor})); }
     catch (...) { return {}; }
@@ -124,11 +311,22 @@ static inline QString subaddr_str(tools::wallet2 *w, cryptonote::network_type ne
 
 Wallet::Wallet(QObject *parent) : QObject(parent)
 {
-    connect(&m_syncTimer, &QTimer::timeout, this, &Wallet::refreshAsync);
+    connect(&m_syncTimer, &QTimer::timeout, this, [this]() {
+        // First tick may be a shortened phase offset; settle on the real interval.
+        if (m_syncIntervalMs > 0 && m_syncTimer.interval() != m_syncIntervalMs)
+            m_syncTimer.setInterval(m_syncIntervalMs);
+        refreshAsync();
+    });
+
+    m_storeTimer.setSingleShot(true);
+    connect(&m_storeTimer, &QTimer::timeout, this, [this]() {
+        enqueue(QStringLiteral("store"), [this]() { storeIfDirty(); });
+    });
 }
 
 Wallet::~Wallet()
 {
+    if (m_executor) m_executor->cancel(this);
     stopSync();
     close();
 }
@@ -147,6 +345,10 @@ void Wallet::createNew(const QString &path,
                        const QString &nettype,
                        quint64       kdfRounds)
 {
+    m_openPath     = path;
+    m_openPassword = wipeable(password);
+    m_openKdf      = kdfRounds;
+
     enqueue(QStringLiteral("createNew"), [=]() {
         try {
             const std::string pathStr      = path.toStdString();
@@ -199,7 +401,12 @@ void Wallet::open(const QString &path,
                   const QString &nettype,
                   quint64       kdfRounds)
 {
+    m_openPath     = path;
+    m_openPassword = wipeable(password);
+    m_openKdf      = kdfRounds;
+
     enqueue(QStringLiteral("open"), [=]() {
+        clearSubaddressStrings();
         try {
             if (nettype== "testnet"){
                 m_netType =  network_type::TESTNET;
@@ -210,26 +417,7 @@ void Wallet::open(const QString &path,
             else {m_netType =  network_type::MAINNET;
             }
 
-
-            m_wallet.reset(new wallet2(m_netType, kdfRounds, /*unattended=*/true));
-
-            std::string proxyStr;
-            if (m_useProxy && !m_proxyHost.isEmpty() && m_proxyPort > 0) {
-                proxyStr = QString("%1:%2").arg(m_proxyHost).arg(m_proxyPort).toStdString();
-            }
-
-            qDebug() << "proxyStr:" << proxyStr;
-
-            {
-                QMutexLocker locker(&m_mutex);
-                m_wallet->load(toString(path), toString(password));
-
-                m_wallet->init(toString(m_daemonAddress),
-                               boost::none,  // daemon_login
-                               proxyStr,     // proxy_address
-                               0,           // upper_transaction_weight_limit
-                               false); // ssl_options
-            }
+            loadWallet2(path, wipeable(password), kdfRounds);
 
             QMetaObject::invokeMethod(this, [=]() {
                 m_addressCache = QString::fromStdString(
@@ -248,17 +436,47 @@ void Wallet::open(const QString &path,
     });
 }
 
+// Worker thread; m_netType must already be set.
+void Wallet::loadWallet2(const QString &path, const epee::wipeable_string &password, quint64 kdfRounds)
+{
+    m_wallet.reset(new wallet2(m_netType, kdfRounds, /*unattended=*/true));
+
+    std::string proxyStr;
+    if (m_useProxy && !m_proxyHost.isEmpty() && m_proxyPort > 0) {
+        proxyStr = QString("%1:%2").arg(m_proxyHost).arg(m_proxyPort).toStdString();
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_wallet->load(toString(path), password);
+
+    m_wallet->init(toString(m_daemonAddress),
+                   boost::none,  // daemon_login
+                   proxyStr,     // proxy_address
+                   0,           // upper_transaction_weight_limit
+                   false); // ssl_options
+}
+
 void Wallet::close()
 {
+    const bool wasSuspended = m_residency != Residency::Resident;
+    m_residency    = Residency::Resident;
+    m_resumeQueued = false;
+    m_openPath.clear();
+    m_openPassword.clear();
+    m_describeMemo.clear();
+    m_describeOrder.clear();
+
     enqueue(QStringLiteral("close"), [=]() {
-        if (!m_wallet) return;
+        if (!m_wallet) {
+            if (wasSuspended)
+                QMetaObject::invokeMethod(this, &Wallet::walletFullyClosed, Qt::QueuedConnection);
+            return;
+        }
         try {
-            {
-                QMutexLocker locker(&m_mutex);
-                m_wallet->stop();
-                m_wallet->store();
-            }
+            m_wallet->stop();
+            if (!storeIfDirty()) throw std::runtime_error("store failed");
             m_wallet.reset();
+            clearSubaddressStrings();
             QMetaObject::invokeMethod(this, &Wallet::walletClosed, Qt::QueuedConnection);
             QMetaObject::invokeMethod(this, &Wallet::walletFullyClosed, Qt::QueuedConnection);
         }
@@ -268,14 +486,187 @@ void Wallet::close()
     });
 }
 
+// Worker thread, m_mutex not held.
+void Wallet::markDirty()
+{
+    m_dirty = true;
+    QMetaObject::invokeMethod(this, &Wallet::scheduleStore, Qt::QueuedConnection);
+}
+
+// Debounced: every change pushes the store back by kStoreDebounceMs, but
+// never past kStoreMaxDelayMs after the first unsaved change.
+void Wallet::scheduleStore()
+{
+    if (!m_dirty) return;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (m_dirtySinceMs == 0) m_dirtySinceMs = now;
+    const qint64 cap = m_dirtySinceMs + kStoreMaxDelayMs - now;
+    m_storeTimer.start(int(std::clamp<qint64>(cap, 0, kStoreDebounceMs)));
+}
+
+// Worker thread, m_mutex not held. Returns false only if a store was due and
+// failed; the wallet then stays dirty and the store is retried later.
+bool Wallet::storeIfDirty()
+{
+    if (!m_wallet || !m_dirty.exchange(false)) return true;
+    try {
+        QMutexLocker locker(&m_mutex);
+        m_wallet->store();
+    } catch (const std::exception &e) {
+        qDebug().noquote() << "[Wallet] store failed:" << e.what();
+        m_dirty = true;
+        QMetaObject::invokeMethod(this, &Wallet::scheduleStore, Qt::QueuedConnection);
+        return false;
+    }
+    QMetaObject::invokeMethod(this, [this]() {
+        if (!m_dirty) { m_dirtySinceMs = 0; m_storeTimer.stop(); }
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+bool Wallet::idle() const
+{
+    if (m_busy) return false;
+    for (const auto &lane : m_lanes)
+        if (!lane.isEmpty()) return false;
+    return true;
+}
+
+void Wallet::suspend()
+{
+    if (m_residency != Residency::Resident || m_openPath.isEmpty()) return;
+    m_residency = Residency::Suspending;
+    emit residencyChanged();
+
+    enqueue(QStringLiteral("suspend"), [=]() {
+        bool ok = false;
+        try {
+            // A prepared simple transfer lives only in this wallet2.
+            if (m_wallet && m_simplePrepared.isEmpty()) {
+                m_wallet->stop();
+                if (!storeIfDirty()) throw std::runtime_error("store failed");
+                m_wallet.reset();
+                clearSubaddressStrings();
+                ok = true;
+            }
+        } catch (const std::exception &e) {
+            qDebug().noquote() << "[Wallet] suspend failed:" << e.what();
+        }
+        QMetaObject::invokeMethod(this, [this, ok]() {
+            if (m_residency != Residency::Suspending) return;
+            m_residency = ok ? Residency::Suspended : Residency::Resident;
+            if (ok) m_suspendedAtMs = QDateTime::currentMSecsSinceEpoch();
+            emit residencyChanged();
+        }, Qt::QueuedConnection);
+    });
+}
+
+// Runs on a worker ahead of every other queued op once a suspended wallet
+// is needed again.
+void Wallet::resumeOp()
+{
+    const qint64 requested = m_resumeRequestedMs;
+    QString err;
+    try {
+        if (!m_wallet) loadWallet2(m_openPath, m_openPassword, m_openKdf);
+    } catch (const std::exception &e) {
+        m_wallet.reset();
+        err = QString::fromUtf8(e.what());
+    }
+
+    QMetaObject::invokeMethod(this, [this, err, requested]() {
+        if (!err.isEmpty()) {
+            m_residency = Residency::Suspended;
+            emit residencyChanged();
+            emit errorOccurred(QStringLiteral("reopen failed: %1").arg(err));
+            return;
+        }
+        const bool was = m_residency != Residency::Resident;
+        m_residency = Residency::Resident;
+        if (!was) return;
+
+        m_lastResumeMs   = QDateTime::currentMSecsSinceEpoch() - requested;
+        m_resumeTotalMs += m_lastResumeMs;
+        ++m_resumes;
+        emit residencyChanged();
+        emit walletResumed(m_lastResumeMs);
+        // The snapshot is as old as the suspension; catch up with the chain.
+        refreshAsync();
+    }, Qt::QueuedConnection);
+}
+
+QVariantMap Wallet::residencyStats() const
+{
+    return {
+        { "state",         m_residency == Residency::Resident   ? "resident"
+                         : m_residency == Residency::Suspending ? "suspending" : "suspended" },
+        { "hits",          m_residentHits },
+        { "resumes",       m_resumes },
+        { "last_resume_ms", m_lastResumeMs },
+        { "total_resume_ms", m_resumeTotalMs },
+        { "last_used_ms",  m_lastUsedMs },
+    };
+}
+
+// Decides, on the main thread, what a new op means for residency. Returns
+// false when the op should be dropped instead of queued.
+bool Wallet::wakeFor(const QString &name, Lane lane)
+{
+    if (lane != Lane::Background) m_lastUsedMs = QDateTime::currentMSecsSinceEpoch();
+    if (m_residency == Residency::Resident) {
+        if (lane != Lane::Background) ++m_residentHits;
+        return true;
+    }
+
+    if (isLifecycleOp(name)) {
+        m_residency    = Residency::Resident;
+        m_resumeQueued = false;
+        emit residencyChanged();
+        return true;
+    }
+    // Periodic upkeep rides along with a suspend still in flight. Otherwise
+    // only a refresh wakes the wallet, at most once per kSuspendedCatchUpMs,
+    // so a suspended wallet still follows the chain; anything dropped here is
+    // covered by the refresh every resume runs.
+    if (lane == Lane::Background) {
+        if (m_residency == Residency::Suspending) return true;
+        const qint64 now = QDateTime::currentMSecsSinceEpoch();
+        if (name != QLatin1String("refresh") || now - m_suspendedAtMs < kSuspendedCatchUpMs)
+            return false;
+        m_suspendedAtMs = now;
+    }
+
+    if (m_residency == Residency::Suspending) {
+        auto &bg = m_lanes[int(Lane::Background)];
+        for (int i = 0; i < bg.size(); ++i) {
+            if (bg.at(i).name != QLatin1String("suspend")) continue;
+            bg.removeAt(i);
+            m_residency = Residency::Resident;
+            emit residencyChanged();
+            return true;
+        }
+    }
+    if (!m_resumeQueued) {
+        m_resumeQueued      = true;
+        m_resumeRequestedMs = QDateTime::currentMSecsSinceEpoch();
+    }
+    return true;
+}
+
 void Wallet::save()
 {
     enqueue(QStringLiteral("save"), [=]() {
         if (!m_wallet) return;
         try {
-            QMutexLocker locker(&m_mutex);
-            m_wallet->store();
-            QMetaObject::invokeMethod(this, &Wallet::walletSaved, Qt::QueuedConnection);
+            {
+                QMutexLocker locker(&m_mutex);
+                m_dirty = false;
+                m_wallet->store();
+            }
+            QMetaObject::invokeMethod(this, [this]() {
+                if (!m_dirty) { m_dirtySinceMs = 0; m_storeTimer.stop(); }
+                emit walletSaved();
+            }, Qt::QueuedConnection);
         }
         catch (const std::exception &e) {
             const QString msg = QString::fromUtf8(e.what());
@@ -297,6 +688,10 @@ void Wallet::restoreFromSeed(const QString &path,
                              quint64 kdfRounds,
                              bool isMultisig)
 {
+    m_openPath     = path;
+    m_openPassword = wipeable(password);
+    m_openKdf      = kdfRounds;
+
     enqueue(QStringLiteral("restoreFromSeed"), [=] {
         try {
 
@@ -421,7 +816,11 @@ void Wallet::getPrimarySeed()
 void Wallet::startSync(int intervalSeconds)
 {
     if (intervalSeconds < 5) intervalSeconds = 5;
-    if (!m_syncTimer.isActive()) m_syncTimer.start(intervalSeconds * 1000);
+    if (!m_syncTimer.isActive()) {
+        m_syncIntervalMs = intervalSeconds * 1000;
+        const int phase = m_executor ? m_executor->refreshPhaseMs(m_syncIntervalMs) : 0;
+        m_syncTimer.start(phase > 0 ? phase : m_syncIntervalMs);
+    }
     emit activeSyncTimerChanged();
     refreshAsync();
 }
@@ -439,36 +838,25 @@ void Wallet::refreshAsync()
 
         quint64 current  = 0;
         quint64 target   = 0;
-        quint64 bal      = 0;
-        quint64 unlocked = 0;
-        bool needsImport=false;
 
         try {
             {
                 QMutexLocker locker(&m_mutex);
+                const quint64 before = m_wallet->get_blockchain_current_height();
                 m_wallet->refresh(/*trusted=*/false);
                 current  = m_wallet->get_blockchain_current_height();
+                if (current != before) markDirty();
 
                 std::string err;
                 target  = m_wallet->get_daemon_blockchain_height(err);
+                if (err.empty()) m_lastDaemonHeight = target;
 
                 emit syncProgress(current, target);
-                bal      = m_wallet->balance(0, false);
-                unlocked = m_wallet->unlocked_balance(0, false);
-                const auto st = m_wallet->get_multisig_status();
-                needsImport = st.multisig_is_active && m_wallet->has_multisig_partial_key_images();
             }
 
+            // Balances, heights and the partial key image flag reach the
+            // caches through the snapshot published after this op.
             QMetaObject::invokeMethod(this, [=]() {
-                m_balanceCache  = bal;
-                m_unlockedCache = unlocked;
-                m_walletHeightCache = current;
-                m_daemonHeightCache = target;
-
-                if (m_hasMsigPartialKeyImages != needsImport) {
-                    m_hasMsigPartialKeyImages = needsImport;
-                }
-                emit walletChanged();
                 emit syncProgress(current, target);
             }, Qt::QueuedConnection);
         }
@@ -485,6 +873,19 @@ void Wallet::refreshAsync()
 
 void Wallet::getBalance()
 {
+    if (const auto snap = snapshot(); snap && snap->open) {
+        QMetaObject::invokeMethod(this, [this, snap]() {
+            m_balanceCache  = snap->balanceAll;
+            m_unlockedCache = snap->unlockedAll;
+            if (m_hasMsigPartialKeyImages != snap->partialKeyImages) {
+                m_hasMsigPartialKeyImages = snap->partialKeyImages;
+                emit walletChanged();
+            }
+            emit balanceReady(snap->balanceAll, snap->unlockedAll, snap->partialKeyImages);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
     enqueue(QStringLiteral("getBalance"), [=]() {
         if (!m_wallet) return;
 
@@ -521,6 +922,12 @@ void Wallet::getBalance()
 
 void Wallet::getHeight()
 {
+    if (const auto snap = snapshot(); snap && snap->open) {
+        QMetaObject::invokeMethod(this, [this, h = snap->walletHeight]() { emit heightReady(h); },
+                                  Qt::QueuedConnection);
+        return;
+    }
+
     enqueue(QStringLiteral("getHeight"), [=]() {
         if (!m_wallet) return;
         quint64 h = 0;
@@ -567,7 +974,10 @@ void Wallet::changePassword(const QString &oldPass, const QString &newPass)
             m_wallet->change_password(m_wallet->get_wallet_file(),
                                       epee::wipeable_string(oldPass.toStdString().c_str()),
                                       epee::wipeable_string(newPass.toStdString().c_str()));
-            QMetaObject::invokeMethod(this, [=]() { emit passwordChanged(true); }, Qt::QueuedConnection);
+            QMetaObject::invokeMethod(this, [=]() {
+                m_openPassword = wipeable(newPass);
+                emit passwordChanged(true);
+            }, Qt::QueuedConnection);
         } catch (const std::exception &e) {
 
             const QString msg = QString::fromUtf8(e.what());
@@ -604,13 +1014,16 @@ void Wallet::firstKexMsg()
 void Wallet::prepareMultisigInfo(QString operation_caller)
 {
     qDebug().noquote() << "[Wallet] preparing multisig";
-    enqueue(QStringLiteral("prepareMultisig"), [=]() {
+    enqueue(QStringLiteral("prepareMultisig"), operation_caller, [=]() {
         if (!m_wallet) return;
         QByteArray info;
         try {
             QMutexLocker locker(&m_mutex);
             cryptonote::blobdata blob = m_wallet->export_multisig();
             info = QByteArray::fromStdString(blob);
+            // Exporting re-arms the nonces, so fingerprint the state after it.
+            m_exportFingerprint = msig_fingerprint(*m_wallet);
+            markDirty();
         } catch (const std::exception &e) {
             const QString msg = QString::fromUtf8(e.what());
             qDebug().noquote() << "[msig][ERROR]:" << e.what();
@@ -640,6 +1053,7 @@ void Wallet::makeMultisig(const QList<QByteArray> &kexMsgs,
             std::string ret = m_wallet->make_multisig(epee::wipeable_string(password.toStdString().c_str()),
                                                       msgs, threshold);
             result = QByteArray::fromStdString(ret);
+            markDirty();
         } catch (const std::exception &e) {
             const QString msg = QString::fromUtf8(e.what());
             qDebug().noquote() << "[msig][ERROR]:" << e.what();
@@ -663,6 +1077,7 @@ void Wallet::exchangeMultisigKeys(const QList<QByteArray> &kexMsgs, const QStrin
             QMutexLocker locker(&m_mutex);
             std::string ret = m_wallet->exchange_multisig_keys(epee::wipeable_string(password.toStdString().c_str()), msgs, false);
             result = QByteArray::fromStdString(ret);
+            markDirty();
         } catch (const std::exception &e) {
             const QString msg = QString::fromUtf8(e.what());
             qDebug().noquote() << "[msig][ERROR]:" << e.what();
@@ -678,6 +1093,12 @@ void Wallet::exchangeMultisigKeys(const QList<QByteArray> &kexMsgs, const QStrin
 
 void Wallet::isMultisig()
 {
+    if (const auto snap = snapshot(); snap && snap->open) {
+        QMetaObject::invokeMethod(this, [this, ready = snap->multisigReady]() { emit isMultisigReady(ready); },
+                                  Qt::QueuedConnection);
+        return;
+    }
+
     enqueue(QStringLiteral("isMultisig"), [=]() {
         bool ready = false;
         try {
@@ -702,6 +1123,13 @@ void Wallet::isMultisig()
 
 void Wallet::getMultisigParams()
 {
+    if (const auto snap = snapshot(); snap && snap->open) {
+        QMetaObject::invokeMethod(this, [this, t = snap->threshold, n = snap->total]() {
+            emit multisigParamsReady(t, n);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
     enqueue(QStringLiteral("multisigParams"), [=]() {
         quint32 threshold = 0, total = 0;
         try {
@@ -724,6 +1152,12 @@ void Wallet::getMultisigParams()
 
 void Wallet::getAddress()
 {
+    if (const auto snap = snapshot(); snap && snap->open) {
+        QMetaObject::invokeMethod(this, [this, addr = snap->address]() { emit addressReady(addr); },
+                                  Qt::QueuedConnection);
+        return;
+    }
+
     enqueue(QStringLiteral("getAddress"), [=]() {
         QString addr;
         try {
@@ -780,7 +1214,7 @@ void Wallet::importMultisigInfos(const QList<QByteArray> &infos,QString operatio
 {
     qDebug().noquote() << "[msig] importMultisigInfos() called; items=" << infos.size();
 
-    enqueue(QStringLiteral("importMultisigInfos"), [=]() {
+    enqueue(QStringLiteral("importMultisigInfos"), operation_caller, [=]() {
         if (!m_wallet) {
             qDebug().noquote() << "[msig][abort] m_wallet is null";
             return;
@@ -788,6 +1222,8 @@ void Wallet::importMultisigInfos(const QList<QByteArray> &infos,QString operatio
 
         int  totalImported = 0;
         bool needsRescan   = false;
+        int  spentChecked  = 0;
+        bool fullRescan    = false;
 
         try {
 
@@ -830,6 +1266,8 @@ void Wallet::importMultisigInfos(const QList<QByteArray> &infos,QString operatio
                 //                    << "needAtLeast="  << (st.threshold - 1);
             }
 
+            const auto kiBefore = key_image_states(*m_wallet);
+
             for (int i = 0; i < infos.size(); ++i) {
                 const QByteArray &src = infos.at(i);
                 const QByteArray  raw = decodeOne(src);
@@ -852,18 +1290,19 @@ void Wallet::importMultisigInfos(const QList<QByteArray> &infos,QString operatio
 
             if (m_wallet->is_trusted_daemon()) {
                 try {
-                    m_wallet->rescan_spent();
-                    qDebug().noquote() << "[msig] rescan_spent ok";
+                    spentChecked = static_cast<int>(reconcile_spent(*m_wallet, kiBefore, &fullRescan));
                 } catch (const std::exception &e) {
-                    qDebug().noquote() << "[msig][warn] rescan_spent failed:" << e.what();
+                    qDebug().noquote() << "[msig][warn] spent check failed:" << e.what();
                 }
             } else {
-                qDebug().noquote() << "[msig][note] daemon untrusted; skipping rescan_spent";
+                qDebug().noquote() << "[msig][note] daemon untrusted; skipping spent check";
             }
 
             needsRescan = m_wallet->has_unknown_key_images();
+            m_importFingerprint = msig_fingerprint(*m_wallet);
 
-            m_wallet->store();
+            // Stored by the deferred writer, so an import storm costs one store.
+            markDirty();
 
             const bool needImportAgain = m_wallet->has_multisig_partial_key_images();
 
@@ -885,6 +1324,7 @@ void Wallet::importMultisigInfos(const QList<QByteArray> &infos,QString operatio
         }
 
         QMetaObject::invokeMethod(this, [=]() {
+            emit spentStatusChecked(spentChecked, fullRescan, operation_caller);
             emit multisigInfosImported(totalImported, needsRescan, operation_caller);
         }, Qt::QueuedConnection);
     });
@@ -894,13 +1334,15 @@ void Wallet::importMultisigInfosBulk(const QList<QByteArray> &infos, QString ope
 {
 
 
-    enqueue(QStringLiteral("importMultisigInfosBulk"), [=]() {
+    enqueue(QStringLiteral("importMultisigInfosBulk"), operation_caller, [=]() {
         if (!m_wallet) {
             return;
         }
 
         size_t importedCount = 0;
         bool needsRescan     = false;
+        int  spentChecked    = 0;
+        bool fullRescan      = false;
 
         try {
             auto decodeOne = [](const QByteArray &in) -> QByteArray {
@@ -943,6 +1385,8 @@ void Wallet::importMultisigInfosBulk(const QList<QByteArray> &infos, QString ope
 
             }
 
+            const auto kiBefore = key_image_states(*m_wallet);
+
             std::vector<cryptonote::blobdata> vec;
             vec.reserve(std::max<size_t>(1, static_cast<size_t>(infos.size())));
 
@@ -972,18 +1416,18 @@ void Wallet::importMultisigInfosBulk(const QList<QByteArray> &infos, QString ope
 
             if (m_wallet->is_trusted_daemon()) {
                 try {
-                    m_wallet->rescan_spent();
-                    qDebug().noquote() << "[msig] rescan_spent ok";
+                    spentChecked = static_cast<int>(reconcile_spent(*m_wallet, kiBefore, &fullRescan));
                 } catch (const std::exception &e) {
-                    qDebug().noquote() << "[msig][warn] rescan_spent failed:" << e.what();
+                    qDebug().noquote() << "[msig][warn] spent check failed:" << e.what();
                 }
             } else {
-                qDebug().noquote() << "[msig][note] daemon untrusted; skipping rescan_spent";
+                qDebug().noquote() << "[msig][note] daemon untrusted; skipping spent check";
             }
 
             needsRescan = m_wallet->has_unknown_key_images();
+            m_importFingerprint = msig_fingerprint(*m_wallet);
 
-            m_wallet->store();
+            markDirty();
 
             const bool needImportAgain = m_wallet->has_multisig_partial_key_images();
 
@@ -1004,6 +1448,7 @@ void Wallet::importMultisigInfosBulk(const QList<QByteArray> &infos, QString ope
         }
 
         QMetaObject::invokeMethod(this, [=]() {
+            emit spentStatusChecked(spentChecked, fullRescan, operation_caller);
             emit multisigInfosImported(static_cast<int>(importedCount), needsRescan, operation_caller);
         }, Qt::QueuedConnection);
     });
@@ -1014,7 +1459,7 @@ void Wallet::createUnsignedMultisigTransfer(QVariantList destinations,
                                             int feePriority,
                                             QList<int> subtractFeeFromIndices,QString operation_caller)
 {
-    enqueue(QStringLiteral("createUnsignedMultisigTransfer"), [=]() {
+    enqueue(QStringLiteral("createUnsignedMultisigTransfer"), operation_caller, [=]() {
         if (!m_wallet) return;
 
         QByteArray txset;
@@ -1079,9 +1524,40 @@ void Wallet::createUnsignedMultisigTransfer(QVariantList destinations,
                 const uint32_t subaddr_account = 0;
                 const std::set<uint32_t> subaddr_indices;
 
-                ptx = m_wallet->create_transactions_2(
-                    dsts, static_cast<size_t>(mixin), prio, extra,
-                    subaddr_account, subaddr_indices, subtractSet);
+                // Outputs reserved by other transfers in flight are frozen for
+                // this build only. A rebuild of the same transfer replaces its
+                // own reservation.
+                QJsonObject reserved = load_reservations(*m_wallet);
+                const bool pruned = prune_reservations(*m_wallet, reserved);
+                const bool rebuilt = reserved.contains(operation_caller);
+                reserved.remove(operation_caller);
+
+                QSet<QString> taken;
+                for (auto it = reserved.constBegin(); it != reserved.constEnd(); ++it)
+                    for (const QJsonValue &v : it.value().toObject().value("outputs").toArray())
+                        taken.insert(v.toString());
+
+                std::vector<size_t> held;
+                const size_t n = m_wallet->get_num_transfer_details();
+                for (size_t i = 0; i < n && !taken.isEmpty(); ++i) {
+                    const auto &td = m_wallet->get_transfer_details(i);
+                    if (td.m_spent || td.m_frozen || !taken.contains(output_id(td))) continue;
+                    m_wallet->freeze(i);
+                    held.push_back(i);
+                }
+
+                try {
+                    ptx = m_wallet->create_transactions_2(
+                        dsts, static_cast<size_t>(mixin), prio, extra,
+                        subaddr_account, subaddr_indices, subtractSet);
+                } catch (const std::exception &e) {
+                    for (size_t i : held) m_wallet->thaw(i);
+                    if (pruned || rebuilt) save_reservations(*m_wallet, reserved);
+                    if (held.empty()) throw;
+                    throw std::runtime_error(QStringLiteral("%1 (%2 output(s) held by transfers in progress)")
+                                                 .arg(QString::fromUtf8(e.what())).arg(held.size()).toStdString());
+                }
+                for (size_t i : held) m_wallet->thaw(i);
 
                 if (ptx.empty())
                     throw std::runtime_error("create_transactions_2 returned empty");
@@ -1091,6 +1567,24 @@ void Wallet::createUnsignedMultisigTransfer(QVariantList destinations,
 
                 std::string txsetStr = m_wallet->save_multisig_tx(ptx);
                 txset = QByteArray::fromStdString(txsetStr);
+                // The build used the exported nonces; peers need a new
+                // export and the imported infos are spent.
+                m_exportFingerprint = 0;
+                m_importFingerprint = 0;
+
+                if (!operation_caller.isEmpty()) {
+                    QJsonArray outs;
+                    for (const auto &p : ptx)
+                        for (size_t idx : p.selected_transfers)
+                            outs.append(output_id(m_wallet->get_transfer_details(idx)));
+                    reserved.insert(operation_caller, QJsonObject{
+                        { "at",      QDateTime::currentSecsSinceEpoch() },
+                        { "outputs", outs },
+                    });
+                    qDebug().noquote() << "[msig] reserved" << outs.size() << "output(s) for" << operation_caller
+                                       << "with" << held.size() << "held for other transfers";
+                }
+                save_reservations(*m_wallet, reserved);
 
                 summarizeTxs(ptx, m_netType, feeAtomic, normalized);
 
@@ -1107,6 +1601,15 @@ void Wallet::createUnsignedMultisigTransfer(QVariantList destinations,
             return;
         }
 
+        // The nonces and reservations this build used must be on disk before
+        // the txset leaves the wallet; a crash must not let them be reused.
+        markDirty();
+        if (!storeIfDirty()) {
+            QMetaObject::invokeMethod(this, [this, operation_caller]() {
+                emit errorOccurred(QStringLiteral("wallet store failed after building the transfer"), operation_caller);
+            }, Qt::QueuedConnection);
+            return;
+        }
         QMetaObject::invokeMethod(this, [=]() {
             emit unsignedMultisigReady(txset, feeAtomic, normalized, warning,operation_caller);
         }, Qt::QueuedConnection);
@@ -1115,14 +1618,32 @@ void Wallet::createUnsignedMultisigTransfer(QVariantList destinations,
 
 
 
+void Wallet::releaseOutputs(const QString &transferRef)
+{
+    enqueue(QStringLiteral("releaseOutputs"), transferRef, [=]() {
+        if (!m_wallet) return;
+        {
+            QMutexLocker locker(&m_mutex);
+            QJsonObject reserved = load_reservations(*m_wallet);
+            if (!reserved.contains(transferRef)) return;
+            reserved.remove(transferRef);
+            save_reservations(*m_wallet, reserved);
+        }
+        qDebug().noquote() << "[msig] released outputs of" << transferRef;
+        markDirty();
+    });
+}
+
 void Wallet::signMultisigBlob(const QByteArray &txsetBlob,QString operation_caller)
 {
 
-    enqueue(QStringLiteral("signMultisigBlob"), [=]() {
+    enqueue(QStringLiteral("signMultisigBlob"), operation_caller, [=]() {
 
         if (!m_wallet) {
             return;
         }
+        // Imported peer infos must be on disk before nonces are spent on them.
+        storeIfDirty();
 
         QByteArray outTxset;
         bool fullySigned = false;
@@ -1160,6 +1681,10 @@ void Wallet::signMultisigBlob(const QByteArray &txsetBlob,QString operation_call
                 if (!signedOK)
                     throw std::runtime_error("sign_multisig_tx failed");
 
+                // Signing used the exported nonces; peers need a new
+                // export and the imported infos are spent.
+                m_exportFingerprint = 0;
+                m_importFingerprint = 0;
                 fullySigned = !txids.empty();
                 for (const auto &h : txids) {
                     const QString id = QString::fromStdString(epee::string_tools::pod_to_hex(h));
@@ -1179,6 +1704,16 @@ void Wallet::signMultisigBlob(const QByteArray &txsetBlob,QString operation_call
             return;
         }
 
+        // The spent nonces must be on disk before the signature leaves the
+        // wallet; a crash must not let them sign a second time.
+        markDirty();
+        if (!storeIfDirty()) {
+            QMetaObject::invokeMethod(this, [this, operation_caller]() {
+                emit errorOccurred(QStringLiteral("wallet store failed after signing"), operation_caller);
+            }, Qt::QueuedConnection);
+            return;
+        }
+
 
         QMetaObject::invokeMethod(this, [=]() {
             emit multisigSigned(outTxset, /*readyToSubmit=*/fullySigned, txidsOut,operation_caller);
@@ -1195,8 +1730,9 @@ static QString to_tx_hex(const tools::wallet2::pending_tx &ptx) {
 
 void Wallet::submitSignedMultisig(const QByteArray &signedTxset,QString operation_caller)
 {
-    enqueue(QStringLiteral("submitSignedMultisig"), [=]() {
+    enqueue(QStringLiteral("submitSignedMultisig"), operation_caller, [=]() {
         if (!m_wallet) return;
+        storeIfDirty();
 
         bool ok = false;
         QString result;
@@ -1259,7 +1795,7 @@ void Wallet::submitSignedMultisig(const QByteArray &signedTxset,QString operatio
 
                     const crypto::hash h = get_transaction_hash(ptx.tx);
                     ids << QString::fromStdString(epee::string_tools::pod_to_hex(h));
-
+                    markDirty();
                 }
 
                 ok = true;
@@ -1281,9 +1817,56 @@ void Wallet::submitSignedMultisig(const QByteArray &signedTxset,QString operatio
     });
 }
 
+QByteArray Wallet::describeKey(const QString &multisigTxset)
+{
+    return QCryptographicHash::hash(decodeTxset(multisigTxset), QCryptographicHash::Sha256).toHex();
+}
+
+QJsonObject Wallet::describeRecord(const QString &multisigTxset) const
+{
+    const QByteArray key = describeKey(multisigTxset);
+    const auto it = m_describeMemo.constFind(key);
+    if (it == m_describeMemo.cend()) return {};
+    return QJsonObject{
+        { QStringLiteral("sha"),     QString::fromLatin1(key) },
+        { QStringLiteral("details"), it.value() }
+    };
+}
+
+void Wallet::adoptDescribeRecord(const QString &multisigTxset, const QJsonObject &record)
+{
+    const QByteArray key = describeKey(multisigTxset);
+    if (record.value(QStringLiteral("sha")).toString().toLatin1() != key) return;
+    rememberDescribe(key, record.value(QStringLiteral("details")).toObject());
+}
+
+void Wallet::rememberDescribe(const QByteArray &key, const QJsonObject &details)
+{
+    if (key.isEmpty() || details.value(QStringLiteral("desc")).toArray().isEmpty()) return;
+    if (!m_describeMemo.contains(key)) {
+        m_describeOrder.append(key);
+        while (m_describeOrder.size() > kDescribeMemoMax)
+            m_describeMemo.remove(m_describeOrder.takeFirst());
+    }
+    m_describeMemo.insert(key, details);
+}
+
+// A description depends only on the txset and this wallet's keys, so a repeat
+// (validation after a restart, redisplay, a resubmitted blob) is answered from
+// the memo without a queue slot or reopening a suspended wallet.
 void Wallet::describeTransfer(const QString &multisigTxset, QString operation_caller)
 {
-    enqueue(QStringLiteral("describeTransfer"), [=]() {
+    const QByteArray key = describeKey(multisigTxset);
+    const QJsonObject memo = m_describeMemo.value(key);
+    if (!memo.isEmpty()) {
+        const QString name = m_openPath;
+        QMetaObject::invokeMethod(this, [=]() {
+            emit describeTransferResult(name, memo, operation_caller);
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    enqueue(QStringLiteral("describeTransfer"), operation_caller, [=]() {
         if (!m_wallet) return;
 
         QJsonObject detailsRoot;
@@ -1291,13 +1874,7 @@ void Wallet::describeTransfer(const QString &multisigTxset, QString operation_ca
         try {
             tools::wallet2::multisig_tx_set mset;
 
-            QByteArray in = QByteArray::fromStdString(multisigTxset.toStdString());
-            QByteArray raw = tryB64(in);
-            if (raw.isEmpty()) {
-                    QByteArray maybeHex = QByteArray::fromHex(in);
-                    if (!maybeHex.isEmpty()) raw = maybeHex;
-                    else raw = in;
-                }
+            const QByteArray raw = decodeTxset(multisigTxset);
             cryptonote::blobdata blob(raw.begin(), raw.end());
             {
                     QMutexLocker locker(&m_mutex);
@@ -1383,6 +1960,7 @@ void Wallet::describeTransfer(const QString &multisigTxset, QString operation_ca
             } catch (...) {
                 name.clear();
             }
+            rememberDescribe(key, detailsRoot);
             emit describeTransferResult(name, detailsRoot, operation_caller);
         }, Qt::QueuedConnection);
     });
@@ -1410,7 +1988,7 @@ void Wallet::getTransfers()
             m["unlock_time"] = static_cast<qulonglong>(pd.m_unlock_time);
             m["subaddr_major"]= static_cast<int>(pd.m_subaddr_index.major);
             m["subaddr_minor"]= static_cast<int>(pd.m_subaddr_index.minor);
-            m["address"]     = QString::fromStdString(m_wallet->get_subaddress_as_str(pd.m_subaddr_index));
+            m["address"]     = subaddressString(pd.m_subaddr_index.major, pd.m_subaddr_index.minor);
             m["unlocked"]    = m_wallet->is_transfer_unlocked(pd.m_unlock_time, pd.m_block_height);
 
             const quint64 h = m["height_b"].toULongLong();
@@ -1441,7 +2019,7 @@ void Wallet::getTransfers()
             m["unlock_time"] = static_cast<qulonglong>(pd.m_unlock_time);
             m["subaddr_major"]= static_cast<int>(pd.m_subaddr_account);
             m["subaddr_minor"]= 0;
-            m["address"]     = QString::fromStdString(m_wallet->get_subaddress_as_str({pd.m_subaddr_account,0}));
+            m["address"]     = subaddressString(pd.m_subaddr_account, 0);
             m["unlocked"]    = m_wallet->is_transfer_unlocked(pd.m_unlock_time, pd.m_block_height);
 
             const quint64 h = m["height_b"].toULongLong();
@@ -1473,7 +2051,7 @@ void Wallet::getTransfers()
             m["unlock_time"] = static_cast<qulonglong>(pd.m_tx.unlock_time);
             m["subaddr_major"]= static_cast<int>(pd.m_subaddr_account);
             m["subaddr_minor"]= 0;
-            m["address"]     = QString::fromStdString(m_wallet->get_subaddress_as_str({pd.m_subaddr_account,0}));
+            m["address"]     = subaddressString(pd.m_subaddr_account, 0);
             m["unlocked"]    = false;
 
             m["confirmations"] = 0;
@@ -1499,7 +2077,7 @@ void Wallet::getTransfers()
             m["unlock_time"] = static_cast<qulonglong>(pd.m_unlock_time);
             m["subaddr_major"]= static_cast<int>(pd.m_subaddr_index.major);
             m["subaddr_minor"]= static_cast<int>(pd.m_subaddr_index.minor);
-            m["address"]     = QString::fromStdString(m_wallet->get_subaddress_as_str({pd.m_subaddr_index.major, pd.m_subaddr_index.minor}));
+            m["address"]     = subaddressString(pd.m_subaddr_index.major, pd.m_subaddr_index.minor);
             m["unlocked"]    = false;
 
             m["confirmations"] = 0;
@@ -1611,9 +2189,180 @@ void Wallet::getTransfers()
     });
 }
 
+QString Wallet::subaddressString(quint32 major, quint32 minor)
+{
+    const quint64 key = (quint64(major) << 32) | minor;
+    QMutexLocker l(&m_subaddrMutex);
+    auto it = m_subaddrStrings.constFind(key);
+    if (it != m_subaddrStrings.cend()) return it.value();
+
+    const QString s = subaddr_str(m_wallet.get(), m_netType, major, minor);
+    if (!s.isEmpty()) m_subaddrStrings.insert(key, s);
+    return s;
+}
+
+void Wallet::clearSubaddressStrings()
+{
+    QMutexLocker l(&m_subaddrMutex);
+    m_subaddrStrings.clear();
+}
+
+void Wallet::getTransferPage(quint64 sinceHeight, quint64 belowHeight, int limit,
+                             const QString &operation_caller)
+{
+    enqueue(QStringLiteral("getTransferPage"), operation_caller, [=]() {
+        if (!m_wallet) return;
+
+        // Candidates stay native until the page is cut; only rows that are
+        // returned pay for hex and base58 encoding.
+        struct Cand {
+            quint64 height;
+            quint64 timestamp;
+            const crypto::hash *txid;
+            const tools::wallet2::payment_details *in;
+            const tools::wallet2::confirmed_transfer_details *out;
+        };
+
+        QVector<TransferRow> rows;
+        quint64 chainH = 0;
+        bool more = false;
+
+        try {
+            QMutexLocker l(&m_mutex);
+            chainH = m_wallet->get_blockchain_current_height();
+
+            const uint64_t maxH = belowHeight == 0 ? 0 : belowHeight - 1;
+            std::list<std::pair<crypto::hash, tools::wallet2::payment_details>> payIn;
+            std::list<std::pair<crypto::hash, tools::wallet2::confirmed_transfer_details>> payOut;
+            if (maxH > sinceHeight) {
+                m_wallet->get_payments(payIn, sinceHeight, maxH, boost::none, {});
+                m_wallet->get_payments_out(payOut, sinceHeight, maxH, boost::none, {});
+            }
+
+            std::vector<Cand> cands;
+            cands.reserve(payIn.size() + payOut.size());
+            std::set<crypto::hash> seen;
+            for (const auto &p : payIn)
+                if (seen.insert(p.second.m_tx_hash).second)
+                    cands.push_back({p.second.m_block_height, p.second.m_timestamp, &p.second.m_tx_hash, &p.second, nullptr});
+            for (const auto &p : payOut)
+                if (seen.insert(p.first).second)
+                    cands.push_back({p.second.m_block_height, p.second.m_timestamp, &p.first, nullptr, &p.second});
+
+            std::sort(cands.begin(), cands.end(), [](const Cand &a, const Cand &b) {
+                if (a.height != b.height) return a.height > b.height;
+                return a.timestamp > b.timestamp;
+            });
+
+            size_t take = cands.size();
+            if (limit > 0 && cands.size() > size_t(limit)) {
+                take = size_t(limit);
+                while (take < cands.size() && cands[take].height == cands[take - 1].height) ++take;
+                more = take < cands.size();
+            }
+
+            rows.reserve(int(take));
+            for (size_t i = 0; i < take; ++i) {
+                const Cand &c = cands[i];
+                TransferRow r;
+                r.txid      = QString::fromStdString(epee::string_tools::pod_to_hex(*c.txid));
+                r.height    = c.height;
+                r.timestamp = c.timestamp;
+                if (c.in) {
+                    const auto &pd = *c.in;
+                    r.direction    = QStringLiteral("in");
+                    r.amount       = pd.m_amount;
+                    r.fee          = pd.m_fee;
+                    r.unlockTime   = pd.m_unlock_time;
+                    r.subaddrMajor = pd.m_subaddr_index.major;
+                    r.subaddrMinor = pd.m_subaddr_index.minor;
+                    r.unlocked     = m_wallet->is_transfer_unlocked(pd.m_unlock_time, pd.m_block_height);
+                } else {
+                    const auto &pd = *c.out;
+                    const uint64_t fee    = pd.m_amount_in - pd.m_amount_out;
+                    const uint64_t change = pd.m_change == (uint64_t)-1 ? 0 : pd.m_change;
+                    r.direction    = QStringLiteral("out");
+                    r.paymentId    = QString::fromStdString(epee::string_tools::pod_to_hex(pd.m_payment_id));
+                    r.amount       = pd.m_amount_in - change - fee;
+                    r.fee          = fee;
+                    r.unlockTime   = pd.m_unlock_time;
+                    r.subaddrMajor = pd.m_subaddr_account;
+                    r.unlocked     = m_wallet->is_transfer_unlocked(pd.m_unlock_time, pd.m_block_height);
+                }
+                r.address = subaddressString(r.subaddrMajor, r.subaddrMinor);
+                rows.append(r);
+            }
+
+            // Pool and unconfirmed rows ride along with the head page only.
+            if (belowHeight == std::numeric_limits<quint64>::max()) {
+                std::list<std::pair<crypto::hash, tools::wallet2::pool_payment_details>> pool;
+                std::list<std::pair<crypto::hash, tools::wallet2::unconfirmed_transfer_details>> upay;
+                m_wallet->get_unconfirmed_payments(pool, boost::none, {});
+                m_wallet->get_unconfirmed_payments_out(upay, boost::none, {});
+
+                for (const auto &pp : pool) {
+                    const auto &pd = pp.second.m_pd;
+                    if (!seen.insert(pd.m_tx_hash).second) continue;
+                    TransferRow r;
+                    r.txid         = QString::fromStdString(epee::string_tools::pod_to_hex(pd.m_tx_hash));
+                    r.direction    = QStringLiteral("in");
+                    r.amount       = pd.m_amount;
+                    r.fee          = pd.m_fee;
+                    r.timestamp    = pd.m_timestamp;
+                    r.unlockTime   = pd.m_unlock_time;
+                    r.subaddrMajor = pd.m_subaddr_index.major;
+                    r.subaddrMinor = pd.m_subaddr_index.minor;
+                    r.address      = subaddressString(r.subaddrMajor, r.subaddrMinor);
+                    rows.append(r);
+                }
+                for (const auto &u : upay) {
+                    if (!seen.insert(u.first).second) continue;
+                    const auto &pd = u.second;
+                    const uint64_t fee = pd.m_amount_in - pd.m_amount_out;
+                    TransferRow r;
+                    r.txid         = QString::fromStdString(epee::string_tools::pod_to_hex(u.first));
+                    r.paymentId    = QString::fromStdString(epee::string_tools::pod_to_hex(pd.m_payment_id));
+                    r.direction    = pd.m_state == tools::wallet2::unconfirmed_transfer_details::failed
+                                         ? QStringLiteral("failed") : QStringLiteral("pending");
+                    r.amount       = pd.m_change == (uint64_t)-1 ? 0 : pd.m_amount_in - pd.m_change - fee;
+                    r.fee          = fee;
+                    r.timestamp    = pd.m_timestamp;
+                    r.unlockTime   = pd.m_tx.unlock_time;
+                    r.subaddrMajor = pd.m_subaddr_account;
+                    r.address      = subaddressString(r.subaddrMajor, 0);
+                    rows.append(r);
+                }
+            }
+        }
+        catch (const std::exception &e) {
+            const QString msg = QString::fromUtf8(e.what());
+            qDebug().noquote() << "[msig][ERROR]:" << e.what();
+            QMetaObject::invokeMethod(this, [this, msg, operation_caller]() {
+                emit errorOccurred(msg, operation_caller);
+            }, Qt::QueuedConnection);
+            return;
+        }
+
+        QMetaObject::invokeMethod(this, [=]() {
+            emit transferPageReady(operation_caller, sinceHeight, belowHeight, chainH, rows, more);
+        }, Qt::QueuedConnection);
+    });
+}
+
 
 void Wallet::refreshHasMultisigPartialKeyImages()
 {
+    // Refresh and import republish the flag, so the snapshot is current.
+    if (const auto snap = snapshot(); snap && snap->open) {
+        QMetaObject::invokeMethod(this, [this, val = snap->partialKeyImages]() {
+            if (m_hasMsigPartialKeyImages != val) {
+                m_hasMsigPartialKeyImages = val;
+                emit walletChanged();
+            }
+        }, Qt::QueuedConnection);
+        return;
+    }
+
     enqueue(QStringLiteral("refreshHasMsigPartialKeyImages"), [=]() {
         if (!m_wallet) {
             return;
@@ -1644,59 +2393,355 @@ void Wallet::refreshHasMultisigPartialKeyImages()
 
 
 
+namespace {
+constexpr qint64 kBackgroundMaxWaitMs = 30'000;   // aging: background never starves
+constexpr int    kRecentOpsKept       = 20;
+
+struct OpTraits {
+    Wallet::Lane lane;
+    bool         coalesce;   // idempotent read whose result carries no caller tag
+    bool         publishes;  // may change state the snapshot exposes
+};
+
+OpTraits traitsFor(const QString &name)
+{
+    using L = Wallet::Lane;
+    static const QHash<QString, OpTraits> table{
+        { "firstKex",                       { L::ProtocolCritical, false, false } },
+        { "prepareMultisig",                { L::ProtocolCritical, false, true  } },
+        { "makeMultisig",                   { L::ProtocolCritical, false, true  } },
+        { "exchangeMultisigKeys",           { L::ProtocolCritical, false, true  } },
+        { "importMultisigInfos",            { L::ProtocolCritical, false, true  } },
+        { "importMultisigInfosBulk",        { L::ProtocolCritical, false, true  } },
+        { "createUnsignedMultisigTransfer", { L::ProtocolCritical, false, true  } },
+        { "releaseOutputs",                 { L::ProtocolCritical, false, false } },
+        { "signMultisigBlob",               { L::ProtocolCritical, false, true  } },
+        { "submitSignedMultisig",           { L::ProtocolCritical, false, true  } },
+        { "describeTransfer",               { L::ProtocolCritical, false, false } },
+
+        { "refresh",                        { L::Background, true, true  } },
+        { "save",                           { L::Background, true, false } },
+        { "store",                          { L::Background, true, false } },
+        { "refreshHasMsigPartialKeyImages", { L::Background, true, true  } },
+        { "suspend",                        { L::Background, true, false } },
+
+        { "open",                           { L::ProtocolCritical, false, true } },
+        { "createNew",                      { L::ProtocolCritical, false, true } },
+        { "restoreFromSeed",                { L::ProtocolCritical, false, true } },
+
+        { "close",                          { L::Interactive, true,  true } },
+        { "commitPreparedSimpleTransfer",   { L::Interactive, false, true } },
+        { "createSubaddress",               { L::Interactive, false, true } },
+        { "labelSubaddress",                { L::Interactive, false, true } },
+
+        { "getBalance",                     { L::Interactive, true, false } },
+        { "getHeight",                      { L::Interactive, true, false } },
+        { "isMultisig",                     { L::Interactive, true, false } },
+        { "multisigParams",                 { L::Interactive, true, false } },
+        { "getAddress",                     { L::Interactive, true, false } },
+        { "getTransfers",                   { L::Interactive, true, false } },
+        { "getAccounts",                    { L::Interactive, true, false } },
+    };
+    return table.value(name, OpTraits{ L::Interactive, false, false });
+}
+
+QString laneName(Wallet::Lane l)
+{
+    switch (l) {
+    case Wallet::Lane::ProtocolCritical: return QStringLiteral("protocol");
+    case Wallet::Lane::Interactive:      return QStringLiteral("interactive");
+    case Wallet::Lane::Background:       return QStringLiteral("background");
+    }
+    return {};
+}
+}
+
 void Wallet::enqueue(const QString &name, std::function<void ()> func)
+{
+    enqueue(name, QString(), std::move(func));
+}
+
+void Wallet::enqueue(const QString &name, const QString &caller, std::function<void ()> func)
 {
     if (QThread::currentThread() != this->thread()) {
 
         QMetaObject::invokeMethod(this,
-                                  [this, name, func]() { enqueue(name, func); },
+                                  [this, name, caller, func]() { enqueue(name, caller, func); },
                                   Qt::QueuedConnection);
         return;
     }
 
-    if (!m_queue.isEmpty() && m_queue.back().name == name) return;
-    m_queue.enqueue({name, std::move(func)});
+    const OpTraits t = traitsFor(name);
+    const int want = int(t.lane);
+    if (name != QLatin1String("suspend") && !wakeFor(name, t.lane)) return;
+
+    // An identical read already waiting anywhere answers this request too;
+    // if it sat in a lower lane it moves up to the requester's lane.
+    if (t.coalesce) {
+        for (int l = 0; l < kLaneCount; ++l) {
+            for (int i = 0; i < m_lanes[l].size(); ++i) {
+                if (m_lanes[l].at(i).name != name) continue;
+                if (l > want) m_lanes[want].enqueue(m_lanes[l].takeAt(i));
+                return;
+            }
+        }
+    }
+
+    Operation op{name, std::move(func), t.lane, caller, QDateTime::currentMSecsSinceEpoch()};
+    op.publishes = t.publishes;
+    if (isLifecycleOp(name)) m_lanes[want].prepend(std::move(op));
+    else                     m_lanes[want].enqueue(std::move(op));
     emit queueChanged();
     if (!m_busy) runNext();
 }
 
+int Wallet::cancelOperations(const QString &operation_caller)
+{
+    if (operation_caller.isEmpty()) return 0;
+
+    int n = 0;
+    for (auto &lane : m_lanes) {
+        for (int i = lane.size() - 1; i >= 0; --i) {
+            if (lane.at(i).caller != operation_caller) continue;
+            lane.removeAt(i);
+            ++n;
+        }
+    }
+    if (n > 0) {
+        qDebug().noquote() << "[Wallet] cancelled" << n << "queued ops for" << operation_caller;
+        emit queueChanged();
+        emit operationsCancelled(operation_caller, n);
+    }
+    return n;
+}
+
+bool Wallet::takeNextOperation(Operation &out)
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (m_resumeQueued) {
+        m_resumeQueued = false;
+        out = Operation{QStringLiteral("resume"), [this]() { resumeOp(); },
+                        Lane::ProtocolCritical, {}, m_resumeRequestedMs};
+        return true;
+    }
+    // An open waiting at the head goes before aged background work too.
+    auto &urgent = m_lanes[int(Lane::ProtocolCritical)];
+    if (!urgent.isEmpty() && isLifecycleOp(urgent.head().name)) {
+        out = urgent.dequeue();
+        return true;
+    }
+    auto &bg = m_lanes[int(Lane::Background)];
+    if (!bg.isEmpty() && now - bg.head().enqueuedMs >= kBackgroundMaxWaitMs) {
+        out = bg.dequeue();
+        return true;
+    }
+    for (auto &lane : m_lanes) {
+        if (lane.isEmpty()) continue;
+        out = lane.dequeue();
+        return true;
+    }
+    return false;
+}
+
 void Wallet::runNext()
 {
-    if (m_queue.isEmpty()) {
-        if (m_busy) { m_busy = false; emit busyChanged(); }
+    Operation op;
+    if (!takeNextOperation(op)) {
+        m_running = Operation{};
+        if (m_busy) { m_busy = false; emit busyChanged(); emit queueChanged(); }
         return;
     }
 
     m_busy = true;
     emit busyChanged();
 
-    const Operation op = m_queue.dequeue();
+    if (op.publishes) {
+        op.func = [this, func = std::move(op.func)]() {
+            func();
+            publishSnapshot();
+        };
+    }
+
+    if (m_executor) {
+        static_assert(int(Lane::ProtocolCritical) == WalletExecutor::Urgent &&
+                      int(Lane::Background)       == WalletExecutor::Background,
+                      "Wallet lanes and executor priorities must line up");
+        // Time spent waiting for a shared worker counts as wait, not run.
+        m_running = op;
+        emit queueChanged();
+        m_executor->submit(this, int(op.lane), op.enqueuedMs,
+                           [this, func = op.func]() {
+                               const qint64 t = QDateTime::currentMSecsSinceEpoch();
+                               QMetaObject::invokeMethod(this, [this, t]() {
+                                   m_running.startedMs = t;
+                                   emit queueChanged();
+                               }, Qt::QueuedConnection);
+                               func();
+                           },
+                           [this]() { finishRunning(); });
+        return;
+    }
+
+    op.startedMs = QDateTime::currentMSecsSinceEpoch();
+    m_running = op;
     emit queueChanged();
 
     auto *watcher = new QFutureWatcher<void>(this);
-    QFuture<void> fut = QtConcurrent::run([=]() { op.func(); });
+    QFuture<void> fut = QtConcurrent::run([func = op.func]() { func(); });
 
     connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher]() {
         watcher->deleteLater();
-        runNext();
+        finishRunning();
     });
 
     watcher->setFuture(fut);
 }
 
+void Wallet::finishRunning()
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (m_running.startedMs <= 0) m_running.startedMs = now;
+    m_recent.prepend(QVariantMap{
+        {"name",    m_running.name},
+        {"lane",    laneName(m_running.lane)},
+        {"caller",  m_running.caller},
+        {"wait_ms", m_running.startedMs - m_running.enqueuedMs},
+        {"run_ms",  now - m_running.startedMs},
+    });
+    while (m_recent.size() > kRecentOpsKept) m_recent.removeLast();
+
+    runNext();
+}
+
 QVariantList Wallet::pendingOps() const
 {
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
     QVariantList list;
-    for (const Operation &op : m_queue) list.append(op.name);
+
+    if (m_busy && !m_running.name.isEmpty()) {
+        list.append(QVariantMap{
+            {"name",    m_running.name},
+            {"lane",    laneName(m_running.lane)},
+            {"caller",  m_running.caller},
+            {"running", m_running.startedMs > 0},
+            {"wait_ms", (m_running.startedMs > 0 ? m_running.startedMs : now) - m_running.enqueuedMs},
+            {"run_ms",  m_running.startedMs > 0 ? now - m_running.startedMs : 0},
+        });
+    }
+    for (const auto &lane : m_lanes) {
+        for (const Operation &op : lane) {
+            list.append(QVariantMap{
+                {"name",    op.name},
+                {"lane",    laneName(op.lane)},
+                {"caller",  op.caller},
+                {"running", false},
+                {"wait_ms", now - op.enqueuedMs},
+            });
+        }
+    }
     return list;
 }
 
+// Runs on the op's worker thread right after a state-changing op.
+void Wallet::publishSnapshot()
+{
+    auto snap = std::make_shared<WalletSnapshot>();
+    try {
+        QMutexLocker locker(&m_mutex);
+        if (m_wallet) {
+            snap->open         = true;
+            snap->address      = QString::fromStdString(m_wallet->get_address_as_str());
+            snap->balance      = m_wallet->balance(0, false);
+            snap->unlocked     = m_wallet->unlocked_balance(0, false);
+            snap->balanceAll   = m_wallet->balance_all(false);
+            snap->unlockedAll  = m_wallet->unlocked_balance_all(false, nullptr, nullptr);
+            snap->walletHeight = m_wallet->get_blockchain_current_height();
+            snap->daemonHeight = m_lastDaemonHeight.load();
+
+            const auto st = m_wallet->get_multisig_status();
+            snap->multisigActive = st.multisig_is_active;
+            snap->multisigReady  = st.multisig_is_active && st.is_ready;
+            if (st.multisig_is_active) { snap->threshold = st.threshold; snap->total = st.total; }
+            snap->partialKeyImages = st.multisig_is_active && m_wallet->has_multisig_partial_key_images();
+            if (st.multisig_is_active) snap->msigFingerprint = msig_fingerprint(*m_wallet);
+            if (snap->partialKeyImages) {
+                const size_t n = m_wallet->get_num_transfer_details();
+                for (size_t i = 0; i < n; ++i)
+                    if (m_wallet->get_transfer_details(i).m_key_image_partial) ++snap->partialOutputs;
+            }
+
+            const uint32_t nAcc = m_wallet->get_num_subaddress_accounts();
+            snap->accounts.reserve(int(nAcc));
+            for (uint32_t a = 0; a < nAcc; ++a) {
+                WalletSnapshot::Account acc;
+                acc.index       = a;
+                acc.label       = subaddr_label(m_wallet.get(), a, 0);
+                acc.baseAddress = subaddressString(a, 0);
+                acc.balance     = m_wallet->balance(a, false);
+                acc.unlocked    = m_wallet->unlocked_balance(a, false);
+
+                const auto perBal  = m_wallet->balance_per_subaddress(a, false);
+                const auto perUnlk = m_wallet->unlocked_balance_per_subaddress(a, false);
+                const uint32_t nSub = m_wallet->get_num_subaddresses(a);
+                acc.subaddresses.reserve(int(nSub));
+                for (uint32_t i = 0; i < nSub; ++i) {
+                    WalletSnapshot::Subaddress sub;
+                    sub.index   = i;
+                    sub.address = subaddressString(a, i);
+                    sub.label   = subaddr_label(m_wallet.get(), a, i);
+                    const auto itB = perBal.find(i);
+                    sub.balance = itB != perBal.end() ? itB->second : 0;
+                    const auto itU = perUnlk.find(i);
+                    sub.unlocked = itU != perUnlk.end() ? itU->second.first : 0;
+                    acc.subaddresses.append(sub);
+                }
+                snap->accounts.append(acc);
+            }
+        }
+    } catch (const std::exception &e) {
+        // Keep serving the previous snapshot.
+        qDebug().noquote() << "[Wallet] snapshot failed:" << e.what();
+        return;
+    }
+
+    snap->generation = ++m_snapshotGeneration;
+    snap->takenMs    = QDateTime::currentMSecsSinceEpoch();
+    std::atomic_store_explicit(&m_snapshot, std::shared_ptr<const WalletSnapshot>(std::move(snap)),
+                               std::memory_order_release);
+
+    QMetaObject::invokeMethod(this, [this]() { adoptSnapshot(); }, Qt::QueuedConnection);
+}
+
+void Wallet::adoptSnapshot()
+{
+    const auto snap = snapshot();
+    if (!snap) return;
+
+    if (snap->open) {
+        m_addressCache      = snap->address;
+        m_balanceCache      = snap->balance;
+        m_unlockedCache     = snap->unlocked;
+        m_walletHeightCache = snap->walletHeight;
+        m_daemonHeightCache = snap->daemonHeight;
+    }
+    m_hasMsigPartialKeyImages = snap->partialKeyImages;
+    const bool moreToImport = snap->partialOutputs > m_partialOutputs;
+    m_partialOutputs = snap->partialOutputs;
+    const bool msigChanged = snap->msigFingerprint != m_msigFingerprint;
+    m_msigFingerprint = snap->msigFingerprint;
+
+    emit walletChanged();
+    emit snapshotChanged();
+    if (moreToImport) emit multisigImportNeeded();
+    if (msigChanged && snap->msigFingerprint) emit multisigStateChanged();
+}
+
 void Wallet::prepareSimpleTransfer(const QString &ref,
                                    QVariantList destinations,
                                    int feePriority,
                                    QList<int> subtractFeeFromIndices)
 {
-    enqueue(QStringLiteral("prepareSimpleTransfer"), [=]() {
+    enqueue(QStringLiteral("prepareSimpleTransfer"), ref, [=]() {
         if (!m_wallet) return;
 
         quint64 feeAtomic = 0;
@@ -1781,7 +2826,7 @@ void Wallet::prepareSimpleTransfer(const QString &ref,
 
 void Wallet::describePreparedSimpleTransfer(const QString &ref)
 {
-    enqueue(QStringLiteral("describePreparedSimpleTransfer"), [=]() {
+    enqueue(QStringLiteral("describePreparedSimpleTransfer"), ref, [=]() {
         if (!m_wallet) return;
         QJsonObject root;
 
@@ -1860,8 +2905,9 @@ static QString txhex_from_ptx(const tools::wallet2::pending_tx &p) {
 
 void Wallet::commitPreparedSimpleTransfer(const QString &ref)
 {
-    enqueue(QStringLiteral("commitPreparedSimpleTransfer"), [=]() {
+    enqueue(QStringLiteral("commitPreparedSimpleTransfer"), ref, [=]() {
         if (!m_wallet) return;
+        storeIfDirty();
 
         bool ok = false;
         QString result;
@@ -1885,6 +2931,7 @@ void Wallet::commitPreparedSimpleTransfer(const QString &ref)
                     const QString txhex = txhex_from_ptx(one);
                     Q_UNUSED(txhex);
                     m_wallet->commit_tx(one);
+                    markDirty();
                     const crypto::hash h = get_transaction_hash(one.tx);
                     ids << QString::fromStdString(epee::string_tools::pod_to_hex(h));
                 }
@@ -1915,7 +2962,7 @@ void Wallet::commitPreparedSimpleTransfer(const QString &ref)
 
 void Wallet::discardPreparedSimpleTransfer(const QString &ref)
 {
-    enqueue(QStringLiteral("discardPreparedSimpleTransfer"), [=]() {
+    enqueue(QStringLiteral("discardPreparedSimpleTransfer"), ref, [=]() {
         QMutexLocker l(&m_mutex);
         m_simplePrepared.remove(ref);
     });
@@ -1923,6 +2970,21 @@ void Wallet::discardPreparedSimpleTransfer(const QString &ref)
 
 void Wallet::getAccounts()
 {
+    if (const auto snap = snapshot(); snap && snap->open) {
+        QVariantList out;
+        for (const auto &acc : snap->accounts) {
+            out.append(QVariantMap{
+                { "account_index", static_cast<int>(acc.index) },
+                { "label",         acc.label },
+                { "balance",       static_cast<qint64>(acc.balance)  },
+                { "unlocked",      static_cast<qint64>(acc.unlocked) },
+                { "base_address",  acc.baseAddress }
+            });
+        }
+        QMetaObject::invokeMethod(this, [this, out](){ emit accountsReady(out); }, Qt::QueuedConnection);
+        return;
+    }
+
     enqueue(QStringLiteral("getAccounts"), [=](){
         if (!m_wallet) return;
         QVariantList out;
@@ -1958,6 +3020,23 @@ void Wallet::getAccounts()
 
 void Wallet::getSubaddresses(int accountIndex)
 {
+    const auto snap = snapshot();
+    if (snap && snap->open && accountIndex >= 0 && accountIndex < snap->accounts.size()) {
+        QVariantList out;
+        for (const auto &sub : snap->accounts.at(accountIndex).subaddresses) {
+            out.append(QVariantMap{
+                { "account_index",  accountIndex },
+                { "address_index",  static_cast<int>(sub.index) },
+                { "address",        sub.address },
+                { "label",          sub.label },
+                { "balance",        static_cast<qint64>(sub.balance) },
+                { "unlocked",       static_cast<qint64>(sub.unlocked) }
+            });
+        }
+        QMetaObject::invokeMethod(this, [=](){ emit subaddressesReady(accountIndex, out); }, Qt::QueuedConnection);
+        return;
+    }
+
     enqueue(QStringLiteral("getSubaddresses"), [=](){
         if (!m_wallet) return;
         QVariantList out;
@@ -2008,7 +3087,7 @@ void Wallet::createSubaddress(int accountIndex, const QString &label)
             m_wallet->add_subaddress(static_cast<uint32_t>(accountIndex), label.toStdString());
             idx = static_cast<int>(m_wallet->get_num_subaddresses(static_cast<uint32_t>(accountIndex)) - 1);
             addr = subaddr_str(m_wallet.get(), m_netType, static_cast<uint32_t>(accountIndex), static_cast<uint32_t>(idx));
-            m_wallet->store();
+            markDirty();
         } catch (const std::exception &e) {
             const QString msg = QString::fromUtf8(e.what());
             qDebug().noquote() << "[msig][ERROR]:" << e.what();
@@ -2028,7 +3107,7 @@ void Wallet::labelSubaddress(int accountIndex, int addressIndex, const QString &
         try {
             QMutexLocker l(&m_mutex);
             m_wallet->set_subaddress_label({static_cast<uint32_t>(accountIndex), static_cast<uint32_t>(addressIndex)}, label.toStdString());
-            m_wallet->store();
+            markDirty();
         } catch (const std::exception &e) {
             const QString msg = QString::fromUtf8(e.what());
             qDebug().noquote() << "[msig][ERROR]:" << e.what();
@@ -2048,7 +3127,7 @@ void Wallet::setSubaddressLookahead(int major, int minor)
         try {
             QMutexLocker l(&m_mutex);
             m_wallet->set_subaddress_lookahead(static_cast<uint32_t>(major), static_cast<uint32_t>(minor));
-            m_wallet->store();
+            markDirty();
         } catch (const std::exception &e) {
             const QString msg = QString::fromUtf8(e.what());
             qDebug().noquote() << "[msig][ERROR]:" << e.what();
@@ -0,0 +1,139 @@
+#include "win_compat.h"
+#include "walletexecutor.h"
+
+#include <QDateTime>
+#include <QThread>
+#include <QVariant>
+#include <QDebug>
+#include <algorithm>
+#include <tuple>
+#include <cmath>
+
+namespace {
+constexpr qint64 kBackgroundMaxWaitMs = 30'000;
+constexpr int    kMaxWorkers          = 16;
+constexpr int    kWorkerStackBytes    = 8 * 1024 * 1024;   // wallet2 recurses deeply in refresh
+}
+
+WalletExecutor::WalletExecutor(QObject *parent) : QObject(parent)
+{
+    m_pool.setStackSize(kWorkerStackBytes);
+    setWorkerCount(0);
+}
+
+WalletExecutor::~WalletExecutor()
+{
+    m_pending.clear();
+    m_pool.waitForDone();
+}
+
+WalletExecutor *WalletExecutor::of(const QObject *holder)
+{
+    if (!holder) return nullptr;
+    return qobject_cast<WalletExecutor*>(holder->property("walletExecutor").value<QObject*>());
+}
+
+int WalletExecutor::defaultWorkerCount()
+{
+    return std::clamp(QThread::idealThreadCount() / 2, 2, kMaxWorkers);
+}
+
+void WalletExecutor::setWorkerCount(int n)
+{
+    n = n <= 0 ? defaultWorkerCount() : std::clamp(n, 1, kMaxWorkers);
+    if (n == m_workers && m_pool.maxThreadCount() == n) return;
+
+    m_workers = n;
+    m_pool.setMaxThreadCount(n);
+    qDebug().noquote() << "[WalletExecutor] workers:" << n;
+    emit statsChanged();
+    dispatch();
+}
+
+void WalletExecutor::submit(QObject *owner, int priority, qint64 enqueuedMs,
+                            std::function<void ()> work, std::function<void ()> done)
+{
+    Task t;
+    t.owner      = owner;
+    t.key        = owner;
+    t.priority   = std::clamp(priority, int(Urgent), int(Background));
+    t.enqueuedMs = enqueuedMs > 0 ? enqueuedMs : QDateTime::currentMSecsSinceEpoch();
+    t.work       = std::move(work);
+    t.done       = std::move(done);
+    m_pending.append(std::move(t));
+
+    emit statsChanged();
+    dispatch();
+}
+
+int WalletExecutor::cancel(const QObject *owner)
+{
+    const int before = m_pending.size();
+    m_pending.removeIf([owner](const Task &t) { return t.key == owner; });
+    m_lastServed.remove(owner);
+
+    const int n = before - m_pending.size();
+    if (n > 0) emit statsChanged();
+    return n;
+}
+
+int WalletExecutor::refreshPhaseMs(int intervalMs)
+{
+    if (intervalMs <= 0) return 0;
+    // Golden-ratio sequence: any number of wallets stays evenly spread.
+    const double frac = std::fmod(double(m_phaseSlot++) * 0.6180339887498949, 1.0);
+    return int(frac * intervalMs);
+}
+
+int WalletExecutor::pickNext() const
+{
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const bool backgroundAllowed = m_workers == 1 || m_runningBackground < m_workers - 1;
+
+    int best = -1;
+    auto rank = [&](const Task &t) {
+        // An aged background op competes as normal so refresh cannot starve.
+        int p = t.priority;
+        if (p == Background && now - t.enqueuedMs >= kBackgroundMaxWaitMs) p = Normal;
+        return std::make_tuple(p, m_lastServed.value(t.key), t.enqueuedMs);
+    };
+
+    for (int i = 0; i < m_pending.size(); ++i) {
+        const Task &t = m_pending.at(i);
+        if (t.priority == Background && !backgroundAllowed) continue;
+        if (best < 0 || rank(t) < rank(m_pending.at(best))) best = i;
+    }
+    return best;
+}
+
+void WalletExecutor::dispatch()
+{
+    while (m_running < m_workers) {
+        const int idx = pickNext();
+        if (idx < 0) break;
+
+        Task t = m_pending.takeAt(idx);
+        if (!t.owner) continue;
+
+        const bool background = t.priority == Background;
+        ++m_running;
+        if (background) ++m_runningBackground;
+        m_lastServed.insert(t.key, ++m_serial);
+
+        // The destructor waits for the pool, so this outlives every runnable.
+        m_pool.start([this, background, work = std::move(t.work),
+                      owner = t.owner, done = std::move(t.done)]() {
+            try { work(); }
+            catch (const std::exception &e) {
+                qWarning() << "[WalletExecutor] op threw:" << e.what();
+            }
+            QMetaObject::invokeMethod(this, [this, background, owner, done]() {
+                --m_running;
+                if (background) --m_runningBackground;
+                if (owner && done) done();
+                dispatch();
+            }, Qt::QueuedConnection);
+        });
+    }
+    emit statsChanged();
+}
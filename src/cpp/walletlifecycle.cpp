@@ -0,0 +1,207 @@
+#include "win_compat.h"
+#include "walletlifecycle.h"
+#include "multiwalletcontroller.h"
+#include "walletexecutor.h"
+#include "wallet.h"
+
+#include <QDateTime>
+#include <QEventLoop>
+#include <QThread>
+#include <QTimer>
+#include <QVariantMap>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+constexpr int kOpenTimeoutMs      = 10 * 60'000;   // a stuck open must not hold its slot forever
+constexpr int kShutdownDeadlineMs = 30'000;
+constexpr int kMaxTrace           = 200;
+}
+
+WalletLifecycle::WalletLifecycle(MultiWalletController *wm, QObject *parent)
+    : QObject(parent),
+      m_wm(wm)
+{
+}
+
+WalletLifecycle *WalletLifecycle::of(const QObject *holder)
+{
+    if (!holder) return nullptr;
+    return qobject_cast<WalletLifecycle*>(holder->property("walletLifecycle").value<QObject*>());
+}
+
+int WalletLifecycle::parallelism() const
+{
+    // Leave one executor worker free so the UI stays responsive while a
+    // batch is opening.
+    if (const WalletExecutor *exec = WalletExecutor::of(m_wm))
+        return std::max(1, exec->workerCount() - 1);
+    return std::max(1, QThread::idealThreadCount() / 2);
+}
+
+void WalletLifecycle::open(const QStringList &names)
+{
+    if (!m_wm) return;
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    for (const QString &name : names) {
+        if (name.isEmpty() || m_queue.contains(name) || m_opening.contains(name)) continue;
+        if (m_wm->walletInstance(name)) continue;
+        m_queue.append(name);
+        m_queuedAt.insert(name, now);
+    }
+    emit traceChanged();
+    pump();
+}
+
+void WalletLifecycle::setVisible(const QStringList &names)
+{
+    m_visible = names;
+}
+
+void WalletLifecycle::pump()
+{
+    while (!m_queue.isEmpty() && m_opening.size() < parallelism()) {
+        auto it = std::find_if(m_queue.begin(), m_queue.end(),
+                               [this](const QString &n) { return m_visible.contains(n); });
+        if (it == m_queue.end()) it = m_queue.begin();
+        const QString name = *it;
+        m_queue.erase(it);
+        start(name);
+    }
+}
+
+void WalletLifecycle::start(const QString &name)
+{
+    Entry e;
+    e.name      = name;
+    e.phase     = QStringLiteral("open");
+    e.queuedMs  = m_queuedAt.take(name);
+    e.startedMs = QDateTime::currentMSecsSinceEpoch();
+    m_opening.insert(name, e);
+
+    const bool started = m_wm->connectWallet(name);
+    auto *w = qobject_cast<Wallet*>(m_wm->walletInstance(name));
+    if (!started || !w) {
+        finishOpen(name, false);
+        return;
+    }
+
+    // Dies with the first outcome, taking the other connections with it.
+    auto *guard = new QObject(w);
+    connect(w, &Wallet::walletOpened, guard, [this, name, guard]() {
+        guard->deleteLater();
+        finishOpen(name, true);
+    });
+    connect(w, &Wallet::errorOccurred, guard, [this, name, guard]() {
+        guard->deleteLater();
+        finishOpen(name, false);
+    });
+    QTimer::singleShot(kOpenTimeoutMs, guard, [this, name, guard]() {
+        guard->deleteLater();
+        finishOpen(name, false);
+    });
+}
+
+void WalletLifecycle::finishOpen(const QString &name, bool ok)
+{
+    auto it = m_opening.find(name);
+    if (it == m_opening.end()) return;
+
+    Entry e = it.value();
+    m_opening.erase(it);
+    e.doneMs = QDateTime::currentMSecsSinceEpoch();
+    e.ok     = ok;
+    record(e);
+    pump();
+}
+
+void WalletLifecycle::trackClose(const QString &name, Wallet *w)
+{
+    if (!w || m_closing.contains(w)) return;
+
+    // A close supersedes an open still waiting for its slot.
+    m_queue.removeAll(name);
+    m_queuedAt.remove(name);
+
+    Entry e;
+    e.name      = name;
+    e.phase     = QStringLiteral("close");
+    e.queuedMs  = QDateTime::currentMSecsSinceEpoch();
+    e.startedMs = e.queuedMs;
+    m_closing.insert(w, e);
+
+    auto done = [this, w](bool ok) {
+        auto it = m_closing.find(w);
+        if (it == m_closing.end()) return;
+        Entry e = it.value();
+        m_closing.erase(it);
+        e.doneMs = QDateTime::currentMSecsSinceEpoch();
+        e.ok     = ok;
+        record(e);
+        if (m_closing.isEmpty()) emit closesDrained();
+    };
+    connect(w, &Wallet::walletFullyClosed, this, [done]() { done(true); });
+    connect(w, &QObject::destroyed,        this, [done]() { done(false); });
+    emit traceChanged();
+}
+
+bool WalletLifecycle::shutdown(int deadlineMs)
+{
+    if (!m_wm) return true;
+    if (deadlineMs < 0) deadlineMs = kShutdownDeadlineMs;
+
+    m_queue.clear();
+    m_queuedAt.clear();
+    const qint64 t0 = QDateTime::currentMSecsSinceEpoch();
+    m_wm->closeAllWallets();
+
+    if (!m_closing.isEmpty()) {
+        QEventLoop loop;
+        connect(this, &WalletLifecycle::closesDrained, &loop, &QEventLoop::quit);
+        QTimer::singleShot(deadlineMs, &loop, &QEventLoop::quit);
+        loop.exec();
+    }
+
+    const qint64 took = QDateTime::currentMSecsSinceEpoch() - t0;
+    if (m_closing.isEmpty()) {
+        qDebug().noquote() << "[WalletLifecycle] shutdown closed all wallets in" << took << "ms";
+        return true;
+    }
+
+    QStringList late;
+    for (const Entry &e : std::as_const(m_closing)) late << e.name;
+    qDebug().noquote() << "[WalletLifecycle] shutdown deadline of" << deadlineMs
+                       << "ms passed; still closing:" << late.join(", ");
+    return false;
+}
+
+void WalletLifecycle::record(const Entry &e)
+{
+    qDebug().noquote() << QStringLiteral("[WalletLifecycle] %1 %2: waited %3 ms, took %4 ms%5")
+                              .arg(e.phase, e.name)
+                              .arg(e.startedMs - e.queuedMs)
+                              .arg(e.doneMs - e.startedMs)
+                              .arg(e.ok ? QString() : QStringLiteral(" (failed)"));
+    m_trace.append(e);
+    if (m_trace.size() > kMaxTrace)
+        m_trace.remove(0, m_trace.size() - kMaxTrace);
+    emit traceChanged();
+}
+
+QVariantList WalletLifecycle::trace() const
+{
+    QVariantList out;
+    out.reserve(m_trace.size());
+    for (const Entry &e : m_trace) {
+        out.append(QVariantMap{
+            { "wallet",  e.name },
+            { "phase",   e.phase },
+            { "at",      e.doneMs },
+            { "wait_ms", e.startedMs - e.queuedMs },
+            { "run_ms",  e.doneMs - e.startedMs },
+            { "ok",      e.ok },
+        });
+    }
+    return out;
+}
@@ -0,0 +1,108 @@
+#include "win_compat.h"
+#include "walletresidency.h"
+#include "multiwalletcontroller.h"
+#include "wallet.h"
+
+#include <QDateTime>
+#include <QTimer>
+#include <QVariant>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+constexpr int    kDefaultLimit  = 8;
+constexpr int    kMaxLimit      = 256;
+constexpr int    kSweepMs       = 30'000;
+constexpr qint64 kMinIdleMs     = 2 * 60'000;   // never suspend something just used
+}
+
+WalletResidency::WalletResidency(MultiWalletController *wm, QObject *parent)
+    : QObject(parent),
+      m_wm(wm),
+      m_timer(new QTimer(this))
+{
+    setLimit(0);
+    m_timer->setInterval(kSweepMs);
+    connect(m_timer, &QTimer::timeout, this, &WalletResidency::sweep);
+    m_timer->start();
+}
+
+WalletResidency *WalletResidency::of(const QObject *holder)
+{
+    if (!holder) return nullptr;
+    return qobject_cast<WalletResidency*>(holder->property("walletResidency").value<QObject*>());
+}
+
+int WalletResidency::defaultLimit()
+{
+    return kDefaultLimit;
+}
+
+void WalletResidency::setLimit(int n)
+{
+    n = n <= 0 ? defaultLimit() : std::min(n, kMaxLimit);
+    if (n == m_limit) return;
+    m_limit = n;
+    emit statsChanged();
+    QTimer::singleShot(0, this, &WalletResidency::sweep);
+}
+
+void WalletResidency::sweep()
+{
+    if (!m_wm) return;
+
+    const QList<Wallet*> all = m_wm->liveWallets();
+    QList<Wallet*> resident;
+    for (Wallet *w : all)
+        if (w->suspendable()) resident.append(w);
+    if (resident.size() <= m_limit) return;
+
+    std::sort(resident.begin(), resident.end(), [](const Wallet *a, const Wallet *b) {
+        return a->lastUsedMs() < b->lastUsedMs();
+    });
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    int excess = resident.size() - m_limit;
+    for (Wallet *w : std::as_const(resident)) {
+        if (excess <= 0) break;
+        if (!w->idle() || now - w->lastUsedMs() < kMinIdleMs) continue;
+        w->suspend();
+        ++m_suspends;
+        --excess;
+    }
+    emit statsChanged();
+}
+
+QVariantMap WalletResidency::stats() const
+{
+    int resident = 0, suspended = 0;
+    quint64 hits = 0, resumes = 0;
+    qint64  resumeMs = 0, lastResumeMs = 0, lastResumeAt = 0;
+
+    if (m_wm) {
+        for (const Wallet *w : m_wm->liveWallets()) {
+            const QVariantMap s = w->residencyStats();
+            if (w->suspended()) ++suspended; else ++resident;
+            hits     += s.value("hits").toULongLong();
+            resumes  += s.value("resumes").toULongLong();
+            resumeMs += s.value("total_resume_ms").toLongLong();
+            if (s.value("resumes").toULongLong() > 0 && w->lastUsedMs() > lastResumeAt) {
+                lastResumeAt = w->lastUsedMs();
+                lastResumeMs = s.value("last_resume_ms").toLongLong();
+            }
+        }
+    }
+
+    const quint64 accesses = hits + resumes;
+    return {
+        { "limit",          m_limit },
+        { "resident",       resident },
+        { "suspended",      suspended },
+        { "suspends",       m_suspends },
+        { "hits",           hits },
+        { "misses",         resumes },
+        { "hit_rate",       accesses ? double(hits) / double(accesses) : 1.0 },
+        { "last_resume_ms", lastResumeMs },
+        { "avg_resume_ms",  resumes ? double(resumeMs) / double(resumes) : 0.0 },
+    };
+}
@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QVariantList>
 #include <QVariantMap>
+#include <QMap>
 #include <QMutex>
 #include <QDir>
 #include <QLockFile>
@@ -11,6 +12,7 @@
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QJsonArray>
+#include <QFuture>
 #include <memory>
 #include "cryptoutils.h"
 #include <QStandardPaths>
@@ -34,6 +36,7 @@ class AccountManager : public QObject
     Q_PROPERTY(int     lock_timeout_minutes  READ lockTimeoutMinutes NOTIFY settingsChanged)
     Q_PROPERTY(QString  networkType          READ networkType       NOTIFY settingsChanged)
     Q_PROPERTY(QString dataRootPath READ dataRootPath NOTIFY dataRootPathChanged)
+    Q_PROPERTY(QStringList unlocked_accounts READ unlockedAccounts NOTIFY unlockedAccountsChanged)
 
 public:
     explicit AccountManager(QObject *parent = nullptr);
@@ -52,6 +55,7 @@ public:
     bool    torAutoconnect()    const { return m_torAutoconnect;  }
     int     lockTimeoutMinutes() const { return m_lockTimeoutMinutes; }
     QString networkType()       const { return m_networkType; }
+    QStringList unlockedAccounts() const;
 
 
     Q_INVOKABLE QVariantList getTorIdentities() const;
@@ -66,6 +70,12 @@ public:
     Q_INVOKABLE bool removePlaceholderIdentityByLabel(const QString &label);
     Q_INVOKABLE bool darkModePref() const;
     Q_INVOKABLE bool setDarkModePref(bool dark);
+    // 0 lets the wallet executor pick from the core count.
+    Q_INVOKABLE int  walletWorkerCount() const;
+    Q_INVOKABLE bool setWalletWorkerCount(int workers);
+    // How many wallets stay loaded before idle ones are suspended; 0 = default.
+    Q_INVOKABLE int  residentWalletLimit() const;
+    Q_INVOKABLE bool setResidentWalletLimit(int limit);
 
     Q_INVOKABLE QString walletAccountDir() const;
     Q_INVOKABLE QString walletPath(const QString &walletName) const;
@@ -98,6 +108,12 @@ public slots:
     Q_INVOKABLE bool verifyPassword(const QString &password) const;
     bool login(const QString &filePath, const QString &password);
     void logout();
+
+    // Several accounts can stay unlocked at once; the others are parked with
+    // their keys and file locks held, so switching skips the KDF and teardown.
+    Q_INVOKABLE bool addSession(const QString &filePath, const QString &password);
+    Q_INVOKABLE bool switchAccount(const QString &accountName);
+    Q_INVOKABLE bool closeSession(const QString &accountName);
     bool updatePassword(const QString &oldPassword, const QString &newPassword);
     bool createAccount(const QString &accountName, const QString &password);
 
@@ -105,6 +121,14 @@ public slots:
     QString loadAccountData();
     bool    saveAccountData(const QString &content);
 
+    QJsonObject accountObject() const;
+    bool        saveAccountObject(const QJsonObject &obj);
+
+    // Encrypts side files (archives, caches) under a per-purpose subkey of the
+    // account's data key, so they survive password changes.
+    QByteArray sealForAccount(const QByteArray &plain, const QByteArray &purpose);
+    bool       openForAccount(const QByteArray &sealed, const QByteArray &purpose, QByteArray &plainOut);
+
 
     QVariantList getAvailableAccounts();
     QVariantList getAddressBook();
@@ -145,15 +169,28 @@ public slots:
 
     Q_INVOKABLE bool isOnionAddress(const QString &url) const;
 
+    Q_INVOKABLE QVariantMap kdfProfile() const;
+    // Calibrates and re-encrypts on a worker; the outcome arrives as kdfTuned().
+    Q_INVOKABLE bool tuneKdf(const QString &password, int targetUnlockMs, int maxMemoryMiB);
+    // Starts calibrating the parameters createAccount() will use; it waits
+    // for the result if the form was submitted first.
+    Q_INVOKABLE void prepareKdf();
+
 signals:
 
     void loginSuccess(const QString &accountName);
     void loginFailed (const QString &error);
     void accountCreated(const QString &accountName);
     void logoutOccurred();
+    void accountSwitching(const QString &fromAccount);
+    void accountSwitched(const QString &fromAccount, const QString &toAccount);
+    void sessionClosed(const QString &accountName);
+    void unlockedAccountsChanged();
     void isAuthenticatedChanged();
     void currentAccountChanged();
     void passwordUpdated(bool success);
+    void kdfTuned(bool success);
+    void accountDataChanged();
 
 
     void settingsChanged();
@@ -184,11 +221,32 @@ signals:
 
 private:
 
+    struct Session {
+        QJsonObject data;
+        QByteArray  key;
+        QByteArray  salt;
+        CryptoUtils::KdfParams kdf;
+        CryptoUtils::Cipher    cipher = CryptoUtils::Cipher::XChaCha20Poly1305;
+        QString     filePath;
+        QString     account;
+        std::shared_ptr<QLockFile> lock;
+        bool        legacyHeader = false;
+    };
+
+    bool    openSession(const QString &filePath, const QString &password,
+                        Session &out, QString &error) const;
+    void    installSessionLocked(Session &&s);
+    Session takeSessionLocked();
+    bool    switchToSession(Session &&s);
+    void    migrateLegacyHeaderLocked();
+    QStringList closeParkedLocked();   // names of the sessions closed
+
     bool passwordIsCorrect(const QString &password) const;
     bool validateDaemonUrl(const QString &url) const;
     void loadSettingsFromJson(const QJsonObject &obj);
     QVariantMap sanitizeTrustedPeers(const QVariantMap &raw) const;
     bool persistUnlocked();
+    QByteArray dataKeyLocked();
     void resetState();
     QString prettyJson(const QJsonObject &obj) const;
 
@@ -200,6 +258,8 @@ private:
     QJsonObject     m_accountData;
     QByteArray      m_key;
     QByteArray      m_salt;
+    CryptoUtils::KdfParams m_kdf;
+    CryptoUtils::Cipher    m_cipher = CryptoUtils::Cipher::XChaCha20Poly1305;
     bool            m_isAuthenticated = false;
     bool            m_hasLoggedOut    = false;
     QString         m_currentAccount;
@@ -220,6 +280,10 @@ private:
 
     QString m_dataRoot;
 
+    QFuture<CryptoUtils::KdfParams> m_defaultKdf;
+    bool                            m_kdfPrepared = false;
+    bool                            m_kdfTuning = false;
+
     static QString defaultDataRoot();
     static QString ensureDataRootName(const QString &parentDirOrDataDir);
 
@@ -233,7 +297,8 @@ private:
 
 
 
-    std::unique_ptr<QLockFile> m_lock;
+    std::shared_ptr<QLockFile> m_lock;
+    QMap<QString, Session>     m_parked;     // other unlocked accounts, by name
     mutable QMutex             m_mutex;
 };
 
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QCache>
+#include <QMutex>
+#include <QByteArray>
+#include <QStringList>
+#include <QJsonObject>
+
+class AccountManager;
+
+// Content-addressed, account-sealed blob store under <wallets>/<account>/blobs.
+// Blobs are keyed by the hex SHA-256 of their plaintext and shared between
+// owners ("transfer/<ref>", "peerinfo/<wallet>/<onion>", ...). Each owner holds
+// at most one blob; a blob file is deleted once no owner references it.
+// Replacing an owner's blob keeps the previous one until settle() confirms
+// which of the two the owner's saved record points at.
+class BlobStore : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BlobStore(AccountManager *acct, QObject *parent = nullptr);
+
+    static BlobStore *of(const QObject *holder);
+    static QString    hashOf(const QByteArray &data);
+
+    // Stores data (if not already present) and points owner at it. What owner
+    // referenced before is kept until settle(). Returns the hash, or empty on
+    // failure.
+    QString    put(const QByteArray &data, const QString &owner);
+    // Call once the record holding owner's hash is saved: keeps the blob it
+    // names and drops the other one.
+    void       settle(const QString &owner, const QString &savedHash);
+    QByteArray get(const QString &hash);
+    bool       contains(const QString &hash);
+
+    void release(const QString &owner);
+    // Drops every owner under prefix that is not in keep (crash leftovers).
+    int  retainOnly(const QString &prefix, const QSet<QString> &keep);
+
+    int  refCount(const QString &hash);
+    void reset();
+
+    // Transfer records keep only "transfer_blob_ref"; legacy records with an
+    // inline "transfer_blob" still resolve. Without a store the blob stays inline.
+    // The store holds the decoded txset, so any base64 flavour of the same
+    // set dedups; it is handed back as unpadded base64url.
+    static void    setTransferBlob(const QObject *holder, const QString &transferRef,
+                                   QJsonObject &entry, const QString &blobB64);
+    static QString transferBlob(const QObject *holder, const QJsonObject &entry);
+    static QString transferOwner(const QString &transferRef);
+
+private:
+    QString dir() const;
+    QString blobPath(const QString &hash) const;
+    QString indexPath() const;
+
+    bool ensureLoadedLocked();
+    bool saveIndexLocked();
+    void unrefLocked(const QString &hash);
+
+    AccountManager *m_acct{nullptr};
+
+    QMutex                   m_mutex;
+    bool                     m_loaded{false};
+    QString                  m_loadedFor;
+    QHash<QString, QString>  m_ownerOf;   // owner -> hash
+    QHash<QString, QString>  m_previous;  // owner -> hash it held before put(), until settle()
+    QHash<QString, int>      m_refs;      // hash  -> owner count
+    QCache<QString, QByteArray> m_cache;  // cost in bytes
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QHash>
+#include <QCache>
+#include <QMutex>
+#include <QVariantMap>
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class QIODevice;
+
+// Height-indexed cache of getblocks.bin answers, shared by every wallet2 of
+// one account that syncs the same chain from the same upstream. Blocks are
+// grouped into fixed chunks and kept on disk, sealed for the account (least
+// recently used chunks go first once over budget), plus a small decoded
+// in-memory cache. Only blocks at least kSafeDepth below the daemon tip that
+// link to their neighbours by prev_id are kept, so anything a reorg can
+// still touch always comes from the daemon.
+class BlockCache
+{
+public:
+    struct Lookup {
+        QByteArray response;      // non-empty: answer with this, skip the daemon
+        qint64     start = -1;    // height the daemon would answer from, -1 if unknown
+        bool       cacheable = false;
+    };
+
+    using Seal = std::function<QByteArray(const QByteArray &plain)>;
+    using Open = std::function<bool(const QByteArray &sealed, QByteArray &plain)>;
+
+    // An empty dir turns the cache off.
+    BlockCache(const QString &dir, qint64 maxDiskBytes, Seal seal, Open open);
+    ~BlockCache();
+
+    // Thread-safe; decoding and disk reads happen outside the lock. upstream
+    // is the endpoint the request goes to; each one has its own space.
+    Lookup lookup(const QString &upstream, const QByteArray &request);
+    void   ingest(const QString &upstream, const QByteArray &request, const QByteArray &response);
+    // The account the cache seals for is gone: stop writing.
+    void   retire() { m_retired = true; }
+
+    QVariantMap stats() const;
+
+private:
+    struct Chunk;
+    struct Space;
+    using ChunkPtr = std::shared_ptr<Chunk>;
+
+    Space   &spaceLocked(const QString &key);
+    void     scanLocked(Space &sp);
+    ChunkPtr chunk(const QString &key, quint64 index);
+    void     evictLocked();
+    void     dropPartialLocked(Space &sp, quint64 index);
+    bool     hashAtLocked(const Space &sp, quint64 height, QByteArray &out) const;
+    bool     readHeader(QIODevice &in, quint64 &first, QByteArray &hashes) const;
+    bool     writeChunk(const QString &dir, const Chunk &c, qint64 *bytes) const;
+
+    const QString m_dir;
+    const qint64  m_maxDiskBytes;
+    const Seal    m_seal;
+    const Open    m_open;
+    std::atomic<bool> m_retired{false};
+
+    mutable QMutex                  m_mutex;
+    QHash<QString, Space*>          m_spaces;
+    QCache<QString, ChunkPtr>       m_hot;   // cost in bytes
+    qint64                          m_diskBytes{0};
+
+    quint64 m_hits{0};
+    quint64 m_misses{0};
+    quint64 m_servedBlocks{0};
+    quint64 m_storedBlocks{0};
+    quint64 m_evicted{0};
+};
@@ -13,13 +13,50 @@ constexpr int KeyBytes    = 32;
 constexpr int NonceBytes  = 24;
 
 
+enum class Cipher : quint8 {
+    XSalsa20Poly1305  = 1,   // crypto_secretbox, legacy files
+    XChaCha20Poly1305 = 2,   // IETF AEAD, header bound as AD
+    Aes256Gcm         = 3    // IETF AEAD, needs AES-NI + CLMUL
+};
+
+struct KdfParams {
+    quint64 opsLimit{0};
+    quint64 memLimit{0};     // bytes
+};
+
+// On-disk header of an account file.
+//   v0 (legacy): u16be saltLen | salt | nonce | secretbox
+//   v1         : "MMSA" | u8 ver | u8 cipher | u32be ops | u32be memKiB | u8 saltLen | salt | nonce | aead
+struct FileHeader {
+    quint8     version{1};
+    Cipher     cipher{Cipher::XChaCha20Poly1305};
+    KdfParams  kdf;
+    QByteArray salt;
+};
+
+constexpr quint8 FileFormatVersion = 1;
+
+
 bool ensureSodium();
 
 
 QByteArray generateSalt();
 
 
+KdfParams legacyKdf();
+Cipher    preferredCipher();
+bool      cipherAvailable(Cipher c);
+QString   cipherName(Cipher c);
+int       nonceBytes(Cipher c);
+bool      kdfParamsSane(const KdfParams &p);
+
+// Benchmarks Argon2id on this machine and returns the strongest parameters
+// whose derivation stays close to targetMs without exceeding maxMemBytes.
+KdfParams calibrateKdf(int targetMs, quint64 maxMemBytes);
+
+
 QByteArray deriveKey(const QString &password, const QByteArray &salt);
+QByteArray deriveKey(const QString &password, const QByteArray &salt, const KdfParams &p);
 
 
 QByteArray encrypt(const QByteArray &plain,
@@ -31,5 +68,28 @@ bool decrypt(const QByteArray &cipher,
              const QByteArray &key,
              QByteArray       &plainOut);
 
+
+QByteArray encrypt(const QByteArray &plain,
+                   const QByteArray &key,
+                   Cipher            cipher,
+                   const QByteArray &ad);
+
+
+bool decrypt(const QByteArray &cipherWithNonce,
+             const QByteArray &key,
+             Cipher            cipher,
+             const QByteArray &ad,
+             QByteArray       &plainOut);
+
+
+// Keyed BLAKE2b of context under key; separates keys for unrelated stores.
+QByteArray deriveSubkey(const QByteArray &key, const QByteArray &context);
+
+
+QByteArray encodeHeader(const FileHeader &h);
+
+// Parses either header version; bodyOffset points at the nonce.
+bool decodeHeader(const QByteArray &file, FileHeader &out, qsizetype &bodyOffset);
+
 }
 #endif
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QPointer>
+#include <QVariantList>
+
+class QNetworkAccessManager;
+class QTimer;
+
+// One poller per daemon endpoint (address + proxy), shared by every wallet
+// and session that talks to it. Polls /get_info and announces only real
+// changes of the chain tip or the mempool, so wallets refresh on new blocks
+// instead of on a fixed timer, and callers needing the chain height read the
+// cached value instead of making their own round trip.
+class DaemonMonitor : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QVariantList endpoints READ endpoints NOTIFY statsChanged)
+
+public:
+    explicit DaemonMonitor(QObject *parent = nullptr);
+    ~DaemonMonitor() override;
+
+    static DaemonMonitor *of(const QObject *holder);
+    static QString endpointKey(const QString &daemonAddr, const QString &proxyHost, quint16 proxyPort);
+
+    // Polls the endpoint for as long as at least one subscriber is alive.
+    // proxyPort 0 means a direct connection. Returns the endpoint key.
+    QString watch(const QString &daemonAddr, const QString &proxyHost, quint16 proxyPort,
+                  QObject *subscriber);
+    void    unwatch(QObject *subscriber);
+
+    // Last height seen from any endpoint of daemonAddr, or 0 when none is
+    // younger than maxAgeMs.
+    quint64 cachedHeight(const QString &daemonAddr, qint64 maxAgeMs = 5 * 60 * 1000) const;
+
+    QVariantList endpoints() const;
+
+signals:
+    void tipChanged(const QString &endpoint, quint64 height, const QString &topHash);
+    void mempoolChanged(const QString &endpoint, quint64 poolSize);
+    void statsChanged();
+
+private:
+    struct Endpoint {
+        QString                 addr;
+        QString                 proxyHost;
+        quint16                 proxyPort = 0;
+        QNetworkAccessManager  *nam   = nullptr;
+        QTimer                 *timer = nullptr;
+        QSet<QObject*>          subscribers;
+
+        quint64 height    = 0;
+        QString topHash;
+        quint64 poolSize  = 0;
+        qint64  lastOkMs  = 0;
+        int     failures  = 0;
+        quint64 polls     = 0;
+        quint64 changes   = 0;
+        bool    inFlight  = false;
+    };
+
+    void poll(const QString &key);
+    void schedule(Endpoint &ep);
+    void drop(const QString &key);
+
+    QHash<QString, Endpoint> m_endpoints;
+};
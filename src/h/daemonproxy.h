@@ -0,0 +1,99 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QVariantMap>
+#include <memory>
+
+class QTcpServer;
+class QTcpSocket;
+class QNetworkAccessManager;
+class QNetworkReply;
+class BlockCache;
+class DistributionCache;
+class RpcCache;
+class DaemonMonitor;
+class AccountManager;
+
+// Local HTTP endpoint every wallet2 talks to instead of the daemon. One
+// listener per upstream (address + SOCKS proxy) forwards each RPC as is,
+// except getblocks.bin: those are answered from the account's BlockCache when
+// it covers the range, identical in-flight calls are merged, and a wallet a few
+// blocks behind another one waits for that fetch instead of starting its own.
+// Sync cost then grows with the chain, not with the number of wallets.
+// Output distributions are answered from a per-tip cache that is refetched in
+// the background on each new block while a transfer is likely, and fee, fork
+// and daemon info calls from a short-lived RpcCache shared by all wallets.
+// The listener has no credentials, so only the calls wallet2 makes are
+// relayed; anything else, or anything from a browser, gets a 403.
+class DaemonProxy : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QVariantMap stats READ stats NOTIFY statsChanged)
+
+public:
+    explicit DaemonProxy(QObject *parent = nullptr);
+    ~DaemonProxy() override;
+
+    static DaemonProxy *of(const QObject *holder);
+
+    // "http://127.0.0.1:<port>" forwarding to daemonAddr (through SOCKS5 when
+    // proxyPort is set), or empty if no local port could be bound.
+    QString localAddress(const QString &daemonAddr, const QString &proxyHost, quint16 proxyPort);
+
+    // Tips come from the monitor; without one the distribution cache stays off.
+    void setMonitor(DaemonMonitor *monitor);
+    // The block cache lives in the current account's data dir; without an
+    // unlocked account it stays off.
+    void setAccountManager(AccountManager *am);
+    // Fetches the RingCT distribution for this endpoint ahead of a transfer
+    // and keeps it current for a while.
+    void warm(const QString &daemonAddr, const QString &proxyHost, quint16 proxyPort);
+
+    QVariantMap stats() const;
+
+signals:
+    void statsChanged();
+
+private:
+    struct Upstream;
+    struct Conn;
+    struct Request;
+    struct Inflight;
+    using ConnPtr = std::shared_ptr<Conn>;
+
+    static int takeRequest(QByteArray &buf, Request &out);
+    QNetworkReply *send(Upstream *up, const Request &req);
+
+    void accept(Upstream *up);
+    void pump(const ConnPtr &conn);
+    void handle(const ConnPtr &conn, const Request &req);
+    void lookupBlocks(const ConnPtr &conn, const Request &req, bool mayWait);
+    void lookupDistribution(const ConnPtr &conn, const Request &req);
+    void forwardRpc(const ConnPtr &conn, const Request &req, const QByteArray &key, qint64 ttlMs);
+    void onTip(const QString &endpoint, quint64 height);
+    void prefetch(Upstream *up, const QByteArray &body);
+    Inflight *startFetch(Upstream *up, const Request &req, const QByteArray &key);
+    void forward(const ConnPtr &conn, const Request &req, qint64 start, bool cacheable, bool mayWait);
+    void finish(const QByteArray &key, int status, const QByteArray &type, const QByteArray &body);
+    void reply(const ConnPtr &conn, int status, const QByteArray &type, const QByteArray &body);
+    void bindCache();
+
+    AccountManager                    *m_acct{nullptr};
+    QString                            m_cacheDir;
+    std::shared_ptr<BlockCache>        m_cache;   // shared with in-flight pool tasks
+    std::unique_ptr<DistributionCache> m_dist;
+    std::unique_ptr<RpcCache>          m_rpc;
+    QHash<QString, quint64>            m_tips;    // upstream key -> chain height
+    QHash<QString, Upstream*>          m_upstreams;
+    QHash<QByteArray, Inflight*>       m_inflight;
+
+    bool    m_closing{false};
+    quint64 m_forwarded{0};
+    quint64 m_merged{0};
+    quint64 m_waited{0};
+    quint64 m_upstreamBytes{0};
+    quint64 m_cacheBytes{0};
+};
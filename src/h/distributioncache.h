@@ -0,0 +1,52 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+
+// get_output_distribution.bin answers per daemon endpoint, each valid for the
+// chain tip it was fetched at. wallet2 downloads the whole RingCT distribution
+// for every transaction it builds, which over Tor is the slowest part of
+// starting a transfer; kept warm here and refetched on each new block, it
+// leaves transfer construction with only the get_outs round trip.
+// Main thread only.
+class DistributionCache
+{
+public:
+    // Semantic key of a request (amounts, range, encoding), ignoring fields
+    // that do not change the answer. Empty if the body does not parse.
+    static QByteArray keyFor(const QByteArray &request);
+    // The request wallet2 sends before picking RingCT decoys.
+    static QByteArray rctRequest();
+    // Cheap check that a binary answer carries status OK.
+    static bool looksOk(const QByteArray &response);
+
+    QByteArray lookup(const QString &upstream, const QByteArray &key, quint64 tip);
+    void       store(const QString &upstream, const QByteArray &key, const QByteArray &request,
+                     quint64 tip, const QByteArray &response);
+    // Marks a request as wanted so it is fetched on the next tip.
+    void       want(const QString &upstream, const QByteArray &key, const QByteArray &request);
+    // Requests used within warmMs that are not current for tip; cold entries
+    // are dropped.
+    QList<QByteArray> due(const QString &upstream, quint64 tip, qint64 warmMs);
+
+    QVariantMap stats() const;
+
+private:
+    struct Entry {
+        QByteArray request;
+        QByteArray response;
+        quint64    tip        = 0;
+        qint64     lastUsedMs = 0;
+    };
+
+    void evict();
+
+    QHash<QString, Entry> m_entries;   // upstream + ' ' + key
+    qint64  m_bytes{0};
+    quint64 m_hits{0};
+    quint64 m_misses{0};
+    quint64 m_stores{0};
+};
@@ -43,6 +43,8 @@ public:
     Q_INVOKABLE void cancel();
     Q_INVOKABLE QString getTransferDetailsJson() const;
     Q_INVOKABLE QString myOnion() const { return m_myOnion; }
+    // Deletes the session once in-flight requests have returned; nothing waits on them.
+    void deleteWhenIdle();
 
 signals:
     void stageChanged(QString stageName);
@@ -85,8 +87,15 @@ private:
 
 
     void        submitToNextPeer();
+    void        confirmOffer();
+    void        submitTo(const QString &peer, const QStringList &order);
     void        broadcastSelf();
 
+    // More cosigners than signatures needed: probe the fastest unsigned
+    // peers and pass the txset to the first that answers ready.
+    bool        fanOut() const;
+    QStringList unsignedPeers() const;
+
 
     void        httpGetAsync (const QString &onion,const QString &path,bool signedFlag);
     void        httpPostAsync(const QString &onion,const QString &path,
@@ -113,6 +122,7 @@ private:
     QStringList  m_signatures;
     QString      m_transferBlobB64;
     QJsonObject  m_description;
+    QJsonObject  m_describeRecord;   // persisted describeTransfer memo
     QString      m_txId;
     QString      m_status;
     QString      m_myOnion;
@@ -122,6 +132,9 @@ private:
     QThreadPool m_httpPool;
 
     QHash<QString,int> m_submitAttempts;
+    QString            m_offeredTo;      // fan-out submit in flight
+    QStringList        m_offeredOrder;
+    bool               m_offerUnconfirmed{false};   // submit to m_offeredTo failed in transit
 
 
     QByteArray m_scalar, m_prefix, m_pubKey;
@@ -4,10 +4,12 @@
 #include <QTimer>
 #include <QThreadPool>
 #include <QHash>
+#include <QSet>
 #include <QJsonObject>
 #include <QDateTime>
 #include <QStringList>
 #include <QMetaType>
+#include <QVariantMap>
 
 class MultiWalletController;
 class TorBackend;
@@ -21,8 +23,15 @@ public:
     explicit MultisigImportSession(QObject *parent=nullptr);
     ~MultisigImportSession() override;
 
+    static MultisigImportSession *of(const QObject *holder);
+
     void initialize(MultiWalletController *wm, TorBackend *tor);
 
+    // {ready, age_secs, current}: whether a transfer can skip collecting and
+    // importing peer infos, and how old the imported infos are (-1: never).
+    QVariantMap readiness(const QString &walletName) const;
+    bool        readyToSpend(const QString &walletName) const;
+
     Q_INVOKABLE bool running() const { return m_running; }
 
 
@@ -47,6 +56,7 @@ signals:
     void sessionStopped();
     void walletImportCompleted(QString walletName);
     void peerInfoReceived(QString walletName, QString peerOnion);
+    void readinessChanged(QString walletName);
 
 
 
@@ -54,6 +64,7 @@ signals:
 
 private slots:
     void _checkAllWallets();
+    void _runDue();
     void onHttp(QString onion, QString path, QJsonObject res, QString err, QString walletName);
     void _onImportMultisigResult(const QString &walletName, int actualImported = 0);
 
@@ -65,13 +76,24 @@ private:
 
     void _processWalletImport(const QString &walletName);
     bool _walletNeedsImport(const QString &walletName) const;
+    bool _walletWantsRefresh(const QString &walletName) const;
+    void _wantImport(const QString &walletName, int delayMs);
+    void _updateReadiness(const QString &walletName);
+    void _armKick();
 
 
     QString     _accountCacheDir() const;
-    QJsonObject _loadCachedInfos(const QString &walletName) const;
+    QString     _peerInfoFile(const QString &walletName) const;
+    QJsonObject &_peerInfos(const QString &walletName);
+    void        _markPeerInfosDirty(const QString &walletName);
+    void        _flushPeerInfos();
+    void        _settlePeerBlobs(const QString &walletName, const QJsonObject &saved);
     void        _saveCachedInfo(const QString &walletName,
                          const QString &peerOnion,
                          const QByteArray &infoRaw);
+    QByteArray  _cachedInfoRaw(const QJsonObject &entry) const;
+    static bool _cachedInfoMatches(const QJsonObject &entry, const QByteArray &infoRaw);
+    static bool _cachedInfoImported(const QJsonObject &entry);
     void        _markPeersAsImported(const QString &walletName,
                               const QStringList &peers);
     QStringList _filterStalePeers(const QStringList &peers,
@@ -108,7 +130,22 @@ private:
     bool   m_running = false;
     qint64 m_cacheExpirySecs = 120;
 
-    QTimer       m_checkTimer;
+    // Import passes are event driven: wallet name -> when to look at it next.
+    QTimer                 m_kickTimer;
+    QHash<QString, qint64> m_dueAt;
+    QSet<QString>          m_afterImport;   // triggered while an import was running
+    QMetaObject::Connection m_importNeededConn;
+    QMetaObject::Connection m_stateChangedConn;
+    QMetaObject::Connection m_walletsChangedConn;
+
+    struct Warm { qint64 atSecs; quint64 fingerprint; };
+    QHash<QString, Warm>    m_warm;   // wallet name -> last complete import
+
+    // wallet name -> { peer onion -> { timestamp, info_hash, imported_hash } }
+    QHash<QString, QJsonObject> m_peerInfos;
+    QSet<QString>               m_peerInfosDirty;
+    QString                     m_peerInfosDir;   // account the cache belongs to
+    QTimer                      m_flushTimer;
     QThreadPool  m_httpPool;
 
 
@@ -3,7 +3,9 @@
 #include <QObject>
 #include <QStringList>
 #include <QHash>
+#include <QTimer>
 #include <memory>
+#include <functional>
 #include <QByteArray>
 #include <QPair>
 #include <QDateTime>
@@ -53,7 +55,19 @@ public:
     }
 
     QPair<QByteArray, qint64> giveMultisigInfo(const QString &walletName) const;
+    // Re-dates the cached multisig info when the wallet has not changed since
+    // it was exported. Returns false when it has to be regenerated.
+    bool renewMultisigInfo(const QString &walletName);
+    // Chain height from the shared daemon monitor, 0 if it has none yet.
+    quint64 cachedChainHeight();
     qint64 lastRefreshTs(const QString &walletName) const;
+    // Open wallets of the current and of parked accounts.
+    QList<Wallet*> liveWallets() const;
+    Q_INVOKABLE QVariantMap residencyStats() const;
+    Q_INVOKABLE QVariantList lifecycleTrace() const;
+    // Starts fetching decoy selection data so building a transfer soon after
+    // does not wait on the daemon for it.
+    Q_INVOKABLE void warmTransferInputs(const QString &walletName);
 
     Q_INVOKABLE QObject *walletInstance(const QString &walletName) const;
     Q_INVOKABLE bool     walletBusy    (const QString &walletName) const;
@@ -111,6 +125,12 @@ public:
 
     void onAccountStatusChanged();
 
+    // Account switch: open wallets of the outgoing account are kept alive
+    // (still syncing, signals muted) and handed back when it becomes current.
+    void parkAccount(const QString &account);
+    void resumeAccount(const QString &account);
+    void dropParkedAccount(const QString &account);
+
 public slots:
 
     void addWalletToAccount(const QString &walletName,
@@ -128,11 +148,18 @@ public slots:
                             const QString &creator       = "user",
                             const QString net_type       = "mainnet");
 
-    void connectWallet     (const QString &walletName);
+    bool connectWallet     (const QString &walletName);
     void disconnectWallet  (const QString &walletName);
     void refreshWallet     (const QString &walletName);
     void createWallet      (const QString &walletName, const QString &password, const QString &nettype);
     void stopAllWallets();
+    // Connects a batch a few at a time, visible wallets first.
+    void connectWallets    (const QStringList &walletNames);
+    void setVisibleWallets (const QStringList &walletNames);
+    // Stores and unloads every open wallet; they reopen on their next use.
+    void suspendAllWallets();
+    // Current and parked accounts alike; used at exit.
+    void closeAllWallets();
     void requestGenMultisig(const QString &walletName);
 
     Q_INVOKABLE QVariantMap getWalletMeta(const QString &walletName) const;
@@ -175,6 +202,8 @@ signals:
     void pendingOpsChanged(const QString &walletName);
     void passwordReady(bool success, const QString &walletName, const QString &newPassword);
     void multisigInfoUpdated(const QString &walletName);
+    void multisigImportNeeded(const QString &walletName);
+    void multisigStateChanged(const QString &walletName);
 
     void walletBalanceChanged(const QString &walletName,
                               quint64 balanceAtomic,
@@ -200,6 +229,17 @@ private:
 
     void loadWalletsFromAccount();
     QVariantMap metaToMap(const Meta &m) const;
+    void startWalletSync(Wallet *w);
+    void wireWallet(const QString &walletName, Wallet *w);
+    void unwireWallet(Wallet *w);
+    void adoptWallet(const QString &walletName, Wallet *w);
+    // Runs fn now, or once the account is resumed if w is one of a parked
+    // account's wallets; fn may touch the current account's wallet list.
+    void whenCurrent(const QString &walletName, Wallet *w, std::function<void()> fn);
+    void hookOpen(const QString &walletName, Wallet *w);
+    // Stops the controller's own daemon poll once no wallet is open and
+    // cachedChainHeight() has not been asked for a while.
+    void releaseHeightWatch();
 
     Wallet *walletPtr(const QString &walletName) const {
         auto it = m_wallets.find(walletName);
@@ -259,6 +299,20 @@ private:
 
     QHash<QString, RestoreInPlaceJob> m_restoreInPlaceJobs;
 
+    struct ParkedAccount {
+        QStringList                       walletNames;
+        QStringList                       walletRefs;
+        QHash<QString, Meta>              meta;
+        QHash<QString, Meta>              metaRef;
+        QHash<QString, Wallet*>           wallets;
+        QHash<QString, MultisigInfoCache> msigCache;
+        QHash<QString, qint64>            lastRefreshTs;
+    };
+    QHash<QString, ParkedAccount> m_parked;
+    QHash<Wallet*, QObject*>      m_wiring;     // context of wireWallet()'s connections
+    QHash<Wallet*, QList<std::function<void()>>> m_deferred;   // see whenCurrent()
+    QTimer                        m_heightWatch;
+
 
     QHash<QString, StandardCreateJob> m_stdCreateJobs;
 
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QObject>
+#include <QJsonObject>
+#include <QStringList>
+#include <QVariantList>
+#include <QVariantMap>
+#include <QTimer>
+
+class AccountManager;
+
+// Payouts waiting to leave a multisig wallet. Destinations accumulate per
+// wallet and go out together in one multi-destination transfer once maxBatch
+// are queued or the oldest has waited maxWait, so signing rounds and fees
+// follow the number of batches, not of payments. Each payout follows the
+// transfer that carries it. When that transfer provably never reached a
+// signer the payout is queued again, at most kMaxAttempts times; any other
+// failure leaves it "needs_review" until resolved by hand, so a payout that
+// may have been broadcast is never paid twice. Kept sealed in the account's
+// data dir, keyed by wallet name. Main thread only.
+class PayoutQueue : public QObject
+{
+    Q_OBJECT
+public:
+    struct Batch {
+        QString      walletRef;
+        QString      myOnion;
+        QStringList  signingOrder;
+        int          threshold   = 0;
+        int          feePriority = 0;
+        bool         inspect     = true;
+        QVariantList destinations;   // {address, amount (atomic)}
+        QStringList  ids;
+    };
+
+    explicit PayoutQueue(AccountManager *acct, QObject *parent = nullptr);
+
+    // meta is MultiWalletController::getWalletMeta(walletName). An empty
+    // signing order means this wallet and the first threshold-1 peers.
+    bool    configure(const QString &walletName, const QVariantMap &meta,
+                      const QStringList &signingOrder, int feePriority, bool inspect,
+                      int maxBatch, int maxWaitMinutes);
+    QString enqueue(const QString &walletName, const QVariantMap &meta,
+                    const QString &address, quint64 amount, const QString &label);
+    bool    cancel(const QString &walletName, const QString &id);
+    QVariantList items(const QString &walletName);
+
+    // The next maxBatch queued payouts. They stay queued until markBatched()
+    // ties them to the transfer they went out in.
+    Batch take(const QString &walletName);
+    void  markBatched(const QString &walletName, const QStringList &ids, const QString &transferRef);
+
+    // A transfer carrying payouts ended: "success" marks them sent; any other
+    // result queues them again if neverSubmitted, else leaves them for
+    // review. Returns true while payouts of the transfer await review, in
+    // which case its outputs stay reserved.
+    bool settle(const QString &transferRef, const QString &result, bool neverSubmitted,
+                const QString &txId = {});
+    bool holds(const QString &transferRef);
+    // Closes a payout left for review: sent, or queued again.
+    bool resolve(const QString &walletName, const QString &id, bool sent, QString *transferRef = nullptr);
+    // Transfers that batched payouts are still waiting on.
+    QStringList batchedRefs();
+
+    void reset();
+
+signals:
+    void flushDue(QString walletName);
+    void changed(QString walletName);
+
+private:
+    bool ensureLoaded();
+    bool save();
+    QString path() const;
+    void sweep();
+    void checkDue(const QString &walletName);
+
+    QJsonObject queueFor(const QString &walletName, const QVariantMap &meta);
+
+    AccountManager *m_acct{nullptr};
+    QTimer          m_timer;
+
+    bool        m_loaded{false};
+    QString     m_loadedFor;
+    QJsonObject m_queues;
+};
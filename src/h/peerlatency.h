@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QStringList>
+
+// Reachability and round-trip time of each cosigner onion, measured from the
+// signed calls transfer sessions make. When a wallet has more cosigners than
+// it needs signatures, the next signer is picked from this ranking instead of
+// the fixed signing order. Main thread only.
+class PeerLatency : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PeerLatency(QObject *parent = nullptr);
+
+    static PeerLatency *of(const QObject *holder);
+
+    void record(const QString &onion, bool ok, qint64 rttMs);
+
+    // Peers that answered recently, fastest first; then peers not measured
+    // lately; then peers whose last calls failed, fewest failures first.
+    // Ties keep the order they were given in.
+    QStringList rank(const QStringList &onions) const;
+
+    // Signing order that hands the txset to next: everyone who has signed,
+    // then next, then the remaining peers in the order given.
+    static QStringList chainVia(const QStringList &signedBy, const QString &next,
+                                const QStringList &rest);
+
+private:
+    struct Entry {
+        double rttMs    = 0;   // smoothed over successful calls
+        int    failures = 0;   // since the last success
+        qint64 lastOkAt = 0;   // secs since epoch
+    };
+
+    QHash<QString, Entry> m_entries;
+};
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVariantMap>
+
+// Short-lived answers to read-only daemon calls that every wallet2 repeats
+// when it builds a transaction: fee estimates, hard fork state, daemon info
+// and version. Keyed by endpoint, method and parameters; an entry expires
+// after its method's TTL or when the chain tip moves, whichever comes first.
+// Main thread only.
+class RpcCache
+{
+public:
+    // Key for a cacheable call, empty otherwise; *ttlMs receives its lifetime.
+    static QByteArray keyFor(const QByteArray &path, const QByteArray &body, qint64 *ttlMs);
+
+    // The stored answer with the JSON-RPC id of this request, or empty.
+    QByteArray lookup(const QString &upstream, const QByteArray &key, quint64 tip,
+                      const QByteArray &requestBody);
+    // Keeps response if it is a successful answer.
+    void       store(const QString &upstream, const QByteArray &key, quint64 tip, qint64 ttlMs,
+                     const QByteArray &response);
+
+    QVariantMap stats() const;
+
+private:
+    struct Entry {
+        QByteArray response;
+        quint64    tip       = 0;
+        qint64     expiresMs = 0;
+    };
+
+    void prune(qint64 now);
+
+    QHash<QString, Entry>   m_entries;
+    QHash<QString, quint64> m_hitsBy;     // method -> hits
+    QHash<QString, quint64> m_missesBy;
+};
@@ -48,6 +48,11 @@ public:
 
     Q_INVOKABLE QString getTransferDetailsJson() const;
 
+    // Account switch: stops without finishing. restarted() is the same
+    // transfer, not yet started, or nullptr once it is being committed.
+    void park();
+    SimpleTransfer *restarted(QObject *parent) const;
+
 signals:
     void stageChanged(QString stageName);
     void statusChanged(QString text);
@@ -59,6 +59,11 @@ public:
     Q_INVOKABLE void resetRequestCount(const QString &onion);
     Q_INVOKABLE void reset();
 
+    // Account switch: the Tor process stays up; only the outgoing account's
+    // onion services are withdrawn and the incoming account's published.
+    void suspendAccountServices();
+    void resumeAccountServices();
+
 
 
     bool    isRunning()    const { return m_running; }
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QVariantList>
+#include <QJsonObject>
+#include <QJsonArray>
+
+class AccountManager;
+
+// Cold tier for transfers that reached a terminal stage. Entries live in
+// compressed, account-sealed segment files under <wallets>/<account>/transfer_archive;
+// a small sealed index carries the summary rows used for paging.
+class TransferArchive : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TransferArchive(AccountManager *acct, QObject *parent = nullptr);
+
+    // entries: transfer ref -> full transfer object (must carry wallet_ref)
+    bool append(const QList<QPair<QString, QJsonObject>> &entries);
+
+    int          count(const QString &walletRef = {});
+    QVariantList page(int offset, int limit, const QString &walletRef = {});
+    QJsonObject  entry(const QString &ref);
+    bool         contains(const QString &ref);
+
+    // Drops ref from the index. Its segment is left as is and only becomes
+    // unreachable; segments are never rewritten.
+    bool remove(const QString &ref);
+
+    void reset();
+
+signals:
+    void archiveChanged();
+
+private:
+    QString dir() const;
+    QString segmentPath(int seg) const;
+    QString indexPath() const;
+
+    bool ensureIndexLoaded();
+    bool writeSealed(const QString &path, const QByteArray &plain, const QByteArray &purpose);
+    bool readSealed(const QString &path, const QByteArray &purpose, QByteArray &plainOut);
+
+    AccountManager *m_acct{nullptr};
+
+    bool        m_loaded{false};
+    QString     m_loadedFor;
+    QJsonArray  m_index;          // summary rows, newest first
+    QHash<QString, int> m_segOf;  // ref -> segment id
+    int         m_nextSeg{0};
+};
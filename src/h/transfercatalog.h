@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QMap>
+#include <QStringList>
+#include <QJsonObject>
+#include <QReadWriteLock>
+
+class AccountManager;
+
+// In-memory view of every saved transfer in the unlocked account, indexed by
+// transfer ref, wallet ref+onion, stage and creation time. Built once at login.
+// Writes made through the catalog update the index directly; any other account
+// save is diffed only for the wallets whose transfers object changed, so
+// readers never reparse the account document.
+class TransferCatalog : public QObject
+{
+    Q_OBJECT
+public:
+    explicit TransferCatalog(AccountManager *acct, QObject *parent = nullptr);
+
+    static TransferCatalog *of(const QObject *holder);
+
+    bool        contains(const QString &ref) const;
+    QJsonObject transfer(const QString &ref) const;
+    QString     walletRefOf(const QString &ref) const;
+    QString     walletNameOf(const QString &ref) const;
+    QString     walletOnionOf(const QString &ref) const;
+
+    QStringList refsForWallet(const QString &walletRef, const QString &onion = {}) const;
+    QStringList refsInStage(const QString &stage) const;
+    QStringList refsNewestFirst() const;
+    QStringList allRefs() const;
+    int         size() const;
+
+    QString     walletNameForRefOnion(const QString &walletRef, const QString &onion) const;
+
+    // Replaces just this transfer in the account and saves. The wallet is
+    // matched by ref+onion, then ref, then name.
+    bool upsert(const QString &walletRef, const QString &walletName, const QString &onion,
+                const QString &ref, const QJsonObject &entry);
+    bool remove(const QString &ref);
+    // Replaces existing transfers and removes others in one save. Refs the
+    // catalog does not know are skipped.
+    bool apply(const QHash<QString, QJsonObject> &updates, const QStringList &removals = {});
+
+public slots:
+    void rebuild();
+    void sync();
+    void clear();
+
+signals:
+    void transferAdded(QString ref);
+    void transferUpdated(QString ref);
+    void transferRemoved(QString ref);
+    void stageChanged(QString ref, QString oldStage, QString newStage);
+    void catalogReset();
+
+private:
+    struct Entry {
+        QString     walletRef;
+        QString     walletName;
+        QString     walletOnion;
+        QString     stage;
+        qint64      createdAt{0};
+        QJsonObject data;
+    };
+
+    struct Change {
+        enum Kind { Added, Updated, Removed } kind;
+        QString ref;
+        QString oldStage;
+        QString newStage;
+    };
+
+    struct WalletSnap {
+        QString     name;
+        QJsonObject transfers;   // shares data with the account document
+    };
+
+    static QString walletKey(const QString &ref, const QString &onion);
+    static QString normOnion(QString s);
+
+    static void scanWallet(const QJsonObject &w, QHash<QString, Entry> &out);
+    void indexLocked(const QString &ref, const Entry &e);
+    void unindexLocked(const QString &ref, const Entry &e);
+    void applyLocked(const QHash<QString, Entry> &fresh, const QSet<QString> &candidates,
+                     QList<Change> &changes);
+    void emitChanges(const QList<Change> &changes);
+    bool saveOwn(const QJsonObject &root);
+
+    AccountManager *m_acct{nullptr};
+
+    mutable QReadWriteLock            m_lock;
+    QHash<QString, Entry>             m_byRef;
+    QHash<QString, QSet<QString>>     m_byWallet;     // ref|onion -> transfer refs
+    QHash<QString, QString>           m_walletNames;  // ref|onion -> wallet name
+    QHash<QString, QSet<QString>>     m_byStage;
+    QMultiMap<qint64, QString>        m_byCreated;
+    QHash<QString, WalletSnap>        m_wallets;      // ref|onion -> last seen
+    bool                              m_saving{false};
+};
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QPointer>
+#include <QVector>
+#include <limits>
+
+#include "wallet.h"
+
+// Transfer history of one wallet as a list model. Rows are loaded newest
+// first in pages keyed by a block-height cursor (fetchMore); when the wallet
+// publishes a new snapshot only the last few blocks and the pool are fetched
+// again and merged, so the view gets row-level inserts/removes/changes
+// instead of a full rebuild.
+class TransferHistoryModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QObject *wallet         READ wallet          WRITE setWallet          NOTIFY walletChanged)
+    Q_PROPERTY(QString directionFilter READ directionFilter WRITE setDirectionFilter NOTIFY directionFilterChanged)
+    Q_PROPERTY(int     count           READ count           NOTIFY countChanged)
+    Q_PROPERTY(bool    loading         READ loading         NOTIFY loadingChanged)
+    Q_PROPERTY(bool    hasMore         READ hasMore         NOTIFY loadingChanged)
+    Q_PROPERTY(quint64 chainHeight     READ chainHeight     NOTIFY chainHeightChanged)
+
+public:
+    enum Roles {
+        TxidRole = Qt::UserRole + 1,
+        PaymentIdRole,
+        DirectionRole,
+        AmountRole,
+        FeeRole,
+        BlockHeightRole,
+        ConfirmationsRole,
+        UnlockedRole,
+        TimestampRole,
+        SubaddrMajorRole,
+        SubaddrMinorRole,
+        AddressRole,
+        SectionRole
+    };
+
+    explicit TransferHistoryModel(QObject *parent = nullptr);
+
+    QObject *wallet() const { return m_wallet; }
+    void     setWallet(QObject *w);
+    QString  directionFilter() const { return m_filter; }
+    void     setDirectionFilter(const QString &f);
+    int      count() const { return m_view.size(); }
+    bool     loading() const { return m_headPending || m_pagePending; }
+    bool     hasMore() const { return m_hasMore; }
+    quint64  chainHeight() const { return m_chainHeight; }
+
+    int      rowCount(const QModelIndex &parent = {}) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+    bool     canFetchMore(const QModelIndex &parent) const override;
+    void     fetchMore(const QModelIndex &parent) override;
+
+    Q_INVOKABLE void        reload();
+    Q_INVOKABLE QVariantMap get(int row) const;
+
+signals:
+    void walletChanged();
+    void directionFilterChanged();
+    void countChanged();
+    void loadingChanged();
+    void chainHeightChanged();
+
+private slots:
+    void onPage(const QString &caller, quint64 sinceHeight, quint64 belowHeight,
+                quint64 chainHeight, const QVector<TransferRow> &rows, bool more);
+    void onSnapshot();
+
+private:
+    static constexpr quint64 kNoCursor = std::numeric_limits<quint64>::max();
+
+    static bool before(const TransferRow &a, const TransferRow &b);
+    bool accepts(const TransferRow &r) const;
+
+    void requestHead();
+    void syncView(bool reset = false);
+    void setChainHeight(quint64 h);
+
+    QPointer<Wallet>     m_wallet;
+    QString              m_filter = QStringLiteral("All");
+    QString              m_caller;
+
+    QVector<TransferRow> m_all;    // every loaded row, sorted
+    QVector<TransferRow> m_view;   // m_all through the filter
+
+    quint64 m_cursor      = kNoCursor;   // all confirmed rows at or above are loaded
+    quint64 m_headHeight  = 0;           // chain height at the last head fetch
+    quint64 m_chainHeight = 0;
+    quint64 m_generation  = 0;
+    bool    m_hasMore     = false;
+    bool    m_loaded      = false;
+    bool    m_headPending = false;
+    bool    m_pagePending = false;
+};
@@ -73,12 +73,23 @@ public:
 
     Q_INVOKABLE QString getTransferDetailsJson() const;
 
+    // Account switch: stops without finishing, so the outputs stay reserved
+    // for the ref. restarted() is the same transfer, not yet started, or
+    // nullptr once the txset may have reached a peer.
+    void park();
+    TransferInitiator *restarted(QObject *parent) const;
+    // Deletes the session once in-flight requests have returned; nothing waits on them.
+    void deleteWhenIdle();
+    // True once the txset may have been handed to a signer; a failure after
+    // that cannot prove the transfer was never broadcast.
+    bool submitStarted() const { return m_submitStarted; }
+
 signals:
     void stageChanged(QString stageName);
     void statusChanged(QString statusText);
     void peerStatusChanged();
     void finished(QString transferRef, QString result);
-    void _httpResult(QString onion, QString path, QJsonObject result, QString error);
+    void _httpResult(QString onion, QString path, QJsonObject result, QString error, qint64 rttMs);
     void submittedSuccessfully(QString transferRef);
 
 
@@ -131,6 +142,13 @@ private:
     void checkPeersOnline();
     void pollMultisigInfo();
 
+    // More cosigners than signatures needed: the next signer is whichever
+    // ranked candidate answers ready first, not the next in signing order.
+    bool fanOut() const;
+    void offerToFastest();
+    void confirmOffer();
+    void submitTo(const QString &peer, const QStringList &order);
+
 private:
     MultiWalletController *m_wm{nullptr};
     TorBackend            *m_tor{nullptr};
@@ -145,9 +163,12 @@ private:
     int m_feePriority{0};
     QList<int> m_feeSplit;
     bool m_inspectBeforeSend{true};
+    bool m_warmStart{false};   // building from infos the import session keeps current
+    bool m_warmTried{false};
 
     Stage m_stage{Stage::INIT};
     bool  m_stopFlag{false};
+    bool  m_submitStarted{false};
 
     QList<Destination> m_destinations;
     QList<Destination> m_destinationsInit;
@@ -155,6 +176,9 @@ private:
     QHash<QString, PeerState> m_peers;
     QStringList               m_signingOrder;
     QStringList               m_signatures;
+    QString                   m_offeredTo;      // fan-out submit in flight
+    QStringList               m_offeredOrder;
+    bool                      m_offerUnconfirmed{false};   // submit to m_offeredTo failed in transit
 
     QTimer m_ping;
     QTimer m_retry;
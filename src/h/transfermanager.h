@@ -5,6 +5,7 @@
 #include <QStringList>
 #include <QVariantMap>
 #include <QJsonObject>
+#include <QTimer>
 
 class MultiWalletController;
 class TorBackend;
@@ -15,6 +16,9 @@ class TransferTracker;
 class IncomingTransfer;
 class MultisigImportSession;
 class SimpleTransfer;
+class TransferArchive;
+class TransferCatalog;
+class PayoutQueue;
 
 class TransferManager : public QObject
 {
@@ -73,6 +77,16 @@ public:
     Q_INVOKABLE void    restoreAllSaved();
     Q_INVOKABLE bool    deleteSavedTransfer(const QString &transferRef);
 
+    // ──────────────────────────────────────────────────  Archive
+    Q_INVOKABLE int          archiveTerminalTransfers();
+    Q_INVOKABLE int          archivedTransferCount(const QString &walletRef = {}) const;
+    Q_INVOKABLE QVariantList archivedTransfersPage(int offset, int limit,
+                                                   const QString &walletRef = {}) const;
+    Q_INVOKABLE QString      getArchivedTransferDetails(const QString &transferRef) const;
+    // Moves an archived transfer back into the account; it is archived
+    // again once it has sat there for the retention period.
+    Q_INVOKABLE bool         restoreArchivedTransfer(const QString &transferRef);
+
     Q_INVOKABLE bool    isMultisigImportSessionRunning() const;
     Q_INVOKABLE void    startMultisigImportSession();
     Q_INVOKABLE void    stopMultisigImportSession();
@@ -81,6 +95,25 @@ public:
     Q_INVOKABLE int     getMultisigImportActiveWalletCount() const;
     Q_INVOKABLE QString getMultisigImportWalletStatus(const QString &walletName) const;
     Q_INVOKABLE void    clearMultisigImportActivity();
+    // {ready, age_secs, current} for the wallet's "ready to spend" indicator.
+    Q_INVOKABLE QVariantMap multisigReadiness(const QString &walletName) const;
+
+    // ──────────────────────────────────────────────────  Payout queue
+    // Payouts from a multisig wallet wait here and leave in batches, one
+    // transfer per batch. amount is XMR (double) or atomic units (integer).
+    Q_INVOKABLE bool         configurePayoutQueue(const QString &walletName,
+                                                  const QStringList &signingOrder,
+                                                  int  feePriority,
+                                                  bool inspectBeforeSending,
+                                                  int  maxBatch,
+                                                  int  maxWaitMinutes);
+    Q_INVOKABLE QString      queuePayout(const QString &walletName, const QString &address,
+                                         const QVariant &amount, const QString &label = {});
+    Q_INVOKABLE bool         cancelPayout(const QString &walletName, const QString &id);
+    // A payout whose transfer may or may not have gone out: sent, or queued again.
+    Q_INVOKABLE bool         resolvePayout(const QString &walletName, const QString &id, bool sent);
+    Q_INVOKABLE QVariantList payoutQueue(const QString &walletName) const;
+    Q_INVOKABLE QString      flushPayouts(const QString &walletName);
 
 
 
@@ -108,6 +141,9 @@ public:
     }
 
     Q_INVOKABLE void reset();
+    void suspendForAccountSwitch(const QString &account);
+    void resumeAfterAccountSwitch(const QString &account);
+    void dropParkedSessions(const QString &account);
 
     QStringList outgoingSessions()          const;
     QStringList incomingSessions()          const;
@@ -124,22 +160,26 @@ signals:
     void sessionFinished(QString transferRef, QString result);
     void currentSessionChanged();
     void session_finished(QString transferRef, QString result);
+    void archiveChanged();
 
     void multisigImportSessionStarted();
     void multisigImportSessionStopped();
     void multisigImportWalletCompleted(QString walletName);
     void multisigImportPeerInfoReceived(QString walletName, QString peerOnion);
+    void multisigReadinessChanged(QString walletName);
+    void payoutQueueChanged(QString walletName);
 
 private:
 
     void    wireTracker  (TransferTracker *trk);
+    void    wireOutgoing (TransferInitiator *init);
+    void    wireSimple   (SimpleTransfer *sess);
+    // A declined, failed or deleted transfer gives its outputs back.
+    void    releaseOutputs(const QString &walletName, const QString &ref);
     QString makeTransferRef(const QString &walletRef, const QString &myOnion) const;
     static QString normOnion(QString s);
 
 
-    QJsonObject loadAccountRoot() const;
-    void        saveAccountRoot(const QJsonObject &root) const;
-
     bool upsertTransfer(const QString &walletRef,
                         const QString &walletName,
                         const QString &transferRef,
@@ -156,6 +196,7 @@ private:
                                QString *outMyOnion);
 
     static bool isTerminalStage(const QString &stage);
+    void reconcilePayouts();
 
 
     MultiWalletController *m_wm  {nullptr};
@@ -167,8 +208,22 @@ private:
     QHash<QString, TransferTracker*>    m_trackers;
     QHash<QString, SimpleTransfer*>     m_simple;
 
-    QHash<QString, QVariantMap> m_pendingIncomingMap;
-    QHash<QString, QVariantMap> m_allSavedMap;
+    // Sessions of accounts switched away from, by account. Pre-submit
+    // transfers wait here unstarted; the others resume from the saved transfer.
+    struct ParkedSessions {
+        QHash<QString, TransferInitiator*> outgoing;
+        QHash<QString, SimpleTransfer*>    simple;
+        QStringList                        incoming;
+        QStringList                        trackers;
+    };
+    QHash<QString, ParkedSessions>      m_parked;
+
+    TransferCatalog *m_catalog{nullptr};
+    QTimer           m_notify;
+
+    TransferArchive *m_archive{nullptr};
+    PayoutQueue     *m_payouts{nullptr};
+    QTimer           m_archiveTimer;
 
     MultisigImportSession *m_msigImport {nullptr};
     void setupMultisigImportWiring();
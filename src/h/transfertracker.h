@@ -51,6 +51,7 @@ private:
                                    const QString &txidCandidate,
                                    qint64 timeCandidate);
     bool        writeBack();
+    QJsonObject currentEntry() const;
 
     bool        persistPeerInfoIfChanged(const QString &onion,
                                   const QString &stage,
@@ -82,8 +83,7 @@ private:
 
 
     bool            m_loaded = false;
-    QJsonObject     m_root;
-    int             m_walletIdx = -1;
+    QJsonObject     m_entry;
     QStringList     m_peersToPoll;
     QString         m_myOnion;
 
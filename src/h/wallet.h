@@ -9,15 +9,81 @@
 #include <QTimer>
 #include <QQueue>
 #include <QMutex>
+#include <QPointer>
+#include <QVector>
+#include <QVariantMap>
+#include <QHash>
+#include <QJsonObject>
+#include <atomic>
 #include <QFutureWatcher>
 #include <QtConcurrent/QtConcurrent>
 #include <memory>
 #include <functional>
 #include <cstdint>
 
+class WalletExecutor;
+
+// Immutable copy of the wallet state that reads need, republished after every
+// op that can change it. Readers on any thread load it without the op queue
+// or the wallet2 mutex.
+struct WalletSnapshot {
+    struct Subaddress {
+        quint32 index    = 0;
+        QString address;
+        QString label;
+        quint64 balance  = 0;
+        quint64 unlocked = 0;
+    };
+    struct Account {
+        quint32 index    = 0;
+        QString label;
+        QString baseAddress;
+        quint64 balance  = 0;
+        quint64 unlocked = 0;
+        QVector<Subaddress> subaddresses;
+    };
+
+    bool     open             = false;
+    quint64  generation       = 0;
+    qint64   takenMs          = 0;
+    QString  address;
+    quint64  balance          = 0;   // account 0, as refresh reports it
+    quint64  unlocked         = 0;
+    quint64  balanceAll       = 0;
+    quint64  unlockedAll      = 0;
+    quint64  walletHeight     = 0;
+    quint64  daemonHeight     = 0;
+    bool     multisigActive   = false;
+    bool     multisigReady    = false;
+    quint32  threshold        = 0;
+    quint32  total            = 0;
+    bool     partialKeyImages = false;
+    quint32  partialOutputs   = 0;   // outputs still waiting for peers' partial key images
+    quint64  msigFingerprint  = 0;   // transfers and key image state; 0 if not multisig
+    QVector<Account> accounts;
+};
+
 namespace tools      { class wallet2; }
 namespace cryptonote { enum network_type : std::uint8_t; }
 
+// One transfer history row in native form; TransferHistoryModel keeps these
+// instead of a QVariantMap per payment.
+struct TransferRow {
+    QString txid;
+    QString paymentId;
+    QString direction;          // in, out, pending, failed
+    quint64 amount       = 0;
+    quint64 fee          = 0;
+    quint64 height       = 0;   // 0 while in the pool / unconfirmed
+    quint64 timestamp    = 0;
+    quint64 unlockTime   = 0;
+    quint32 subaddrMajor = 0;
+    quint32 subaddrMinor = 0;
+    QString address;
+    bool    unlocked     = false;
+};
+Q_DECLARE_METATYPE(TransferRow)
+
 class Wallet : public QObject
 {
     Q_OBJECT
@@ -28,12 +94,18 @@ class Wallet : public QObject
     Q_PROPERTY(QString  daemonAddress    READ daemonAddress    WRITE setDaemonAddress NOTIFY walletChanged)
     Q_PROPERTY(bool     busy             READ busy             NOTIFY busyChanged)
     Q_PROPERTY(QVariantList pendingOps   READ pendingOps       NOTIFY queueChanged)
+    Q_PROPERTY(QVariantList recentOps    READ recentOps        NOTIFY queueChanged)
     Q_PROPERTY(bool activeSyncTimer READ activeSyncTimer NOTIFY walletChanged)
     Q_PROPERTY(bool has_multisig_partial_key_images   READ hasMultisigPartialKeyImages  NOTIFY walletChanged)
     Q_PROPERTY(quint64  wallet_height          READ wallet_height          NOTIFY walletChanged)
     Q_PROPERTY(quint64  daemon_height          READ daemon_height          NOTIFY walletChanged)
+    Q_PROPERTY(bool     snapshot_ready         READ snapshotReady          NOTIFY snapshotChanged)
+    Q_PROPERTY(bool     suspended              READ suspended              NOTIFY residencyChanged)
 
 public:
+    // Scheduling lanes, highest priority first.
+    enum class Lane : quint8 { ProtocolCritical = 0, Interactive = 1, Background = 2 };
+
     explicit Wallet(QObject *parent = nullptr);
     ~Wallet() override;
 
@@ -45,9 +117,48 @@ public:
     quint64 wallet_height()         const { return m_walletHeightCache;  }
     quint64 daemon_height()         const { return m_daemonHeightCache;  }
     QVariantList pendingOps() const;
+    QVariantList recentOps() const { return m_recent; }
     bool activeSyncTimer() const { return m_syncTimer.isActive(); }
-    bool hasMultisigPartialKeyImages() const { return m_hasMsigPartialKeyImages; }
-
+    std::shared_ptr<const WalletSnapshot> snapshot() const {
+        return std::atomic_load_explicit(&m_snapshot, std::memory_order_acquire);
+    }
+    bool snapshotReady() const { const auto s = snapshot(); return s && s->open; }
+    bool hasMultisigPartialKeyImages() const {
+        const auto s = snapshot();
+        return s && s->open ? s->partialKeyImages : m_hasMsigPartialKeyImages;
+    }
+    // True while the last exported multisig info still describes the wallet:
+    // no transfer, spend, key image or nonce changed since the export.
+    bool multisigInfoCurrent() const {
+        const auto s = snapshot();
+        const quint64 fp = m_exportFingerprint.load();
+        return s && s->open && fp != 0 && s->msigFingerprint == fp;
+    }
+    // Multisig state right after the last peer info import (0 once a txset
+    // built or signed since has used it), and now.
+    quint64 lastImportFingerprint() const { return m_importFingerprint.load(); }
+    quint64 multisigFingerprint() const {
+        const auto s = snapshot();
+        return s && s->open ? s->msigFingerprint : 0;
+    }
+
+
+    // Ops run on the shared executor when set, otherwise on QtConcurrent.
+    void setExecutor(WalletExecutor *exec) { m_executor = exec; }
+
+    // A suspended wallet has stored and unloaded its wallet2 but keeps its
+    // snapshot; the next op that needs wallet2 reopens it first.
+    bool suspended() const { return m_residency == Residency::Suspended; }
+    bool resident()  const { return m_residency == Residency::Resident; }
+    bool idle()      const;
+    bool suspendable() const { return resident() && !m_openPath.isEmpty(); }
+    // Last time a non-background op was queued; periodic upkeep does not count.
+    qint64 lastUsedMs() const { return m_lastUsedMs; }
+    // hits: foreground ops that found wallet2 loaded; resumes: reopens.
+    QVariantMap residencyStats() const;
+
+    // Drops queued (not yet running) ops tagged with operation_caller.
+    Q_INVOKABLE int  cancelOperations(const QString &operation_caller);
 
     Q_INVOKABLE void getBalance();
     Q_INVOKABLE void getHeight();
@@ -63,15 +174,29 @@ public:
     Q_INVOKABLE void getAddress();
     Q_INVOKABLE void seedMulti();
     Q_INVOKABLE void getTransfers();
+    // Confirmed rows with sinceHeight < height < belowHeight, newest first,
+    // capped at limit (<= 0: no cap) but never splitting a block. Pending
+    // and pool rows are included when belowHeight is the maximum.
+    void getTransferPage(quint64 sinceHeight, quint64 belowHeight, int limit,
+                         const QString &operation_caller);
     Q_INVOKABLE void importMultisigInfos(const QList<QByteArray>  &infos, QString operation_caller);
     Q_INVOKABLE void importMultisigInfosBulk(const QList<QByteArray>  &infos,QString operation_caller);
+    // operation_caller is the transfer ref: the outputs the txset spends stay
+    // reserved for it, and later transfers are built from the other outputs
+    // until releaseOutputs() or until those outputs are seen spent.
     Q_INVOKABLE void createUnsignedMultisigTransfer(QVariantList destinations,
                                                     int feePriority,
                                                     QList<int> subtractFeeFromIndices, QString operation_caller);
+    Q_INVOKABLE void releaseOutputs(const QString &transferRef);
     Q_INVOKABLE void signMultisigBlob(const QByteArray &txsetBlob, QString operation_caller);
     Q_INVOKABLE void submitSignedMultisig(const QByteArray &signedTxset, QString operation_caller);
 
     Q_INVOKABLE void describeTransfer(const QString &multisigTxset,QString operation_caller);
+    // describeTransfer results are memoized by the SHA-256 of the decoded
+    // txset. A record ({sha, details}) is persisted with the transfer and
+    // adopted again after a restart; one for another txset is ignored.
+    QJsonObject describeRecord(const QString &multisigTxset) const;
+    void adoptDescribeRecord(const QString &multisigTxset, const QJsonObject &record);
 
     Q_INVOKABLE void restoreFromSeed(const QString &path,
                                      const QString &password,
@@ -123,6 +248,7 @@ public slots:
 
     void close();
     void save();
+    void suspend();
 
 
     void setDaemonAddress(const QString &addr);
@@ -145,15 +271,21 @@ signals:
 
     void busyChanged();
     void queueChanged();
+    void snapshotChanged();
+    void operationsCancelled(QString operation_caller, int count);
     void errorOccurred(const QString &message, QString operation_caller = "");
     void activeSyncTimerChanged();
     void walletFullyClosed();
+    void residencyChanged();
+    void walletResumed(qint64 latencyMs);
 
 
     void balanceReady(quint64 balance, quint64 unlocked, bool needsImport);
     void heightReady(quint64 height);
     void restoreHeightSet();
     void transfersReady(QVariantList transfers);
+    void transferPageReady(QString operation_caller, quint64 sinceHeight, quint64 belowHeight,
+                           quint64 chainHeight, QVector<TransferRow> rows, bool more);
     void passwordChanged(bool ok);
 
     void firstKexMsgReady(QByteArray blob);
@@ -164,7 +296,15 @@ signals:
     void addressReady(QString address);
     void seedMultiReady(QString seed);
     void multisigParamsReady(quint32 threshold, quint32 total);
+    // A published snapshot has more outputs waiting for key image import
+    // than the previous one, e.g. a refresh found new multisig outputs.
+    void multisigImportNeeded();
+    // Outputs, spends, key images or imported peer infos changed.
+    void multisigStateChanged();
     void multisigInfosImported(int nImported, bool needsRescan, QString operation_caller);
+    // Outputs whose spent status was checked with the daemon after an import;
+    // fullRescan when the daemon disagreed and every output was rechecked.
+    void spentStatusChecked(int outputsChecked, bool fullRescan, QString operation_caller);
     void unsignedMultisigReady(QByteArray txset, quint64 feeAtomic,
                                QVariantList normalizedDestinations,
                                QString warningOrEmpty, QString operation_caller);
@@ -194,16 +334,37 @@ private:
     struct Operation {
         QString                     name;
         std::function<void ()>      func;
+        Lane                        lane = Lane::Interactive;
+        QString                     caller;
+        qint64                      enqueuedMs = 0;
+        qint64                      startedMs  = 0;
+        bool                        publishes  = false;   // republish the snapshot afterwards
     };
 
+    static constexpr int kLaneCount = 3;
+
+    enum class Residency : quint8 { Resident, Suspending, Suspended };
+
     void enqueue(const QString &name, std::function<void ()> func);
+    void enqueue(const QString &name, const QString &caller, std::function<void ()> func);
+    bool takeNextOperation(Operation &out);
+    bool wakeFor(const QString &name, Lane lane);
+    void loadWallet2(const QString &path, const epee::wipeable_string &password, quint64 kdfRounds);
+    void resumeOp();
     void runNext();
+    void finishRunning();
+    void publishSnapshot();
+    void adoptSnapshot();
+    QString subaddressString(quint32 major, quint32 minor);
+    void    clearSubaddressStrings();
 
 
     QString    m_addressCache;
     quint64    m_balanceCache   = 0;
     quint64    m_unlockedCache  = 0;
     bool m_hasMsigPartialKeyImages = false;
+    quint32    m_partialOutputs = 0;
+    quint64    m_msigFingerprint = 0;
     quint64    m_walletHeightCache   = 0;
     quint64    m_daemonHeightCache   = 0;
 
@@ -213,14 +374,58 @@ private:
 
     QHash<QString, std::vector<tools::wallet2::pending_tx>> m_simplePrepared;
 
+    // describeTransfer memo; main thread only, cleared on close.
+    static QByteArray describeKey(const QString &multisigTxset);
+    void rememberDescribe(const QByteArray &key, const QJsonObject &details);
+    QHash<QByteArray, QJsonObject> m_describeMemo;
+    QList<QByteArray>              m_describeOrder;   // insertion order, oldest first
+
+    std::shared_ptr<const WalletSnapshot> m_snapshot;   // atomic_load/atomic_store only
+    std::atomic<quint64>      m_lastDaemonHeight{0};
+    std::atomic<quint64>      m_snapshotGeneration{0};
+    std::atomic<quint64>      m_exportFingerprint{0};
+    std::atomic<quint64>      m_importFingerprint{0};
 
-    QQueue<Operation>         m_queue;
+    QMutex                    m_subaddrMutex;
+    QHash<quint64, QString>   m_subaddrStrings;   // (major << 32 | minor) -> base58
+
+
+    QQueue<Operation>         m_lanes[kLaneCount];
+    Operation                 m_running;
+    QVariantList              m_recent;      // last finished ops with wait/run times
     bool                      m_busy       = false;
     QMutex                    m_mutex;
 
+    // Residency; main thread only. The open parameters are kept so a
+    // suspended wallet can reopen itself; the password only in a buffer that
+    // is wiped on close.
+    Residency                 m_residency  = Residency::Resident;
+    bool                      m_resumeQueued = false;
+    qint64                    m_resumeRequestedMs = 0;
+    qint64                    m_suspendedAtMs = 0;     // last suspend or background catch-up
+    QString                   m_openPath;
+    epee::wipeable_string     m_openPassword;
+    quint64                   m_openKdf    = 1;
+    qint64                    m_lastUsedMs = 0;
+    quint64                   m_residentHits = 0;
+    quint64                   m_resumes    = 0;
+    qint64                    m_resumeTotalMs = 0;
+    qint64                    m_lastResumeMs  = 0;
+
+    // Deferred store. Ops that change wallet2 mark it dirty on the worker;
+    // the main thread batches those into one background store.
+    void markDirty();
+    void scheduleStore();
+    bool storeIfDirty();
+    std::atomic<bool>         m_dirty{false};
+    qint64                    m_dirtySinceMs = 0;
+    QTimer                    m_storeTimer;
+
     // misc
     QString                   m_daemonAddress = "http://127.0.0.1:18081";
     QTimer                    m_syncTimer;
+    int                       m_syncIntervalMs = 0;
+    QPointer<WalletExecutor>  m_executor;
 
     QString m_proxyHost = "127.0.0.1";
     quint16 m_proxyPort = 0;
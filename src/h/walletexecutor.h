@@ -0,0 +1,72 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QThreadPool>
+#include <functional>
+
+// Shared worker pool for every Wallet's wallet2 calls. Each wallet hands over
+// at most one op at a time; the executor picks the next one by priority, then
+// by which wallet was served least recently, so one busy wallet cannot starve
+// the others. One worker is held back from background work so urgent ops are
+// never stuck behind a pool full of refreshes.
+class WalletExecutor : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(int workerCount READ workerCount WRITE setWorkerCount NOTIFY statsChanged)
+    Q_PROPERTY(int running     READ running     NOTIFY statsChanged)
+    Q_PROPERTY(int queued      READ queued      NOTIFY statsChanged)
+
+public:
+    // Lower value runs first; matches Wallet::Lane.
+    enum Priority { Urgent = 0, Normal = 1, Background = 2 };
+
+    explicit WalletExecutor(QObject *parent = nullptr);
+    ~WalletExecutor() override;
+
+    static WalletExecutor *of(const QObject *holder);
+    static int defaultWorkerCount();
+
+    int  workerCount() const { return m_workers; }
+    void setWorkerCount(int n);   // <= 0 selects the default
+    int  running() const { return m_running; }
+    int  queued()  const { return m_pending.size(); }
+
+    // work runs on a pool thread; done runs on the executor's thread afterwards,
+    // and only while owner is still alive.
+    void submit(QObject *owner, int priority, qint64 enqueuedMs,
+                std::function<void ()> work, std::function<void ()> done);
+    int  cancel(const QObject *owner);
+
+    // Start offset for a periodic refresh so wallets opened together do not
+    // refresh in lockstep.
+    int  refreshPhaseMs(int intervalMs);
+
+signals:
+    void statsChanged();
+
+private:
+    struct Task {
+        QPointer<QObject>       owner;
+        const QObject          *key = nullptr;
+        int                     priority = Normal;
+        qint64                  enqueuedMs = 0;
+        std::function<void ()>  work;
+        std::function<void ()>  done;
+    };
+
+    int  pickNext() const;
+    void dispatch();
+
+    QThreadPool                  m_pool;
+    int                          m_workers = 1;
+    int                          m_running = 0;
+    int                          m_runningBackground = 0;
+    QList<Task>                  m_pending;
+    QHash<const QObject*, quint64> m_lastServed;   // owner -> dispatch serial
+    quint64                      m_serial = 0;
+    quint32                      m_phaseSlot = 0;
+};
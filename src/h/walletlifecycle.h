@@ -0,0 +1,70 @@
+#pragma once
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QStringList>
+#include <QVariantList>
+#include <QVector>
+
+class MultiWalletController;
+class Wallet;
+
+// Opens and closes batches of wallets. Opens run a few at a time so the
+// executor keeps a worker for interactive ops, wallets the UI shows go
+// first, and each open and close is timed into a short trace. At exit the
+// pending closes (wallet2 store included) get a deadline instead of being
+// dropped with the event loop.
+class WalletLifecycle : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QVariantList trace READ trace NOTIFY traceChanged)
+    Q_PROPERTY(int pendingOpens  READ pendingOpens  NOTIFY traceChanged)
+    Q_PROPERTY(int pendingCloses READ pendingCloses NOTIFY traceChanged)
+
+public:
+    explicit WalletLifecycle(MultiWalletController *wm, QObject *parent = nullptr);
+
+    static WalletLifecycle *of(const QObject *holder);
+
+    void open(const QStringList &names);
+    void setVisible(const QStringList &names);
+    void trackClose(const QString &name, Wallet *w);
+
+    // Closes every wallet, parked accounts included, and waits for the
+    // closes to finish or for deadlineMs to pass. Returns false on timeout.
+    bool shutdown(int deadlineMs = -1);
+
+    QVariantList trace() const;
+    int pendingOpens()  const { return int(m_queue.size() + m_opening.size()); }
+    int pendingCloses() const { return int(m_closing.size()); }
+
+signals:
+    void traceChanged();
+    void closesDrained();
+
+private:
+    struct Entry {
+        QString name;
+        QString phase;
+        qint64  queuedMs  = 0;
+        qint64  startedMs = 0;
+        qint64  doneMs    = 0;
+        bool    ok        = false;
+    };
+
+    int  parallelism() const;
+    void pump();
+    void start(const QString &name);
+    void finishOpen(const QString &name, bool ok);
+    void record(const Entry &e);
+
+    QPointer<MultiWalletController> m_wm;
+    QStringList                     m_queue;
+    QHash<QString, qint64>          m_queuedAt;
+    QHash<QString, Entry>           m_opening;
+    QHash<QObject*, Entry>          m_closing;
+    QStringList                     m_visible;
+    QVector<Entry>                  m_trace;
+};
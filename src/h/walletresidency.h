@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QObject>
+#include <QVariantMap>
+#include <QPointer>
+
+class MultiWalletController;
+class QTimer;
+
+// Keeps at most limit() wallets loaded. Wallets idle for a while are suspended
+// least recently used first: wallet2 is stored and unloaded, the Wallet object
+// and its snapshot stay, and the next op that needs it reopens it. Parked
+// accounts count too, so their wallets are the first to go.
+class WalletResidency : public QObject
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QVariantMap stats READ stats NOTIFY statsChanged)
+
+public:
+    explicit WalletResidency(MultiWalletController *wm, QObject *parent = nullptr);
+
+    static WalletResidency *of(const QObject *holder);
+    static int defaultLimit();
+
+    int  limit() const { return m_limit; }
+    void setLimit(int n);   // <= 0 selects the default
+
+    QVariantMap stats() const;
+
+public slots:
+    void sweep();
+
+signals:
+    void statsChanged();
+
+private:
+    QPointer<MultiWalletController> m_wm;
+    QTimer                         *m_timer;
+    int                             m_limit{0};
+    quint64                         m_suspends{0};
+};